@@ -16,10 +16,14 @@
 
 #include "zetasql/public/analyzer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "zetasql/base/logging.h"
 #include "zetasql/analyzer/function_resolver.h"
@@ -32,11 +36,14 @@
 #include "zetasql/public/coercer.h"
 #include "zetasql/public/parse_helpers.h"
 #include "zetasql/public/parse_resume_location.h"
+#include "zetasql/public/parse_tokens.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/type.pb.h"
 #include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_node.h"
 #include "zetasql/resolved_ast/validator.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/ascii.h"
 #include "zetasql/base/map_util.h"
 #include "zetasql/base/source_location.h"
 #include "zetasql/base/ret_check.h"
@@ -356,6 +363,8 @@ zetasql_base::Status AnalyzerOptions::Deserialize(
   result->set_error_message_mode(proto.error_message_mode());
   result->set_record_parse_locations(proto.record_parse_locations());
   result->set_prune_unused_columns(proto.prune_unused_columns());
+  result->set_allocate_resolved_nodes_in_arena(
+      proto.allocate_resolved_nodes_in_arena());
   result->set_allow_undeclared_parameters(proto.allow_undeclared_parameters());
   result->set_parameter_mode(proto.parameter_mode());
 
@@ -413,6 +422,8 @@ zetasql_base::Status AnalyzerOptions::Serialize(
   proto->set_error_message_mode(error_message_mode_);
   proto->set_record_parse_locations(record_parse_locations_);
   proto->set_prune_unused_columns(prune_unused_columns_);
+  proto->set_allocate_resolved_nodes_in_arena(
+      allocate_resolved_nodes_in_arena_);
   proto->set_allow_undeclared_parameters(allow_undeclared_parameters_);
   proto->set_parameter_mode(parameter_mode_);
 
@@ -701,6 +712,191 @@ zetasql_base::Status AnalyzeNextStatement(
       options.error_message_mode(), resume_location->input(), status);
 }
 
+namespace {
+
+// A byte range of the input that ends with a top-level semicolon, or at the
+// end of the input.
+struct StatementRange {
+  int start_byte_offset;
+  int end_byte_offset;
+};
+
+// Returns true if <tokens> start a CREATE PROCEDURE statement.
+bool StartsCreateProcedure(const std::vector<ParseToken>& tokens) {
+  if (tokens.empty() || tokens[0].GetKeyword() != "CREATE") return false;
+  // Only modifiers like OR REPLACE or TEMP can come before PROCEDURE.
+  for (int i = 1; i < tokens.size() && tokens[i].IsKeyword(); ++i) {
+    if (tokens[i].GetKeyword() == "PROCEDURE") return true;
+  }
+  return false;
+}
+
+// Updates the BEGIN ... END nesting <depth> of a procedure body with
+// <tokens>. CASE expressions also end with END, while END IF, END LOOP and
+// END WHILE close blocks whose opening keyword is not counted.
+void UpdateBlockDepth(const std::vector<ParseToken>& tokens, int* depth) {
+  for (int i = 0; i < tokens.size(); ++i) {
+    const std::string keyword = tokens[i].GetKeyword();
+    if (keyword == "BEGIN" || keyword == "CASE") {
+      ++*depth;
+    } else if (keyword == "END") {
+      const std::string next_keyword =
+          i + 1 < tokens.size() ? tokens[i + 1].GetKeyword() : "";
+      if (next_keyword == "IF" || next_keyword == "LOOP" ||
+          next_keyword == "WHILE") {
+        ++i;
+      } else if (*depth > 0) {
+        --*depth;
+      }
+    }
+  }
+}
+
+// Splits <sql> into StatementRanges using the tokenizer. If the tokenizer
+// fails, the rest of the input is returned as one range, so that analyzing it
+// reports the error.
+//
+// A CREATE PROCEDURE statement is kept in one range up to the semicolon after
+// the END of its body, so that the statements inside the body are not
+// analyzed on their own. This only looks at keywords, so it can be fooled,
+// e.g. by a column called "begin". The caller then re-aligns the ranges with
+// the statements the parser actually finds.
+std::vector<StatementRange> SplitStatements(absl::string_view sql) {
+  std::vector<StatementRange> ranges;
+  ParseResumeLocation location = ParseResumeLocation::FromStringView(sql);
+  ParseTokenOptions token_options;
+  token_options.stop_at_end_of_statement = true;
+  std::vector<ParseToken> tokens;
+  // Set while inside a CREATE PROCEDURE statement.
+  bool in_procedure = false;
+  int block_depth = 0;
+  while (true) {
+    const int start_byte_offset = location.byte_position();
+    if (!GetParseTokens(token_options, &location, &tokens).ok()) {
+      if (in_procedure) {
+        ranges.back().end_byte_offset = static_cast<int>(sql.size());
+      } else {
+        ranges.push_back({start_byte_offset, static_cast<int>(sql.size())});
+      }
+      break;
+    }
+    // Only whitespace and comments are left.
+    if (tokens.size() == 1 && tokens[0].IsEndOfInput()) break;
+    if (in_procedure) {
+      ranges.back().end_byte_offset = location.byte_position();
+    } else {
+      ranges.push_back({start_byte_offset, location.byte_position()});
+      in_procedure = StartsCreateProcedure(tokens);
+      block_depth = 0;
+    }
+    if (in_procedure) {
+      UpdateBlockDepth(tokens, &block_depth);
+      // The body has been closed, or hasn't started yet, which means the
+      // statement is malformed and ends here.
+      in_procedure = block_depth > 0;
+    }
+    if (tokens.back().IsEndOfInput()) break;
+  }
+  return ranges;
+}
+
+// Returns the offset of the first non-whitespace character in <sql> at or
+// after <byte_offset>.
+int SkipWhitespace(absl::string_view sql, int byte_offset) {
+  while (byte_offset < sql.size() && absl::ascii_isspace(sql[byte_offset])) {
+    ++byte_offset;
+  }
+  return byte_offset;
+}
+
+// Analyzes the statement starting at <start_byte_offset> in <sql>.
+void AnalyzeStatementAt(absl::string_view sql, int start_byte_offset,
+                        const AnalyzerOptions& options, Catalog* catalog,
+                        TypeFactory* type_factory,
+                        StatementAnalysisResult* result) {
+  ParseResumeLocation location = ParseResumeLocation::FromStringView(sql);
+  location.set_byte_position(start_byte_offset);
+  bool at_end_of_input;
+  result->start_byte_offset = start_byte_offset;
+  result->status = AnalyzeNextStatement(&location, options, catalog,
+                                        type_factory, &result->output,
+                                        &at_end_of_input);
+  result->end_byte_offset = location.byte_position();
+}
+
+}  // namespace
+
+zetasql_base::Status AnalyzeStatementsInParallel(
+    absl::string_view sql, const AnalyzerOptions& options, Catalog* catalog,
+    TypeFactory* type_factory, int num_threads,
+    std::vector<StatementAnalysisResult>* results) {
+  results->clear();
+  ZETASQL_RETURN_IF_ERROR(ValidateAnalyzerOptions(options));
+
+  // Arenas can't be shared between concurrent analyses.
+  AnalyzerOptions statement_options = options;
+  statement_options.set_arena(nullptr);
+  statement_options.set_id_string_pool(nullptr);
+
+  std::vector<StatementRange> ranges = SplitStatements(sql);
+  if (ranges.empty()) {
+    return ::zetasql_base::OkStatus();
+  }
+
+  // Every range is analyzed as if it started a statement. Since each analysis
+  // parses from the full input, its result is the same as sequential
+  // analysis would produce at that position.
+  std::vector<StatementAnalysisResult> range_results(ranges.size());
+  std::atomic<int> next_range(0);
+  const auto analyze_ranges = [&]() {
+    for (int i = next_range++; i < ranges.size(); i = next_range++) {
+      AnalyzeStatementAt(sql, ranges[i].start_byte_offset, statement_options,
+                         catalog, type_factory, &range_results[i]);
+    }
+  };
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  num_threads = std::min<int>(num_threads, ranges.size());
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(analyze_ranges);
+  }
+  analyze_ranges();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  int i = 0;
+  while (i < ranges.size()) {
+    StatementAnalysisResult& result = range_results[i];
+    if (!result.status.ok()) {
+      // The parser doesn't tell where a statement with errors ends, so
+      // continue after the next semicolon.
+      result.end_byte_offset = ranges[i].end_byte_offset;
+    }
+    const int end_byte_offset = result.end_byte_offset;
+    results->push_back(std::move(result));
+
+    // Skip ranges that were part of this statement.
+    ++i;
+    while (i < ranges.size() && ranges[i].end_byte_offset <= end_byte_offset) {
+      ++i;
+    }
+    // The parser includes whitespace after the semicolon in the statement.
+    if (i < ranges.size() &&
+        SkipWhitespace(sql, ranges[i].start_byte_offset) !=
+            SkipWhitespace(sql, end_byte_offset)) {
+      // The statement ended inside a range, so the rest of that range starts
+      // the next statement.
+      ranges[i].start_byte_offset = end_byte_offset;
+      AnalyzeStatementAt(sql, end_byte_offset, statement_options, catalog,
+                         type_factory, &range_results[i]);
+    }
+  }
+  return ::zetasql_base::OkStatus();
+}
+
 static zetasql_base::Status AnalyzeStatementFromParserOutputImpl(
     std::unique_ptr<ParserOutput>* statement_parser_output,
     bool take_ownership_on_success, const AnalyzerOptions& options,
@@ -721,6 +917,12 @@ static zetasql_base::Status AnalyzeStatementFromParserOutputImpl(
   }
   output->reset();
 
+  // A scope is installed even if nodes are allocated on the heap, in case this
+  // is a nested analysis, e.g. from a Catalog lookup.
+  ResolvedNodeArenaScope arena_scope(
+      local_options.allocate_resolved_nodes_in_arena()
+          ? local_options.arena().get()
+          : nullptr);
   std::unique_ptr<const ResolvedStatement> resolved_statement;
   Resolver resolver(catalog, type_factory, &local_options);
   const zetasql_base::Status status =
@@ -809,6 +1011,9 @@ static zetasql_base::Status AnalyzeExpressionFromParserASTImpl(
     std::unique_ptr<ParserOutput> parser_output, absl::string_view sql,
     const AnalyzerOptions& options, Catalog* catalog, TypeFactory* type_factory,
     const Type* target_type, std::unique_ptr<const AnalyzerOutput>* output) {
+  ResolvedNodeArenaScope arena_scope(options.allocate_resolved_nodes_in_arena()
+                                         ? options.arena().get()
+                                         : nullptr);
   std::unique_ptr<const ResolvedExpr> resolved_expr;
   Resolver resolver(catalog, type_factory, &options);
   ZETASQL_RETURN_IF_ERROR(resolver.ResolveStandaloneExpr(
@@ -0,0 +1,211 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/analyzer.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/parse_resume_location.h"
+#include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/type.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+
+namespace zetasql {
+
+using ::testing::HasSubstr;
+using ::zetasql_base::testing::StatusIs;
+
+// A SimpleCatalog that counts table lookups.
+class CountingCatalog : public SimpleCatalog {
+ public:
+  CountingCatalog() : SimpleCatalog("counting") {
+    AddZetaSQLFunctions();
+    AddOwnedTable(absl::make_unique<SimpleTable>(
+        "t", std::vector<SimpleTable::NameAndType>{{"a", types::Int64Type()}}));
+  }
+
+  zetasql_base::Status GetTable(const std::string& name, const Table** table,
+                        const FindOptions& options) override {
+    ++num_table_lookups_;
+    return SimpleCatalog::GetTable(name, table, options);
+  }
+
+  int num_table_lookups() const { return num_table_lookups_; }
+
+ private:
+  std::atomic<int> num_table_lookups_{0};
+};
+
+class AnalyzeStatementsInParallelTest : public ::testing::Test {
+ protected:
+  AnalyzeStatementsInParallelTest() {
+    options_.mutable_language()->SetSupportsAllStatementKinds();
+    options_.mutable_language()->EnableMaximumLanguageFeatures();
+  }
+
+  // Analyzes <sql> in parallel and checks that each statement has the same
+  // byte range and resolved AST as with AnalyzeNextStatement() from the same
+  // position.
+  void ExpectSameAsSerial(const std::string& sql,
+                          std::vector<StatementAnalysisResult>* results) {
+    ZETASQL_ASSERT_OK(AnalyzeStatementsInParallel(sql, options_, &catalog_,
+                                          &type_factory_, /*num_threads=*/4,
+                                          results));
+    int expected_start = 0;
+    for (const StatementAnalysisResult& result : *results) {
+      EXPECT_EQ(expected_start, result.start_byte_offset) << sql;
+      ParseResumeLocation location = ParseResumeLocation::FromString(sql);
+      location.set_byte_position(result.start_byte_offset);
+      std::unique_ptr<const AnalyzerOutput> output;
+      bool at_end_of_input;
+      const zetasql_base::Status status =
+          AnalyzeNextStatement(&location, options_, &catalog_, &type_factory_,
+                               &output, &at_end_of_input);
+      EXPECT_EQ(status, result.status) << sql;
+      if (status.ok()) {
+        EXPECT_EQ(location.byte_position(), result.end_byte_offset) << sql;
+        EXPECT_EQ(output->resolved_statement()->DebugString(),
+                  result.output->resolved_statement()->DebugString());
+      }
+      expected_start = result.end_byte_offset;
+    }
+  }
+
+  AnalyzerOptions options_;
+  CountingCatalog catalog_;
+  TypeFactory type_factory_;
+};
+
+TEST_F(AnalyzeStatementsInParallelTest, MatchesSerialAnalysis) {
+  const std::string sql =
+      "SELECT 1;\n"
+      "CREATE TEMP PROCEDURE p(x INT64)\n"
+      "BEGIN\n"
+      "  SELECT a FROM t;\n"
+      "  IF x > 0 THEN\n"
+      "    SELECT CASE WHEN x > 1 THEN 'a;' END FROM t;\n"
+      "  END IF;\n"
+      "  BEGIN SELECT a + 1 FROM t; END;\n"
+      "END;\n"
+      "SELECT 'b;c' AS s;\n"
+      "SELECT 3";
+  std::vector<StatementAnalysisResult> results;
+  ExpectSameAsSerial(sql, &results);
+  ASSERT_EQ(4, results.size());
+  for (const StatementAnalysisResult& result : results) {
+    ZETASQL_EXPECT_OK(result.status);
+  }
+  EXPECT_EQ(RESOLVED_CREATE_PROCEDURE_STMT,
+            results[1].output->resolved_statement()->node_kind());
+  EXPECT_EQ(sql.size(), results.back().end_byte_offset);
+  // The statements in the procedure body are not analyzed on their own.
+  EXPECT_EQ(0, catalog_.num_table_lookups());
+}
+
+TEST_F(AnalyzeStatementsInParallelTest, FailingStatements) {
+  const std::string sql =
+      "SELECT a FROM t;\n"
+      "SELECT b FROM t;\n"
+      "CREATE PROCEDURE p(x UNKNOWN_TYPE)\n"
+      "BEGIN\n"
+      "  SELECT a FROM t;\n"
+      "END;\n"
+      "SELECT a FROM t WHERE;\n"
+      "SELECT 1";
+  std::vector<StatementAnalysisResult> results;
+  ExpectSameAsSerial(sql, &results);
+
+  // Each failing statement, including the whole failing procedure, gets one
+  // result, and analysis continues with the next statement.
+  ASSERT_EQ(5, results.size());
+  ZETASQL_EXPECT_OK(results[0].status);
+  EXPECT_THAT(results[1].status,
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument,
+                       HasSubstr("Unrecognized name: b")));
+  EXPECT_THAT(results[2].status,
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument,
+                       HasSubstr("UNKNOWN_TYPE")));
+  EXPECT_EQ(sql.find("SELECT a FROM t WHERE"),
+            sql.find_first_not_of(" \n", results[3].start_byte_offset));
+  EXPECT_THAT(results[3].status,
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+  ZETASQL_EXPECT_OK(results[4].status);
+}
+
+TEST(AnalyzerTest, AllocateResolvedNodesInArena) {
+  SimpleCatalog catalog("arena");
+  catalog.AddZetaSQLFunctions();
+  catalog.AddOwnedTable(absl::make_unique<SimpleTable>(
+      "t", std::vector<SimpleTable::NameAndType>{{"a", types::Int64Type()},
+                                                 {"s", types::StringType()}}));
+  TypeFactory type_factory;
+  const std::string sql =
+      "SELECT a + 1 AS x, CONCAT(s, 'abc') FROM t "
+      "WHERE a IN (SELECT a FROM t WHERE s = 'def') ORDER BY x";
+
+  AnalyzerOptions heap_options;
+  heap_options.set_record_parse_locations(true);
+  std::unique_ptr<const AnalyzerOutput> heap_output;
+  ZETASQL_ASSERT_OK(AnalyzeStatement(sql, heap_options, &catalog, &type_factory,
+                             &heap_output));
+
+  AnalyzerOptions arena_options = heap_options;
+  arena_options.set_allocate_resolved_nodes_in_arena(true);
+  arena_options.CreateDefaultArenasIfNotSet();
+  const size_t initial_bytes =
+      arena_options.arena()->status().bytes_allocated();
+  std::unique_ptr<const AnalyzerOutput> arena_output;
+  ZETASQL_ASSERT_OK(AnalyzeStatement(sql, arena_options, &catalog, &type_factory,
+                             &arena_output));
+  EXPECT_EQ(arena_options.arena(), arena_output->arena());
+  EXPECT_GT(arena_options.arena()->status().bytes_allocated(), initial_bytes);
+
+  // The trees are the same, including parse locations, and the arena-allocated
+  // one stays valid as long as the output holds on to the arena.
+  arena_options = AnalyzerOptions();
+  EXPECT_EQ(heap_output->resolved_statement()->DebugString(),
+            arena_output->resolved_statement()->DebugString());
+  std::vector<const ResolvedNode*> heap_literals;
+  std::vector<const ResolvedNode*> arena_literals;
+  heap_output->resolved_statement()->GetDescendantsWithKinds(
+      {RESOLVED_LITERAL}, &heap_literals);
+  arena_output->resolved_statement()->GetDescendantsWithKinds(
+      {RESOLVED_LITERAL}, &arena_literals);
+  ASSERT_EQ(heap_literals.size(), arena_literals.size());
+  ASSERT_FALSE(arena_literals.empty());
+  for (int i = 0; i < arena_literals.size(); ++i) {
+    ASSERT_NE(nullptr, arena_literals[i]->GetParseLocationRangeOrNULL());
+    EXPECT_EQ(*heap_literals[i]->GetParseLocationRangeOrNULL(),
+              *arena_literals[i]->GetParseLocationRangeOrNULL());
+  }
+
+  // Expressions can be analyzed into the arena too.
+  std::unique_ptr<const AnalyzerOutput> expr_output;
+  AnalyzerOptions expr_options;
+  expr_options.set_allocate_resolved_nodes_in_arena(true);
+  ZETASQL_ASSERT_OK(AnalyzeExpression("1 + 2", expr_options, &catalog, &type_factory,
+                              &expr_output));
+  EXPECT_EQ(RESOLVED_FUNCTION_CALL, expr_output->resolved_expr()->node_kind());
+}
+
+}  // namespace zetasql
@@ -961,6 +961,58 @@ zetasql_base::Status FunctionResolver::CheckCreateAggregateFunctionProperties(
   return zetasql_base::OkStatus();
 }
 
+// Appends the kind and type of <argument>, and of its STRUCT fields, to
+// <key_arguments>. Returns false if matching can depend on more than that.
+static bool AppendSignatureMatchCacheKeyArgument(
+    const InputArgumentType& argument,
+    std::vector<std::pair<int, const Type*>>* key_arguments) {
+  if (argument.is_literal() || argument.is_relation() || argument.is_model()) {
+    return false;
+  }
+  int kind;
+  if (argument.is_untyped_null()) {
+    kind = 1;
+  } else if (argument.is_untyped_empty_array()) {
+    kind = 2;
+  } else if (argument.is_untyped_query_parameter()) {
+    kind = 3;
+  } else if (argument.is_query_parameter()) {
+    kind = 4;
+  } else {
+    kind = 0;
+  }
+  key_arguments->emplace_back(kind, argument.type());
+  // STRUCT arguments built with STRUCT(...) or (...) carry per-field
+  // information, which may include literals.
+  for (const InputArgumentType& field : argument.field_types()) {
+    if (!AppendSignatureMatchCacheKeyArgument(field, key_arguments)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FunctionResolver::GetSignatureMatchCacheKey(
+    const Function* function,
+    const std::vector<InputArgumentType>& input_arguments,
+    SignatureMatchCacheKey* key) {
+  // Constraint callbacks see the full InputArgumentTypes, and may be stateful.
+  for (const FunctionSignature& signature : function->signatures()) {
+    if (signature.HasArgumentConstraints()) {
+      return false;
+    }
+  }
+  key->function = function;
+  key->arguments.clear();
+  key->arguments.reserve(input_arguments.size());
+  for (const InputArgumentType& argument : input_arguments) {
+    if (!AppendSignatureMatchCacheKeyArgument(argument, &key->arguments)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // TODO: Eventually we want to keep track of the closest
 // signature even if there is no match, so that we can provide a good
 // error message.  Currently, this code takes an early exit if a signature
@@ -969,6 +1021,17 @@ zetasql_base::Status FunctionResolver::CheckCreateAggregateFunctionProperties(
 const FunctionSignature* FunctionResolver::FindMatchingSignature(
     const Function* function,
     const std::vector<InputArgumentType>& input_arguments) const {
+  SignatureMatchCacheKey cache_key;
+  const bool cacheable =
+      GetSignatureMatchCacheKey(function, input_arguments, &cache_key);
+  if (cacheable) {
+    const auto it = signature_match_cache_.find(cache_key);
+    if (it != signature_match_cache_.end()) {
+      return it->second == nullptr ? nullptr
+                                   : new FunctionSignature(*it->second);
+    }
+  }
+
   std::unique_ptr<FunctionSignature> best_result_signature;
   SignatureMatchResult best_result;
 
@@ -1017,6 +1080,14 @@ const FunctionSignature* FunctionResolver::FindMatchingSignature(
       }
     }
   }
+  if (cacheable) {
+    signature_match_cache_.emplace(
+        std::move(cache_key),
+        best_result_signature == nullptr
+            ? nullptr
+            : absl::make_unique<const FunctionSignature>(
+                  *best_result_signature));
+  }
   return best_result_signature.release();
 }
 
@@ -1757,16 +1828,11 @@ zetasql_base::Status FunctionResolver::ResolveTemplatedSQLFunctionCall(
         MakeResolvedArgumentRef(arg_type.type(), arg_name.ToString(), arg_kind);
   }
 
-  // Create a separate new parser and parse the function's SQL expression from
-  // the <parse_resume_location_>. Use the same ID std::string pool as the
-  // original parser.
-  ParserOptions parser_options(analyzer_options.id_string_pool(),
-                               analyzer_options.arena());
-  std::unique_ptr<ParserOutput> parser_output;
+  // Get the function's parsed SQL expression. The function parses it once and
+  // shares the parse tree with every call.
+  const ParserOutput* parser_output;
   ZETASQL_RETURN_IF_ERROR(ForwardNestedResolutionAnalysisError(
-      function,
-      ParseExpression(function.GetParseResumeLocation(), parser_options,
-                      &parser_output),
+      function, function.GetParsedExpression(&parser_output),
       analyzer_options.error_message_mode()));
   Catalog* catalog = catalog_;
   if (function.resolution_catalog() != nullptr) {
@@ -22,6 +22,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "zetasql/analyzer/expr_resolver_helper.h"
@@ -33,6 +34,7 @@
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
 #include "zetasql/resolved_ast/resolved_ast.h"
+#include "absl/container/flat_hash_map.h"
 #include "zetasql/base/status.h"
 
 namespace zetasql {
@@ -151,6 +153,10 @@ class FunctionResolver {
   // Returns the Coercer from <resolver_>.
   const Coercer& coercer() const;
 
+  // Forgets all signatures memoized by FindMatchingSignature(). Must be called
+  // if Function or Type objects seen so far may have been destroyed.
+  void ClearSignatureMatchCache() { signature_match_cache_.clear(); }
+
   // Determines if the function signature matches the argument list, returning
   // a non-templated signature if true.  If <allow_argument_coercion> is TRUE
   // then function arguments can be coerced to the required signature
@@ -173,10 +179,34 @@ class FunctionResolver {
       QueryResolutionInfo* query_info);
 
  private:
+  // Identifies a call for the purpose of memoizing FindMatchingSignature().
+  // Holds the function and, for each argument (and recursively for each field
+  // of a STRUCT argument), its kind and Type.
+  struct SignatureMatchCacheKey {
+    const Function* function = nullptr;
+    std::vector<std::pair<int, const Type*>> arguments;
+
+    bool operator==(const SignatureMatchCacheKey& other) const {
+      return function == other.function && arguments == other.arguments;
+    }
+    template <typename H>
+    friend H AbslHashValue(H state, const SignatureMatchCacheKey& key) {
+      return H::combine(std::move(state), key.function, key.arguments);
+    }
+  };
+
   Catalog* catalog_;           // Not owned.
   TypeFactory* type_factory_;  // Not owned.
   Resolver* resolver_;         // Not owned.
 
+  // Memoized results of FindMatchingSignature(). A NULL value means that no
+  // signature matched. Calls with literal arguments are never memoized, since
+  // whether a literal coerces can depend on its value, and neither are calls
+  // to functions with argument constraint callbacks.
+  mutable absl::flat_hash_map<SignatureMatchCacheKey,
+                              std::unique_ptr<const FunctionSignature>>
+      signature_match_cache_;
+
   // Represents the argument types corresponding to a SignatureArgumentKind.
   // There are three possibilities:
   // 1) The object represents an untyped NULL.
@@ -270,10 +300,20 @@ class FunctionResolver {
   // Returns a signature that matches the argument type list, returning
   // a concrete FunctionSignature if found.  If not found, returns NULL.
   // The caller takes ownership of the returned FunctionSignature.
+  // Results are memoized in <signature_match_cache_> where possible.
   const FunctionSignature* FindMatchingSignature(
       const Function* function,
       const std::vector<InputArgumentType>& input_arguments) const;
 
+  // Builds the memoization key for calling <function> with <input_arguments>
+  // into <key>. Returns false if the call can't be memoized, because an
+  // argument is a literal or <function> has signatures with argument
+  // constraints.
+  static bool GetSignatureMatchCacheKey(
+      const Function* function,
+      const std::vector<InputArgumentType>& input_arguments,
+      SignatureMatchCacheKey* key);
+
   // Determines if the argument list count matches signature, returning the
   // number of times each repeated argument repeats and the number of
   // optional arguments present if true.
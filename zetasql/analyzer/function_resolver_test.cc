@@ -0,0 +1,130 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/analyzer/function_resolver.h"
+
+#include <memory>
+#include <vector>
+
+#include "zetasql/analyzer/resolver.h"
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/function.h"
+#include "zetasql/public/function_signature.h"
+#include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+
+namespace zetasql {
+
+class FunctionResolverTest : public ::testing::Test {
+ protected:
+  FunctionResolverTest() : catalog_("catalog") {
+    analyzer_options_.CreateDefaultArenasIfNotSet();
+    resolver_ = absl::make_unique<Resolver>(&catalog_, &type_factory_,
+                                            &analyzer_options_);
+    function_resolver_ = absl::make_unique<FunctionResolver>(
+        &catalog_, &type_factory_, resolver_.get());
+  }
+
+  std::unique_ptr<const FunctionSignature> FindMatchingSignature(
+      const Function& function,
+      const std::vector<InputArgumentType>& arguments) {
+    return absl::WrapUnique(
+        function_resolver_->FindMatchingSignature(&function, arguments));
+  }
+
+  int NumMemoizedSignatures() const {
+    return function_resolver_->signature_match_cache_.size();
+  }
+
+  TypeFactory type_factory_;
+  SimpleCatalog catalog_;
+  AnalyzerOptions analyzer_options_;
+  std::unique_ptr<Resolver> resolver_;
+  std::unique_ptr<FunctionResolver> function_resolver_;
+};
+
+TEST_F(FunctionResolverTest, MemoizesMatchingSignatures) {
+  const Function function(
+      "fn", "test", Function::SCALAR,
+      {FunctionSignature(types::Int64Type(), {types::Int64Type()},
+                         /*context_id=*/1),
+       FunctionSignature(types::DoubleType(), {types::DoubleType()},
+                         /*context_id=*/2)});
+  const std::vector<InputArgumentType> int32_argument = {
+      InputArgumentType(types::Int32Type())};
+
+  std::unique_ptr<const FunctionSignature> first =
+      FindMatchingSignature(function, int32_argument);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(1, first->context_id());
+  EXPECT_EQ(1, NumMemoizedSignatures());
+
+  // A hit returns a copy of the same signature.
+  std::unique_ptr<const FunctionSignature> second =
+      FindMatchingSignature(function, int32_argument);
+  ASSERT_NE(nullptr, second);
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_EQ(first->DebugString(), second->DebugString());
+  EXPECT_EQ(1, NumMemoizedSignatures());
+
+  // Other argument types miss, including when nothing matches.
+  std::unique_ptr<const FunctionSignature> float_match =
+      FindMatchingSignature(function, {InputArgumentType(types::FloatType())});
+  ASSERT_NE(nullptr, float_match);
+  EXPECT_EQ(2, float_match->context_id());
+  EXPECT_EQ(2, NumMemoizedSignatures());
+  EXPECT_EQ(nullptr, FindMatchingSignature(
+                         function, {InputArgumentType(types::StringType())}));
+  EXPECT_EQ(3, NumMemoizedSignatures());
+  EXPECT_EQ(nullptr, FindMatchingSignature(
+                         function, {InputArgumentType(types::StringType())}));
+  EXPECT_EQ(3, NumMemoizedSignatures());
+
+  // Literals are not memoized.
+  ASSERT_NE(nullptr, FindMatchingSignature(
+                         function, {InputArgumentType(Value::Int32(1))}));
+  EXPECT_EQ(3, NumMemoizedSignatures());
+}
+
+TEST_F(FunctionResolverTest, SignaturesWithConstraintsAreNotMemoized) {
+  int num_constraint_calls = 0;
+  bool accept = true;
+  const Function function(
+      "fn", "test", Function::SCALAR,
+      {FunctionSignature(
+          types::Int64Type(), {types::Int64Type()}, /*context_id=*/1,
+          FunctionSignatureOptions().set_constraints(
+              [&num_constraint_calls,
+               &accept](const std::vector<InputArgumentType>& arguments) {
+                ++num_constraint_calls;
+                return accept;
+              }))});
+  const std::vector<InputArgumentType> int64_argument = {
+      InputArgumentType(types::Int64Type())};
+
+  EXPECT_NE(nullptr, FindMatchingSignature(function, int64_argument));
+  EXPECT_EQ(1, num_constraint_calls);
+  // The callback runs for every call, and its new answer is honored.
+  accept = false;
+  EXPECT_EQ(nullptr, FindMatchingSignature(function, int64_argument));
+  EXPECT_EQ(2, num_constraint_calls);
+  EXPECT_EQ(0, NumMemoizedSignatures());
+}
+
+}  // namespace zetasql
@@ -98,6 +98,7 @@ void Resolver::Reset(absl::string_view sql) {
   analyzing_check_constraint_expression_ = false;
   unique_deprecation_warnings_.clear();
   deprecation_warnings_.clear();
+  function_resolver_->ClearSignatureMatchCache();
   function_arguments_.clear();
   function_table_arguments_.clear();
   resolved_columns_from_table_scans_.clear();
@@ -18,6 +18,7 @@
 
 #include <memory>
 
+#include "zetasql/base/atomic_sequence_num.h"
 #include "zetasql/base/logging.h"
 #include "zetasql/analyzer/name_scope.h"
 #include "zetasql/analyzer/query_resolver_helper.h"
@@ -25,6 +26,8 @@
 #include "zetasql/parser/ast_node_kind.h"
 #include "zetasql/parser/parser.h"
 #include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/templated_sql_function.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
 #include "zetasql/resolved_ast/resolved_node_kind.pb.h"
 #include "zetasql/testdata/error_catalog.h"
 #include "zetasql/testdata/sample_catalog.h"
@@ -746,4 +749,79 @@ TEST_F(ResolverTest, TestExpectedErrorMessage) {
                            expected_error_substr);
 }
 
+// Returns the TemplatedSQLFunctionCalls for the arguments of <expr>, which must
+// all be calls to templated SQL functions.
+static std::vector<const TemplatedSQLFunctionCall*> GetTemplatedArgumentCalls(
+    const ResolvedExpr* expr) {
+  std::vector<const TemplatedSQLFunctionCall*> calls;
+  for (const std::unique_ptr<const ResolvedExpr>& argument :
+       expr->GetAs<ResolvedFunctionCall>()->argument_list()) {
+    const ResolvedFunctionCall* call =
+        argument->GetAs<ResolvedFunctionCall>();
+    calls.push_back(static_cast<const TemplatedSQLFunctionCall*>(
+        call->function_call_info().get()));
+  }
+  return calls;
+}
+
+TEST_F(ResolverTest, RepeatedTemplatedSQLFunctionCalls) {
+  const std::string sql =
+      "udf_templated_arg_plus_integer(1) + udf_templated_arg_plus_integer(2)";
+  // Resolve twice, so that the second resolution uses the parse tree of the
+  // function body cached by the first one.
+  for (int i = 0; i < 2; ++i) {
+    resolver_->Reset(sql);
+    std::unique_ptr<ParserOutput> parser_output;
+    std::unique_ptr<const ResolvedExpr> resolved_expr;
+    ZETASQL_ASSERT_OK(ParseExpression(sql, ParserOptions(), &parser_output));
+    ZETASQL_ASSERT_OK(ResolveExpr(parser_output->expression(), &resolved_expr));
+    ASSERT_EQ(RESOLVED_FUNCTION_CALL, resolved_expr->node_kind());
+
+    // Each call gets its own resolved body.
+    const std::vector<const TemplatedSQLFunctionCall*> calls =
+        GetTemplatedArgumentCalls(resolved_expr.get());
+    ASSERT_EQ(2, calls.size());
+    EXPECT_NE(calls[0], calls[1]);
+    EXPECT_NE(calls[0]->expr(), calls[1]->expr());
+    EXPECT_EQ(calls[0]->expr()->DebugString(), calls[1]->expr()->DebugString());
+    EXPECT_TRUE(calls[1]->expr()->type()->IsInt64());
+  }
+}
+
+TEST_F(ResolverTest, TemplatedSQLFunctionBodiesWithSubqueries) {
+  sample_catalog_->catalog()->AddOwnedFunction(new TemplatedSQLFunction(
+      {"udf_templated_subquery"},
+      FunctionSignature(FunctionArgumentType(ARG_TYPE_ARBITRARY),
+                        {FunctionArgumentType(ARG_TYPE_ARBITRARY)},
+                        /*context_id=*/1),
+      /*argument_names=*/{"x"},
+      ParseResumeLocation::FromString("(SELECT y FROM UNNEST([x]) AS y)")));
+  // Share the column ids of the calling statement with the function bodies.
+  zetasql_base::SequenceNumber column_id_sequence;
+  analyzer_options_.set_column_id_sequence_number(&column_id_sequence);
+  resolver_->Reset("");
+
+  std::unique_ptr<ParserOutput> parser_output;
+  std::unique_ptr<const ResolvedExpr> resolved_expr;
+  ZETASQL_ASSERT_OK(ParseExpression(
+      "udf_templated_subquery(1) + udf_templated_subquery(2)", ParserOptions(),
+      &parser_output));
+  ZETASQL_ASSERT_OK(ResolveExpr(parser_output->expression(), &resolved_expr));
+  ASSERT_EQ(RESOLVED_FUNCTION_CALL, resolved_expr->node_kind());
+
+  // The subquery of each call produces columns of its own.
+  const std::vector<const TemplatedSQLFunctionCall*> calls =
+      GetTemplatedArgumentCalls(resolved_expr.get());
+  ASSERT_EQ(2, calls.size());
+  std::vector<int> column_ids;
+  for (const TemplatedSQLFunctionCall* call : calls) {
+    ASSERT_EQ(RESOLVED_SUBQUERY_EXPR, call->expr()->node_kind());
+    const ResolvedScan* subquery =
+        call->expr()->GetAs<ResolvedSubqueryExpr>()->subquery();
+    ASSERT_EQ(1, subquery->column_list_size());
+    column_ids.push_back(subquery->column_list(0).column_id());
+  }
+  EXPECT_NE(column_ids[0], column_ids[1]);
+}
+
 }  // namespace zetasql
@@ -20,8 +20,11 @@
 
 #include "zetasql/base/case.h"
 
+#include <algorithm>
 #include <string>
+#include <utility>
 
+#include "absl/hash/hash.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/string_view.h"
 
@@ -57,4 +60,31 @@ int CaseCompare(absl::string_view s1, absl::string_view s2) {
   }
 }
 
+namespace {
+
+// Hashes the ASCII-lowercased contents of <str>. The bytes are lowercased
+// into a small stack buffer and fed to the hash state chunk by chunk.
+struct LowercasedView {
+  absl::string_view str;
+
+  template <typename H>
+  friend H AbslHashValue(H state, const LowercasedView& view) {
+    char buffer[64];
+    for (size_t pos = 0; pos < view.str.size(); pos += sizeof(buffer)) {
+      const size_t length = std::min(sizeof(buffer), view.str.size() - pos);
+      for (size_t i = 0; i < length; ++i) {
+        buffer[i] = absl::ascii_tolower(view.str[pos + i]);
+      }
+      state = H::combine_contiguous(std::move(state), buffer, length);
+    }
+    return H::combine(std::move(state), view.str.size());
+  }
+};
+
+}  // namespace
+
+size_t CaseHash(absl::string_view s) {
+  return absl::Hash<LowercasedView>()(LowercasedView{s});
+}
+
 }  // namespace zetasql_base
@@ -107,16 +107,25 @@ struct CaseLess {
   }
 };
 
+// CaseHash()
+//
+// Returns a hash of <s> that is consistent with CaseEqual(), i.e. strings that
+// differ only in ASCII case hash to the same value. Does not allocate.
+size_t CaseHash(absl::string_view s);
+
+// Case-insensitive equality and hash functors. Both are transparent, so hash
+// containers keyed by std::string can be probed with an absl::string_view (or
+// any-case std::string) without building a lowercased copy of the key.
 struct StringViewCaseEqual {
+  using is_transparent = void;
   bool operator()(absl::string_view s1, absl::string_view s2) const {
     return CaseEqual(s1, s2);
   }
 };
 
 struct StringViewCaseHash {
-  size_t operator()(absl::string_view s1) const {
-    return std::hash<std::string>()(absl::AsciiStrToLower(s1));
-  }
+  using is_transparent = void;
+  size_t operator()(absl::string_view s1) const { return CaseHash(s1); }
 };
 
 }  // namespace zetasql_base
@@ -21,8 +21,10 @@
 
 #include <algorithm>
 #include <cstring>
+#include <string>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 
 namespace zetasql_base {
 
@@ -102,4 +104,31 @@ TEST(stringtest, CaseCompare) {
   ASSERT_TRUE(CaseLess()(k, j));
 }
 
+TEST(CaseHashTest, ConsistentWithCaseEqual) {
+  EXPECT_EQ(CaseHash("abc"), CaseHash("ABC"));
+  EXPECT_EQ(CaseHash("aBc"), CaseHash(std::string("AbC")));
+  EXPECT_EQ(CaseHash(""), CaseHash(absl::string_view()));
+  EXPECT_NE(CaseHash("abc"), CaseHash("abd"));
+  EXPECT_NE(CaseHash("abc"), CaseHash(absl::string_view("abc\0", 4)));
+
+  // Longer than the internal chunk size.
+  const std::string lower(200, 'x');
+  const std::string upper(200, 'X');
+  EXPECT_EQ(CaseHash(lower), CaseHash(upper));
+  EXPECT_NE(CaseHash(lower), CaseHash(lower + "x"));
+}
+
+TEST(CaseHashTest, HeterogeneousLookup) {
+  absl::flat_hash_map<std::string, int, StringViewCaseHash,
+                      StringViewCaseEqual>
+      map;
+  map["table"] = 1;
+  map["other"] = 2;
+  ASSERT_NE(map.end(), map.find(absl::string_view("TaBlE")));
+  EXPECT_EQ(1, map.find(absl::string_view("TaBlE"))->second);
+  EXPECT_EQ(2, map.find(std::string("OTHER"))->second);
+  EXPECT_EQ(map.end(), map.find(absl::string_view("tables")));
+  EXPECT_EQ(1, map.count("TABLE"));
+}
+
 }  // namespace zetasql_base
@@ -0,0 +1,142 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_ZETASQL_ZETASQL_BASE_THREAD_CONFINABLE_REFERENCE_COUNTED_H_
+#define THIRD_PARTY_ZETASQL_ZETASQL_BASE_THREAD_CONFINABLE_REFERENCE_COUNTED_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+namespace zetasql_base {
+
+// Like SimpleReferenceCounted, but instances that are only ever referenced
+// from one thread can be confined to that thread with
+// ConfineToCurrentThread(). Ref() and Unref() on a confined instance use
+// plain loads and stores instead of atomic read-modify-write operations.
+//
+// Before a confined instance becomes reachable from another thread, the
+// owning thread must call Share(), and the instance must then be handed over
+// with the usual synchronization (a mutex, a queue, ...). Debug builds assert
+// that confined instances are only referenced by their owner.
+//
+// Ref() and Unref() of unconfined instances pay one extra, well predicted
+// branch over SimpleReferenceCounted, so only classes that actually get
+// confined should derive from this one.
+class ThreadConfinableReferenceCounted {
+ public:
+  // The caller owns the initial reference, and must eventually call Unref()
+  // to release it. New instances are not confined.
+  ThreadConfinableReferenceCounted() : ref_count_(1) {}
+
+  // Not copyable or movable, for the same reasons as SimpleReferenceCounted.
+  ThreadConfinableReferenceCounted(const ThreadConfinableReferenceCounted&) =
+      delete;
+  ThreadConfinableReferenceCounted(ThreadConfinableReferenceCounted&&) =
+      delete;
+  ThreadConfinableReferenceCounted& operator=(
+      const ThreadConfinableReferenceCounted&) = delete;
+  ThreadConfinableReferenceCounted& operator=(
+      ThreadConfinableReferenceCounted&&) = delete;
+
+  // Take possession of a reference on this, which must eventually be released
+  // with Unref().
+  void Ref() const {
+    if (owner_ != 0) {
+      assert(IsConfinedToCurrentThread());
+      ref_count_.store(ref_count_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+    } else {
+      ref_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Drop a reference on this, which ought to have been owned by the caller.
+  // WARNING: Unref() may delete the object and it should not be touched once
+  // a reference is no longer held.
+  void Unref() const {
+    if (owner_ != 0) {
+      assert(IsConfinedToCurrentThread());
+      const int32_t ref_count = ref_count_.load(std::memory_order_relaxed) - 1;
+      ref_count_.store(ref_count, std::memory_order_relaxed);
+      if (ref_count == 0) {
+        OnRefCountIsZero();
+      }
+    } else if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) - 1 == 0) {
+      OnRefCountIsZero();
+    }
+  }
+
+  // Confines this instance to the calling thread. REQUIRES: the instance is
+  // not referenced from any other thread.
+  void ConfineToCurrentThread() { owner_ = CurrentThreadId(); }
+
+  // Makes this instance safe to reference from any thread again. Must be
+  // called on the owning thread if the instance is confined.
+  //
+  // This is const so that it can be applied to instances that are shared
+  // logically, through const pointers. Confinement is not part of the
+  // observable state of the instance.
+  void Share() const {
+    assert(!IsThreadConfined() || IsConfinedToCurrentThread());
+    owner_ = 0;
+  }
+
+  bool IsThreadConfined() const { return owner_ != 0; }
+  bool IsConfinedToCurrentThread() const {
+    return owner_ == CurrentThreadId();
+  }
+
+  // Returns true if the reference count is exactly 1. See
+  // SimpleReferenceCounted::RefCountIsOne().
+  bool RefCountIsOne() const {
+    return ref_count_.load(std::memory_order_acquire) == 1;
+  }
+
+ protected:
+  virtual ~ThreadConfinableReferenceCounted() {}
+
+  // Invoked by Unref() once the reference count reaches 0. See
+  // SimpleReferenceCounted::OnRefCountIsZero().
+  virtual void OnRefCountIsZero() const {
+    delete this;
+  }
+
+  // Protected accessor for testing/debugging purposes in base classes.
+  const int32_t ref_count() const {
+    return ref_count_.load(std::memory_order_acquire);
+  }
+
+ private:
+  // Returns a nonzero number identifying the calling thread.
+  static int32_t CurrentThreadId() {
+    static std::atomic<int32_t> next_thread_id(1);
+    thread_local const int32_t thread_id =
+        next_thread_id.fetch_add(1, std::memory_order_relaxed);
+    return thread_id;
+  }
+
+  mutable std::atomic<int32_t> ref_count_;
+  // The CurrentThreadId() of the owning thread of a confined instance, or 0.
+  // Stored in what would otherwise be padding after the count, so derived
+  // classes are no larger than with SimpleReferenceCounted.
+  mutable int32_t owner_ = 0;
+};
+
+}  // namespace zetasql_base
+
+#endif  // THIRD_PARTY_ZETASQL_ZETASQL_BASE_THREAD_CONFINABLE_REFERENCE_COUNTED_H_
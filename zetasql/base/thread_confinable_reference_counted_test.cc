@@ -0,0 +1,113 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/base/thread_confinable_reference_counted.h"
+
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using ::testing::Eq;
+
+namespace zetasql_base {
+
+// Test class that counts dtor and OnRefCountIsZero() invocations and exposes
+// ref_count().
+class TestRefCounted : public ThreadConfinableReferenceCounted {
+ public:
+  TestRefCounted(int* destructor_counter, int* final_unref_count)
+      : destruct_count_(destructor_counter),
+        final_unref_count_(final_unref_count) {}
+
+  ~TestRefCounted() override {
+    if (destruct_count_) ++*destruct_count_;
+  }
+
+  void OnRefCountIsZero() const override {
+    if (final_unref_count_) ++*final_unref_count_;
+    ThreadConfinableReferenceCounted::OnRefCountIsZero();
+  }
+
+  size_t ref_count() const {
+    return ThreadConfinableReferenceCounted::ref_count();
+  }
+
+ private:
+  int* const destruct_count_;
+  int* const final_unref_count_;
+};
+
+// Tests Ref(), Unref() and reference counts of unconfined instances.
+TEST(ThreadConfinableReferenceCounted, RefUnrefAndRefCount) {
+  int destruct_count = 0;
+  int finalize_count = 0;
+  TestRefCounted* rc = new TestRefCounted(&destruct_count, &finalize_count);
+  EXPECT_FALSE(rc->IsThreadConfined());
+  EXPECT_TRUE(rc->RefCountIsOne());
+
+  rc->Ref();
+  EXPECT_FALSE(rc->RefCountIsOne());
+  EXPECT_THAT(rc->ref_count(), Eq(2));
+  std::thread other_thread([rc] { rc->Unref(); });
+  other_thread.join();
+  EXPECT_TRUE(rc->RefCountIsOne());
+  EXPECT_THAT(destruct_count, Eq(0));
+
+  rc->Unref();
+  EXPECT_THAT(destruct_count, Eq(1));
+  EXPECT_THAT(finalize_count, Eq(1));
+}
+
+// Tests Ref() and Unref() on thread-confined instances, and sharing them
+// with another thread.
+TEST(ThreadConfinableReferenceCounted, ThreadConfined) {
+  int destruct_count = 0;
+  int finalize_count = 0;
+  TestRefCounted* rc = new TestRefCounted(&destruct_count, &finalize_count);
+  rc->ConfineToCurrentThread();
+  EXPECT_TRUE(rc->IsThreadConfined());
+  EXPECT_TRUE(rc->IsConfinedToCurrentThread());
+
+  rc->Ref();
+  rc->Ref();
+  EXPECT_THAT(rc->ref_count(), Eq(3));
+  rc->Unref();
+  EXPECT_THAT(rc->ref_count(), Eq(2));
+
+  std::thread other_thread([rc] {
+    EXPECT_TRUE(rc->IsThreadConfined());
+    EXPECT_FALSE(rc->IsConfinedToCurrentThread());
+  });
+  other_thread.join();
+
+  rc->Share();
+  EXPECT_FALSE(rc->IsThreadConfined());
+  std::thread sharing_thread([rc] {
+    rc->Ref();
+    rc->Unref();
+    rc->Unref();
+  });
+  sharing_thread.join();
+  EXPECT_TRUE(rc->RefCountIsOne());
+
+  rc->ConfineToCurrentThread();
+  rc->Unref();
+  EXPECT_THAT(destruct_count, Eq(1));
+  EXPECT_THAT(finalize_count, Eq(1));
+}
+
+}  // namespace zetasql_base
@@ -16,20 +16,368 @@
 
 #include "zetasql/common/utf_util.h"
 
+#include <cstdint>
+#include <cstring>
+
 #include "zetasql/base/logging.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ZETASQL_UTF_UTIL_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
 namespace zetasql {
 
 constexpr absl::string_view kReplacementCharacter = "\uFFFD";
 
+// Returns the number of bytes of the UTF8 sequence starting with <lead>, or 0
+// if <lead> cannot start a well formed sequence.
+static int SequenceLength(uint8_t lead) {
+  if (lead < 0x80) return 1;
+  if (lead < 0xC2) return 0;  // Continuation byte, or overlong 2-byte lead.
+  if (lead < 0xE0) return 2;
+  if (lead < 0xF0) return 3;
+  if (lead < 0xF5) return 4;
+  return 0;  // Above U+10FFFF.
+}
+
+// Returns true if <byte> can follow <lead> in a multibyte sequence. The valid
+// second bytes are narrower than 0x80..0xBF after some leads, which rules out
+// overlong encodings, surrogates and code points above U+10FFFF.
+static bool IsValidSecondByte(uint8_t lead, uint8_t byte) {
+  switch (lead) {
+    case 0xE0:
+      return byte >= 0xA0 && byte <= 0xBF;
+    case 0xED:
+      return byte >= 0x80 && byte <= 0x9F;
+    case 0xF0:
+      return byte >= 0x90 && byte <= 0xBF;
+    case 0xF4:
+      return byte >= 0x80 && byte <= 0x8F;
+    default:
+      return byte >= 0x80 && byte <= 0xBF;
+  }
+}
+
+// Returns the number of bytes at the start of <s> that are a prefix of a well
+// formed sequence, and sets <*length> to the length of the sequence that <s>
+// starts with (0 if its first byte is invalid). The sequence is well formed
+// if the return value equals <*length>. <s> must not be empty.
+static int WellFormedSequencePrefix(absl::string_view s, int* length) {
+  const uint8_t lead = static_cast<uint8_t>(s[0]);
+  *length = SequenceLength(lead);
+  if (*length <= 1) return *length;
+  if (s.size() < 2 || !IsValidSecondByte(lead, static_cast<uint8_t>(s[1]))) {
+    return 1;
+  }
+  int valid = 2;
+  while (valid < *length && valid < s.size() &&
+         (static_cast<uint8_t>(s[valid]) & 0xC0) == 0x80) {
+    ++valid;
+  }
+  return valid;
+}
+
+// Returns the length of the well formed prefix of <s>, starting the scan at
+// <start>, which must be at a character boundary with s[0, start) well formed.
+static absl::string_view::size_type ScalarSpanWellFormedUTF8(
+    absl::string_view s, absl::string_view::size_type start) {
+  constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+  absl::string_view::size_type pos = start;
+  while (pos < s.size()) {
+    // Skip ASCII eight bytes at a time.
+    if (pos + sizeof(uint64_t) <= s.size()) {
+      uint64_t word;
+      memcpy(&word, s.data() + pos, sizeof(word));
+      if ((word & kHighBits) == 0) {
+        pos += sizeof(word);
+        continue;
+      }
+    }
+    if (static_cast<uint8_t>(s[pos]) < 0x80) {
+      ++pos;
+      continue;
+    }
+    int length;
+    if (WellFormedSequencePrefix(s.substr(pos), &length) != length ||
+        length == 0) {
+      return pos;
+    }
+    pos += length;
+  }
+  return pos;
+}
+
+// Returns the start of the character containing s[pos], or <pos> if it starts
+// a character, given that s[0, pos) is well formed except possibly for its
+// last sequence, which may be incomplete or start with an invalid lead.
+static absl::string_view::size_type CharacterStartAtOrBefore(
+    absl::string_view s, absl::string_view::size_type pos) {
+  for (int back = 1; back <= 3 && back <= pos; ++back) {
+    const uint8_t byte = static_cast<uint8_t>(s[pos - back]);
+    if ((byte & 0xC0) != 0x80) {
+      // Invalid leads such as 0xC0 are only caught with the byte after them.
+      const int length = SequenceLength(byte);
+      return length == 0 || back < length ? pos - back : pos;
+    }
+  }
+  return pos;
+}
+
+#ifdef ZETASQL_UTF_UTIL_X86_SIMD
+
+// Vectorized validation following "Validating UTF-8 In Less Than One
+// Instruction Per Byte" (Keiser and Lemire). Each byte is classified by
+// looking up the high nibble of the previous byte, the low nibble of the
+// previous byte and the high nibble of the byte itself in three 16-entry
+// tables; any bit set in all three lookups is an error. Continuation bytes
+// required by 3- and 4-byte leads two and three bytes back are checked
+// separately.
+//
+// Error bits in the lookup tables.
+constexpr uint8_t kTooShort = 1 << 0;    // 11______ 0_______ or 11______.
+constexpr uint8_t kTooLong = 1 << 1;     // 0_______ 10______
+constexpr uint8_t kOverlong3 = 1 << 2;   // 11100000 100_____
+constexpr uint8_t kTooLarge = 1 << 3;    // 11110100 1001____ and above.
+constexpr uint8_t kSurrogate = 1 << 4;   // 11101101 101_____
+constexpr uint8_t kOverlong2 = 1 << 5;   // 1100000_ 10______
+constexpr uint8_t kTooLarge1000 = 1 << 6;  // 11110101 1000____ and above.
+constexpr uint8_t kOverlong4 = 1 << 6;   // 11110000 1000____
+constexpr uint8_t kTwoConts = 1 << 7;    // 10______ 10______
+// Errors that depend only on the high nibble of the previous byte.
+constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+alignas(16) static const uint8_t kPrevHighNibbleTable[16] = {
+    // 0_______: ASCII.
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    // 10______: continuation.
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    // 1100____, 1101____: 2-byte lead.
+    kTooShort | kOverlong2,
+    kTooShort,
+    // 1110____: 3-byte lead.
+    kTooShort | kOverlong3 | kSurrogate,
+    // 1111____: 4-byte lead.
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4};
+
+alignas(16) static const uint8_t kPrevLowNibbleTable[16] = {
+    // ____0000
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    // ____0001
+    kCarry | kOverlong2,
+    // ____001_
+    kCarry,
+    kCarry,
+    // ____0100
+    kCarry | kTooLarge,
+    // ____0101, ____011_, ____1___
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    // ____1101
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000};
+
+alignas(16) static const uint8_t kHighNibbleTable[16] = {
+    // 0_______: ASCII.
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    // 1000____
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 |
+        kOverlong4,
+    // 1001____
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    // 101_____
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    // 11______: lead.
+    kTooShort, kTooShort, kTooShort, kTooShort};
+
+// Bytes above these values at the end of a block start a sequence that
+// continues into the next block.
+alignas(32) static const uint8_t kIncompleteMax[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1};
+
+// Returns the start of the first 16-byte block of <data> that may contain an
+// error, or the start of the incomplete block at the end of <data>. The bytes
+// before the returned position are well formed except possibly for an
+// incomplete sequence at the end.
+__attribute__((target("sse4.2"))) static size_t ValidatedPrefixSSE42(
+    const char* data, size_t length) {
+  const __m128i prev_high_table = _mm_load_si128(
+      reinterpret_cast<const __m128i*>(kPrevHighNibbleTable));
+  const __m128i prev_low_table =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kPrevLowNibbleTable));
+  const __m128i high_table =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kHighNibbleTable));
+  const __m128i incomplete_max =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(kIncompleteMax + 16));
+  const __m128i low_nibble_mask = _mm_set1_epi8(0x0F);
+  const __m128i third_byte_min = _mm_set1_epi8(0xE0 - 0x80);
+  const __m128i fourth_byte_min = _mm_set1_epi8(0xF0 - 0x80);
+  const __m128i high_bit = _mm_set1_epi8(static_cast<char>(0x80));
+
+  __m128i prev_input = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+  size_t pos = 0;
+  for (; pos + 16 <= length; pos += 16) {
+    const __m128i input =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    __m128i error;
+    if (_mm_movemask_epi8(input) == 0) {
+      // All ASCII. Only a sequence left open by the previous block can fail.
+      error = prev_incomplete;
+    } else {
+      const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+      const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+      const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+      const __m128i special_cases = _mm_and_si128(
+          _mm_and_si128(
+              _mm_shuffle_epi8(prev_high_table,
+                               _mm_and_si128(_mm_srli_epi16(prev1, 4),
+                                             low_nibble_mask)),
+              _mm_shuffle_epi8(prev_low_table,
+                               _mm_and_si128(prev1, low_nibble_mask))),
+          _mm_shuffle_epi8(high_table,
+                           _mm_and_si128(_mm_srli_epi16(input, 4),
+                                         low_nibble_mask)));
+      const __m128i must_be_continuation = _mm_and_si128(
+          _mm_or_si128(_mm_subs_epu8(prev2, third_byte_min),
+                       _mm_subs_epu8(prev3, fourth_byte_min)),
+          high_bit);
+      error = _mm_xor_si128(must_be_continuation, special_cases);
+      prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+    }
+    if (!_mm_testz_si128(error, error)) break;
+    prev_input = input;
+  }
+  return pos;
+}
+
+// Same as ValidatedPrefixSSE42(), with 32-byte blocks.
+__attribute__((target("avx2"))) static size_t ValidatedPrefixAVX2(
+    const char* data, size_t length) {
+  const __m256i prev_high_table = _mm256_broadcastsi128_si256(_mm_load_si128(
+      reinterpret_cast<const __m128i*>(kPrevHighNibbleTable)));
+  const __m256i prev_low_table = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kPrevLowNibbleTable)));
+  const __m256i high_table = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kHighNibbleTable)));
+  const __m256i incomplete_max =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(kIncompleteMax));
+  const __m256i low_nibble_mask = _mm256_set1_epi8(0x0F);
+  const __m256i third_byte_min = _mm256_set1_epi8(0xE0 - 0x80);
+  const __m256i fourth_byte_min = _mm256_set1_epi8(0xF0 - 0x80);
+  const __m256i high_bit = _mm256_set1_epi8(static_cast<char>(0x80));
+
+  __m256i prev_input = _mm256_setzero_si256();
+  __m256i prev_incomplete = _mm256_setzero_si256();
+  size_t pos = 0;
+  for (; pos + 32 <= length; pos += 32) {
+    const __m256i input =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+    __m256i error;
+    if (_mm256_movemask_epi8(input) == 0) {
+      error = prev_incomplete;
+    } else {
+      // The last 16 bytes of the previous block followed by the first 16
+      // bytes of this one, so that alignr can shift across the two lanes.
+      const __m256i shifted =
+          _mm256_permute2x128_si256(prev_input, input, 0x21);
+      const __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+      const __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+      const __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+      const __m256i special_cases = _mm256_and_si256(
+          _mm256_and_si256(
+              _mm256_shuffle_epi8(prev_high_table,
+                                  _mm256_and_si256(_mm256_srli_epi16(prev1, 4),
+                                                   low_nibble_mask)),
+              _mm256_shuffle_epi8(prev_low_table,
+                                  _mm256_and_si256(prev1, low_nibble_mask))),
+          _mm256_shuffle_epi8(high_table,
+                              _mm256_and_si256(_mm256_srli_epi16(input, 4),
+                                               low_nibble_mask)));
+      const __m256i must_be_continuation = _mm256_and_si256(
+          _mm256_or_si256(_mm256_subs_epu8(prev2, third_byte_min),
+                          _mm256_subs_epu8(prev3, fourth_byte_min)),
+          high_bit);
+      error = _mm256_xor_si256(must_be_continuation, special_cases);
+      prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+    }
+    if (!_mm256_testz_si256(error, error)) break;
+    prev_input = input;
+  }
+  return pos;
+}
+
+using ValidatedPrefixFunction = size_t (*)(const char* data, size_t length);
+
+static ValidatedPrefixFunction ChooseValidatedPrefixFunction() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return ValidatedPrefixAVX2;
+  if (__builtin_cpu_supports("sse4.2")) return ValidatedPrefixSSE42;
+  return nullptr;
+}
+
+#endif  // ZETASQL_UTF_UTIL_X86_SIMD
+
+namespace internal {
+
+absl::string_view::size_type SpanWellFormedUTF8Scalar(absl::string_view s) {
+  return ScalarSpanWellFormedUTF8(s, 0);
+}
+
+}  // namespace internal
+
 absl::string_view::size_type SpanWellFormedUTF8(absl::string_view s) {
-  return s.length();  // yup, that looks right.
+  absl::string_view::size_type start = 0;
+#ifdef ZETASQL_UTF_UTIL_X86_SIMD
+  // Shorter strings never fill a block.
+  if (s.size() >= 16) {
+    static const ValidatedPrefixFunction validated_prefix =
+        ChooseValidatedPrefixFunction();
+    if (validated_prefix != nullptr) {
+      // The vectorized scan stops at the block containing the first error, if
+      // any; finish from the start of the character containing that block's
+      // first byte.
+      start = CharacterStartAtOrBefore(s, validated_prefix(s.data(), s.size()));
+    }
+  }
+#endif
+  return ScalarSpanWellFormedUTF8(s, start);
 }
 
 std::string CoerceToWellFormedUTF8(absl::string_view input) {
-  return std::string(input);  // yup, that looks right.
+  absl::string_view::size_type span = SpanWellFormedUTF8(input);
+  if (span == input.size()) {
+    return std::string(input);
+  }
+  std::string output;
+  output.reserve(input.size() + kReplacementCharacter.size());
+  while (true) {
+    output.append(input.data(), span);
+    if (span == input.size()) break;
+    output.append(kReplacementCharacter.data(), kReplacementCharacter.size());
+    // Replace each maximal prefix of a well formed sequence (or a single
+    // invalid byte) with one replacement character.
+    input.remove_prefix(span);
+    int length;
+    const int invalid_length = WellFormedSequencePrefix(input, &length);
+    input.remove_prefix(invalid_length > 0 ? invalid_length : 1);
+    span = SpanWellFormedUTF8(input);
+  }
+  return output;
 }
 
 std::string PrettyTruncateUTF8(absl::string_view input, int max_bytes) {
@@ -17,18 +17,32 @@
 #ifndef ZETASQL_COMMON_UTF_UTIL_H_
 #define ZETASQL_COMMON_UTF_UTIL_H_
 
+#include <string>
+
 #include "absl/strings/string_view.h"
 
 namespace zetasql {
 
 // Returns the length of `s` that is well formed UTF8. This will return
-// `s.length()` if it is completely well formed UTF8.
+// `s.length()` if it is completely well formed UTF8. Overlong encodings,
+// surrogates and code points above U+10FFFF are not well formed.
+//
+// On x86 CPUs with AVX2 or SSE4.2, this validates 32 or 16 bytes at a time,
+// with a fast path for ASCII.
 absl::string_view::size_type SpanWellFormedUTF8(absl::string_view s);
 
 inline bool IsWellFormedUTF8(absl::string_view s) {
   return SpanWellFormedUTF8(s) == s.length();
 }
 
+namespace internal {
+
+// Portable implementation of SpanWellFormedUTF8(), which otherwise uses SIMD
+// instructions when the CPU supports them. Exposed for tests and benchmarks.
+absl::string_view::size_type SpanWellFormedUTF8Scalar(absl::string_view s);
+
+}  // namespace internal
+
 // Returns a well-formed Unicode std::string. Replaces any ill-formed
 // subsequences with the Unicode REPLACEMENT CHARACTER (U+FFFD).
 // This is usually rendered as a diamond with a question mark in the middle.
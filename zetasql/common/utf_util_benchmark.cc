@@ -0,0 +1,97 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Measures the throughput of UTF8 validation and coercion on ASCII, mixed
+// and ill-formed inputs, comparing SpanWellFormedUTF8() with the portable
+// scalar implementation.
+//
+// Usage: bazel run -c opt //zetasql/common:utf_util_benchmark
+
+#include <cstdio>
+#include <functional>
+#include <string>
+
+#include "zetasql/common/utf_util.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace zetasql {
+namespace {
+
+constexpr int kInputSize = 1 << 20;
+constexpr int kIterations = 200;
+
+// Returns <pattern> repeated up to about kInputSize bytes.
+std::string Repeat(absl::string_view pattern) {
+  std::string result;
+  while (result.size() + pattern.size() <= kInputSize) {
+    result.append(pattern.data(), pattern.size());
+  }
+  return result;
+}
+
+// Prints the throughput of <function> over <input> in MB/s.
+void Run(const char* input_name, const char* function_name,
+         const std::string& input,
+         const std::function<size_t(absl::string_view)>& function) {
+  size_t checksum = 0;
+  const absl::Time start = absl::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    checksum += function(input);
+  }
+  const double seconds = absl::ToDoubleSeconds(absl::Now() - start);
+  const double megabytes =
+      static_cast<double>(input.size()) * kIterations / (1 << 20);
+  printf("%-10s %-24s %10.1f MB/s  (checksum %zu)\n", input_name,
+         function_name, megabytes / seconds, checksum);
+}
+
+void RunAll(const char* input_name, const std::string& input) {
+  Run(input_name, "SpanWellFormedUTF8", input, SpanWellFormedUTF8);
+  Run(input_name, "SpanWellFormedUTF8Scalar", input,
+      internal::SpanWellFormedUTF8Scalar);
+  Run(input_name, "CoerceToWellFormedUTF8", input, [](absl::string_view s) {
+    return CoerceToWellFormedUTF8(s).size();
+  });
+}
+
+}  // namespace
+}  // namespace zetasql
+
+int main(int argc, char** argv) {
+  using zetasql::Repeat;
+  using zetasql::RunAll;
+
+  RunAll("ascii", Repeat("SELECT key, value FROM KeyValue WHERE key > 10; "));
+  // Latin-1 supplement, CJK and emoji mixed with ASCII.
+  RunAll("mixed",
+         Repeat("caf\xc3\xa9 \xe8\xb0\xb7\xe6\xad\x8c \xf0\x9f\x98\x80 "
+                "na\xc3\xafve r\xc3\xa9sum\xc3\xa9 "));
+  // Well formed except for the last byte, so validation scans everything.
+  std::string invalid_at_end = Repeat("caf\xc3\xa9 \xe8\xb0\xb7\xe6\xad\x8c ");
+  invalid_at_end.back() = '\xff';
+  RunAll("invalid", invalid_at_end);
+  // An ill-formed byte every 32 bytes. Validation stops at the first one, so
+  // only coercion is measured.
+  zetasql::Run("corrupt", "CoerceToWellFormedUTF8",
+               Repeat("caf\xc3\xa9 \xe8\xb0\xb7\xe6\xad\x8c \x80"
+                      "abcdefghijklmnopq"),
+               [](absl::string_view s) {
+                 return zetasql::CoerceToWellFormedUTF8(s).size();
+               });
+  return 0;
+}
@@ -16,11 +16,19 @@
 
 #include "zetasql/common/utf_util.h"
 
+#include <string>
+
 #include "gtest/gtest.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 
 namespace zetasql {
 
+static std::string EscapeForTest(absl::string_view str) {
+  return absl::CHexEscape(str);
+}
+
 static void TestWellFormedString(absl::string_view str) {
   EXPECT_EQ(SpanWellFormedUTF8(str), str.length());
   EXPECT_TRUE(IsWellFormedUTF8(str));
@@ -45,7 +53,63 @@ void TestCoerce(std::string str, std::string expected) {
   EXPECT_EQ(CoerceToWellFormedUTF8(str), expected) << "str: " << str;
 }
 
+static void TestIllFormedString(absl::string_view str, int expected_span) {
+  EXPECT_EQ(SpanWellFormedUTF8(str), expected_span) << str;
+  EXPECT_FALSE(IsWellFormedUTF8(str)) << str;
+}
+
+TEST(UtfUtilTest, IllFormedUTF8) {
+  TestIllFormedString("\x80", 0);           // Lone continuation byte.
+  TestIllFormedString("abc\xc2", 3);        // Truncated 2-byte sequence.
+  TestIllFormedString("\xc0\xaf", 0);       // Overlong '/'.
+  TestIllFormedString("\xe0\x80\xaf", 0);   // Overlong 3-byte '/'.
+  TestIllFormedString("\xed\xa0\x80", 0);   // Surrogate U+D800.
+  TestIllFormedString("\xf4\x90\x80\x80", 0);  // U+110000.
+  TestIllFormedString("\xf5\x80\x80\x80", 0);
+  TestIllFormedString("a\xe8\xb0", 1);      // Truncated 3-byte sequence.
+  TestIllFormedString("\xc2\xbf\xff", 2);
+}
+
+// Builds strings long enough for the vectorized implementations, with an
+// ill-formed sequence at every offset, and checks them against the scalar one.
+TEST(UtfUtilTest, SpanWellFormedUTF8MatchesScalar) {
+  const std::string fillers[] = {
+      std::string(100, 'a'),
+      "\xc2\xbf\xe8\xb0\xb7\xf0\x9f\x98\x80" "abcdefgh\xe6\xad\x8c"
+      "\xc2\xbf\xe8\xb0\xb7\xf0\x9f\x98\x80" "abcdefgh\xe6\xad\x8c"
+      "\xc2\xbf\xe8\xb0\xb7\xf0\x9f\x98\x80" "abcdefgh\xe6\xad\x8c"};
+  const std::string errors[] = {
+      "", "\x80", "\xc2", "\xc0\xaf", "\xe0\x80\xaf", "\xed\xa0\x80",
+      "\xf4\x90\x80\x80", "\xf0\x9f\x98", "\xff", "\xbf\xbf"};
+  for (const std::string& filler : fillers) {
+    ASSERT_TRUE(IsWellFormedUTF8(filler)) << EscapeForTest(filler);
+    for (const std::string& error : errors) {
+      for (int offset = 0; offset <= filler.size(); ++offset) {
+        const std::string str =
+            absl::StrCat(filler.substr(0, offset), error, filler);
+        const auto expected = internal::SpanWellFormedUTF8Scalar(str);
+        EXPECT_EQ(SpanWellFormedUTF8(str), expected)
+            << "offset: " << offset << " error: " << EscapeForTest(error);
+        EXPECT_EQ(SpanWellFormedUTF8(str.substr(0, offset + error.size())),
+                  internal::SpanWellFormedUTF8Scalar(
+                      str.substr(0, offset + error.size())));
+      }
+    }
+  }
+}
+
 TEST(UtfUtilTest, CoerceToWellFormedUTF8) {
+  TestCoerce("abc", "abc");
+  TestCoerce("\xe8\xb0\xb7", "\xe8\xb0\xb7");
+  TestCoerce("\x80", "\uFFFD");
+  TestCoerce("a\x80" "b", "a\uFFFDb");
+  TestCoerce("a\x80\x80" "b", "a\uFFFD\uFFFDb");
+  // A truncated sequence is replaced by a single replacement character.
+  TestCoerce("a\xe8\xb0" "b", "a\uFFFDb");
+  TestCoerce("\xf0\x9f\x98", "\uFFFD");
+  // Bytes that can never start a sequence are replaced one by one.
+  TestCoerce("\xc0\xaf", "\uFFFD\uFFFD");
+  TestCoerce("\xed\xa0\x80", "\uFFFD\uFFFD\uFFFD");
 }
 
 TEST(UtfUtilTest, PrettyTruncateUTF8) {
@@ -54,6 +54,7 @@ public class AnalyzerOptions implements Serializable {
     builder.setDefaultTimezone("America/Los_Angeles");
     builder.setRecordParseLocations(false);
     builder.setPruneUnusedColumns(false);
+    builder.setAllocateResolvedNodesInArena(false);
     builder.setAllowUndeclaredParameters(false);
     builder.setParameterMode(ParameterMode.PARAMETER_NAMED);
     builder.setErrorMessageMode(ErrorMessageMode.ERROR_MESSAGE_ONE_LINE);
@@ -208,6 +209,14 @@ public class AnalyzerOptions implements Serializable {
     return builder.getPruneUnusedColumns();
   }
 
+  public void setAllocateResolvedNodesInArena(boolean value) {
+    builder.setAllocateResolvedNodesInArena(value);
+  }
+
+  public boolean getAllocateResolvedNodesInArena() {
+    return builder.getAllocateResolvedNodesInArena();
+  }
+
   public void setAllowedHintsAndOptions(AllowedHintsAndOptions allowedHintsAndOptions) {
     this.allowedHintsAndOptions = Preconditions.checkNotNull(allowedHintsAndOptions);
   }
@@ -240,6 +249,7 @@ public class AnalyzerOptions implements Serializable {
     options.setErrorMessageMode(proto.getErrorMessageMode());
     options.setStatementContext(proto.getStatementContext());
     options.setPruneUnusedColumns(proto.getPruneUnusedColumns());
+    options.setAllocateResolvedNodesInArena(proto.getAllocateResolvedNodesInArena());
     options.setRecordParseLocations(proto.getRecordParseLocations());
     options.setAllowUndeclaredParameters(proto.getAllowUndeclaredParameters());
     options.setParameterMode(proto.getParameterMode());
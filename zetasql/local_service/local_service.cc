@@ -17,11 +17,13 @@
 #include "zetasql/local_service/local_service.h"
 
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "zetasql/base/arena.h"
 #include "zetasql/base/logging.h"
 #include "google/protobuf/descriptor.pb.h"
 #include "google/protobuf/descriptor.h"
@@ -30,6 +32,9 @@
 #include "zetasql/local_service/state.h"
 #include "zetasql/proto/simple_catalog.pb.h"
 #include "zetasql/public/builtin_function.h"
+#include "zetasql/public/error_helpers.h"
+#include "zetasql/public/error_location.pb.h"
+#include "zetasql/public/evaluator.h"
 #include "zetasql/public/function.h"
 #include "zetasql/public/language_options.h"
 #include "zetasql/public/simple_catalog.h"
@@ -40,6 +45,8 @@
 #include "zetasql/public/value.pb.h"
 #include "zetasql/resolved_ast/resolved_ast.h"
 #include "absl/base/thread_annotations.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "zetasql/base/source_location.h"
 #include "zetasql/base/ret_check.h"
@@ -229,10 +236,117 @@ class RegisteredParseResumeLocationState : public GenericState {
 class RegisteredParseResumeLocationPool
     : public SharedStatePool<RegisteredParseResumeLocationState> {};
 
+// A PreparedExpression together with the type factory and descriptor pools
+// that own the types of its columns and parameters. After Init() succeeds, the
+// expression is immutable and can be evaluated concurrently.
+class PreparedExpressionState : public BaseSavedState {
+ public:
+  PreparedExpressionState() : BaseSavedState() {}
+  PreparedExpressionState(const PreparedExpressionState&) = delete;
+  PreparedExpressionState& operator=(const PreparedExpressionState&) = delete;
+
+  // Prepares <sql> with columns and parameters declared in <options>.
+  zetasql_base::Status Init(
+      const std::string& sql, const AnalyzerOptionsProto& options,
+      const RepeatedPtrField<google::protobuf::FileDescriptorSet>& fdsets) {
+    ZETASQL_RETURN_IF_ERROR(BaseSavedState::Init(fdsets));
+
+    absl::MutexLock lock(&mutex_);
+    ZETASQL_RETURN_IF_ERROR(AnalyzerOptions::Deserialize(options, const_pools_,
+                                                 &factory_, &options_));
+    return PrepareLocked(sql);
+  }
+
+  // Prepares request.sql(), declaring the columns and parameters of the
+  // request (or of its first row) with the types given in the request.
+  zetasql_base::Status Init(const EvaluateRequest& request) {
+    ZETASQL_RETURN_IF_ERROR(BaseSavedState::Init(request.file_descriptor_set()));
+
+    absl::MutexLock lock(&mutex_);
+    const bool has_rows = request.rows_size() > 0;
+    for (const auto& column :
+         has_rows ? request.rows(0).columns() : request.columns()) {
+      const Type* type;
+      ZETASQL_RETURN_IF_ERROR(factory_.DeserializeFromProtoUsingExistingPools(
+          column.type(), const_pools_, &type));
+      ZETASQL_RETURN_IF_ERROR(options_.AddExpressionColumn(column.name(), type));
+    }
+    for (const auto& param :
+         has_rows ? request.rows(0).params() : request.params()) {
+      const Type* type;
+      ZETASQL_RETURN_IF_ERROR(factory_.DeserializeFromProtoUsingExistingPools(
+          param.type(), const_pools_, &type));
+      ZETASQL_RETURN_IF_ERROR(options_.AddQueryParameter(param.name(), type));
+    }
+    return PrepareLocked(request.sql());
+  }
+
+  const PreparedExpression* GetExpression() {
+    absl::MutexLock lock(&mutex_);
+    CHECK(initialized_);
+    return expression_.get();
+  }
+
+  // Deserializes the value of the column or parameter <param>, which must be
+  // declared in <declared>. The declared type is used if <param> has none.
+  zetasql_base::Status DeserializeParameter(
+      const EvaluateRequest::Parameter& param,
+      const QueryParametersMap& declared, std::string* name, Value* value) {
+    *name = absl::AsciiStrToLower(param.name());
+    const auto it = declared.find(*name);
+    if (it == declared.end()) {
+      return MakeSqlError() << "Undeclared column or parameter: "
+                            << param.name();
+    }
+    const Type* type = it->second;
+    if (param.has_type()) {
+      absl::MutexLock lock(&mutex_);
+      ZETASQL_RETURN_IF_ERROR(factory_.DeserializeFromProtoUsingExistingPools(
+          param.type(), const_pools_, &type));
+      if (!type->Equals(it->second)) {
+        return MakeSqlError() << "Type of " << param.name() << " is "
+                              << type->DebugString() << ", expected "
+                              << it->second->DebugString();
+      }
+    }
+    ZETASQL_ASSIGN_OR_RETURN(*value, Value::Deserialize(param.value(), type));
+    return ::zetasql_base::OkStatus();
+  }
+
+  const QueryParametersMap& expression_columns() {
+    absl::MutexLock lock(&mutex_);
+    return options_.expression_columns();
+  }
+
+  const QueryParametersMap& query_parameters() {
+    absl::MutexLock lock(&mutex_);
+    return options_.query_parameters();
+  }
+
+ private:
+  zetasql_base::Status PrepareLocked(const std::string& sql)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    EvaluatorOptions evaluator_options;
+    evaluator_options.default_time_zone = options_.default_time_zone();
+    evaluator_options.language_options = options_.language();
+    expression_ = absl::make_unique<PreparedExpression>(sql, evaluator_options);
+    ZETASQL_RETURN_IF_ERROR(expression_->Prepare(options_));
+    initialized_ = true;
+    return ::zetasql_base::OkStatus();
+  }
+
+  AnalyzerOptions options_ GUARDED_BY(mutex_);
+  std::unique_ptr<PreparedExpression> expression_ GUARDED_BY(mutex_);
+};
+
+class PreparedExpressionPool
+    : public SharedStatePool<PreparedExpressionState> {};
+
 ZetaSqlLocalServiceImpl::ZetaSqlLocalServiceImpl()
     : registered_catalogs_(new RegisteredCatalogPool()),
       registered_parse_resume_locations_(
-          new RegisteredParseResumeLocationPool()) {}
+          new RegisteredParseResumeLocationPool()),
+      prepared_expressions_(new PreparedExpressionPool()) {}
 
 ZetaSqlLocalServiceImpl::~ZetaSqlLocalServiceImpl() {}
 
@@ -269,26 +383,36 @@ zetasql_base::Status ZetaSqlLocalServiceImpl::GetTableFromProto(
   return ::zetasql_base::OkStatus();
 }
 
-zetasql_base::Status ZetaSqlLocalServiceImpl::Analyze(const AnalyzeRequest& request,
-                                                AnalyzeResponse* response) {
-  RegisteredCatalogState* catalog_state;
-  // Needed to hold the new state because shared_ptr doesn't support release().
-  std::unique_ptr<RegisteredCatalogState> new_catalog_state;
+namespace {
 
+// Returns the registered catalog of <request>, or a new catalog built from the
+// catalog and descriptors in <request> if it doesn't refer to a registered
+// one. <Request> is AnalyzeRequest or AnalyzeBatchRequest.
+template <class Request>
+zetasql_base::Status GetCatalogState(
+    const Request& request, RegisteredCatalogPool* registered_catalogs,
+    std::shared_ptr<RegisteredCatalogState>* catalog_state) {
   if (request.has_registered_catalog_id()) {
     int64_t id = request.registered_catalog_id();
-    std::shared_ptr<RegisteredCatalogState> shared_state =
-        registered_catalogs_->Get(id);
-    catalog_state = shared_state.get();
-    if (catalog_state == nullptr) {
+    *catalog_state = registered_catalogs->Get(id);
+    if (*catalog_state == nullptr) {
       return MakeSqlError() << "Registered catalog " << id << " unknown.";
     }
   } else {
-    new_catalog_state = absl::make_unique<RegisteredCatalogState>();
-    catalog_state = new_catalog_state.get();
-    ZETASQL_RETURN_IF_ERROR(catalog_state->Init(request.simple_catalog(),
-                                        request.file_descriptor_set()));
+    *catalog_state = std::make_shared<RegisteredCatalogState>();
+    ZETASQL_RETURN_IF_ERROR((*catalog_state)->Init(request.simple_catalog(),
+                                           request.file_descriptor_set()));
   }
+  return ::zetasql_base::OkStatus();
+}
+
+}  // namespace
+
+zetasql_base::Status ZetaSqlLocalServiceImpl::Analyze(const AnalyzeRequest& request,
+                                                AnalyzeResponse* response) {
+  std::shared_ptr<RegisteredCatalogState> catalog_state;
+  ZETASQL_RETURN_IF_ERROR(
+      GetCatalogState(request, registered_catalogs_.get(), &catalog_state));
 
   RegisteredParseResumeLocationState* parse_resume_location_state;
   std::unique_ptr<RegisteredParseResumeLocationState>
@@ -316,7 +440,7 @@ zetasql_base::Status ZetaSqlLocalServiceImpl::Analyze(const AnalyzeRequest& requ
     parse_resume_location_state = owned_parse_resume_location_state.get();
     location = parse_resume_location_state->GetParseResumeLocation(&lock);
   }
-  return AnalyzeImpl(request, catalog_state, location, response);
+  return AnalyzeImpl(request, catalog_state.get(), location, response);
 }
 
 zetasql_base::Status ZetaSqlLocalServiceImpl::AnalyzeImpl(
@@ -341,8 +465,9 @@ zetasql_base::Status ZetaSqlLocalServiceImpl::AnalyzeImpl(
     ZETASQL_RETURN_IF_ERROR(zetasql::AnalyzeStatement(
         sql, options, catalog_state->GetCatalog(), &factory, &output));
 
-    ZETASQL_RETURN_IF_ERROR(
-        SerializeResolvedStatement(output.get(), sql, response, catalog_state));
+    ZETASQL_RETURN_IF_ERROR(SerializeResolvedStatement(
+        output.get(), sql, response->mutable_resolved_statement(),
+        catalog_state));
   } else if (location != nullptr) {
     bool at_end_of_input;
     ZETASQL_RETURN_IF_ERROR(zetasql::AnalyzeNextStatement(
@@ -350,12 +475,78 @@ zetasql_base::Status ZetaSqlLocalServiceImpl::AnalyzeImpl(
         &at_end_of_input));
 
     ZETASQL_RETURN_IF_ERROR(SerializeResolvedStatement(
-        output.get(), location->input(), response, catalog_state));
+        output.get(), location->input(), response->mutable_resolved_statement(),
+        catalog_state));
     response->set_resume_byte_position(location->byte_position());
   }
   return ::zetasql_base::OkStatus();
 }
 
+zetasql_base::Status ZetaSqlLocalServiceImpl::AnalyzeBatchStream(
+    const AnalyzeBatchRequest& request,
+    const std::function<bool(const AnalyzeBatchResult&)>& emit) {
+  std::shared_ptr<RegisteredCatalogState> catalog_state;
+  ZETASQL_RETURN_IF_ERROR(
+      GetCatalogState(request, registered_catalogs_.get(), &catalog_state));
+
+  AnalyzerOptions options;
+  ZETASQL_RETURN_IF_ERROR(AnalyzerOptions::Deserialize(
+      request.options(), catalog_state->GetDescriptorPools(),
+      catalog_state->GetTypeFactory(), &options));
+  // Statements are analyzed one at a time, so they can share the arena and
+  // IdStringPool instead of creating new ones for every statement.
+  options.CreateDefaultArenasIfNotSet();
+  zetasql_base::UnsafeArena* arena = options.arena().get();
+  // Errors are returned with an ErrorLocation payload so the location can be
+  // copied into each result, and the message is then formatted as requested.
+  const ErrorMessageMode error_message_mode = options.error_message_mode();
+  options.set_error_message_mode(ERROR_MESSAGE_WITH_PAYLOAD);
+  TypeFactory factory;
+
+  for (int i = 0; i < request.sql_statement_size(); ++i) {
+    const std::string& sql = request.sql_statement(i);
+    AnalyzeBatchResult result;
+    result.set_statement_index(i);
+    {
+      std::unique_ptr<const AnalyzerOutput> output;
+      zetasql_base::Status status = zetasql::AnalyzeStatement(
+          sql, options, catalog_state->GetCatalog(), &factory, &output);
+      if (status.ok()) {
+        status = SerializeResolvedStatement(output.get(), sql,
+                                            result.mutable_resolved_statement(),
+                                            catalog_state.get());
+      }
+      if (!status.ok()) {
+        AnalyzeBatchError* error = result.mutable_error();
+        ErrorLocation location;
+        if (GetErrorLocation(status, &location)) {
+          *error->mutable_error_location() = location;
+        }
+        status = MaybeUpdateErrorFromPayload(error_message_mode, sql, status);
+        error->set_code(static_cast<int>(status.code()));
+        error->set_message(status.error_message());
+      }
+    }
+    // The output has been serialized and released, so nothing refers to the
+    // arena any more and its memory can be reused by the next statement.
+    arena->Reset();
+    if (!emit(result)) {
+      break;
+    }
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status ZetaSqlLocalServiceImpl::AnalyzeBatch(
+    const AnalyzeBatchRequest& request, AnalyzeBatchResponse* response) {
+  response->mutable_result()->Reserve(request.sql_statement_size());
+  return AnalyzeBatchStream(
+      request, [response](const AnalyzeBatchResult& result) {
+        *response->add_result() = result;
+        return true;
+      });
+}
+
 zetasql_base::Status ZetaSqlLocalServiceImpl::ExtractTableNamesFromStatement(
     const ExtractTableNamesFromStatementRequest& request,
     ExtractTableNamesFromStatementResponse* response) {
@@ -410,14 +601,14 @@ zetasql_base::Status ZetaSqlLocalServiceImpl::ExtractTableNamesFromNextStatement
 
 zetasql_base::Status ZetaSqlLocalServiceImpl::SerializeResolvedStatement(
     const AnalyzerOutput* output, absl::string_view statement,
-    AnalyzeResponse* response, RegisteredCatalogState* state) {
+    AnyResolvedStatementProto* proto, RegisteredCatalogState* state) {
   const std::vector<const google::protobuf::DescriptorPool*>& pools =
       state->GetDescriptorPools();
   FileDescriptorSetMap file_descriptor_set_map;
   PopulateExistingPoolsToFileDescriptorSetMap(pools, &file_descriptor_set_map);
 
   ZETASQL_RETURN_IF_ERROR(output->resolved_statement()->SaveTo(
-      &file_descriptor_set_map, response->mutable_resolved_statement()));
+      &file_descriptor_set_map, proto));
 
   // If the file_descriptor_set_map contains more descriptor pools than those
   // passed in the request, the additonal one must be the generated descriptor
@@ -483,6 +674,173 @@ zetasql_base::Status ZetaSqlLocalServiceImpl::UnregisterParseResumeLocation(
   return MakeSqlError() << "Unknown ParseResumeLocation ID: " << id;
 }
 
+zetasql_base::Status ZetaSqlLocalServiceImpl::Prepare(const PrepareRequest& request,
+                                                PrepareResponse* response) {
+  std::unique_ptr<PreparedExpressionState> state(new PreparedExpressionState());
+  ZETASQL_RETURN_IF_ERROR(state->Init(request.sql(), request.options(),
+                              request.file_descriptor_set()));
+
+  FileDescriptorSetMap file_descriptor_set_map;
+  PopulateExistingPoolsToFileDescriptorSetMap(state->GetDescriptorPools(),
+                                              &file_descriptor_set_map);
+  const Type* output_type = state->GetExpression()->output_type();
+  ZETASQL_RETURN_IF_ERROR(output_type->SerializeToProtoAndDistinctFileDescriptors(
+      response->mutable_output_type(), &file_descriptor_set_map));
+
+  int64_t id = prepared_expressions_->Register(state.release());
+  ZETASQL_RET_CHECK_NE(-1, id)
+      << "Failed to register prepared expression, this shouldn't happen.";
+
+  response->set_prepared_expression_id(id);
+
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status ZetaSqlLocalServiceImpl::Evaluate(const EvaluateRequest& request,
+                                                 EvaluateResponse* response) {
+  std::shared_ptr<PreparedExpressionState> state;
+  if (request.has_prepared_expression_id()) {
+    int64_t id = request.prepared_expression_id();
+    state = prepared_expressions_->Get(id);
+    if (state == nullptr) {
+      return MakeSqlError() << "Prepared expression " << id << " unknown.";
+    }
+  } else {
+    std::unique_ptr<PreparedExpressionState> new_state(
+        new PreparedExpressionState());
+    ZETASQL_RETURN_IF_ERROR(new_state->Init(request));
+    int64_t id = prepared_expressions_->Register(new_state.release());
+    ZETASQL_RET_CHECK_NE(-1, id)
+        << "Failed to register prepared expression, this shouldn't happen.";
+    state = prepared_expressions_->Get(id);
+    // The id is only returned on success, so don't keep the expression
+    // around otherwise.
+    const zetasql_base::Status status = EvaluateImpl(request, state.get(), response);
+    if (!status.ok()) {
+      prepared_expressions_->Delete(id);
+    }
+    return status;
+  }
+  return EvaluateImpl(request, state.get(), response);
+}
+
+zetasql_base::Status ZetaSqlLocalServiceImpl::EvaluateImpl(
+    const EvaluateRequest& request, PreparedExpressionState* state,
+    EvaluateResponse* response) {
+  const PreparedExpression* expression = state->GetExpression();
+  const QueryParametersMap& declared_columns = state->expression_columns();
+  const QueryParametersMap& declared_params = state->query_parameters();
+
+  // A request without rows is evaluated as a single row.
+  const bool has_rows = request.rows_size() > 0;
+  const int num_rows = has_rows ? request.rows_size() : 1;
+  auto columns_of = [&request, has_rows](int row)
+      -> const RepeatedPtrField<EvaluateRequest::Parameter>& {
+    return has_rows ? request.rows(row).columns() : request.columns();
+  };
+  auto params_of = [&request, has_rows](int row)
+      -> const RepeatedPtrField<EvaluateRequest::Parameter>& {
+    return has_rows ? request.rows(row).params() : request.params();
+  };
+
+  std::vector<ParameterValueMap> row_params(num_rows);
+  // Identifies the parameter values of each row by their serialized bytes.
+  // Value equality is not enough to share a batch: it treats -0.0 and 0.0 as
+  // equal, which an expression can tell apart, and NaN as unequal to itself.
+  std::vector<std::string> row_param_keys(num_rows);
+  for (int row = 0; row < num_rows; ++row) {
+    for (const auto& param : params_of(row)) {
+      std::string name;
+      Value value;
+      ZETASQL_RETURN_IF_ERROR(
+          state->DeserializeParameter(param, declared_params, &name, &value));
+      row_params[row][name] = value;
+    }
+    if (has_rows) {
+      std::string& key = row_param_keys[row];
+      for (const auto& entry : row_params[row]) {
+        ValueProto value_proto;
+        ZETASQL_RETURN_IF_ERROR(entry.second.Serialize(&value_proto));
+        const std::string value_bytes = value_proto.SerializeAsString();
+        absl::StrAppend(&key, entry.first.size(), ":", entry.first,
+                        value_bytes.size(), ":", value_bytes);
+      }
+    }
+  }
+
+  // Consecutive rows with the same parameter values are evaluated as one
+  // batch.
+  const std::vector<std::string> referenced_columns =
+      expression->GetReferencedColumns();
+  ValueColumn result(expression->output_type());
+  for (int begin = 0; begin < num_rows;) {
+    int end = begin + 1;
+    while (end < num_rows && row_param_keys[end] == row_param_keys[begin]) {
+      ++end;
+    }
+
+    std::vector<ValueColumn> columns;
+    columns.reserve(referenced_columns.size());
+    for (const std::string& name : referenced_columns) {
+      columns.emplace_back(declared_columns.at(name));
+    }
+    for (int row = begin; row < end; ++row) {
+      for (const auto& param : columns_of(row)) {
+        const auto it = std::find(referenced_columns.begin(),
+                                  referenced_columns.end(),
+                                  absl::AsciiStrToLower(param.name()));
+        if (it == referenced_columns.end()) continue;
+        ValueColumn& column = columns[it - referenced_columns.begin()];
+        if (column.size() != row - begin) {
+          return MakeSqlError() << "Duplicate column " << param.name()
+                                << " in row " << row;
+        }
+        std::string name;
+        Value value;
+        ZETASQL_RETURN_IF_ERROR(state->DeserializeParameter(param, declared_columns,
+                                                    &name, &value));
+        ZETASQL_RETURN_IF_ERROR(column.Append(value));
+      }
+      for (int i = 0; i < columns.size(); ++i) {
+        if (columns[i].size() != row - begin + 1) {
+          return MakeSqlError() << "Incomplete column values, missing "
+                                << referenced_columns[i] << " in row " << row;
+        }
+      }
+    }
+
+    ColumnBatch batch(end - begin);
+    for (int i = 0; i < columns.size(); ++i) {
+      ZETASQL_RETURN_IF_ERROR(
+          batch.AddColumn(referenced_columns[i], std::move(columns[i])));
+    }
+    ZETASQL_RETURN_IF_ERROR(
+        expression->ExecuteBatch(batch, row_params[begin], &result));
+    for (int i = 0; i < result.size(); ++i) {
+      ZETASQL_RETURN_IF_ERROR(result.GetValue(i).Serialize(
+          has_rows ? response->add_values() : response->mutable_value()));
+    }
+    begin = end;
+  }
+
+  FileDescriptorSetMap file_descriptor_set_map;
+  PopulateExistingPoolsToFileDescriptorSetMap(state->GetDescriptorPools(),
+                                              &file_descriptor_set_map);
+  ZETASQL_RETURN_IF_ERROR(
+      expression->output_type()->SerializeToProtoAndDistinctFileDescriptors(
+          response->mutable_type(), &file_descriptor_set_map));
+  response->set_prepared_expression_id(state->GetId());
+
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status ZetaSqlLocalServiceImpl::Unprepare(int64_t id) {
+  if (prepared_expressions_->Delete(id)) {
+    return ::zetasql_base::OkStatus();
+  }
+  return MakeSqlError() << "Unknown prepared expression ID: " << id;
+}
+
 zetasql_base::Status ZetaSqlLocalServiceImpl::GetBuiltinFunctions(
     const ZetaSQLBuiltinFunctionOptionsProto& proto,
     GetBuiltinFunctionsResponse* resp) {
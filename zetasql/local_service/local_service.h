@@ -18,6 +18,7 @@
 #define ZETASQL_LOCAL_SERVICE_LOCAL_SERVICE_H_
 
 #include <stddef.h>
+#include <functional>
 #include <memory>
 
 #include "zetasql/local_service/local_service.pb.h"
@@ -35,6 +36,8 @@ namespace local_service {
 class RegisteredCatalogPool;
 class RegisteredCatalogState;
 class RegisteredParseResumeLocationPool;
+class PreparedExpressionPool;
+class PreparedExpressionState;
 
 // Implementation of ZetaSqlLocalService RPC service.
 class ZetaSqlLocalServiceImpl {
@@ -62,6 +65,18 @@ class ZetaSqlLocalServiceImpl {
                            ParseResumeLocation* location,
                            AnalyzeResponse* response);
 
+  // Analyzes each statement in request.sql_statement() against the catalog of
+  // the request. All statements share one arena and IdStringPool. Calls
+  // <emit> with the result of each statement as soon as it is analyzed, and
+  // stops early if <emit> returns false. Errors in individual statements are
+  // reported in their results; the returned status only covers the request.
+  zetasql_base::Status AnalyzeBatchStream(
+      const AnalyzeBatchRequest& request,
+      const std::function<bool(const AnalyzeBatchResult&)>& emit);
+
+  zetasql_base::Status AnalyzeBatch(const AnalyzeBatchRequest& request,
+                            AnalyzeBatchResponse* response);
+
   zetasql_base::Status ExtractTableNamesFromStatement(
       const ExtractTableNamesFromStatementRequest& request,
       ExtractTableNamesFromStatementResponse* response);
@@ -72,7 +87,7 @@ class ZetaSqlLocalServiceImpl {
 
   zetasql_base::Status SerializeResolvedStatement(const AnalyzerOutput* output,
                                           absl::string_view statement,
-                                          AnalyzeResponse* response,
+                                          AnyResolvedStatementProto* proto,
                                           RegisteredCatalogState* state);
 
   zetasql_base::Status RegisterCatalog(const RegisterCatalogRequest& request,
@@ -85,13 +100,29 @@ class ZetaSqlLocalServiceImpl {
 
   zetasql_base::Status UnregisterParseResumeLocation(int64_t id);
 
+  zetasql_base::Status Prepare(const PrepareRequest& request,
+                       PrepareResponse* response);
+
+  // Evaluates a prepared expression, or prepares request.sql() and keeps it
+  // registered under the returned id. Consecutive rows in request.rows() with
+  // bit-identical parameter values are evaluated together as one batch.
+  zetasql_base::Status Evaluate(const EvaluateRequest& request,
+                        EvaluateResponse* response);
+
+  zetasql_base::Status Unprepare(int64_t id);
+
   zetasql_base::Status GetLanguageOptions(const LanguageOptionsRequest& request,
                                   LanguageOptionsProto* response);
 
  private:
+  zetasql_base::Status EvaluateImpl(const EvaluateRequest& request,
+                            PreparedExpressionState* state,
+                            EvaluateResponse* response);
+
   std::unique_ptr<RegisteredCatalogPool> registered_catalogs_;
   std::unique_ptr<RegisteredParseResumeLocationPool>
       registered_parse_resume_locations_;
+  std::unique_ptr<PreparedExpressionPool> prepared_expressions_;
 
   friend class ZetaSqlLocalServiceImplTest;
 };
@@ -88,12 +88,52 @@ grpc::Status ZetaSqlLocalServiceGrpcImpl::GetTableFromProto(
   return ToGrpcStatus(service_.GetTableFromProto(*req, resp));
 }
 
+grpc::Status ZetaSqlLocalServiceGrpcImpl::Prepare(
+    grpc::ServerContext* context, const PrepareRequest* req,
+    PrepareResponse* resp) {
+  return ToGrpcStatus(service_.Prepare(*req, resp));
+}
+
+grpc::Status ZetaSqlLocalServiceGrpcImpl::Unprepare(
+    grpc::ServerContext* context, const UnprepareRequest* req,
+    google::protobuf::Empty* unused) {
+  return ToGrpcStatus(service_.Unprepare(req->prepared_expression_id()));
+}
+
+grpc::Status ZetaSqlLocalServiceGrpcImpl::Evaluate(
+    grpc::ServerContext* context, const EvaluateRequest* req,
+    EvaluateResponse* resp) {
+  return ToGrpcStatus(service_.Evaluate(*req, resp));
+}
+
 grpc::Status ZetaSqlLocalServiceGrpcImpl::Analyze(
     grpc::ServerContext* context, const AnalyzeRequest* req,
     AnalyzeResponse* resp) {
   return ToGrpcStatus(service_.Analyze(*req, resp));
 }
 
+grpc::Status ZetaSqlLocalServiceGrpcImpl::AnalyzeBatch(
+    grpc::ServerContext* context, const AnalyzeBatchRequest* req,
+    AnalyzeBatchResponse* resp) {
+  return ToGrpcStatus(service_.AnalyzeBatch(*req, resp));
+}
+
+grpc::Status ZetaSqlLocalServiceGrpcImpl::AnalyzeBatchStream(
+    grpc::ServerContext* context, const AnalyzeBatchRequest* req,
+    grpc::ServerWriter<AnalyzeBatchResult>* writer) {
+  bool cancelled = false;
+  zetasql_base::Status status = service_.AnalyzeBatchStream(
+      *req, [context, writer, &cancelled](const AnalyzeBatchResult& result) {
+        // Stop analyzing once the client has gone away.
+        cancelled = context->IsCancelled() || !writer->Write(result);
+        return !cancelled;
+      });
+  if (cancelled) {
+    return grpc::Status(grpc::CANCELLED, "AnalyzeBatchStream cancelled");
+  }
+  return ToGrpcStatus(status);
+}
+
 grpc::Status ZetaSqlLocalServiceGrpcImpl::ExtractTableNamesFromStatement(
     grpc::ServerContext* context,
     const ExtractTableNamesFromStatementRequest* req,
@@ -36,9 +36,28 @@ class ZetaSqlLocalServiceGrpcImpl
                                  const TableFromProtoRequest* req,
                                  SimpleTableProto* resp) override;
 
+  grpc::Status Prepare(grpc::ServerContext* context, const PrepareRequest* req,
+                       PrepareResponse* resp) override;
+
+  grpc::Status Unprepare(grpc::ServerContext* context,
+                         const UnprepareRequest* req,
+                         google::protobuf::Empty* unused) override;
+
+  grpc::Status Evaluate(grpc::ServerContext* context,
+                        const EvaluateRequest* req,
+                        EvaluateResponse* resp) override;
+
   grpc::Status Analyze(grpc::ServerContext* context, const AnalyzeRequest* req,
                        AnalyzeResponse* resp) override;
 
+  grpc::Status AnalyzeBatch(grpc::ServerContext* context,
+                            const AnalyzeBatchRequest* req,
+                            AnalyzeBatchResponse* resp) override;
+
+  grpc::Status AnalyzeBatchStream(
+      grpc::ServerContext* context, const AnalyzeBatchRequest* req,
+      grpc::ServerWriter<AnalyzeBatchResult>* writer) override;
+
   grpc::Status ExtractTableNamesFromStatement(
       grpc::ServerContext* context,
       const ExtractTableNamesFromStatementRequest* req,
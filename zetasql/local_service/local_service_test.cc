@@ -0,0 +1,254 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/local_service/local_service.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/proto/options.pb.h"
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/error_location.pb.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace zetasql {
+namespace local_service {
+
+using ::zetasql_base::testing::StatusIs;
+
+class ZetaSqlLocalServiceImplTest : public ::testing::Test {
+ protected:
+  // Adds a parameter called <name> with <value> to <params>, with its type if
+  // <with_type> is true.
+  static void AddParameter(
+      const std::string& name, const Value& value, bool with_type,
+      google::protobuf::RepeatedPtrField<EvaluateRequest::Parameter>* params) {
+    EvaluateRequest::Parameter* param = params->Add();
+    param->set_name(name);
+    ZETASQL_CHECK_OK(value.Serialize(param->mutable_value()));
+    if (with_type) {
+      ZETASQL_CHECK_OK(value.type()->SerializeToSelfContainedProto(
+          param->mutable_type()));
+    }
+  }
+
+  // Prepares <sql> with the expression column "a" and the query parameter "p",
+  // both of type <type>, and returns the prepared expression id.
+  int64_t Prepare(const std::string& sql, const Type* type) {
+    AnalyzerOptions options;
+    ZETASQL_CHECK_OK(options.AddExpressionColumn("a", type));
+    ZETASQL_CHECK_OK(options.AddQueryParameter("p", type));
+    PrepareRequest request;
+    request.set_sql(sql);
+    FileDescriptorSetMap file_descriptor_set_map;
+    ZETASQL_CHECK_OK(
+        options.Serialize(&file_descriptor_set_map, request.mutable_options()));
+    PrepareResponse response;
+    ZETASQL_CHECK_OK(service_.Prepare(request, &response));
+    return response.prepared_expression_id();
+  }
+
+  // Returns the values of <response>, which must have type <type>.
+  static std::vector<Value> GetValues(const EvaluateResponse& response,
+                                      const Type* type) {
+    std::vector<Value> values;
+    for (const ValueProto& value_proto : response.values()) {
+      values.push_back(Value::Deserialize(value_proto, type).ValueOrDie());
+    }
+    return values;
+  }
+
+  ZetaSqlLocalServiceImpl service_;
+};
+
+TEST_F(ZetaSqlLocalServiceImplTest, EvaluatePreparedExpressionRows) {
+  const int64_t id = Prepare("a + @p", types::Int64Type());
+
+  EvaluateRequest request;
+  request.set_prepared_expression_id(id);
+  const std::vector<std::pair<int64_t, int64_t>> rows = {
+      {1, 10}, {2, 10}, {3, 20}, {4, 10}};
+  for (const auto& row : rows) {
+    EvaluateRequest::Row* request_row = request.add_rows();
+    AddParameter("a", Value::Int64(row.first), /*with_type=*/false,
+                 request_row->mutable_columns());
+    AddParameter("p", Value::Int64(row.second), /*with_type=*/false,
+                 request_row->mutable_params());
+  }
+  EvaluateResponse response;
+  ZETASQL_ASSERT_OK(service_.Evaluate(request, &response));
+  EXPECT_EQ(id, response.prepared_expression_id());
+  EXPECT_FALSE(response.has_value());
+  EXPECT_EQ(std::vector<Value>({Value::Int64(11), Value::Int64(12),
+                                Value::Int64(23), Value::Int64(14)}),
+            GetValues(response, types::Int64Type()));
+
+  // A row without one of the columns of the expression fails.
+  request.mutable_rows(1)->clear_columns();
+  EXPECT_THAT(service_.Evaluate(request, &response),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+
+  ZETASQL_EXPECT_OK(service_.Unprepare(id));
+}
+
+TEST_F(ZetaSqlLocalServiceImplTest, RowsWithSignedZerosAreNotBatchedTogether) {
+  const int64_t id = Prepare("IEEE_DIVIDE(a, @p)", types::DoubleType());
+
+  // 0.0 and -0.0 compare equal as Values but give different results. NaNs
+  // never compare equal, but can share a batch.
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  EvaluateRequest request;
+  request.set_prepared_expression_id(id);
+  for (const double p : {0.0, -0.0, nan, nan, 0.0}) {
+    EvaluateRequest::Row* row = request.add_rows();
+    AddParameter("a", Value::Double(1), /*with_type=*/false,
+                 row->mutable_columns());
+    AddParameter("p", Value::Double(p), /*with_type=*/false,
+                 row->mutable_params());
+  }
+  EvaluateResponse response;
+  ZETASQL_ASSERT_OK(service_.Evaluate(request, &response));
+  const std::vector<Value> values = GetValues(response, types::DoubleType());
+  ASSERT_EQ(5, values.size());
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), values[0].double_value());
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(),
+            values[1].double_value());
+  EXPECT_TRUE(std::isnan(values[2].double_value()));
+  EXPECT_TRUE(std::isnan(values[3].double_value()));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), values[4].double_value());
+}
+
+TEST_F(ZetaSqlLocalServiceImplTest, EvaluateRowsPreparesTheExpression) {
+  // Without a prepared expression id, the types come from the first row.
+  EvaluateRequest request;
+  request.set_sql("a * @p");
+  for (int64_t a : {1, 2}) {
+    EvaluateRequest::Row* row = request.add_rows();
+    AddParameter("a", Value::Int64(a), /*with_type=*/true,
+                 row->mutable_columns());
+    AddParameter("p", Value::Int64(3), /*with_type=*/true,
+                 row->mutable_params());
+  }
+  EvaluateResponse response;
+  ZETASQL_ASSERT_OK(service_.Evaluate(request, &response));
+  EXPECT_EQ(std::vector<Value>({Value::Int64(3), Value::Int64(6)}),
+            GetValues(response, types::Int64Type()));
+
+  // The expression stays prepared under the returned id.
+  const int64_t id = response.prepared_expression_id();
+  request.clear_sql();
+  request.set_prepared_expression_id(id);
+  request.mutable_rows(1)->mutable_params(0)->mutable_value()->set_int64_value(
+      5);
+  response.Clear();
+  ZETASQL_ASSERT_OK(service_.Evaluate(request, &response));
+  EXPECT_EQ(std::vector<Value>({Value::Int64(3), Value::Int64(10)}),
+            GetValues(response, types::Int64Type()));
+  ZETASQL_EXPECT_OK(service_.Unprepare(id));
+}
+
+TEST_F(ZetaSqlLocalServiceImplTest, AnalyzeBatch) {
+  AnalyzeBatchRequest request;
+  request.add_sql_statement("SELECT 1");
+  request.add_sql_statement("SELECT x");
+  request.add_sql_statement("SELECT 2");
+  AnalyzeBatchResponse response;
+  ZETASQL_ASSERT_OK(service_.AnalyzeBatch(request, &response));
+
+  // A statement that fails to analyze gets an error of its own, and the
+  // others are still analyzed.
+  ASSERT_EQ(3, response.result_size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, response.result(i).statement_index());
+  }
+  EXPECT_TRUE(response.result(0)
+                  .resolved_statement()
+                  .has_resolved_query_stmt_node());
+  ASSERT_TRUE(response.result(1).has_error());
+  EXPECT_EQ(static_cast<int>(zetasql_base::StatusCode::kInvalidArgument),
+            response.result(1).error().code());
+  EXPECT_THAT(response.result(1).error().message(),
+              ::testing::HasSubstr("Unrecognized name: x"));
+  EXPECT_TRUE(response.result(2)
+                  .resolved_statement()
+                  .has_resolved_query_stmt_node());
+}
+
+TEST_F(ZetaSqlLocalServiceImplTest, AnalyzeBatchErrorsKeepTheirLocation) {
+  AnalyzeBatchRequest request;
+  request.add_sql_statement("SELECT 1");
+  request.add_sql_statement("SELECT 1,\n  x");
+  AnalyzeBatchResponse response;
+  ZETASQL_ASSERT_OK(service_.AnalyzeBatch(request, &response));
+
+  // The location is set even though the message also includes it, as in the
+  // default ERROR_MESSAGE_ONE_LINE mode.
+  ASSERT_EQ(2, response.result_size());
+  EXPECT_FALSE(response.result(0).has_error());
+  const AnalyzeBatchError& error = response.result(1).error();
+  ASSERT_TRUE(error.has_error_location());
+  EXPECT_EQ(2, error.error_location().line());
+  EXPECT_EQ(3, error.error_location().column());
+  EXPECT_THAT(error.message(),
+              ::testing::HasSubstr("Unrecognized name: x [at 2:3]"));
+
+  // With ERROR_MESSAGE_WITH_PAYLOAD the location is only in the result.
+  request.mutable_options()->set_error_message_mode(
+      ERROR_MESSAGE_WITH_PAYLOAD);
+  std::vector<AnalyzeBatchResult> results;
+  ZETASQL_ASSERT_OK(service_.AnalyzeBatchStream(
+      request, [&results](const AnalyzeBatchResult& result) {
+        results.push_back(result);
+        return true;
+      }));
+  ASSERT_EQ(2, results.size());
+  ASSERT_TRUE(results[1].error().has_error_location());
+  EXPECT_EQ(2, results[1].error().error_location().line());
+  EXPECT_EQ(3, results[1].error().error_location().column());
+  EXPECT_THAT(results[1].error().message(),
+              ::testing::HasSubstr("Unrecognized name: x"));
+  EXPECT_THAT(results[1].error().message(),
+              ::testing::Not(::testing::HasSubstr("[at 2:3]")));
+}
+
+TEST_F(ZetaSqlLocalServiceImplTest, AnalyzeBatchStreamStopsEarly) {
+  AnalyzeBatchRequest request;
+  request.add_sql_statement("SELECT x");
+  request.add_sql_statement("SELECT 1");
+  request.add_sql_statement("SELECT 2");
+
+  // Results are emitted in order, until the callback returns false.
+  std::vector<AnalyzeBatchResult> results;
+  ZETASQL_ASSERT_OK(service_.AnalyzeBatchStream(
+      request, [&results](const AnalyzeBatchResult& result) {
+        results.push_back(result);
+        return results.size() < 2;
+      }));
+  ASSERT_EQ(2, results.size());
+  EXPECT_EQ(0, results[0].statement_index());
+  EXPECT_TRUE(results[0].has_error());
+  EXPECT_EQ(1, results[1].statement_index());
+  EXPECT_TRUE(results[1].resolved_statement().has_resolved_query_stmt_node());
+}
+
+}  // namespace local_service
+}  // namespace zetasql
@@ -16,6 +16,9 @@
 
 #include "zetasql/parser/flex_tokenizer.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "zetasql/parser/bison_parser.bison.h"
 #include "zetasql/parser/keywords.h"
 #include "zetasql/parser/location.hh"
@@ -39,6 +42,29 @@ zetasql_base::Status ZetaSqlFlexTokenizer::GetNextToken(
   return override_error_;
 }
 
+int ZetaSqlFlexTokenizer::LexerInput(char* buf, int max_size) {
+  const int64_t sentinel_size = sizeof(kEofSentinelInput) - 1;
+  const int64_t bytes_to_copy = std::min<int64_t>(
+      max_size, input_size_ + sentinel_size - input_position_);
+  if (bytes_to_copy <= 0) {
+    return 0;
+  }
+  const int64_t input_bytes =
+      std::max<int64_t>(0, std::min(bytes_to_copy,
+                                    input_size_ - input_position_));
+  if (input_bytes > 0) {
+    memcpy(buf, input_.data() + input_position_, input_bytes);
+  }
+  if (bytes_to_copy > input_bytes) {
+    const int64_t sentinel_offset =
+        input_position_ + input_bytes - input_size_;
+    memcpy(buf + input_bytes, kEofSentinelInput + sentinel_offset,
+           bytes_to_copy - input_bytes);
+  }
+  input_position_ += bytes_to_copy;
+  return static_cast<int>(bytes_to_copy);
+}
+
 bool ZetaSqlFlexTokenizer::IsDotGeneralizedIdentifierPrefixToken(
     int bison_token) {
   if (bison_token ==
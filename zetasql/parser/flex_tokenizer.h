@@ -17,7 +17,6 @@
 #ifndef ZETASQL_PARSER_FLEX_TOKENIZER_H_
 #define ZETASQL_PARSER_FLEX_TOKENIZER_H_
 
-#include <sstream>
 #include <string>
 
 #include "zetasql/parser/position.hh"
@@ -48,20 +47,17 @@ class ZetaSqlFlexTokenizer final : public ZetaSqlFlexTokenizerBase {
   // Constructs a simple wrapper around a flex generated tokenizer. 'mode'
   // controls the first token that is returned to the bison parser, which
   // determines the starting production used by the parser.  The 'filename'
-  // must outlive this object.
+  // and 'input' must outlive this object. The input is not copied; flex reads
+  // it on demand starting at 'start_offset', so tokenizing a statement in the
+  // middle of a large script only touches the bytes of that statement.
   ZetaSqlFlexTokenizer(BisonParserMode mode, absl::string_view filename,
                          absl::string_view input, int start_offset)
       : filename_(filename),
         start_offset_(start_offset),
         input_size_(static_cast<int64_t>(input.size())),
         mode_(mode),
-        input_stream_(absl::StrCat(input, kEofSentinelInput)) {
-    // Seek the stringstream to the start_offset, and then instruct flex to read
-    // from the stream. (Flex has the ability to read multiple consecutive
-    // streams, but we only ever feed it one.)
-    input_stream_.seekg(start_offset, std::ios_base::beg);
-    switch_streams(&input_stream_ /* new_in */, nullptr /* new_out */);
-  }
+        input_(input),
+        input_position_(start_offset) {}
 
   ZetaSqlFlexTokenizer(const ZetaSqlFlexTokenizer&) = delete;
   ZetaSqlFlexTokenizer& operator=(const ZetaSqlFlexTokenizer&) = delete;
@@ -106,6 +102,11 @@ class ZetaSqlFlexTokenizer final : public ZetaSqlFlexTokenizerBase {
   // Returns the next token id, returning its location in 'yylloc'.
   int GetNextTokenFlexImpl(zetasql_bison_parser::location* yylloc);
 
+  // This is called by flex to fill its buffer. Copies up to 'max_size' bytes
+  // of the input followed by kEofSentinelInput into 'buf', and returns the
+  // number of bytes copied, or 0 at the end of the input.
+  int LexerInput(char* buf, int max_size) override;
+
   // This is called by flex when it is wedged.
   void LexerError(const char* msg) override {
     override_error_ = MakeSqlError() << msg;
@@ -150,11 +151,14 @@ class ZetaSqlFlexTokenizer final : public ZetaSqlFlexTokenizerBase {
   // determines the mode that we'll run in.
   const BisonParserMode mode_;
 
-  // Stream on the input. This is what is consumed by flex. It consists of the
-  // input (of size input_size_) plus a single byte \001 which is used as a
-  // sentinel value in the tokenizer (but only if it occurs at location
-  // input_size_).
-  std::istringstream input_stream_;
+  // The input. Flex consumes it through LexerInput(), followed by
+  // kEofSentinelInput, which is used as a sentinel value in the tokenizer (but
+  // only if it occurs at location input_size_).
+  const absl::string_view input_;
+
+  // The offset in the input plus sentinel of the next byte to be returned by
+  // LexerInput().
+  int64_t input_position_;
 
   // The tokenizer may want to return an error directly. It does this by
   // returning EOF to the bison parser, which then may or may not spew out its
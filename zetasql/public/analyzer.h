@@ -356,6 +356,12 @@ class AnalyzerOptions {
   const DdlPseudoColumnsCallback& ddl_pseudo_columns_callback() const {
     return ddl_pseudo_columns_callback_;
   }
+  // Returns the fixed set of pseudo-columns provided with SetDdlPseudoColumns,
+  // or an empty list if there is none or a callback was set instead.
+  const std::vector<std::pair<std::string, const Type*>>& ddl_pseudo_columns()
+      const {
+    return ddl_pseudo_columns_;
+  }
 
   void set_column_id_sequence_number(zetasql_base::SequenceNumber* sequence) {
     column_id_sequence_number_ = sequence;
@@ -458,6 +464,20 @@ class AnalyzerOptions {
   void set_prune_unused_columns(bool value) { prune_unused_columns_ = value; }
   bool prune_unused_columns() const { return prune_unused_columns_; }
 
+  // Set this to true to allocate the nodes of the resolved AST from arena()
+  // instead of individually on the heap. This makes analysis and destroying
+  // the AnalyzerOutput cheaper. Nodes are still owned through std::unique_ptr
+  // and can be released from the AnalyzerOutput, but like the IdStrings they
+  // reference, they are only valid while arena() is alive. If arena() is set
+  // explicitly and shared by many statements, the nodes' memory is only
+  // reclaimed when the arena is destroyed.
+  void set_allocate_resolved_nodes_in_arena(bool value) {
+    allocate_resolved_nodes_in_arena_ = value;
+  }
+  bool allocate_resolved_nodes_in_arena() const {
+    return allocate_resolved_nodes_in_arena_;
+  }
+
   void set_allowed_hints_and_options(const AllowedHintsAndOptions& allowed) {
     allowed_hints_and_options_ = allowed;
   }
@@ -551,6 +571,9 @@ class AnalyzerOptions {
   // and then remove this option.
   bool prune_unused_columns_ = false;
 
+  // If true, resolved AST nodes are allocated from arena_.
+  bool allocate_resolved_nodes_in_arena_ = false;
+
   // This specifies the set of allowed hints and options, their expected
   // types, and whether to give errors on unrecognized names.
   // See the class definition for details.
@@ -703,6 +726,43 @@ zetasql_base::Status AnalyzeNextStatement(
     std::unique_ptr<const AnalyzerOutput>* output,
     bool* at_end_of_input);
 
+// The result of analyzing one statement with AnalyzeStatementsInParallel().
+struct StatementAnalysisResult {
+  // The byte range of the statement in the input, including its terminating
+  // semicolon if there is one.
+  int start_byte_offset = 0;
+  int end_byte_offset = 0;
+
+  // The status of analyzing this statement. <output> is set iff it is OK.
+  zetasql_base::Status status;
+  std::unique_ptr<const AnalyzerOutput> output;
+};
+
+// Analyzes all statements in <sql>, with the same results as calling
+// AnalyzeNextStatement() in a loop, but using up to <num_threads> threads.
+// If <num_threads> is not positive, one thread per core is used.
+//
+// The input is first split at semicolons using the tokenizer, keeping the
+// BEGIN ... END body of a CREATE PROCEDURE statement with the statement, and
+// the statements are then analyzed concurrently. If the parser finds a
+// statement boundary elsewhere, the statement is handled as
+// AnalyzeNextStatement() would.
+//
+// <results> gets one entry per statement, in input order. Unlike with
+// AnalyzeNextStatement(), an error in one statement does not stop the
+// analysis; the next statement starts after the next semicolon, or after the
+// body of a failing CREATE PROCEDURE statement.
+//
+// <catalog> must support concurrent lookups, and objects it returns must be
+// thread-safe. Each statement is analyzed with its own arena and
+// IdStringPool, even if <options> specifies them. If
+// <options.column_id_sequence_number()> is set, column ids are unique across
+// the statements but depend on the order in which they were analyzed.
+zetasql_base::Status AnalyzeStatementsInParallel(
+    absl::string_view sql, const AnalyzerOptions& options, Catalog* catalog,
+    TypeFactory* type_factory, int num_threads,
+    std::vector<StatementAnalysisResult>* results);
+
 // Same as AnalyzeStatement(), but analyze from the parsed AST contained in a
 // ParserOutput instead of raw SQL std::string. For projects which are allowed to use
 // the parser directly, using this may save double parsing. If the
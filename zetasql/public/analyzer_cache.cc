@@ -0,0 +1,254 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/analyzer_cache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "zetasql/base/arena.h"
+#include "zetasql/proto/options.pb.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_node.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "zetasql/base/status_macros.h"
+
+namespace zetasql {
+
+namespace {
+
+// Rough size of a resolved AST node, including the vectors and strings it
+// owns. Only used to estimate the memory held by cache entries.
+constexpr int64_t kApproximateResolvedNodeBytes = 256;
+
+int64_t CountResolvedNodes(const ResolvedNode* node) {
+  std::vector<const ResolvedNode*> children;
+  node->GetChildNodes(&children);
+  int64_t count = 1;
+  for (const ResolvedNode* child : children) {
+    count += CountResolvedNodes(child);
+  }
+  return count;
+}
+
+// Appends the identities of the Types the analyzer may reference from
+// <options>. Types are serialized by value, but the resolved AST points to the
+// caller's Type objects, so equal types from different TypeFactories must not
+// share an entry.
+void AppendOptionTypes(const AnalyzerOptions& options, std::string* key) {
+  for (const auto& entry : options.query_parameters()) {
+    absl::StrAppend(key, "q", reinterpret_cast<uintptr_t>(entry.second));
+  }
+  for (const Type* type : options.positional_query_parameters()) {
+    absl::StrAppend(key, "n", reinterpret_cast<uintptr_t>(type));
+  }
+  for (const auto& entry : options.expression_columns()) {
+    absl::StrAppend(key, "e", reinterpret_cast<uintptr_t>(entry.second));
+  }
+  absl::StrAppend(
+      key, "i",
+      reinterpret_cast<uintptr_t>(options.in_scope_expression_column_type()));
+  for (const auto& entry : options.ddl_pseudo_columns()) {
+    absl::StrAppend(key, "d", entry.first.size(), ":", entry.first,
+                    reinterpret_cast<uintptr_t>(entry.second));
+  }
+
+  // The hint and option maps are unordered, so sort their pieces to get the
+  // same key for equal maps.
+  const AllowedHintsAndOptions& allowed = options.allowed_hints_and_options();
+  std::vector<std::string> pieces;
+  for (const auto& entry : allowed.hints_lower) {
+    pieces.push_back(absl::StrCat("h", entry.first.first.size(), ":",
+                                  entry.first.first, entry.first.second.size(),
+                                  ":", entry.first.second,
+                                  reinterpret_cast<uintptr_t>(entry.second)));
+  }
+  for (const auto& entry : allowed.options_lower) {
+    pieces.push_back(absl::StrCat("o", entry.first.size(), ":", entry.first,
+                                  reinterpret_cast<uintptr_t>(entry.second)));
+  }
+  std::sort(pieces.begin(), pieces.end());
+  for (const std::string& piece : pieces) {
+    absl::StrAppend(key, piece, ";");
+  }
+}
+
+// Keeps the TypeFactory used for analysis alive as long as the output.
+struct CachedAnalyzerOutput {
+  std::shared_ptr<TypeFactory> type_factory;
+  std::unique_ptr<const AnalyzerOutput> output;
+};
+
+}  // namespace
+
+AnalyzerCache::AnalyzerCache(const AnalyzerCacheOptions& options)
+    : options_(options), type_factory_(std::make_shared<TypeFactory>()) {}
+
+AnalyzerCache::~AnalyzerCache() {}
+
+bool AnalyzerCache::ComputeKey(absl::string_view sql,
+                               const AnalyzerOptions& options,
+                               const Catalog* catalog, std::string* key) {
+  // A fixed list of DDL pseudo-columns is part of the key, but an arbitrary
+  // callback can't be.
+  if (options.lookup_expression_column_callback() != nullptr ||
+      (options.ddl_pseudo_columns_callback() != nullptr &&
+       options.ddl_pseudo_columns().empty()) ||
+      options.column_id_sequence_number() != nullptr) {
+    return false;
+  }
+  const absl::optional<uint64_t> version_token = catalog->GetVersionToken();
+  if (!version_token.has_value()) {
+    return false;
+  }
+
+  FileDescriptorSetMap file_descriptor_set_map;
+  AnalyzerOptionsProto options_proto;
+  if (!options.Serialize(&file_descriptor_set_map, &options_proto).ok()) {
+    return false;
+  }
+  const std::string options_bytes = options_proto.SerializeAsString();
+
+  // Pieces are length-prefixed so that different arguments can't produce the
+  // same key.
+  *key = absl::StrCat(sql.size(), ":", sql, options_bytes.size(), ":",
+                      options_bytes);
+  // Proto and enum types are serialized by name, so also distinguish the
+  // DescriptorPools they come from.
+  for (const auto& entry : file_descriptor_set_map) {
+    absl::StrAppend(key, "p", entry.second->descriptor_set_index, ":",
+                    reinterpret_cast<uintptr_t>(entry.first));
+  }
+  AppendOptionTypes(options, key);
+  absl::StrAppend(key, "c", reinterpret_cast<uintptr_t>(catalog), ":",
+                  *version_token, "f",
+                  reinterpret_cast<uintptr_t>(
+                      options.find_options().cycle_detector()));
+  return true;
+}
+
+int64_t AnalyzerCache::EstimateBytes(absl::string_view sql,
+                                     const AnalyzerOutput& output,
+                                     bool owns_arena) {
+  int64_t bytes = sizeof(Entry) + sizeof(AnalyzerOutput) + 2 * sql.size();
+  if (owns_arena && output.arena() != nullptr) {
+    bytes += output.arena()->status().bytes_allocated();
+  }
+  if (output.resolved_statement() != nullptr) {
+    bytes += kApproximateResolvedNodeBytes *
+             CountResolvedNodes(output.resolved_statement());
+  }
+  return bytes;
+}
+
+zetasql_base::Status AnalyzerCache::AnalyzeStatement(
+    absl::string_view sql, const AnalyzerOptions& options, Catalog* catalog,
+    std::shared_ptr<const AnalyzerOutput>* output) {
+  std::string key;
+  const bool cacheable = ComputeKey(sql, options, catalog, &key);
+  std::shared_ptr<TypeFactory> type_factory;
+  if (cacheable) {
+    absl::MutexLock l(&mutex_);
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+      ++stats_.hits;
+      lru_.splice(lru_.begin(), lru_, it->second);
+      *output = it->second->output;
+      return ::zetasql_base::OkStatus();
+    }
+    ++stats_.misses;
+    type_factory = type_factory_;
+  } else {
+    absl::MutexLock l(&mutex_);
+    type_factory = type_factory_;
+    ++stats_.uncacheable;
+  }
+
+  // Analyze without holding the lock. Concurrent misses on the same key
+  // analyze the statement more than once, and the first result is kept.
+  auto cached = std::make_shared<CachedAnalyzerOutput>();
+  cached->type_factory = std::move(type_factory);
+  ZETASQL_RETURN_IF_ERROR(zetasql::AnalyzeStatement(sql, options, catalog,
+                                            cached->type_factory.get(),
+                                            &cached->output));
+  std::shared_ptr<const AnalyzerOutput> result(cached, cached->output.get());
+  *output = result;
+  if (!cacheable) {
+    return ::zetasql_base::OkStatus();
+  }
+
+  // A caller-provided arena is shared with other statements, so it is not
+  // attributed to this entry.
+  const int64_t bytes =
+      EstimateBytes(sql, *result, /*owns_arena=*/options.arena() == nullptr);
+
+  absl::MutexLock l(&mutex_);
+  if (index_.contains(key) || cached->type_factory != type_factory_) {
+    // Already cached, or the cache replaced its TypeFactory meanwhile.
+    return ::zetasql_base::OkStatus();
+  }
+  lru_.push_front(Entry{std::move(key), std::move(result), bytes});
+  index_.emplace(lru_.front().key, lru_.begin());
+  ++stats_.entries;
+  stats_.bytes += bytes;
+  EvictLocked();
+  return ::zetasql_base::OkStatus();
+}
+
+void AnalyzerCache::EvictLocked() {
+  // Types created during analysis stay in the TypeFactory after their entry
+  // is evicted, so they count against <max_bytes> on their own.
+  const int64_t type_bytes = type_factory_->GetEstimatedOwnedMemoryBytesSize();
+  while (!lru_.empty() && (stats_.entries > options_.max_entries ||
+                           stats_.bytes + type_bytes > options_.max_bytes)) {
+    const Entry& entry = lru_.back();
+    stats_.bytes -= entry.bytes;
+    --stats_.entries;
+    ++stats_.evictions;
+    index_.erase(entry.key);
+    lru_.pop_back();
+  }
+  if (type_bytes > options_.max_bytes) {
+    // Every entry is gone, and only a new TypeFactory releases the types.
+    // Outputs still held by callers keep the old one alive.
+    ResetTypeFactoryLocked();
+  }
+}
+
+void AnalyzerCache::ResetTypeFactoryLocked() {
+  type_factory_ = std::make_shared<TypeFactory>();
+}
+
+AnalyzerCache::Stats AnalyzerCache::GetStats() const {
+  absl::MutexLock l(&mutex_);
+  Stats stats = stats_;
+  stats.bytes += type_factory_->GetEstimatedOwnedMemoryBytesSize();
+  return stats;
+}
+
+void AnalyzerCache::Clear() {
+  absl::MutexLock l(&mutex_);
+  index_.clear();
+  lru_.clear();
+  stats_.entries = 0;
+  stats_.bytes = 0;
+  ResetTypeFactoryLocked();
+}
+
+}  // namespace zetasql
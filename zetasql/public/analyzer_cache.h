@@ -0,0 +1,136 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef ZETASQL_PUBLIC_ANALYZER_CACHE_H_
+#define ZETASQL_PUBLIC_ANALYZER_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/catalog.h"
+#include "zetasql/public/type.h"
+#include <cstdint>
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "zetasql/base/status.h"
+
+namespace zetasql {
+
+struct AnalyzerCacheOptions {
+  // The cache evicts least recently used entries when it holds more than
+  // <max_entries> statements, or when the estimated memory used by the cached
+  // statements and by the types created while analyzing them exceeds
+  // <max_bytes>.
+  int64_t max_entries = 1000;
+  int64_t max_bytes = int64_t{64} << 20;
+};
+
+// A cache of AnalyzerOutputs for statements, for callers that analyze the
+// same SQL text many times.
+//
+// Entries are keyed on the SQL text, on the AnalyzerOptions (including the
+// LanguageOptions, the Catalog::FindOptions and the identity of the Types of
+// parameters, expression columns, hints and options), and on the Catalog and
+// its Catalog::GetVersionToken(), so a Catalog change makes previously cached
+// statements unreachable. Statements
+// analyzed against a Catalog without a version token, or with
+// AnalyzerOptions that can't be fingerprinted (callbacks, or a caller-provided
+// column id sequence), are analyzed but not cached. Analysis errors are not
+// cached.
+//
+// The cache owns the TypeFactory used for analysis, and the returned
+// AnalyzerOutput keeps it alive. As with AnalyzeStatement, the Catalog,
+// objects looked up through it and the Types in the AnalyzerOptions must
+// outlive the AnalyzerOutput. Since entries are keyed on their addresses,
+// they must also outlive the cache, or the caller must Clear() it before
+// destroying them.
+//
+// This class is thread-safe.
+class AnalyzerCache {
+ public:
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    // Calls that bypassed the cache.
+    int64_t uncacheable = 0;
+    int64_t evictions = 0;
+    int64_t entries = 0;
+    // Includes the types owned by the cache's TypeFactory.
+    int64_t bytes = 0;
+  };
+
+  explicit AnalyzerCache(
+      const AnalyzerCacheOptions& options = AnalyzerCacheOptions());
+  AnalyzerCache(const AnalyzerCache&) = delete;
+  AnalyzerCache& operator=(const AnalyzerCache&) = delete;
+  ~AnalyzerCache();
+
+  // Like zetasql::AnalyzeStatement(), but returns a cached output if the same
+  // statement was analyzed before with equivalent options and the same
+  // Catalog version. The output is shared and must not be modified.
+  zetasql_base::Status AnalyzeStatement(
+      absl::string_view sql, const AnalyzerOptions& options, Catalog* catalog,
+      std::shared_ptr<const AnalyzerOutput>* output) LOCKS_EXCLUDED(mutex_);
+
+  Stats GetStats() const LOCKS_EXCLUDED(mutex_);
+
+  // Removes all entries and releases the types created for them. Outputs
+  // previously returned stay valid.
+  void Clear() LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const AnalyzerOutput> output;
+    int64_t bytes;
+  };
+
+  // Computes the cache key for the arguments, or returns false if the
+  // statement can't be cached.
+  static bool ComputeKey(absl::string_view sql, const AnalyzerOptions& options,
+                         const Catalog* catalog, std::string* key);
+
+  // Returns the approximate memory used by <output>, including its arena if
+  // <owns_arena> is true.
+  static int64_t EstimateBytes(absl::string_view sql,
+                               const AnalyzerOutput& output, bool owns_arena);
+
+  void EvictLocked() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Starts analyzing with a new TypeFactory. The previous one lives on as
+  // long as outputs that refer to it.
+  void ResetTypeFactoryLocked() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const AnalyzerCacheOptions options_;
+
+  mutable absl::Mutex mutex_;
+  // Shared with every output analyzed with it, which may refer to its types.
+  std::shared_ptr<TypeFactory> type_factory_ GUARDED_BY(mutex_);
+  // Entries ordered from most to least recently used.
+  std::list<Entry> lru_ GUARDED_BY(mutex_);
+  // Points into <lru_>; keys are owned by the entries.
+  absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator> index_
+      GUARDED_BY(mutex_);
+  Stats stats_ GUARDED_BY(mutex_);
+};
+
+}  // namespace zetasql
+
+#endif  // ZETASQL_PUBLIC_ANALYZER_CACHE_H_
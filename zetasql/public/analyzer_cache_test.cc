@@ -0,0 +1,277 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/analyzer_cache.h"
+
+#include <memory>
+
+#include "zetasql/base/atomic_sequence_num.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/cycle_detector.h"
+#include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/type.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+
+namespace zetasql {
+
+using ::zetasql_base::testing::StatusIs;
+
+class AnalyzerCacheTest : public ::testing::Test {
+ protected:
+  AnalyzerCacheTest() : catalog_("catalog") {
+    catalog_.AddZetaSQLFunctions();
+    catalog_.AddOwnedTable(absl::make_unique<SimpleTable>(
+        "t", std::vector<SimpleTable::NameAndType>{
+                 {"a", types::Int64Type()}, {"b", types::StringType()}}));
+  }
+
+  SimpleCatalog catalog_;
+};
+
+TEST_F(AnalyzerCacheTest, HitsAndMisses) {
+  AnalyzerCache cache;
+  AnalyzerOptions options;
+  std::shared_ptr<const AnalyzerOutput> output1;
+  std::shared_ptr<const AnalyzerOutput> output2;
+  std::shared_ptr<const AnalyzerOutput> output3;
+
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output1));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output2));
+  EXPECT_EQ(output1.get(), output2.get());
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT b FROM t", options, &catalog_,
+                                   &output3));
+  EXPECT_NE(output1.get(), output3.get());
+
+  AnalyzerCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(2, stats.entries);
+  EXPECT_GT(stats.bytes, 0);
+
+  // Errors are returned but not cached.
+  EXPECT_FALSE(
+      cache.AnalyzeStatement("SELECT c FROM t", options, &catalog_, &output3)
+          .ok());
+  EXPECT_EQ(2, cache.GetStats().entries);
+}
+
+TEST_F(AnalyzerCacheTest, KeyIncludesOptions) {
+  AnalyzerCache cache;
+  AnalyzerOptions options;
+  std::shared_ptr<const AnalyzerOutput> output1;
+  std::shared_ptr<const AnalyzerOutput> output2;
+  EXPECT_THAT(
+      cache.AnalyzeStatement("SELECT @p FROM t", options, &catalog_, &output1),
+      StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+
+  ZETASQL_ASSERT_OK(options.AddQueryParameter("p", types::Int64Type()));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT @p FROM t", options, &catalog_,
+                                   &output1));
+  AnalyzerOptions other_options;
+  ZETASQL_ASSERT_OK(other_options.AddQueryParameter("p", types::StringType()));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT @p FROM t", other_options,
+                                   &catalog_, &output2));
+  EXPECT_NE(output1.get(), output2.get());
+
+  other_options.mutable_language()->EnableMaximumLanguageFeatures();
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT @p FROM t", other_options,
+                                   &catalog_, &output1));
+  EXPECT_NE(output1.get(), output2.get());
+  EXPECT_EQ(0, cache.GetStats().hits);
+}
+
+TEST_F(AnalyzerCacheTest, CatalogChangeInvalidates) {
+  AnalyzerCache cache;
+  AnalyzerOptions options;
+  std::shared_ptr<const AnalyzerOutput> output1;
+  std::shared_ptr<const AnalyzerOutput> output2;
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output1));
+
+  catalog_.AddOwnedTable(absl::make_unique<SimpleTable>(
+      "u", std::vector<SimpleTable::NameAndType>{{"a", types::Int64Type()}}));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output2));
+  EXPECT_NE(output1.get(), output2.get());
+
+  // Changes in sub-catalogs are also detected.
+  SimpleCatalog* sub_catalog = catalog_.MakeOwnedSimpleCatalog("sub");
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output1));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output2));
+  EXPECT_EQ(output1.get(), output2.get());
+  sub_catalog->AddOwnedTable(absl::make_unique<SimpleTable>(
+      "v", std::vector<SimpleTable::NameAndType>{{"a", types::Int64Type()}}));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output2));
+  EXPECT_NE(output1.get(), output2.get());
+}
+
+TEST_F(AnalyzerCacheTest, UncacheableOptions) {
+  AnalyzerCache cache;
+  AnalyzerOptions options;
+  zetasql_base::SequenceNumber sequence;
+  options.set_column_id_sequence_number(&sequence);
+  std::shared_ptr<const AnalyzerOutput> output1;
+  std::shared_ptr<const AnalyzerOutput> output2;
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output1));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options, &catalog_,
+                                   &output2));
+  EXPECT_NE(output1.get(), output2.get());
+  EXPECT_EQ(2, cache.GetStats().uncacheable);
+  EXPECT_EQ(0, cache.GetStats().entries);
+}
+
+TEST_F(AnalyzerCacheTest, Eviction) {
+  AnalyzerCacheOptions cache_options;
+  cache_options.max_entries = 2;
+  AnalyzerCache cache(cache_options);
+  AnalyzerOptions options;
+  std::shared_ptr<const AnalyzerOutput> output;
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT 1", options, &catalog_, &output));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT 2", options, &catalog_, &output));
+  // Makes "SELECT 1" the most recently used entry.
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT 1", options, &catalog_, &output));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT 3", options, &catalog_, &output));
+
+  AnalyzerCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(2, stats.entries);
+  EXPECT_EQ(1, stats.evictions);
+
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT 1", options, &catalog_, &output));
+  EXPECT_EQ(2, cache.GetStats().hits);
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT 2", options, &catalog_, &output));
+  EXPECT_EQ(2, cache.GetStats().hits);
+
+  // Outputs stay valid after the cache is cleared.
+  cache.Clear();
+  EXPECT_EQ(0, cache.GetStats().entries);
+  ASSERT_NE(nullptr, output->resolved_statement());
+  EXPECT_EQ(RESOLVED_QUERY_STMT, output->resolved_statement()->node_kind());
+}
+
+TEST_F(AnalyzerCacheTest, KeyIncludesTypeIdentity) {
+  AnalyzerCache cache;
+  TypeFactory factory1;
+  TypeFactory factory2;
+  const Type* array1;
+  const Type* array2;
+  ZETASQL_ASSERT_OK(factory1.MakeArrayType(types::Int64Type(), &array1));
+  ZETASQL_ASSERT_OK(factory2.MakeArrayType(types::Int64Type(), &array2));
+  ASSERT_TRUE(array1->Equals(array2));
+
+  AnalyzerOptions options1;
+  ZETASQL_ASSERT_OK(options1.AddQueryParameter("p", array1));
+  AnalyzerOptions options2;
+  ZETASQL_ASSERT_OK(options2.AddQueryParameter("p", array2));
+
+  std::shared_ptr<const AnalyzerOutput> output1;
+  std::shared_ptr<const AnalyzerOutput> output2;
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT @p", options1, &catalog_,
+                                   &output1));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT @p", options2, &catalog_,
+                                   &output2));
+  EXPECT_NE(output1.get(), output2.get());
+  EXPECT_EQ(0, cache.GetStats().hits);
+  // The output of the second call refers to the second factory's type.
+  const ResolvedQueryStmt* query =
+      output2->resolved_statement()->GetAs<ResolvedQueryStmt>();
+  EXPECT_EQ(array2, query->output_column_list(0)->column().type());
+
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT @p", options2, &catalog_,
+                                   &output1));
+  EXPECT_EQ(output1.get(), output2.get());
+  EXPECT_EQ(1, cache.GetStats().hits);
+}
+
+TEST_F(AnalyzerCacheTest, KeyIncludesDdlPseudoColumns) {
+  AnalyzerCache cache;
+  AnalyzerOptions options1;
+  options1.mutable_language()->SetSupportsAllStatementKinds();
+  options1.SetDdlPseudoColumns({{"pc", types::Int64Type()}});
+  AnalyzerOptions options2;
+  options2.mutable_language()->SetSupportsAllStatementKinds();
+  options2.SetDdlPseudoColumns({{"pc", types::StringType()}});
+
+  const std::string sql = "CREATE TABLE x (a INT64)";
+  std::shared_ptr<const AnalyzerOutput> output1;
+  std::shared_ptr<const AnalyzerOutput> output2;
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement(sql, options1, &catalog_, &output1));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement(sql, options2, &catalog_, &output2));
+  EXPECT_NE(output1.get(), output2.get());
+  EXPECT_EQ(0, cache.GetStats().hits);
+  EXPECT_EQ(0, cache.GetStats().uncacheable);
+  const ResolvedCreateTableStmt* create =
+      output2->resolved_statement()->GetAs<ResolvedCreateTableStmt>();
+  ASSERT_EQ(1, create->pseudo_column_list_size());
+  EXPECT_EQ(types::StringType(), create->pseudo_column_list(0).type());
+
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement(sql, options2, &catalog_, &output1));
+  EXPECT_EQ(output1.get(), output2.get());
+  EXPECT_EQ(1, cache.GetStats().hits);
+}
+
+TEST_F(AnalyzerCacheTest, KeyIncludesFindOptions) {
+  AnalyzerCache cache;
+  AnalyzerOptions options1;
+  CycleDetector cycle_detector;
+  AnalyzerOptions options2;
+  options2.mutable_find_options()->set_cycle_detector(&cycle_detector);
+
+  std::shared_ptr<const AnalyzerOutput> output;
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options1, &catalog_,
+                                   &output));
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement("SELECT a FROM t", options2, &catalog_,
+                                   &output));
+  EXPECT_EQ(0, cache.GetStats().hits);
+  EXPECT_EQ(2, cache.GetStats().entries);
+}
+
+TEST_F(AnalyzerCacheTest, TypesCountAgainstMaxBytes) {
+  AnalyzerCache unbounded_cache;
+  AnalyzerOptions options;
+  std::shared_ptr<const AnalyzerOutput> output;
+  const std::string sql = "SELECT STRUCT(a AS x, b AS y) FROM t";
+  ZETASQL_ASSERT_OK(
+      unbounded_cache.AnalyzeStatement(sql, options, &catalog_, &output));
+  // Creating the struct type made the factory grow.
+  const int64_t entry_and_type_bytes = unbounded_cache.GetStats().bytes;
+
+  AnalyzerCacheOptions cache_options;
+  cache_options.max_bytes = entry_and_type_bytes - 1;
+  AnalyzerCache cache(cache_options);
+  ZETASQL_ASSERT_OK(cache.AnalyzeStatement(sql, options, &catalog_, &output));
+  AnalyzerCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(0, stats.entries);
+  EXPECT_EQ(1, stats.evictions);
+  EXPECT_LE(stats.bytes, cache_options.max_bytes);
+
+  // The output keeps its types alive after the cache drops its factory.
+  const ResolvedQueryStmt* query =
+      output->resolved_statement()->GetAs<ResolvedQueryStmt>();
+  EXPECT_EQ("STRUCT<x INT64, y STRING>",
+            query->output_column_list(0)->column().type()->DebugString());
+}
+
+}  // namespace zetasql
@@ -18,6 +18,7 @@
 
 #include <ctype.h>
 #include <algorithm>
+#include <list>
 #include <memory>
 #include <set>
 #include <utility>
@@ -41,6 +42,7 @@
 #include "zetasql/public/options.pb.h"
 #include "zetasql/public/type.pb.h"
 #include "zetasql/public/value.h"
+#include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "zetasql/base/bind_front.h"
@@ -48,6 +50,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "zetasql/base/map_util.h"
 #include "zetasql/base/ret_check.h"
 #include "zetasql/base/status.h"
@@ -878,7 +881,7 @@ static zetasql_base::Status CheckIsSupportedKeyType(
   }
 
   // Check the key type for std::string literals.
-  const std::string& key_type = argument.literal_value()->string_value();
+  const std::string key_type(argument.literal_value()->string_view_value());
   if (!zetasql_base::ContainsKey(supported_key_types, key_type)) {
     const std::string key_type_list =
         supported_key_types.size() == 1
@@ -4423,6 +4426,99 @@ void GetZetaSQLFunctions(TypeFactory* type_factory,
   }
 }
 
+ZetaSQLBuiltinFunctionSet::ZetaSQLBuiltinFunctionSet(
+    const ZetaSQLBuiltinFunctionOptions& options) {
+  // Shared by all sets and never destroyed. Other TypeFactories may depend on
+  // it through types derived from signature types, and a TypeFactory must
+  // outlive the factories that depend on it. Array and struct types are
+  // cached by the factory, so rebuilding evicted sets adds only their PROTO
+  // and ENUM types.
+  static TypeFactory* type_factory = new TypeFactory;
+  NameToFunctionMap functions;
+  GetZetaSQLFunctions(type_factory, options, &functions);
+  for (auto& entry : functions) {
+    functions_.emplace(entry.first, std::move(entry.second));
+  }
+}
+
+namespace {
+
+// Returns a string that is equal for options that select the same functions.
+std::string BuiltinFunctionOptionsKey(
+    const ZetaSQLBuiltinFunctionOptions& options) {
+  ZetaSQLBuiltinFunctionOptionsProto proto;
+  options.language_options.Serialize(proto.mutable_language_options());
+  // Statement kinds don't affect which functions are loaded.
+  proto.mutable_language_options()->clear_supported_statement_kinds();
+  const std::set<FunctionSignatureId> include_ids(
+      options.include_function_ids.begin(), options.include_function_ids.end());
+  for (FunctionSignatureId id : include_ids) {
+    proto.add_include_function_ids(id);
+  }
+  const std::set<FunctionSignatureId> exclude_ids(
+      options.exclude_function_ids.begin(), options.exclude_function_ids.end());
+  for (FunctionSignatureId id : exclude_ids) {
+    proto.add_exclude_function_ids(id);
+  }
+  return proto.SerializeAsString();
+}
+
+// The most recently requested shared function sets, by options key.
+class SharedFunctionSetCache {
+ public:
+  // The function sets of evicted options stay alive while a catalog uses
+  // them, so this only bounds the sets kept alive by the cache itself.
+  static constexpr int kMaxEntries = 16;
+
+  // A function set that is built once, outside the cache lock.
+  struct Entry {
+    absl::once_flag once;
+    std::shared_ptr<const ZetaSQLBuiltinFunctionSet> function_set;
+  };
+
+  // Returns the entry for <key>, making it the most recently used one.
+  std::shared_ptr<Entry> GetEntry(const std::string& key) {
+    absl::MutexLock lock(&mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->second;
+    }
+    lru_.emplace_front(key, std::make_shared<Entry>());
+    index_.emplace(lru_.front().first, lru_.begin());
+    if (lru_.size() > kMaxEntries) {
+      index_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+    return lru_.front().second;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::list<std::pair<std::string, std::shared_ptr<Entry>>> lru_
+      GUARDED_BY(mutex_);
+  // Points into <lru_>; keys are owned by the entries.
+  absl::flat_hash_map<absl::string_view,
+                      std::list<std::pair<std::string,
+                                          std::shared_ptr<Entry>>>::iterator>
+      index_ GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+std::shared_ptr<const ZetaSQLBuiltinFunctionSet> GetSharedZetaSQLFunctions(
+    const ZetaSQLBuiltinFunctionOptions& options) {
+  static SharedFunctionSetCache* cache = new SharedFunctionSetCache;
+  const std::shared_ptr<SharedFunctionSetCache::Entry> entry =
+      cache->GetEntry(BuiltinFunctionOptionsKey(options));
+  // Concurrent callers with the same options wait here for one of them to
+  // build the set, without blocking callers with other options.
+  absl::call_once(entry->once, [&entry, &options] {
+    entry->function_set.reset(new ZetaSQLBuiltinFunctionSet(options));
+  });
+  return entry->function_set;
+}
+
 bool FunctionMayHaveUnintendedArgumentCoercion(const Function* function) {
   if (function->NumSignatures() == 0 ||
       !function->ArgumentsAreCoercible()) {
@@ -19,6 +19,7 @@
 
 #include <stddef.h>
 #include <map>
+#include <memory>
 #include <string>
 
 #include "zetasql/proto/options.pb.h"
@@ -88,6 +89,45 @@ void GetZetaSQLFunctions(
     TypeFactory* type_factory, const ZetaSQLBuiltinFunctionOptions& options,
     std::map<std::string, std::unique_ptr<Function>>* functions);
 
+// The built-in functions for one ZetaSQLBuiltinFunctionOptions. Instances
+// are immutable and can be shared by any number of catalogs and threads.
+//
+// The types in the function signatures come from a TypeFactory that lives
+// for the rest of the process, so types that other TypeFactories derive from
+// them (e.g. an ARRAY of a signature's PROTO type) stay valid after the set is
+// destroyed.
+class ZetaSQLBuiltinFunctionSet {
+ public:
+  ZetaSQLBuiltinFunctionSet(const ZetaSQLBuiltinFunctionSet&) = delete;
+  ZetaSQLBuiltinFunctionSet& operator=(const ZetaSQLBuiltinFunctionSet&) =
+      delete;
+
+  // The functions selected by the options, keyed by name as in
+  // GetZetaSQLFunctions().
+  const std::map<std::string, std::unique_ptr<const Function>>& functions()
+      const {
+    return functions_;
+  }
+
+ private:
+  explicit ZetaSQLBuiltinFunctionSet(
+      const ZetaSQLBuiltinFunctionOptions& options);
+
+  std::map<std::string, std::unique_ptr<const Function>> functions_;
+
+  friend std::shared_ptr<const ZetaSQLBuiltinFunctionSet>
+  GetSharedZetaSQLFunctions(const ZetaSQLBuiltinFunctionOptions& options);
+};
+
+// Returns the built-in functions for <options>. The functions are built the
+// first time equivalent options are requested, and the same instance is
+// returned to later callers as long as the options stay among the most
+// recently requested ones. Unlike GetZetaSQLFunctions(), this avoids
+// rebuilding the functions for every catalog. Thread-safe; concurrent callers
+// with equivalent options wait for a single build.
+std::shared_ptr<const ZetaSQLBuiltinFunctionSet> GetSharedZetaSQLFunctions(
+    const ZetaSQLBuiltinFunctionOptions& options);
+
 // If the function allows argument coercion, then checks the function
 // signatures to see if they are defined for floating point and
 // only one of signed/unsigned integer arguments (but not both integer
@@ -16,6 +16,8 @@
 
 #include "zetasql/public/builtin_function.h"
 
+#include <memory>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -25,11 +27,14 @@
 #include "zetasql/public/function.pb.h"
 #include "zetasql/public/language_options.h"
 #include "zetasql/public/options.pb.h"
+#include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
 #include "zetasql/resolved_ast/resolved_node_kind.pb.h"
 #include "zetasql/testdata/test_schema.pb.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
 #include "zetasql/base/map_util.h"
 #include "zetasql/base/status.h"
@@ -447,6 +452,113 @@ TEST(SimpleBuiltinFunctionTests, NumericFunctions) {
             (*function)->GetSignature(0)->DebugString());
 }
 
+TEST(SimpleBuiltinFunctionTests, SharedFunctions) {
+  ZetaSQLBuiltinFunctionOptions options;
+  options.exclude_function_ids.insert(FN_ABS_DOUBLE);
+  options.exclude_function_ids.insert(FN_AND);
+
+  // Equivalent options share the same functions. Statement kinds don't
+  // matter.
+  ZetaSQLBuiltinFunctionOptions same_options;
+  same_options.exclude_function_ids.insert(FN_AND);
+  same_options.exclude_function_ids.insert(FN_ABS_DOUBLE);
+  same_options.language_options.SetSupportedStatementKinds(
+      {RESOLVED_QUERY_STMT});
+  std::shared_ptr<const ZetaSQLBuiltinFunctionSet> shared =
+      GetSharedZetaSQLFunctions(options);
+  EXPECT_EQ(shared.get(), GetSharedZetaSQLFunctions(same_options).get());
+
+  ZetaSQLBuiltinFunctionOptions other_options{LanguageOptions()};
+  EXPECT_NE(shared.get(), GetSharedZetaSQLFunctions(other_options).get());
+
+  // The shared functions are the same as those built from scratch.
+  TypeFactory type_factory;
+  NameToFunctionMap functions;
+  GetZetaSQLFunctions(&type_factory, options, &functions);
+  ASSERT_EQ(functions.size(), shared->functions().size());
+  for (const auto& entry : functions) {
+    const auto it = shared->functions().find(entry.first);
+    ASSERT_TRUE(it != shared->functions().end()) << entry.first;
+    EXPECT_EQ(entry.second->DebugString(), it->second->DebugString());
+  }
+}
+
+TEST(SimpleBuiltinFunctionTests, SharedFunctionsAreBounded) {
+  ZetaSQLBuiltinFunctionOptions options;
+  options.exclude_function_ids.insert(FN_ABS_INT64);
+  const std::shared_ptr<const ZetaSQLBuiltinFunctionSet> shared =
+      GetSharedZetaSQLFunctions(options);
+
+  // Concurrent callers get the same functions.
+  std::vector<std::shared_ptr<const ZetaSQLBuiltinFunctionSet>> results(4);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < results.size(); ++i) {
+    threads.emplace_back([&results, &options, i] {
+      results[i] = GetSharedZetaSQLFunctions(options);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (const auto& result : results) {
+    EXPECT_EQ(shared.get(), result.get());
+  }
+
+  // Many other options evict <options>, but the functions stay valid while
+  // they are used.
+  int num_other_options = 0;
+  for (int id = 0;
+       id < FunctionSignatureId_ARRAYSIZE && num_other_options < 32; ++id) {
+    if (!FunctionSignatureId_IsValid(id) || id == FN_ABS_INT64) continue;
+    ZetaSQLBuiltinFunctionOptions other_options;
+    other_options.exclude_function_ids.insert(
+        static_cast<FunctionSignatureId>(id));
+    GetSharedZetaSQLFunctions(other_options);
+    ++num_other_options;
+  }
+  EXPECT_NE(shared.get(), GetSharedZetaSQLFunctions(options).get());
+  const std::unique_ptr<const Function>* abs =
+      zetasql_base::FindOrNull(shared->functions(), "abs");
+  ASSERT_THAT(abs, NotNull());
+  for (const FunctionSignature& signature : (*abs)->signatures()) {
+    EXPECT_NE(FN_ABS_INT64, signature.context_id());
+  }
+}
+
+TEST(SimpleBuiltinFunctionTests, SharedFunctionTypesOutliveSets) {
+  ZetaSQLBuiltinFunctionOptions options;
+  options.exclude_function_ids.insert(FN_ABS_FLOAT);
+  TypeFactory type_factory;
+  const StructType* struct_type;
+  {
+    auto catalog = absl::make_unique<SimpleCatalog>("catalog", &type_factory);
+    catalog->AddZetaSQLFunctions(options);
+    const Function* split;
+    ZETASQL_ASSERT_OK(catalog->GetFunction("split", &split));
+    const Type* array_type = split->GetSignature(0)->result_type().type();
+    ASSERT_TRUE(array_type->IsArray());
+    // <type_factory> now depends on the factory that owns <array_type>.
+    ZETASQL_ASSERT_OK(
+        type_factory.MakeStructType({{"a", array_type}}, &struct_type));
+
+    // Evict the set from the cache and drop the catalog's reference.
+    int num_other_options = 0;
+    for (int id = 0;
+         id < FunctionSignatureId_ARRAYSIZE && num_other_options < 32; ++id) {
+      if (!FunctionSignatureId_IsValid(id) || id == FN_ABS_FLOAT) continue;
+      ++num_other_options;
+      ZetaSQLBuiltinFunctionOptions other_options;
+      other_options.exclude_function_ids.insert(
+          static_cast<FunctionSignatureId>(id));
+      GetSharedZetaSQLFunctions(other_options);
+    }
+  }
+
+  // The signature types are still valid, and destroying <type_factory> does
+  // not outlive a factory it depends on.
+  EXPECT_EQ("STRUCT<a ARRAY<STRING>>", struct_type->DebugString());
+}
+
 static ArgumentConstraintsCallback GetArgumentConstraints(
     FunctionSignatureId function_id, const NameToFunctionMap& functions,
     bool pre_resolution = true) {
@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "zetasql/base/logging.h"
@@ -233,12 +234,6 @@ const CastHashMap& GetZetaSQLCasts() {
   return *cast_hash_map;
 }
 
-// Returns a single uint64_t that represents an (input kind, output kind) pair.
-// Useful for switching on a combination of two kinds.
-static constexpr uint64_t FCT(TypeKind input_kind, TypeKind output_kind) {
-  return ((static_cast<uint64_t>(input_kind) << 32) + output_kind);
-}
-
 bool SupportsImplicitCoercion(CastFunctionType type) {
   return type == CastFunctionType::IMPLICIT;
 }
@@ -261,10 +256,18 @@ bool SupportsExplicitCast(CastFunctionType type) {
          type == CastFunctionType::EXPLICIT_OR_LITERAL_OR_PARAMETER;
 }
 
+// The cast kernels below cast a non-NULL value to a type of a given kind.
+// They all have the signature of CastKernel, and are registered by (input
+// kind, output kind) in the dense table built by InitializeCastKernels(), so
+// that finding the kernel for a cast is an array index rather than a hash
+// lookup and a switch.
+using CastKernel = zetasql_base::StatusOr<Value> (*)(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options);
+
 template <typename FromType, typename ToType>
-static zetasql_base::StatusOr<Value> NumericCast(const Value& value) {
+static zetasql_base::StatusOr<Value> NumericValueCast(const FromType& in) {
   zetasql_base::Status status;
-  FromType in = value.Get<FromType>();
   ToType out;
   functions::Convert<FromType, ToType>(in, &out, &status);
   if (status.ok()) {
@@ -275,15 +278,10 @@ static zetasql_base::StatusOr<Value> NumericCast(const Value& value) {
 }
 
 template <typename FromType, typename ToType>
-static zetasql_base::StatusOr<Value> NumericValueCast(const FromType& in) {
-  zetasql_base::Status status;
-  ToType out;
-  functions::Convert<FromType, ToType>(in, &out, &status);
-  if (status.ok()) {
-    return Value::Make<ToType>(out);
-  } else {
-    return status;
-  }
+static zetasql_base::StatusOr<Value> NumericCast(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  return NumericValueCast<FromType, ToType>(v.Get<FromType>());
 }
 
 zetasql_base::Status CheckLegacyRanges(int64_t timestamp,
@@ -321,12 +319,12 @@ zetasql_base::Status CheckLegacyRanges(int64_t timestamp,
 // Conversion function from a numeric Value to a std::string Value that
 // handles NULL Values but otherwise just wraps the ZetaSQL function
 // library function (which does not handle NULL values).
-// The function is invoked like:
-//   status = NumericToString<int32_t>(value)
 //
 // Crashes if the Value type does not correspond with <T>.
 template <typename T>
-static zetasql_base::StatusOr<Value> NumericToString(const Value& v) {
+static zetasql_base::StatusOr<Value> NumericToString(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
   if (v.is_null()) return Value::NullString();
   T value = v.Get<T>();
   std::string str;
@@ -338,17 +336,17 @@ static zetasql_base::StatusOr<Value> NumericToString(const Value& v) {
   }
 }
 
-// Conversion function from a numeric Value to a std::string Value that
+// Conversion function from a std::string Value to a numeric Value that
 // handles NULL Values but otherwise just wraps the ZetaSQL function
 // library function (which does not handle NULL values).
-// The function is invoked like:
-//   status = StringToNumeric<int32_t>(value)
 //
 // Crashes if the Value <v> is not a std::string.
 template <typename T>
-static zetasql_base::StatusOr<Value> StringToNumeric(const Value& v) {
+static zetasql_base::StatusOr<Value> StringToNumeric(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
   if (v.is_null()) return Value::MakeNull<T>();
-  std::string value = v.string_value();
+  const absl::string_view value = v.string_view_value();
   T out;
   zetasql_base::Status error;
   if (zetasql::functions::StringToNumeric<T>(value, &out, &error)) {
@@ -358,6 +356,598 @@ static zetasql_base::StatusOr<Value> StringToNumeric(const Value& v) {
   }
 }
 
+// Used for INT32, INT64 and UINT32 inputs.
+static zetasql_base::StatusOr<Value> CastIntegerToEnum(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  const Value to_value = Value::Enum(to_type->AsEnum(), v.ToInt64());
+  if (!to_value.is_valid()) {
+    return MakeEvalError() << "Out of range cast of integer " << v.ToInt64()
+                           << " to enum type " << to_type->DebugString();
+  }
+  return to_value;
+}
+
+static zetasql_base::StatusOr<Value> CastUint64ToEnum(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  // Static cast may turn out-of-bound uint64_t's to negative int64_t's which
+  // will yield invalid enums.
+  const Value to_value =
+      Value::Enum(to_type->AsEnum(), static_cast<int64_t>(v.uint64_value()));
+  if (!to_value.is_valid()) {
+    return MakeEvalError() << "Out of range cast of integer "
+                           << v.uint64_value() << " to enum type "
+                           << to_type->DebugString();
+  }
+  return to_value;
+}
+
+static zetasql_base::StatusOr<Value> CastStringToEnum(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  const Value to_value = Value::Enum(to_type->AsEnum(), v.string_view_value());
+  if (!to_value.is_valid()) {
+    return MakeEvalError() << "Out of range cast of std::string '"
+                           << v.string_view_value() << "' to enum type "
+                           << to_type->DebugString();
+  }
+  return to_value;
+}
+
+static zetasql_base::StatusOr<Value> CastStringToDate(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  int32_t date;
+  ZETASQL_RETURN_IF_ERROR(
+      functions::ConvertStringToDate(v.string_view_value(), &date));
+  return Value::Date(date);
+}
+
+static zetasql_base::StatusOr<Value> CastStringToTimestamp(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  // TODO: These should be using the non-deprecated signature
+  // that includes an argument to indicate if a timezone is allowed in
+  // the std::string or not.  If not allowed and there is a timezone then
+  // an error should be provided.
+  if (language_options.LanguageFeatureEnabled(FEATURE_TIMESTAMP_NANOS)) {
+    absl::Time timestamp;
+    ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToTimestamp(
+        v.string_view_value(), default_timezone, functions::kNanoseconds,
+        true /* allow_tz_in_str */, &timestamp));
+    return Value::Timestamp(timestamp);
+  } else {
+    int64_t timestamp;
+    ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToTimestamp(
+        v.string_view_value(), default_timezone, functions::kMicroseconds,
+        &timestamp));
+    return Value::TimestampFromUnixMicros(timestamp);
+  }
+}
+
+static zetasql_base::StatusOr<Value> CastTimestampToString(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  std::string timestamp;
+  if (language_options.LanguageFeatureEnabled(FEATURE_TIMESTAMP_NANOS)) {
+    ZETASQL_RETURN_IF_ERROR(functions::ConvertTimestampToString(
+        v.ToTime(), functions::kNanoseconds, default_timezone, &timestamp));
+  } else {
+    ZETASQL_RETURN_IF_ERROR(functions::ConvertTimestampToStringWithTruncation(
+        v.ToUnixMicros(), functions::kMicroseconds, default_timezone,
+        &timestamp));
+  }
+  return Value::String(timestamp);
+}
+
+static zetasql_base::StatusOr<Value> CastDateToTimestamp(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  int64_t timestamp;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertDateToTimestamp(
+      v.date_value(), functions::kMicroseconds, default_timezone, &timestamp));
+  return Value::TimestampFromUnixMicros(timestamp);
+}
+
+static zetasql_base::StatusOr<Value> CastTimestampToDate(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  int32_t date;
+  ZETASQL_RETURN_IF_ERROR(ExtractFromTimestamp(
+      functions::DateTimestampPart::DATE, v.ToUnixMicros(),
+      functions::kMicroseconds, default_timezone, &date));
+  return Value::Date(date);
+}
+
+static zetasql_base::StatusOr<Value> CastStringToBytes(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  return Value::Bytes(v.string_view_value());
+}
+
+static zetasql_base::StatusOr<Value> CastStringToProto(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  if (to_type->AsProto()->descriptor() == nullptr) {
+    // TODO: Cannot currently get here, since a ProtoType
+    // requires a non-nullptr descriptor.  This may change when we
+    // implement  opaque protos.  Additionally, opaque protos may affect
+    // the ability to successfully parse or serialize the proto (note
+    // also that a fully-defined proto might have a descendant field
+    // that is an opaque proto).
+    return MakeEvalError()
+           << "Invalid cast from std::string to opaque proto type "
+           << to_type->DebugString();
+  }
+  google::protobuf::DynamicMessageFactory msg_factory;
+  std::unique_ptr<google::protobuf::Message> message(
+      msg_factory.GetPrototype(to_type->AsProto()->descriptor())->New());
+  zetasql_base::Status error;
+  functions::StringToProto(v.string_view_value(), message.get(), &error);
+  ZETASQL_RETURN_IF_ERROR(error);
+  // TODO: SerializeToString returns false if not all required
+  // fields are present.  If we want to allow missing required fields
+  // We could use SerializePartialToString().
+  std::string cord_value;
+  if (!message->SerializeToString(&cord_value)) {
+    // TODO: This does not seem reachable given that we just
+    // successfully parsed the std::string to a valid message.
+    std::string output_string(ToStringLiteral(v.string_view_value()));
+    output_string =
+        PrettyTruncateUTF8(output_string, MAX_LITERAL_DISPLAY_LENGTH);
+    return MakeEvalError() << "Invalid cast to type " << to_type->DebugString()
+                           << " from std::string: " << output_string;
+  }
+  return Value::Proto(to_type->AsProto(), cord_value);
+}
+
+static zetasql_base::StatusOr<Value> CastBytesToString(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  const absl::string_view utf8 = v.bytes_view_value();
+  // No escaping is needed since the bytes value is already unescaped.
+  if (!IsWellFormedUTF8(utf8)) {
+    return MakeEvalError() << "Invalid cast of bytes to UTF8 string";
+  }
+  return Value::String(utf8);
+}
+
+static zetasql_base::StatusOr<Value> CastBytesToProto(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  // Opaque proto support does not affect this implementation, which does
+  // no validation.
+  return Value::Proto(to_type->AsProto(), std::string(v.bytes_view_value()));
+}
+
+static zetasql_base::StatusOr<Value> CastDateToString(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  std::string date;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertDateToString(v.date_value(), &date));
+  return Value::String(date);
+}
+
+static zetasql_base::StatusOr<Value> CastEnumToString(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  return Value::String(v.enum_name());
+}
+
+static zetasql_base::StatusOr<Value> CastEnumToInt32(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  return Value::Int32(v.enum_value());
+}
+
+template <typename ToType>
+static zetasql_base::StatusOr<Value> CastEnumToNumeric(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  return NumericValueCast<int32_t, ToType>(v.enum_value());
+}
+
+static zetasql_base::StatusOr<Value> CastEnumToEnum(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  if (!v.type()->Equivalent(to_type)) {
+    return MakeSqlError() << "Invalid enum cast from "
+                          << v.type()->DebugString() << " to "
+                          << to_type->DebugString();
+  }
+  const Value to_value = Value::Enum(to_type->AsEnum(), v.enum_value());
+  if (!to_value.is_valid()) {
+    return MakeEvalError() << "Out of range enum value " << v.ToInt64()
+                           << " when converting enum type "
+                           << to_type->DebugString()
+                           << " to a different definition of the same enum";
+  }
+  return to_value;
+}
+
+static zetasql_base::StatusOr<Value> CastStringToTime(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  TimeValue time;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToTime(
+      v.string_view_value(), GetTimestampScale(language_options), &time));
+  return Value::Time(time);
+}
+
+static zetasql_base::StatusOr<Value> CastTimeToString(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  std::string result;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertTimeToString(
+      v.time_value(), GetTimestampScale(language_options), &result));
+  return Value::String(result);
+}
+
+static zetasql_base::StatusOr<Value> CastTimestampToTime(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  TimeValue time;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertTimestampToTime(
+      v.ToTime(), default_timezone, &time));
+  return Value::Time(time);
+}
+
+static zetasql_base::StatusOr<Value> CastStringToDatetime(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  DatetimeValue datetime;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToDatetime(
+      v.string_view_value(), GetTimestampScale(language_options), &datetime));
+  return Value::Datetime(datetime);
+}
+
+static zetasql_base::StatusOr<Value> CastDatetimeToString(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  std::string result;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertDatetimeToString(
+      v.datetime_value(), GetTimestampScale(language_options), &result));
+  return Value::String(result);
+}
+
+static zetasql_base::StatusOr<Value> CastDatetimeToTimestamp(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  absl::Time time;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertDatetimeToTimestamp(
+      v.datetime_value(), default_timezone, &time));
+  return Value::Timestamp(time);
+}
+
+static zetasql_base::StatusOr<Value> CastTimestampToDatetime(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  DatetimeValue datetime;
+  ZETASQL_RETURN_IF_ERROR(functions::ConvertTimestampToDatetime(
+      v.ToTime(), default_timezone, &datetime));
+  return Value::Datetime(datetime);
+}
+
+static zetasql_base::StatusOr<Value> CastDatetimeToDate(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  int32_t date;
+  ZETASQL_RETURN_IF_ERROR(functions::ExtractFromDatetime(
+      functions::DATE, v.datetime_value(), &date));
+  return Value::Date(date);
+}
+
+static zetasql_base::StatusOr<Value> CastDateToDatetime(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  DatetimeValue datetime;
+  ZETASQL_CHECK_OK(
+      functions::ConstructDatetime(v.date_value(), TimeValue(), &datetime));
+  return Value::Datetime(datetime);
+}
+
+static zetasql_base::StatusOr<Value> CastDatetimeToTime(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  TimeValue time;
+  ZETASQL_RETURN_IF_ERROR(
+      functions::ExtractTimeFromDatetime(v.datetime_value(), &time));
+  return Value::Time(time);
+}
+
+static zetasql_base::StatusOr<Value> CastStructToStruct(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  const StructType* v_type = v.type()->AsStruct();
+  std::vector<Value> casted_field_values(v_type->num_fields());
+  if (v_type->num_fields() != to_type->AsStruct()->num_fields()) {
+    return MakeSqlError() << "Unsupported cast from "
+                          << v.type()->DebugString() << " to "
+                          << to_type->DebugString();
+  }
+  for (int i = 0; i < v_type->num_fields(); ++i) {
+    ZETASQL_ASSIGN_OR_RETURN(
+        casted_field_values[i],
+        CastValue(v.field(i), default_timezone, language_options,
+                  to_type->AsStruct()->field(i).type));
+  }
+
+  return Value::Struct(to_type->AsStruct(), casted_field_values);
+}
+
+static zetasql_base::StatusOr<Value> CastProtoToString(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  if (v.type()->AsProto()->descriptor() == nullptr) {
+    // TODO: Cannot currently get here.  The implementation of
+    // opaque protos may affect this.
+    return MakeEvalError() << "Invalid cast from opaque proto type "
+                           << to_type->DebugString() << " to string";
+  }
+  google::protobuf::DynamicMessageFactory msg_factory;
+  std::unique_ptr<google::protobuf::Message> message(
+      msg_factory.GetPrototype(v.type()->AsProto()->descriptor())->New());
+  std::string message_string;
+  if (!message->ParsePartialFromString(v.ToCord())) {
+    std::string display_bytes = PrettyTruncateUTF8(
+        ToBytesLiteral(std::string(v.ToCord())), MAX_LITERAL_DISPLAY_LENGTH);
+    return MakeEvalError() << "Invalid cast to std::string from type "
+                           << v.type()->DebugString() << ": "
+                           << display_bytes;
+  }
+  zetasql_base::Status error;
+  std::string printed_msg;
+  functions::ProtoToString(message.get(), &printed_msg, &error);
+  ZETASQL_RETURN_IF_ERROR(error);
+  return Value::String(std::string(printed_msg));
+}
+
+static zetasql_base::StatusOr<Value> CastProtoToBytes(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  // Opaque proto support does not affect this implementation, which does
+  // no validation.
+  return Value::Bytes(v.ToCord());
+}
+
+static zetasql_base::StatusOr<Value> CastProtoToProto(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  if (!v.type()->Equivalent(to_type)) {
+    return MakeSqlError() << "Invalid proto cast from "
+                          << v.type()->DebugString() << " to "
+                          << to_type->DebugString();
+  }
+  // We don't currently do any validity checking on the serialized bytes.
+  return Value::Proto(to_type->AsProto(), v.ToCord());
+}
+
+static zetasql_base::StatusOr<Value> CastArrayToArray(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  SignatureMatchResult result;
+  TypeFactory type_factory;
+  Coercer coercer(&type_factory, default_timezone, &language_options);
+  if (!coercer.CoercesTo(InputArgumentType(v), to_type,
+                         true /* is_explicit */, &result)) {
+    return MakeSqlError() << "Unsupported cast from "
+                          << v.type()->DebugString() << " to "
+                          << to_type->DebugString();
+  }
+
+  const Type* to_element_type = to_type->AsArray()->element_type();
+  std::vector<Value> casted_elements(v.num_elements());
+  for (int i = 0; i < v.num_elements(); ++i) {
+    if (v.element(i).is_null()) {
+      casted_elements[i] = Value::Null(to_element_type);
+    } else {
+      ZETASQL_ASSIGN_OR_RETURN(casted_elements[i],
+                       CastValue(v.element(i), default_timezone,
+                                 language_options, to_element_type));
+    }
+  }
+  return InternalValue::ArrayChecked(to_type->AsArray(),
+                                     InternalValue::order_kind(v),
+                                     std::move(casted_elements));
+}
+
+// For each (input kind, output kind) pair, whether the cast is allowed
+// according to GetZetaSQLCasts(), and the kernel implementing it for
+// non-NULL values if there is one.
+struct CastKernelTable {
+  bool castable[TypeKind_ARRAYSIZE][TypeKind_ARRAYSIZE] = {};
+  CastKernel kernels[TypeKind_ARRAYSIZE][TypeKind_ARRAYSIZE] = {};
+};
+
+static const CastKernelTable* InitializeCastKernels() {
+  CastKernelTable* table = new CastKernelTable();
+  for (const auto& entry : GetZetaSQLCasts()) {
+    table->castable[entry.first.first][entry.first.second] = true;
+  }
+
+#define ADD_KERNEL(from_type, to_type, ...) \
+  table->kernels[TYPE_##from_type][TYPE_##to_type] = __VA_ARGS__;
+
+  // Numeric casts. Identity casts never reach a kernel.
+  ADD_KERNEL(INT32,   INT64,     NumericCast<int32_t, int64_t>);
+  ADD_KERNEL(INT32,   UINT32,    NumericCast<int32_t, uint32_t>);
+  ADD_KERNEL(INT32,   UINT64,    NumericCast<int32_t, uint64_t>);
+  ADD_KERNEL(INT32,   BOOL,      NumericCast<int32_t, bool>);
+  ADD_KERNEL(INT32,   FLOAT,     NumericCast<int32_t, float>);
+  ADD_KERNEL(INT32,   DOUBLE,    NumericCast<int32_t, double>);
+  ADD_KERNEL(INT32,   STRING,    NumericToString<int32_t>);
+  ADD_KERNEL(INT32,   NUMERIC,   NumericCast<int32_t, NumericValue>);
+
+  ADD_KERNEL(UINT32,  INT32,     NumericCast<uint32_t, int32_t>);
+  ADD_KERNEL(UINT32,  INT64,     NumericCast<uint32_t, int64_t>);
+  ADD_KERNEL(UINT32,  UINT64,    NumericCast<uint32_t, uint64_t>);
+  ADD_KERNEL(UINT32,  BOOL,      NumericCast<uint32_t, bool>);
+  ADD_KERNEL(UINT32,  FLOAT,     NumericCast<uint32_t, float>);
+  ADD_KERNEL(UINT32,  DOUBLE,    NumericCast<uint32_t, double>);
+  ADD_KERNEL(UINT32,  STRING,    NumericToString<uint32_t>);
+  ADD_KERNEL(UINT32,  NUMERIC,   NumericCast<uint32_t, NumericValue>);
+
+  ADD_KERNEL(INT64,   INT32,     NumericCast<int64_t, int32_t>);
+  ADD_KERNEL(INT64,   UINT32,    NumericCast<int64_t, uint32_t>);
+  ADD_KERNEL(INT64,   UINT64,    NumericCast<int64_t, uint64_t>);
+  ADD_KERNEL(INT64,   BOOL,      NumericCast<int64_t, bool>);
+  ADD_KERNEL(INT64,   FLOAT,     NumericCast<int64_t, float>);
+  ADD_KERNEL(INT64,   DOUBLE,    NumericCast<int64_t, double>);
+  ADD_KERNEL(INT64,   STRING,    NumericToString<int64_t>);
+  ADD_KERNEL(INT64,   NUMERIC,   NumericCast<int64_t, NumericValue>);
+
+  ADD_KERNEL(UINT64,  INT32,     NumericCast<uint64_t, int32_t>);
+  ADD_KERNEL(UINT64,  INT64,     NumericCast<uint64_t, int64_t>);
+  ADD_KERNEL(UINT64,  UINT32,    NumericCast<uint64_t, uint32_t>);
+  ADD_KERNEL(UINT64,  BOOL,      NumericCast<uint64_t, bool>);
+  ADD_KERNEL(UINT64,  FLOAT,     NumericCast<uint64_t, float>);
+  ADD_KERNEL(UINT64,  DOUBLE,    NumericCast<uint64_t, double>);
+  ADD_KERNEL(UINT64,  STRING,    NumericToString<uint64_t>);
+  ADD_KERNEL(UINT64,  NUMERIC,   NumericCast<uint64_t, NumericValue>);
+
+  ADD_KERNEL(BOOL,    INT32,     NumericCast<bool, int32_t>);
+  ADD_KERNEL(BOOL,    INT64,     NumericCast<bool, int64_t>);
+  ADD_KERNEL(BOOL,    UINT32,    NumericCast<bool, uint32_t>);
+  ADD_KERNEL(BOOL,    UINT64,    NumericCast<bool, uint64_t>);
+  ADD_KERNEL(BOOL,    STRING,    NumericToString<bool>);
+
+  ADD_KERNEL(FLOAT,   INT32,     NumericCast<float, int32_t>);
+  ADD_KERNEL(FLOAT,   INT64,     NumericCast<float, int64_t>);
+  ADD_KERNEL(FLOAT,   UINT32,    NumericCast<float, uint32_t>);
+  ADD_KERNEL(FLOAT,   UINT64,    NumericCast<float, uint64_t>);
+  ADD_KERNEL(FLOAT,   DOUBLE,    NumericCast<float, double>);
+  ADD_KERNEL(FLOAT,   STRING,    NumericToString<float>);
+  ADD_KERNEL(FLOAT,   NUMERIC,   NumericCast<float, NumericValue>);
+
+  ADD_KERNEL(DOUBLE,  INT32,     NumericCast<double, int32_t>);
+  ADD_KERNEL(DOUBLE,  INT64,     NumericCast<double, int64_t>);
+  ADD_KERNEL(DOUBLE,  UINT32,    NumericCast<double, uint32_t>);
+  ADD_KERNEL(DOUBLE,  UINT64,    NumericCast<double, uint64_t>);
+  ADD_KERNEL(DOUBLE,  FLOAT,     NumericCast<double, float>);
+  ADD_KERNEL(DOUBLE,  STRING,    NumericToString<double>);
+  ADD_KERNEL(DOUBLE,  NUMERIC,   NumericCast<double, NumericValue>);
+
+  ADD_KERNEL(NUMERIC, INT32,     NumericCast<NumericValue, int32_t>);
+  ADD_KERNEL(NUMERIC, INT64,     NumericCast<NumericValue, int64_t>);
+  ADD_KERNEL(NUMERIC, UINT32,    NumericCast<NumericValue, uint32_t>);
+  ADD_KERNEL(NUMERIC, UINT64,    NumericCast<NumericValue, uint64_t>);
+  ADD_KERNEL(NUMERIC, FLOAT,     NumericCast<NumericValue, float>);
+  ADD_KERNEL(NUMERIC, DOUBLE,    NumericCast<NumericValue, double>);
+  ADD_KERNEL(NUMERIC, STRING,    NumericToString<NumericValue>);
+
+  ADD_KERNEL(INT32,   ENUM,      CastIntegerToEnum);
+  ADD_KERNEL(INT64,   ENUM,      CastIntegerToEnum);
+  ADD_KERNEL(UINT32,  ENUM,      CastIntegerToEnum);
+  ADD_KERNEL(UINT64,  ENUM,      CastUint64ToEnum);
+
+  ADD_KERNEL(STRING,  BOOL,      StringToNumeric<bool>);
+  ADD_KERNEL(STRING,  INT32,     StringToNumeric<int32_t>);
+  ADD_KERNEL(STRING,  INT64,     StringToNumeric<int64_t>);
+  ADD_KERNEL(STRING,  UINT32,    StringToNumeric<uint32_t>);
+  ADD_KERNEL(STRING,  UINT64,    StringToNumeric<uint64_t>);
+  ADD_KERNEL(STRING,  FLOAT,     StringToNumeric<float>);
+  ADD_KERNEL(STRING,  DOUBLE,    StringToNumeric<double>);
+  ADD_KERNEL(STRING,  NUMERIC,   StringToNumeric<NumericValue>);
+  ADD_KERNEL(STRING,  ENUM,      CastStringToEnum);
+  ADD_KERNEL(STRING,  DATE,      CastStringToDate);
+  ADD_KERNEL(STRING,  TIMESTAMP, CastStringToTimestamp);
+  ADD_KERNEL(STRING,  BYTES,     CastStringToBytes);
+  ADD_KERNEL(STRING,  PROTO,     CastStringToProto);
+  ADD_KERNEL(STRING,  TIME,      CastStringToTime);
+  ADD_KERNEL(STRING,  DATETIME,  CastStringToDatetime);
+
+  ADD_KERNEL(BYTES,   STRING,    CastBytesToString);
+  ADD_KERNEL(BYTES,   PROTO,     CastBytesToProto);
+
+  ADD_KERNEL(DATE,    STRING,    CastDateToString);
+  ADD_KERNEL(DATE,    TIMESTAMP, CastDateToTimestamp);
+  ADD_KERNEL(DATE,    DATETIME,  CastDateToDatetime);
+
+  ADD_KERNEL(TIMESTAMP, STRING,   CastTimestampToString);
+  ADD_KERNEL(TIMESTAMP, DATE,     CastTimestampToDate);
+  ADD_KERNEL(TIMESTAMP, TIME,     CastTimestampToTime);
+  ADD_KERNEL(TIMESTAMP, DATETIME, CastTimestampToDatetime);
+
+  ADD_KERNEL(TIME,    STRING,    CastTimeToString);
+
+  ADD_KERNEL(DATETIME, STRING,    CastDatetimeToString);
+  ADD_KERNEL(DATETIME, TIMESTAMP, CastDatetimeToTimestamp);
+  ADD_KERNEL(DATETIME, DATE,      CastDatetimeToDate);
+  ADD_KERNEL(DATETIME, TIME,      CastDatetimeToTime);
+
+  ADD_KERNEL(ENUM,    STRING,    CastEnumToString);
+  ADD_KERNEL(ENUM,    INT32,     CastEnumToInt32);
+  ADD_KERNEL(ENUM,    INT64,     CastEnumToNumeric<int64_t>);
+  ADD_KERNEL(ENUM,    UINT32,    CastEnumToNumeric<uint32_t>);
+  ADD_KERNEL(ENUM,    UINT64,    CastEnumToNumeric<uint64_t>);
+  ADD_KERNEL(ENUM,    ENUM,      CastEnumToEnum);
+
+  ADD_KERNEL(PROTO,   STRING,    CastProtoToString);
+  ADD_KERNEL(PROTO,   BYTES,     CastProtoToBytes);
+  ADD_KERNEL(PROTO,   PROTO,     CastProtoToProto);
+
+  ADD_KERNEL(STRUCT,  STRUCT,    CastStructToStruct);
+  ADD_KERNEL(ARRAY,   ARRAY,     CastArrayToArray);
+
+  // TODO: implement missing casts.
+
+#undef ADD_KERNEL
+
+  return table;
+}
+
+// Returns the kernel casting non-NULL values from <from_kind> to <to_kind>,
+// which is NULL if that cast is not implemented. Sets <castable> to whether
+// the cast is allowed at all.
+static CastKernel LookupCastKernel(TypeKind from_kind, TypeKind to_kind,
+                                   bool* castable) {
+  static const CastKernelTable* table = InitializeCastKernels();
+  if (from_kind < 0 || from_kind >= TypeKind_ARRAYSIZE || to_kind < 0 ||
+      to_kind >= TypeKind_ARRAYSIZE) {
+    *castable = false;
+    return nullptr;
+  }
+  *castable = table->castable[from_kind][to_kind];
+  return table->kernels[from_kind][to_kind];
+}
+
+static zetasql_base::Status MakeUnsupportedCastError(const Type* from_type,
+                                             const Type* to_type) {
+  return MakeSqlError() << "Unsupported cast from " << from_type->DebugString()
+                        << " to " << to_type->DebugString();
+}
+
+static zetasql_base::Status MakeUnimplementedCastError(const Type* from_type,
+                                               const Type* to_type) {
+  return ::zetasql_base::UnimplementedErrorBuilder(ZETASQL_LOC)
+         << "Unimplemented cast from " << from_type->DebugString() << " to "
+         << to_type->DebugString();
+}
+
+// Returns OK if a NULL of <from_type> can be cast to <to_type>, given that
+// the type kinds are castable and the types are not equal.
+static zetasql_base::Status CheckNullCast(const Type* from_type, const Type* to_type,
+                                  absl::TimeZone default_timezone,
+                                  const LanguageOptions& language_options) {
+  if (!from_type->IsSimpleType() && from_type->kind() == to_type->kind()) {
+    // This is a cast of a complex type to a complex type with the same
+    // kind.  Type kind checks are not enough to verify that the cast
+    // between types is valid (i.e., array to array or struct to struct),
+    // so perform a literal coercion check to see if the complex types
+    // are compatible and therefore a NULL value can cast from one to
+    // the other.
+    SignatureMatchResult result;
+    TypeFactory type_factory;
+    Coercer coercer(&type_factory, default_timezone, &language_options);
+    if (!coercer.CoercesTo(InputArgumentType(Value::Null(from_type)), to_type,
+                           true /* is_explicit */, &result)) {
+      return MakeUnsupportedCastError(from_type, to_type);
+    }
+  }
+  return ::zetasql_base::OkStatus();
+}
+
 zetasql_base::StatusOr<Value> CastValue(const Value& from_value,
                                 absl::TimeZone default_timezone,
                                 const LanguageOptions& language_options,
@@ -371,449 +961,135 @@ zetasql_base::StatusOr<Value> CastValue(const Value& from_value,
     return v;
   }
   // Check to see if the type kinds are castable.
-  if (!zetasql_base::ContainsKey(GetZetaSQLCasts(),
-                        TypeKindPair(v.type_kind(), to_type->kind()))) {
-    return MakeSqlError() << "Unsupported cast from " << v.type()->DebugString()
-                          << " to " << to_type->DebugString();
+  bool castable;
+  const CastKernel kernel =
+      LookupCastKernel(v.type_kind(), to_type->kind(), &castable);
+  if (!castable) {
+    return MakeUnsupportedCastError(v.type(), to_type);
   }
 
   //  NULL handling for Values occurs here.
   if (v.is_null()) {
-    if (!v.type()->IsSimpleType() && v.type_kind() == to_type->kind()) {
-      // This is a cast of a complex type to a complex type with the same
-      // kind.  Type kind checks are not enough to verify that the cast
-      // between types is valid (i.e., array to array or struct to struct),
-      // so perform a literal coercion check to see if the complex types
-      // are compatible and therefore a NULL value can cast from one to
-      // the other.
-      SignatureMatchResult result;
-      TypeFactory type_factory;
-      Coercer coercer(&type_factory, default_timezone, &language_options);
-      if (!coercer.CoercesTo(InputArgumentType(v), to_type,
-                             true /* is_explicit */, &result)) {
-        return MakeSqlError() << "Unsupported cast from "
-                              << v.type()->DebugString() << " to "
-                              << to_type->DebugString();
-      }
-    }
+    ZETASQL_RETURN_IF_ERROR(
+        CheckNullCast(v.type(), to_type, default_timezone, language_options));
     // We have already validated that this is a valid cast for NULL values,
     // so just return a NULL value of <to_type>.
     return Value::Null(to_type);
   }
 
-  // TODO: Consider breaking this up, as the switch is extremely
-  // large.
-  switch (FCT(v.type()->kind(), to_type->kind())) {
-    // Numeric casts. Identity casts are handled above.
-    case FCT(TYPE_INT32, TYPE_INT64): return NumericCast<int32_t, int64_t>(v);
-    case FCT(TYPE_INT32, TYPE_UINT32): return NumericCast<int32_t, uint32_t>(v);
-    case FCT(TYPE_INT32, TYPE_UINT64): return NumericCast<int32_t, uint64_t>(v);
-    case FCT(TYPE_INT32, TYPE_BOOL): return NumericCast<int32_t, bool>(v);
-    case FCT(TYPE_INT32, TYPE_FLOAT): return NumericCast<int32_t, float>(v);
-    case FCT(TYPE_INT32, TYPE_DOUBLE): return NumericCast<int32_t, double>(v);
-    case FCT(TYPE_INT32, TYPE_STRING): return NumericToString<int32_t>(v);
-    case FCT(TYPE_INT32, TYPE_NUMERIC):
-      return NumericCast<int32_t, NumericValue>(v);
-
-    case FCT(TYPE_UINT32, TYPE_INT32): return NumericCast<uint32_t, int32_t>(v);
-    case FCT(TYPE_UINT32, TYPE_INT64): return NumericCast<uint32_t, int64_t>(v);
-    case FCT(TYPE_UINT32, TYPE_UINT64): return NumericCast<uint32_t, uint64_t>(v);
-    case FCT(TYPE_UINT32, TYPE_BOOL): return NumericCast<uint32_t, bool>(v);
-    case FCT(TYPE_UINT32, TYPE_FLOAT): return NumericCast<uint32_t, float>(v);
-    case FCT(TYPE_UINT32, TYPE_DOUBLE): return NumericCast<uint32_t, double>(v);
-    case FCT(TYPE_UINT32, TYPE_STRING): return NumericToString<uint32_t>(v);
-    case FCT(TYPE_UINT32, TYPE_NUMERIC):
-      return NumericCast<uint32_t, NumericValue>(v);
-
-    case FCT(TYPE_INT64, TYPE_INT32): return NumericCast<int64_t, int32_t>(v);
-    case FCT(TYPE_INT64, TYPE_UINT32): return NumericCast<int64_t, uint32_t>(v);
-    case FCT(TYPE_INT64, TYPE_UINT64): return NumericCast<int64_t, uint64_t>(v);
-    case FCT(TYPE_INT64, TYPE_BOOL): return NumericCast<int64_t, bool>(v);
-    case FCT(TYPE_INT64, TYPE_FLOAT): return NumericCast<int64_t, float>(v);
-    case FCT(TYPE_INT64, TYPE_DOUBLE): return NumericCast<int64_t, double>(v);
-    case FCT(TYPE_INT64, TYPE_STRING): return NumericToString<int64_t>(v);
-    case FCT(TYPE_INT64, TYPE_NUMERIC):
-      return NumericCast<int64_t, NumericValue>(v);
-
-    case FCT(TYPE_UINT64, TYPE_INT32): return NumericCast<uint64_t, int32_t>(v);
-    case FCT(TYPE_UINT64, TYPE_INT64): return NumericCast<uint64_t, int64_t>(v);
-    case FCT(TYPE_UINT64, TYPE_UINT32): return NumericCast<uint64_t, uint32_t>(v);
-    case FCT(TYPE_UINT64, TYPE_BOOL): return NumericCast<uint64_t, bool>(v);
-    case FCT(TYPE_UINT64, TYPE_FLOAT): return NumericCast<uint64_t, float>(v);
-    case FCT(TYPE_UINT64, TYPE_DOUBLE): return NumericCast<uint64_t, double>(v);
-    case FCT(TYPE_UINT64, TYPE_STRING): return NumericToString<uint64_t>(v);
-    case FCT(TYPE_UINT64, TYPE_NUMERIC):
-      return NumericCast<uint64_t, NumericValue>(v);
-
-    case FCT(TYPE_BOOL, TYPE_INT32): return NumericCast<bool, int32_t>(v);
-    case FCT(TYPE_BOOL, TYPE_INT64): return NumericCast<bool, int64_t>(v);
-    case FCT(TYPE_BOOL, TYPE_UINT32): return NumericCast<bool, uint32_t>(v);
-    case FCT(TYPE_BOOL, TYPE_UINT64): return NumericCast<bool, uint64_t>(v);
-    case FCT(TYPE_BOOL, TYPE_STRING): return NumericToString<bool>(v);
-
-    case FCT(TYPE_FLOAT, TYPE_INT32): return NumericCast<float, int32_t>(v);
-    case FCT(TYPE_FLOAT, TYPE_INT64): return NumericCast<float, int64_t>(v);
-    case FCT(TYPE_FLOAT, TYPE_UINT32): return NumericCast<float, uint32_t>(v);
-    case FCT(TYPE_FLOAT, TYPE_UINT64): return NumericCast<float, uint64_t>(v);
-    case FCT(TYPE_FLOAT, TYPE_DOUBLE): return NumericCast<float, double>(v);
-    case FCT(TYPE_FLOAT, TYPE_STRING): return NumericToString<float>(v);
-    case FCT(TYPE_FLOAT, TYPE_NUMERIC):
-      return NumericCast<float, NumericValue>(v);
-
-    case FCT(TYPE_DOUBLE, TYPE_INT32): return NumericCast<double, int32_t>(v);
-    case FCT(TYPE_DOUBLE, TYPE_INT64): return NumericCast<double, int64_t>(v);
-    case FCT(TYPE_DOUBLE, TYPE_UINT32): return NumericCast<double, uint32_t>(v);
-    case FCT(TYPE_DOUBLE, TYPE_UINT64): return NumericCast<double, uint64_t>(v);
-    case FCT(TYPE_DOUBLE, TYPE_FLOAT): return NumericCast<double, float>(v);
-    case FCT(TYPE_DOUBLE, TYPE_STRING): return NumericToString<double>(v);
-    case FCT(TYPE_DOUBLE, TYPE_NUMERIC):
-      return NumericCast<double, NumericValue>(v);
-
-    case FCT(TYPE_INT32, TYPE_ENUM):
-    case FCT(TYPE_INT64, TYPE_ENUM):
-    case FCT(TYPE_UINT32, TYPE_ENUM): {
-      const Value to_value = Value::Enum(to_type->AsEnum(), v.ToInt64());
-      if (!to_value.is_valid()) {
-        return MakeEvalError() << "Out of range cast of integer " << v.ToInt64()
-                               << " to enum type " << to_type->DebugString();
-      }
-      return to_value;
-    }
-    case FCT(TYPE_UINT64, TYPE_ENUM): {
-      // Static cast may turn out-of-bound uint64_t's to negative int64_t's which
-      // will yield invalid enums.
-      const Value to_value = Value::Enum(
-          to_type->AsEnum(), static_cast<int64_t>(v.uint64_value()));
-      if (!to_value.is_valid()) {
-        return MakeEvalError() << "Out of range cast of integer "
-                               << v.uint64_value() << " to enum type "
-                               << to_type->DebugString();
-      }
-      return to_value;
-    }
-
-    case FCT(TYPE_STRING, TYPE_BOOL): return StringToNumeric<bool>(v);
-    case FCT(TYPE_STRING, TYPE_INT32): return StringToNumeric<int32_t>(v);
-    case FCT(TYPE_STRING, TYPE_INT64): return StringToNumeric<int64_t>(v);
-    case FCT(TYPE_STRING, TYPE_UINT32): return StringToNumeric<uint32_t>(v);
-    case FCT(TYPE_STRING, TYPE_UINT64): return StringToNumeric<uint64_t>(v);
-    case FCT(TYPE_STRING, TYPE_FLOAT): return StringToNumeric<float>(v);
-    case FCT(TYPE_STRING, TYPE_DOUBLE): return StringToNumeric<double>(v);
-    case FCT(TYPE_STRING, TYPE_NUMERIC):
-      return StringToNumeric<NumericValue>(v);
-
-    case FCT(TYPE_STRING, TYPE_ENUM): {
-      const Value to_value = Value::Enum(to_type->AsEnum(), v.string_value());
-      if (!to_value.is_valid()) {
-        return MakeEvalError() << "Out of range cast of std::string '"
-                               << v.string_value() << "' to enum type "
-                               << to_type->DebugString();
-      }
-      return to_value;
-    }
-
-    case FCT(TYPE_STRING, TYPE_DATE): {
-      int32_t date;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToDate(v.string_value(), &date));
-      return Value::Date(date);
-    }
-    case FCT(TYPE_STRING, TYPE_TIMESTAMP): {
-      // TODO: These should be using the non-deprecated signature
-      // that includes an argument to indicate if a timezone is allowed in
-      // the std::string or not.  If not allowed and there is a timezone then
-      // an error should be provided.
-      if (language_options.LanguageFeatureEnabled(FEATURE_TIMESTAMP_NANOS)) {
-        absl::Time timestamp;
-        ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToTimestamp(
-            v.string_value(), default_timezone, functions::kNanoseconds,
-            true /* allow_tz_in_str */, &timestamp));
-        return Value::Timestamp(timestamp);
-      } else {
-        int64_t timestamp;
-        ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToTimestamp(
-            v.string_value(), default_timezone, functions::kMicroseconds,
-            &timestamp));
-        return Value::TimestampFromUnixMicros(timestamp);
-      }
-    }
-    case FCT(TYPE_TIMESTAMP, TYPE_STRING): {
-      std::string timestamp;
-      if (language_options.LanguageFeatureEnabled(FEATURE_TIMESTAMP_NANOS)) {
-        ZETASQL_RETURN_IF_ERROR(functions::ConvertTimestampToString(
-            v.ToTime(), functions::kNanoseconds, default_timezone, &timestamp));
-      } else {
-        ZETASQL_RETURN_IF_ERROR(functions::ConvertTimestampToStringWithTruncation(
-            v.ToUnixMicros(), functions::kMicroseconds, default_timezone,
-            &timestamp));
-      }
-      return Value::String(timestamp);
-    }
-    case FCT(TYPE_DATE, TYPE_TIMESTAMP): {
-      int64_t timestamp;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertDateToTimestamp(
-          v.date_value(), functions::kMicroseconds, default_timezone,
-          &timestamp));
-      return Value::TimestampFromUnixMicros(timestamp);
-    }
-    case FCT(TYPE_TIMESTAMP, TYPE_DATE): {
-      int32_t date;
-      ZETASQL_RETURN_IF_ERROR(ExtractFromTimestamp(
-          functions::DateTimestampPart::DATE, v.ToUnixMicros(),
-          functions::kMicroseconds, default_timezone, &date));
-      return Value::Date(date);
-    }
-    case FCT(TYPE_STRING, TYPE_BYTES):
-      return Value::Bytes(v.string_value());
-
-    case FCT(TYPE_STRING, TYPE_PROTO): {
-      if (to_type->AsProto()->descriptor() == nullptr) {
-        // TODO: Cannot currently get here, since a ProtoType
-        // requires a non-nullptr descriptor.  This may change when we
-        // implement  opaque protos.  Additionally, opaque protos may affect
-        // the ability to successfully parse or serialize the proto (note
-        // also that a fully-defined proto might have a descendant field
-        // that is an opaque proto).
-        return MakeEvalError()
-               << "Invalid cast from std::string to opaque proto type "
-               << to_type->DebugString();
-      }
-      google::protobuf::DynamicMessageFactory msg_factory;
-      std::unique_ptr<google::protobuf::Message> message(
-          msg_factory.GetPrototype(to_type->AsProto()->descriptor())->New());
-      zetasql_base::Status error;
-      functions::StringToProto(v.string_value(), message.get(), &error);
-      ZETASQL_RETURN_IF_ERROR(error);
-      // TODO: SerializeToString returns false if not all required
-      // fields are present.  If we want to allow missing required fields
-      // We could use SerializePartialToString().
-      std::string cord_value;
-      if (!message->SerializeToString(&cord_value)) {
-        // TODO: This does not seem reachable given that we just
-        // successfully parsed the std::string to a valid message.
-        std::string output_string(ToStringLiteral(v.string_value()));
-        output_string =
-            PrettyTruncateUTF8(output_string, MAX_LITERAL_DISPLAY_LENGTH);
-        return MakeEvalError() << "Invalid cast to type "
-                               << to_type->DebugString()
-                               << " from std::string: " << output_string;
-      }
-      return Value::Proto(to_type->AsProto(), cord_value);
-    }
-
-    case FCT(TYPE_BYTES, TYPE_STRING): {
-      const std::string& utf8 = v.bytes_value();
-      // No escaping is needed since the bytes value is already unescaped.
-      if (!IsWellFormedUTF8(utf8)) {
-        return MakeEvalError() << "Invalid cast of bytes to UTF8 string";
-      }
-      return Value::String(utf8);
-    }
+  if (kernel == nullptr) {
+    return MakeUnimplementedCastError(v.type(), to_type);
+  }
+  return kernel(v, to_type, default_timezone, language_options);
+}
 
-    case FCT(TYPE_BYTES, TYPE_PROTO):
-      // Opaque proto support does not affect this implementation, which does
-      // no validation.
-      return Value::Proto(to_type->AsProto(), v.bytes_value());
-    case FCT(TYPE_DATE, TYPE_STRING): {
-      std::string date;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertDateToString(v.date_value(), &date));
-      return Value::String(date);
-    }
+static zetasql_base::StatusOr<Value> IdentityCast(
+    const Value& v, const Type* to_type, absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  return v;
+}
 
-    case FCT(TYPE_ENUM, TYPE_STRING):
-      return Value::String(v.enum_name());
-
-    case FCT(TYPE_ENUM, TYPE_INT32):
-      return Value::Int32(v.enum_value());
-    case FCT(TYPE_ENUM, TYPE_INT64):
-      return NumericValueCast<int32_t, int64_t>(v.enum_value());
-    case FCT(TYPE_ENUM, TYPE_UINT32):
-      return NumericValueCast<int32_t, uint32_t>(v.enum_value());
-    case FCT(TYPE_ENUM, TYPE_UINT64):
-      return NumericValueCast<int32_t, uint64_t>(v.enum_value());
-
-    case FCT(TYPE_ENUM, TYPE_ENUM): {
-      if (!v.type()->Equivalent(to_type)) {
-        return MakeSqlError() << "Invalid enum cast from "
-                              << v.type()->DebugString() << " to "
-                              << to_type->DebugString();
-      }
-      const Value to_value = Value::Enum(to_type->AsEnum(), v.enum_value());
-      if (!to_value.is_valid()) {
-        return MakeEvalError() << "Out of range enum value " << v.ToInt64()
-                               << " when converting enum type "
-                               << to_type->DebugString()
-                               << " to a different definition of the same enum";
-      }
-      return to_value;
-    }
+zetasql_base::StatusOr<PreparedCast> PreparedCast::Create(
+    const Type* from_type, const Type* to_type,
+    absl::TimeZone default_timezone,
+    const LanguageOptions& language_options) {
+  if (from_type->Equals(to_type)) {
+    return PreparedCast(from_type, to_type, default_timezone, language_options,
+                        IdentityCast);
+  }
+  bool castable;
+  const CastKernel kernel =
+      LookupCastKernel(from_type->kind(), to_type->kind(), &castable);
+  if (!castable) {
+    return MakeUnsupportedCastError(from_type, to_type);
+  }
+  if (kernel == nullptr) {
+    return MakeUnimplementedCastError(from_type, to_type);
+  }
+  ZETASQL_RETURN_IF_ERROR(
+      CheckNullCast(from_type, to_type, default_timezone, language_options));
+  return PreparedCast(from_type, to_type, default_timezone, language_options,
+                      kernel);
+}
 
-    case FCT(TYPE_STRING, TYPE_TIME): {
-      TimeValue time;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToTime(
-          v.string_value(), GetTimestampScale(language_options), &time));
-      return Value::Time(time);
-    }
-    case FCT(TYPE_TIME, TYPE_STRING): {
-      std::string result;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertTimeToString(
-          v.time_value(), GetTimestampScale(language_options), &result));
-      return Value::String(result);
-    }
-    case FCT(TYPE_TIMESTAMP, TYPE_TIME): {
-      TimeValue time;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertTimestampToTime(
-          v.ToTime(), default_timezone, &time));
-      return Value::Time(time);
-    }
+PreparedCast::PreparedCast(const Type* from_type, const Type* to_type,
+                           absl::TimeZone default_timezone,
+                           const LanguageOptions& language_options,
+                           Kernel kernel)
+    : from_type_(from_type),
+      to_type_(to_type),
+      default_timezone_(default_timezone),
+      language_options_(language_options),
+      kernel_(kernel),
+      null_value_(Value::Null(to_type)) {}
+
+zetasql_base::StatusOr<Value> PreparedCast::Cast(const Value& from_value) const {
+  DCHECK(from_value.is_valid());
+  DCHECK(from_value.type()->Equals(from_type_));
+  if (from_value.is_null()) {
+    return null_value_;
+  }
+  return kernel_(from_value, to_type_, default_timezone_, language_options_);
+}
 
-    case FCT(TYPE_STRING, TYPE_DATETIME): {
-      DatetimeValue datetime;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertStringToDatetime(
-          v.string_value(), GetTimestampScale(language_options), &datetime));
-      return Value::Datetime(datetime);
-    }
-    case FCT(TYPE_DATETIME, TYPE_STRING): {
-      std::string result;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertDatetimeToString(
-          v.datetime_value(), GetTimestampScale(language_options), &result));
-      return Value::String(result);
-    }
-    case FCT(TYPE_DATETIME, TYPE_TIMESTAMP): {
-      absl::Time time;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertDatetimeToTimestamp(
-          v.datetime_value(), default_timezone, &time));
-      return Value::Timestamp(time);
-    }
-    case FCT(TYPE_TIMESTAMP, TYPE_DATETIME): {
-      DatetimeValue datetime;
-      ZETASQL_RETURN_IF_ERROR(functions::ConvertTimestampToDatetime(
-          v.ToTime(), default_timezone, &datetime));
-      return Value::Datetime(datetime);
-    }
-    case FCT(TYPE_DATETIME, TYPE_DATE): {
-      int32_t date;
-      ZETASQL_RETURN_IF_ERROR(functions::ExtractFromDatetime(
-          functions::DATE, v.datetime_value(), &date));
-      return Value::Date(date);
-    }
-    case FCT(TYPE_DATE, TYPE_DATETIME): {
-      DatetimeValue datetime;
-      ZETASQL_CHECK_OK(
-          functions::ConstructDatetime(v.date_value(), TimeValue(), &datetime));
-      return Value::Datetime(datetime);
-    }
-    case FCT(TYPE_DATETIME, TYPE_TIME): {
-      TimeValue time;
-      ZETASQL_RETURN_IF_ERROR(
-          functions::ExtractTimeFromDatetime(v.datetime_value(), &time));
-      return Value::Time(time);
-    }
+zetasql_base::Status PreparedCast::AppendCast(const Value& from_value,
+                                      std::vector<Value>* to_values) const {
+  ZETASQL_ASSIGN_OR_RETURN(Value to_value, kernel_(from_value, to_type_,
+                                           default_timezone_,
+                                           language_options_));
+  to_values->push_back(std::move(to_value));
+  return ::zetasql_base::OkStatus();
+}
 
-    case FCT(TYPE_STRUCT, TYPE_STRUCT): {
-      const StructType* v_type = v.type()->AsStruct();
-      std::vector<Value> casted_field_values(v_type->num_fields());
-      if (v_type->num_fields() != to_type->AsStruct()->num_fields()) {
-        return MakeSqlError() << "Unsupported cast from "
-                              << v.type()->DebugString() << " to "
-                              << to_type->DebugString();
-      }
-      for (int i = 0; i < v_type->num_fields(); ++i) {
-        ZETASQL_ASSIGN_OR_RETURN(
-            casted_field_values[i],
-            CastValue(v.field(i), default_timezone, language_options,
-                      to_type->AsStruct()->field(i).type));
-      }
-
-      return Value::Struct(to_type->AsStruct(), casted_field_values);
+zetasql_base::Status PreparedCast::CastValues(absl::Span<const Value> from_values,
+                                      std::vector<Value>* to_values) const {
+  to_values->clear();
+  to_values->reserve(from_values.size());
+  for (const Value& from_value : from_values) {
+    DCHECK(from_value.type()->Equals(from_type_));
+    if (from_value.is_null()) {
+      to_values->push_back(null_value_);
+    } else {
+      ZETASQL_RETURN_IF_ERROR(AppendCast(from_value, to_values));
     }
+  }
+  return ::zetasql_base::OkStatus();
+}
 
-    case FCT(TYPE_PROTO, TYPE_STRING): {
-      if (v.type()->AsProto()->descriptor() == nullptr) {
-        // TODO: Cannot currently get here.  The implementation of
-        // opaque protos may affect this.
-        return MakeEvalError() << "Invalid cast from opaque proto type "
-                               << to_type->DebugString() << " to string";
-      }
-      google::protobuf::DynamicMessageFactory msg_factory;
-      std::unique_ptr<google::protobuf::Message> message(
-          msg_factory.GetPrototype(v.type()->AsProto()->descriptor())->New());
-      std::string message_string;
-      if (!message->ParsePartialFromString(v.ToCord())) {
-        std::string display_bytes = PrettyTruncateUTF8(
-            ToBytesLiteral(std::string(v.ToCord())), MAX_LITERAL_DISPLAY_LENGTH);
-        return MakeEvalError() << "Invalid cast to std::string from type "
-                               << v.type()->DebugString() << ": "
-                               << display_bytes;
-      }
-      zetasql_base::Status error;
-      std::string printed_msg;
-      functions::ProtoToString(message.get(), &printed_msg, &error);
-      ZETASQL_RETURN_IF_ERROR(error);
-      return Value::String(std::string(printed_msg));
-    }
+zetasql_base::Status PreparedCast::StartColumn(TypeKind column_kind,
+                                       int64_t num_values, int64_t num_nulls,
+                                       std::vector<Value>* to_values) const {
+  ZETASQL_RET_CHECK(from_type_->IsSimpleType()) << from_type_->DebugString();
+  ZETASQL_RET_CHECK_EQ(column_kind, from_type_->kind())
+      << "Column of " << Type::TypeKindToString(column_kind, PRODUCT_INTERNAL)
+      << " values cast as " << from_type_->DebugString();
+  ZETASQL_RET_CHECK(num_nulls == 0 || num_nulls == num_values)
+      << "Column has " << num_values << " values and " << num_nulls
+      << " NULL indicators";
+  to_values->clear();
+  to_values->reserve(num_values);
+  return ::zetasql_base::OkStatus();
+}
 
-    case FCT(TYPE_PROTO, TYPE_BYTES):
-      // Opaque proto support does not affect this implementation, which does
-      // no validation.
-      return Value::Bytes(v.ToCord());
-
-    case FCT(TYPE_PROTO, TYPE_PROTO):
-      if (!v.type()->Equivalent(to_type)) {
-        return MakeSqlError() << "Invalid proto cast from "
-                              << v.type()->DebugString() << " to "
-                              << to_type->DebugString();
-      }
-      // We don't currently do any validity checking on the serialized bytes.
-      return Value::Proto(to_type->AsProto(), v.ToCord());
-
-    case FCT(TYPE_ARRAY, TYPE_ARRAY): {
-      SignatureMatchResult result;
-      TypeFactory type_factory;
-      Coercer coercer(&type_factory, default_timezone, &language_options);
-      if (!coercer.CoercesTo(InputArgumentType(v), to_type,
-                             true /* is_explicit */, &result)) {
-        return MakeSqlError() << "Unsupported cast from "
-                              << v.type()->DebugString() << " to "
-                              << to_type->DebugString();
-      }
-
-      const Type* to_element_type = to_type->AsArray()->element_type();
-      std::vector<Value> casted_elements(v.num_elements());
-      for (int i = 0; i < v.num_elements(); ++i) {
-        if (v.element(i).is_null()) {
-          casted_elements[i] = Value::Null(to_element_type);
-        } else {
-          ZETASQL_ASSIGN_OR_RETURN(casted_elements[i],
-                           CastValue(v.element(i), default_timezone,
-                                     language_options, to_element_type));
-        }
-      }
-      return InternalValue::ArrayChecked(to_type->AsArray(),
-                                         InternalValue::order_kind(v),
-                                         std::move(casted_elements));
+zetasql_base::Status PreparedCast::CastColumn(
+    absl::Span<const absl::string_view> values, absl::Span<const bool> is_null,
+    std::vector<Value>* to_values) const {
+  ZETASQL_RET_CHECK(from_type_->kind() == TYPE_STRING ||
+            from_type_->kind() == TYPE_BYTES)
+      << from_type_->DebugString();
+  ZETASQL_RETURN_IF_ERROR(StartColumn(from_type_->kind(), values.size(),
+                              is_null.size(), to_values));
+  const bool is_string = from_type_->kind() == TYPE_STRING;
+  for (int64_t i = 0; i < values.size(); ++i) {
+    if (!is_null.empty() && is_null[i]) {
+      to_values->push_back(null_value_);
+    } else {
+      ZETASQL_RETURN_IF_ERROR(AppendCast(is_string ? Value::String(values[i])
+                                           : Value::Bytes(values[i]),
+                                 to_values));
     }
-
-    case FCT(TYPE_NUMERIC, TYPE_INT32):
-      return NumericCast<NumericValue, int32_t>(v);
-    case FCT(TYPE_NUMERIC, TYPE_INT64):
-      return NumericCast<NumericValue, int64_t>(v);
-    case FCT(TYPE_NUMERIC, TYPE_UINT32):
-      return NumericCast<NumericValue, uint32_t>(v);
-    case FCT(TYPE_NUMERIC, TYPE_UINT64):
-      return NumericCast<NumericValue, uint64_t>(v);
-    case FCT(TYPE_NUMERIC, TYPE_FLOAT):
-      return NumericCast<NumericValue, float>(v);
-    case FCT(TYPE_NUMERIC, TYPE_DOUBLE):
-      return NumericCast<NumericValue, double>(v);
-    case FCT(TYPE_NUMERIC, TYPE_STRING):
-      return NumericToString<NumericValue>(v);
-
-    // TODO: implement missing casts.
-    default:
-      return ::zetasql_base::UnimplementedErrorBuilder(ZETASQL_LOC)
-             << "Unimplemented cast from " << v.type()->DebugString() << " to "
-             << to_type->DebugString();
   }
+  return ::zetasql_base::OkStatus();
 }
 
 }  // namespace zetasql
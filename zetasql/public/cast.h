@@ -17,10 +17,17 @@
 #ifndef ZETASQL_PUBLIC_CAST_H_
 #define ZETASQL_PUBLIC_CAST_H_
 
+#include <cstdint>
+#include <vector>
+
+#include "zetasql/public/language_options.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "zetasql/base/status.h"
 #include "zetasql/base/statusor.h"
 
 // The full specification for ZetaSQL casting and coercion is at:
@@ -28,8 +35,6 @@
 
 namespace zetasql {
 
-class LanguageOptions;
-
 // Identifies the conditions where casting/coercion from type <A> to type <B>
 // is valid.  EXPLICIT means coercion can only be performed if explicitly
 // present in the SQL query, i.e. CAST(column AS INT32).
@@ -115,6 +120,106 @@ inline zetasql_base::StatusOr<Value> CastStatusOrValue(
   return CastValue(from_value, default_timezone, language_options, to_type);
 }
 
+// A cast from one Type to another, resolved once so that many values can be
+// cast without looking up the cast for each of them. Casting a value with a
+// PreparedCast gives the same result as calling CastValue() with the same
+// arguments.
+//
+// Example:
+//   ZETASQL_ASSIGN_OR_RETURN(PreparedCast cast,
+//                    PreparedCast::Create(types::Int64Type(),
+//                                         types::StringType(), timezone,
+//                                         language_options));
+//   std::vector<Value> strings;
+//   ZETASQL_RETURN_IF_ERROR(cast.CastValues(int64_values, &strings));
+//
+// The Types must outlive the PreparedCast. A PreparedCast is immutable and
+// thread-safe.
+class PreparedCast {
+ public:
+  // Returns an error if values of <from_type> cannot be cast to <to_type>,
+  // either because the cast is not allowed or because it is not implemented.
+  // A PreparedCast is only created for casts that CastValue() supports for
+  // both NULL and non-NULL values.
+  static zetasql_base::StatusOr<PreparedCast> Create(
+      const Type* from_type, const Type* to_type,
+      absl::TimeZone default_timezone,
+      const LanguageOptions& language_options);
+
+  const Type* from_type() const { return from_type_; }
+  const Type* to_type() const { return to_type_; }
+
+  // Returns <from_value> casted to to_type(). <from_value> must have type
+  // from_type().
+  zetasql_base::StatusOr<Value> Cast(const Value& from_value) const;
+
+  // Replaces the contents of <to_values> with the casts of <from_values>, in
+  // order. NULL inputs produce NULL outputs. Stops at the first value that
+  // cannot be cast and returns its error; <to_values> is then unspecified.
+  zetasql_base::Status CastValues(absl::Span<const Value> from_values,
+                          std::vector<Value>* to_values) const;
+
+  // Like CastValues(), but for a column of unboxed values. <T> is the C++ type
+  // of from_type(), as for Value::Make<T>() (int32_t, int64_t, uint32_t,
+  // uint64_t, bool, float, double or NumericValue); returns an internal error
+  // if <T> does not match from_type(). <is_null> is either empty, if the
+  // column has no NULLs, or has one entry per value; entries of <values> that
+  // are NULL are ignored.
+  template <typename T>
+  zetasql_base::Status CastColumn(absl::Span<const T> values,
+                          absl::Span<const bool> is_null,
+                          std::vector<Value>* to_values) const;
+
+  // Same as above, for a STRING or BYTES column.
+  zetasql_base::Status CastColumn(absl::Span<const absl::string_view> values,
+                          absl::Span<const bool> is_null,
+                          std::vector<Value>* to_values) const;
+
+ private:
+  // Casts a non-NULL value whose type has the same kind as from_type().
+  using Kernel = zetasql_base::StatusOr<Value> (*)(const Value&, const Type*,
+                                           absl::TimeZone,
+                                           const LanguageOptions&);
+
+  PreparedCast(const Type* from_type, const Type* to_type,
+               absl::TimeZone default_timezone,
+               const LanguageOptions& language_options, Kernel kernel);
+
+  // Checks that a column with values of <column_kind> can be cast, and its
+  // sizes, and prepares <to_values> for its casts.
+  zetasql_base::Status StartColumn(TypeKind column_kind, int64_t num_values,
+                           int64_t num_nulls,
+                           std::vector<Value>* to_values) const;
+
+  // Appends the cast of non-NULL <from_value> to <to_values>.
+  zetasql_base::Status AppendCast(const Value& from_value,
+                          std::vector<Value>* to_values) const;
+
+  const Type* from_type_;
+  const Type* to_type_;
+  absl::TimeZone default_timezone_;
+  LanguageOptions language_options_;
+  Kernel kernel_;
+  // The result of casting a NULL value.
+  Value null_value_;
+};
+
+template <typename T>
+zetasql_base::Status PreparedCast::CastColumn(absl::Span<const T> values,
+                                      absl::Span<const bool> is_null,
+                                      std::vector<Value>* to_values) const {
+  zetasql_base::Status status = StartColumn(Value::MakeNull<T>().type_kind(),
+                                   values.size(), is_null.size(), to_values);
+  for (int64_t i = 0; status.ok() && i < values.size(); ++i) {
+    if (!is_null.empty() && is_null[i]) {
+      to_values->push_back(null_value_);
+    } else {
+      status = AppendCast(Value::Make<T>(values[i]), to_values);
+    }
+  }
+  return status;
+}
+
 }  // namespace zetasql
 
 #endif  // ZETASQL_PUBLIC_CAST_H_
@@ -0,0 +1,337 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/cast.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/civil_time.h"
+#include "zetasql/public/language_options.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "zetasql/testdata/test_schema.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "zetasql/base/status.h"
+#include "zetasql/base/statusor.h"
+
+namespace zetasql {
+namespace {
+
+using ::zetasql_base::testing::StatusIs;
+
+// Checks that <actual> is the same result as <expected>: equal values, or
+// errors with the same code and message.
+void ExpectSameResult(const zetasql_base::StatusOr<Value>& expected,
+                      const zetasql_base::StatusOr<Value>& actual,
+                      const std::string& context) {
+  ASSERT_EQ(expected.ok(), actual.ok())
+      << context << ": " << expected.status() << " vs " << actual.status();
+  if (expected.ok()) {
+    EXPECT_TRUE(expected.ValueOrDie().Equals(actual.ValueOrDie()))
+        << context << ": " << expected.ValueOrDie().FullDebugString()
+        << " vs " << actual.ValueOrDie().FullDebugString();
+  } else {
+    EXPECT_EQ(expected.status(), actual.status()) << context;
+  }
+}
+
+// Checks that a column cast gives the casts of <from_values> in order, or the
+// first of their errors.
+void ExpectSameColumnResult(const std::vector<zetasql_base::StatusOr<Value>>& expected,
+                            const zetasql_base::Status& status,
+                            const std::vector<Value>& to_values,
+                            const std::string& context) {
+  for (int i = 0; i < expected.size(); ++i) {
+    if (!expected[i].ok()) {
+      EXPECT_EQ(expected[i].status(), status) << context;
+      return;
+    }
+  }
+  ZETASQL_ASSERT_OK(status) << context;
+  ASSERT_EQ(expected.size(), to_values.size()) << context;
+  for (int i = 0; i < expected.size(); ++i) {
+    ExpectSameResult(expected[i], to_values[i], context);
+  }
+}
+
+// Unboxes <values>, which have the type kind of <T>, and casts them with
+// CastColumn().
+template <typename T>
+zetasql_base::Status CastUnboxedColumn(const PreparedCast& cast,
+                               const std::vector<Value>& values,
+                               std::vector<Value>* to_values) {
+  // Not vectors, since std::vector<bool> cannot be viewed as a span.
+  std::unique_ptr<T[]> column(new T[values.size()]);
+  std::unique_ptr<bool[]> is_null(new bool[values.size()]);
+  for (int i = 0; i < values.size(); ++i) {
+    is_null[i] = values[i].is_null();
+    column[i] = values[i].is_null() ? T() : values[i].Get<T>();
+  }
+  return cast.CastColumn<T>(absl::MakeConstSpan(column.get(), values.size()),
+                            absl::MakeConstSpan(is_null.get(), values.size()),
+                            to_values);
+}
+
+zetasql_base::Status CastStringColumn(const PreparedCast& cast,
+                              const std::vector<Value>& values,
+                              std::vector<Value>* to_values) {
+  std::vector<absl::string_view> column;
+  std::unique_ptr<bool[]> is_null(new bool[values.size()]);
+  for (int i = 0; i < values.size(); ++i) {
+    is_null[i] = values[i].is_null();
+    if (values[i].is_null()) {
+      column.push_back(absl::string_view());
+    } else if (values[i].type_kind() == TYPE_STRING) {
+      column.push_back(values[i].string_view_value());
+    } else {
+      column.push_back(values[i].bytes_view_value());
+    }
+  }
+  return cast.CastColumn(column,
+                         absl::MakeConstSpan(is_null.get(), values.size()),
+                         to_values);
+}
+
+class PreparedCastTest : public ::testing::Test {
+ protected:
+  PreparedCastTest() {
+    language_options_.EnableMaximumLanguageFeatures();
+    ZETASQL_CHECK_OK(type_factory_.MakeEnumType(zetasql_test::TestEnum_descriptor(),
+                                        &enum_type_));
+    ZETASQL_CHECK_OK(type_factory_.MakeProtoType(
+        zetasql_test::KitchenSinkPB::descriptor(), &proto_type_));
+    ZETASQL_CHECK_OK(type_factory_.MakeStructType(
+        {{"a", types::Int64Type()}, {"b", types::StringType()}},
+        &struct_type_));
+    ZETASQL_CHECK_OK(type_factory_.MakeStructType(
+        {{"a", types::Int32Type()}, {"b", types::BytesType()}},
+        &other_struct_type_));
+
+    zetasql_test::KitchenSinkPB kitchen_sink;
+    kitchen_sink.set_int64_key_1(1);
+    kitchen_sink.set_int64_key_2(2);
+    std::string serialized;
+    kitchen_sink.SerializeToString(&serialized);
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    // Each column includes values that some casts reject.
+    columns_ = {
+        {Value::Int32(0), Value::Int32(1), Value::Int32(-1),
+         Value::Int32(std::numeric_limits<int32_t>::max()),
+         Value::NullInt32()},
+        {Value::Int64(2), Value::Int64(std::numeric_limits<int64_t>::max()),
+         Value::Int64(std::numeric_limits<int64_t>::min()),
+         Value::NullInt64()},
+        {Value::Uint32(1), Value::Uint32(std::numeric_limits<uint32_t>::max()),
+         Value::NullUint32()},
+        {Value::Uint64(0), Value::Uint64(std::numeric_limits<uint64_t>::max()),
+         Value::NullUint64()},
+        {Value::Bool(true), Value::Bool(false), Value::NullBool()},
+        {Value::Float(1.5f), Value::Float(-0.0f), Value::Float(1e20f),
+         Value::Float(std::numeric_limits<float>::quiet_NaN()),
+         Value::NullFloat()},
+        {Value::Double(2.5), Value::Double(1e300), Value::Double(inf),
+         Value::Double(nan), Value::NullDouble()},
+        {Value::Numeric(NumericValue(3)), Value::Numeric(NumericValue::MaxValue()),
+         Value::NullNumeric()},
+        {Value::String("1"), Value::String("true"), Value::String("abc"),
+         Value::String("1.5"), Value::String("2019-01-02"),
+         Value::String("2019-01-02 03:04:05"), Value::String("03:04:05"),
+         Value::String("TESTENUM1"), Value::String("int64_key_1: 1"),
+         Value::String("int64_key_1: 1 int64_key_2: 2"), Value::NullString()},
+        {Value::Bytes("abc"), Value::Bytes("\xff"), Value::Bytes(serialized),
+         Value::NullBytes()},
+        {Value::Date(0), Value::Date(17000), Value::NullDate()},
+        {Value::Timestamp(absl::FromUnixSeconds(0)),
+         Value::Timestamp(absl::FromUnixMicros(1546398245123456)),
+         Value::NullTimestamp()},
+        {Value::Time(TimeValue::FromHMSAndNanos(3, 4, 5, 6)),
+         Value::NullTime()},
+        {Value::Datetime(
+             DatetimeValue::FromYMDHMSAndNanos(2019, 1, 2, 3, 4, 5, 6)),
+         Value::NullDatetime()},
+        {Value::Enum(enum_type_, 1), Value::Enum(enum_type_, 2147483647),
+         Value::Null(enum_type_)},
+        {Value::Proto(proto_type_, serialized), Value::Null(proto_type_)},
+        {Value::Struct(struct_type_, {Value::Int64(1), Value::String("x")}),
+         Value::Struct(struct_type_,
+                       {Value::Int64(std::numeric_limits<int64_t>::max()),
+                        Value::NullString()}),
+         Value::Null(struct_type_)},
+        {Value::Array(types::Int64ArrayType(),
+                      {Value::Int64(1), Value::NullInt64()}),
+         Value::EmptyArray(types::Int64ArrayType()),
+         Value::Null(types::Int64ArrayType())},
+        {Value::Array(types::StringArrayType(), {Value::String("5")}),
+         Value::Array(types::StringArrayType(), {Value::String("x")}),
+         Value::Null(types::StringArrayType())},
+    };
+    for (const std::vector<Value>& column : columns_) {
+      types_.push_back(column[0].type());
+    }
+    types_.push_back(other_struct_type_);
+    types_.push_back(types::Int32ArrayType());
+  }
+
+  // Casts <values> with CastColumn() if they have an unboxed representation.
+  // Returns false if they do not.
+  bool CastColumn(const PreparedCast& cast, const std::vector<Value>& values,
+                  zetasql_base::Status* status, std::vector<Value>* to_values) {
+    switch (cast.from_type()->kind()) {
+      case TYPE_INT32:
+        *status = CastUnboxedColumn<int32_t>(cast, values, to_values);
+        return true;
+      case TYPE_INT64:
+        *status = CastUnboxedColumn<int64_t>(cast, values, to_values);
+        return true;
+      case TYPE_UINT32:
+        *status = CastUnboxedColumn<uint32_t>(cast, values, to_values);
+        return true;
+      case TYPE_UINT64:
+        *status = CastUnboxedColumn<uint64_t>(cast, values, to_values);
+        return true;
+      case TYPE_BOOL:
+        *status = CastUnboxedColumn<bool>(cast, values, to_values);
+        return true;
+      case TYPE_FLOAT:
+        *status = CastUnboxedColumn<float>(cast, values, to_values);
+        return true;
+      case TYPE_DOUBLE:
+        *status = CastUnboxedColumn<double>(cast, values, to_values);
+        return true;
+      case TYPE_NUMERIC:
+        *status = CastUnboxedColumn<NumericValue>(cast, values, to_values);
+        return true;
+      case TYPE_STRING:
+      case TYPE_BYTES:
+        *status = CastStringColumn(cast, values, to_values);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  const absl::TimeZone timezone_ = absl::UTCTimeZone();
+  LanguageOptions language_options_;
+  TypeFactory type_factory_;
+  const EnumType* enum_type_ = nullptr;
+  const ProtoType* proto_type_ = nullptr;
+  const StructType* struct_type_ = nullptr;
+  const StructType* other_struct_type_ = nullptr;
+  // One column of values per type, including NULLs.
+  std::vector<std::vector<Value>> columns_;
+  // All the types to cast to.
+  std::vector<const Type*> types_;
+};
+
+TEST_F(PreparedCastTest, MatchesCastValueForAllPairs) {
+  int num_prepared = 0;
+  for (const std::vector<Value>& column : columns_) {
+    const Type* from_type = column[0].type();
+    for (const Type* to_type : types_) {
+      const std::string context = absl::StrCat(
+          from_type->DebugString(), " to ", to_type->DebugString());
+      zetasql_base::StatusOr<PreparedCast> cast = PreparedCast::Create(
+          from_type, to_type, timezone_, language_options_);
+      if (!cast.ok()) {
+        // Casts that cannot be prepared fail for all non-NULL values.
+        for (const Value& value : column) {
+          if (value.is_null()) continue;
+          EXPECT_FALSE(
+              CastValue(value, timezone_, language_options_, to_type).ok())
+              << context << ": " << value.FullDebugString();
+        }
+        continue;
+      }
+      ++num_prepared;
+
+      std::vector<zetasql_base::StatusOr<Value>> expected;
+      for (const Value& value : column) {
+        expected.push_back(
+            CastValue(value, timezone_, language_options_, to_type));
+        ExpectSameResult(expected.back(), cast.ValueOrDie().Cast(value),
+                         absl::StrCat(context, ": ", value.FullDebugString()));
+      }
+
+      std::vector<Value> to_values;
+      const zetasql_base::Status status =
+          cast.ValueOrDie().CastValues(column, &to_values);
+      ExpectSameColumnResult(expected, status, to_values,
+                             absl::StrCat(context, " (CastValues)"));
+
+      zetasql_base::Status column_status;
+      to_values.clear();
+      if (CastColumn(cast.ValueOrDie(), column, &column_status, &to_values)) {
+        ExpectSameColumnResult(expected, column_status, to_values,
+                               absl::StrCat(context, " (CastColumn)"));
+      }
+    }
+  }
+  EXPECT_GT(num_prepared, 100);
+}
+
+TEST_F(PreparedCastTest, CreateFailsForUnsupportedCasts) {
+  EXPECT_THAT(PreparedCast::Create(types::Int64Type(), types::DateType(),
+                                   timezone_, language_options_),
+              StatusIs(zetasql_base::INVALID_ARGUMENT));
+  // The kinds can be cast, but not these struct types.
+  const StructType* three_fields;
+  ZETASQL_ASSERT_OK(type_factory_.MakeStructType({{"a", types::Int64Type()},
+                                          {"b", types::StringType()},
+                                          {"c", types::StringType()}},
+                                         &three_fields));
+  EXPECT_FALSE(PreparedCast::Create(struct_type_, three_fields, timezone_,
+                                    language_options_)
+                   .ok());
+}
+
+TEST_F(PreparedCastTest, CastColumnChecksTheColumnType) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      PreparedCast cast,
+      PreparedCast::Create(types::DateType(), types::StringType(), timezone_,
+                           language_options_));
+  // DATE values are int32_t, but Value::Make<int32_t>() makes INT32 values.
+  const int32_t dates[] = {0, 17000};
+  std::vector<Value> to_values;
+  EXPECT_THAT(cast.CastColumn<int32_t>(dates, {}, &to_values),
+              StatusIs(zetasql_base::INTERNAL));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      cast, PreparedCast::Create(types::Int64Type(), types::StringType(),
+                                 timezone_, language_options_));
+  const int32_t int32s[] = {1};
+  EXPECT_THAT(cast.CastColumn<int32_t>(int32s, {}, &to_values),
+              StatusIs(zetasql_base::INTERNAL));
+  const int64_t int64s[] = {1, 2};
+  const bool is_null[] = {false, true};
+  ZETASQL_ASSERT_OK(cast.CastColumn<int64_t>(int64s, is_null, &to_values));
+  EXPECT_THAT(to_values, ::testing::ElementsAre(Value::String("1"),
+                                                Value::NullString()));
+}
+
+}  // namespace
+}  // namespace zetasql
@@ -25,6 +25,7 @@
 #include "zetasql/public/evaluator_table_iterator.h"
 #include "zetasql/public/type.h"
 #include <cstdint>
+#include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "zetasql/base/source_location.h"
 #include "zetasql/base/status.h"
@@ -284,6 +285,16 @@ class Catalog {
       const absl::Span<const std::string>& mistyped_path);
   virtual std::string SuggestConstant(const absl::Span<const std::string>& mistyped_path);
 
+  // Returns a token that identifies the current contents of this Catalog, for
+  // use as part of the key of caches of analysis results (see AnalyzerCache).
+  // Two calls may return the same token only if every lookup through this
+  // Catalog would return the same objects. Returns absl::nullopt if the
+  // Catalog does not track its changes, which is the default; results
+  // analyzed against such a Catalog are never cached.
+  virtual absl::optional<uint64_t> GetVersionToken() const {
+    return absl::nullopt;
+  }
+
   // Returns whether or not this Catalog is a specific catalog interface or
   // implementation.
   template <class CatalogSubclass>
@@ -0,0 +1,1241 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/evaluator.h"
+
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <utility>
+
+#include "zetasql/base/logging.h"
+#include "zetasql/public/builtin_function.pb.h"
+#include "zetasql/public/cast.h"
+#include "zetasql/public/function.h"
+#include "zetasql/public/functions/arithmetics.h"
+#include "zetasql/public/functions/comparison.h"
+#include "zetasql/public/functions/date_time_util.h"
+#include "zetasql/public/functions/datetime.pb.h"
+#include "zetasql/public/simple_catalog.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_node_kind.pb.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "zetasql/base/canonical_errors.h"
+#include "zetasql/base/map_util.h"
+#include "zetasql/base/ret_check.h"
+#include "zetasql/base/status_macros.h"
+
+namespace zetasql {
+
+// ---------------------------- ValueColumn ----------------------------
+
+ValueColumn::Storage ValueColumn::StorageForTypeKind(TypeKind kind) {
+  switch (kind) {
+    case TYPE_INT32:
+    case TYPE_INT64:
+    case TYPE_DATE:
+    case TYPE_ENUM:
+      return Storage::kInt64;
+    case TYPE_UINT32:
+    case TYPE_UINT64:
+      return Storage::kUint64;
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+      return Storage::kDouble;
+    case TYPE_BOOL:
+      return Storage::kBool;
+    case TYPE_STRING:
+    case TYPE_BYTES:
+      return Storage::kString;
+    case TYPE_NUMERIC:
+      return Storage::kNumeric;
+    default:
+      return Storage::kValue;
+  }
+}
+
+ValueColumn::ValueColumn(const Type* type)
+    : type_(type), storage_(StorageForTypeKind(type->kind())) {}
+
+void ValueColumn::Resize(int size) {
+  const int old_size = size_;
+  size_ = size;
+  null_bits_.resize((size + 63) / 64, 0);
+  if (size > old_size) {
+    int row = old_size;
+    for (; row < size && (row & 63) != 0; ++row) SetNull(row, true);
+    for (; row + 64 <= size; row += 64) null_bits_[row >> 6] = ~uint64_t{0};
+    for (; row < size; ++row) SetNull(row, true);
+  } else if ((size & 63) != 0) {
+    // Keep the bits past size() zero.
+    null_bits_[size >> 6] &= (uint64_t{1} << (size & 63)) - 1;
+  }
+  switch (storage_) {
+    case Storage::kInt64:
+      int64_data_.resize(size);
+      break;
+    case Storage::kUint64:
+      uint64_data_.resize(size);
+      break;
+    case Storage::kDouble:
+      double_data_.resize(size);
+      break;
+    case Storage::kBool:
+      bool_data_.resize(size);
+      break;
+    case Storage::kString:
+      string_data_.resize(size);
+      break;
+    case Storage::kNumeric:
+      numeric_data_.resize(size);
+      break;
+    case Storage::kValue:
+      value_data_.resize(size);
+      break;
+  }
+}
+
+bool ValueColumn::HasNoNulls() const {
+  for (uint64_t word : null_bits_) {
+    if (word != 0) return false;
+  }
+  return true;
+}
+
+template <>
+const std::vector<int64_t>& ValueColumn::data<int64_t>() const {
+  DCHECK(storage_ == Storage::kInt64);
+  return int64_data_;
+}
+template <>
+const std::vector<uint64_t>& ValueColumn::data<uint64_t>() const {
+  DCHECK(storage_ == Storage::kUint64);
+  return uint64_data_;
+}
+template <>
+const std::vector<double>& ValueColumn::data<double>() const {
+  DCHECK(storage_ == Storage::kDouble);
+  return double_data_;
+}
+template <>
+const std::vector<uint8_t>& ValueColumn::data<uint8_t>() const {
+  DCHECK(storage_ == Storage::kBool);
+  return bool_data_;
+}
+template <>
+const std::vector<std::string>& ValueColumn::data<std::string>() const {
+  DCHECK(storage_ == Storage::kString);
+  return string_data_;
+}
+template <>
+const std::vector<NumericValue>& ValueColumn::data<NumericValue>() const {
+  DCHECK(storage_ == Storage::kNumeric);
+  return numeric_data_;
+}
+template <>
+const std::vector<Value>& ValueColumn::data<Value>() const {
+  DCHECK(storage_ == Storage::kValue);
+  return value_data_;
+}
+
+template <>
+std::vector<int64_t>* ValueColumn::mutable_data<int64_t>() {
+  DCHECK(storage_ == Storage::kInt64);
+  return &int64_data_;
+}
+template <>
+std::vector<uint64_t>* ValueColumn::mutable_data<uint64_t>() {
+  DCHECK(storage_ == Storage::kUint64);
+  return &uint64_data_;
+}
+template <>
+std::vector<double>* ValueColumn::mutable_data<double>() {
+  DCHECK(storage_ == Storage::kDouble);
+  return &double_data_;
+}
+template <>
+std::vector<uint8_t>* ValueColumn::mutable_data<uint8_t>() {
+  DCHECK(storage_ == Storage::kBool);
+  return &bool_data_;
+}
+template <>
+std::vector<std::string>* ValueColumn::mutable_data<std::string>() {
+  DCHECK(storage_ == Storage::kString);
+  return &string_data_;
+}
+template <>
+std::vector<NumericValue>* ValueColumn::mutable_data<NumericValue>() {
+  DCHECK(storage_ == Storage::kNumeric);
+  return &numeric_data_;
+}
+template <>
+std::vector<Value>* ValueColumn::mutable_data<Value>() {
+  DCHECK(storage_ == Storage::kValue);
+  return &value_data_;
+}
+
+Value ValueColumn::GetValue(int row) const {
+  DCHECK_LT(row, size_);
+  if (IsNull(row)) return Value::Null(type_);
+  switch (type_->kind()) {
+    case TYPE_INT32:
+      return Value::Int32(static_cast<int32_t>(int64_data_[row]));
+    case TYPE_INT64:
+      return Value::Int64(int64_data_[row]);
+    case TYPE_DATE:
+      return Value::Date(static_cast<int32_t>(int64_data_[row]));
+    case TYPE_ENUM:
+      return Value::Enum(type_->AsEnum(), int64_data_[row]);
+    case TYPE_UINT32:
+      return Value::Uint32(static_cast<uint32_t>(uint64_data_[row]));
+    case TYPE_UINT64:
+      return Value::Uint64(uint64_data_[row]);
+    case TYPE_FLOAT:
+      return Value::Float(static_cast<float>(double_data_[row]));
+    case TYPE_DOUBLE:
+      return Value::Double(double_data_[row]);
+    case TYPE_BOOL:
+      return Value::Bool(bool_data_[row] != 0);
+    case TYPE_STRING:
+      return Value::String(string_data_[row]);
+    case TYPE_BYTES:
+      return Value::Bytes(string_data_[row]);
+    case TYPE_NUMERIC:
+      return Value::Numeric(numeric_data_[row]);
+    default:
+      return value_data_[row];
+  }
+}
+
+zetasql_base::Status ValueColumn::SetValue(int row, const Value& value) {
+  ZETASQL_RET_CHECK_LT(row, size_);
+  if (!value.type()->Equals(type_)) {
+    return ::zetasql_base::InvalidArgumentError(absl::StrCat(
+        "Expected value of type ", type_->DebugString(), " but found ",
+        value.type()->DebugString()));
+  }
+  if (value.is_null()) {
+    SetNull(row, true);
+    return zetasql_base::OkStatus();
+  }
+  switch (type_->kind()) {
+    case TYPE_INT32:
+      int64_data_[row] = value.int32_value();
+      break;
+    case TYPE_INT64:
+      int64_data_[row] = value.int64_value();
+      break;
+    case TYPE_DATE:
+      int64_data_[row] = value.date_value();
+      break;
+    case TYPE_ENUM:
+      int64_data_[row] = value.enum_value();
+      break;
+    case TYPE_UINT32:
+      uint64_data_[row] = value.uint32_value();
+      break;
+    case TYPE_UINT64:
+      uint64_data_[row] = value.uint64_value();
+      break;
+    case TYPE_FLOAT:
+      double_data_[row] = value.float_value();
+      break;
+    case TYPE_DOUBLE:
+      double_data_[row] = value.double_value();
+      break;
+    case TYPE_BOOL:
+      bool_data_[row] = value.bool_value() ? 1 : 0;
+      break;
+    case TYPE_STRING:
+      string_data_[row] = std::string(value.string_view_value());
+      break;
+    case TYPE_BYTES:
+      string_data_[row] = std::string(value.bytes_view_value());
+      break;
+    case TYPE_NUMERIC:
+      numeric_data_[row] = value.numeric_value();
+      break;
+    default:
+      value_data_[row] = value;
+      break;
+  }
+  SetNull(row, false);
+  return zetasql_base::OkStatus();
+}
+
+zetasql_base::Status ValueColumn::Append(const Value& value) {
+  Resize(size_ + 1);
+  return SetValue(size_ - 1, value);
+}
+
+// ---------------------------- ColumnBatch ----------------------------
+
+zetasql_base::Status ColumnBatch::AddColumn(const std::string& name,
+                                    ValueColumn column) {
+  if (column.size() != num_rows_) {
+    return ::zetasql_base::InvalidArgumentError(
+        absl::StrCat("Column ", name, " has ", column.size(),
+                     " rows but the batch has ", num_rows_, " rows"));
+  }
+  if (!columns_.emplace(absl::AsciiStrToLower(name), std::move(column))
+           .second) {
+    return ::zetasql_base::InvalidArgumentError(
+        absl::StrCat("Duplicate column in batch: ", name));
+  }
+  return zetasql_base::OkStatus();
+}
+
+const ValueColumn* ColumnBatch::FindColumn(absl::string_view name) const {
+  return zetasql_base::FindOrNull(columns_, absl::AsciiStrToLower(name));
+}
+
+// --------------------------- Batch operators ---------------------------
+
+namespace internal {
+
+struct EvalContext {
+  const ColumnBatch* batch;
+  const ParameterValueMap* parameters;
+  const EvaluatorOptions* options;
+
+  int num_rows() const { return batch->num_rows(); }
+};
+
+// A compiled expression that is evaluated a whole batch at a time.
+class BatchExpr {
+ public:
+  explicit BatchExpr(const Type* output_type) : output_type_(output_type) {}
+  BatchExpr(const BatchExpr&) = delete;
+  BatchExpr& operator=(const BatchExpr&) = delete;
+  virtual ~BatchExpr() {}
+
+  const Type* output_type() const { return output_type_; }
+
+  // Evaluates the expression over all rows of <context.batch>. Sets <*result>
+  // either to <scratch> after filling it, or to a column that outlives
+  // <context>. <scratch> has type output_type().
+  virtual zetasql_base::Status Eval(const EvalContext& context, ValueColumn* scratch,
+                            const ValueColumn** result) const = 0;
+
+ private:
+  const Type* output_type_;
+};
+
+}  // namespace internal
+
+namespace {
+
+using internal::BatchExpr;
+using internal::EvalContext;
+
+// Sets all <num_rows> rows of <output> to <value>.
+zetasql_base::Status FillConstant(const Value& value, int num_rows,
+                          ValueColumn* output) {
+  output->Resize(num_rows);
+  if (value.is_null()) {
+    for (int row = 0; row < num_rows; ++row) output->SetNull(row, true);
+    return zetasql_base::OkStatus();
+  }
+  for (int row = 0; row < num_rows; ++row) {
+    ZETASQL_RETURN_IF_ERROR(output->SetValue(row, value));
+  }
+  return zetasql_base::OkStatus();
+}
+
+// Sets the null bitmap of <output> for a strict function of <inputs>: a row
+// is NULL iff it is NULL in any input. <output> must already have the right
+// size.
+void PropagateNulls(absl::Span<const ValueColumn* const> inputs,
+                    ValueColumn* output) {
+  std::vector<uint64_t>* out_bits = output->mutable_null_bits();
+  std::fill(out_bits->begin(), out_bits->end(), 0);
+  for (const ValueColumn* input : inputs) {
+    const std::vector<uint64_t>& in_bits = input->null_bits();
+    for (int i = 0; i < out_bits->size(); ++i) {
+      (*out_bits)[i] |= in_bits[i];
+    }
+  }
+}
+
+// Applies <fn> row by row to non-NULL rows of <a> and <b>. <fn> has the
+// signature of the functions in functions/arithmetics.h. If <fn> fails, the
+// row becomes NULL in SAFE mode, and otherwise the error is returned.
+template <typename In1, typename In2, typename Out, typename Fn>
+zetasql_base::Status EvalBinaryStrict(const ValueColumn& a, const ValueColumn& b,
+                              bool safe, Fn fn, ValueColumn* output) {
+  const int num_rows = a.size();
+  output->Resize(num_rows);
+  PropagateNulls({&a, &b}, output);
+  const In1* x = a.data<In1>().data();
+  const In2* y = b.data<In2>().data();
+  Out* z = output->mutable_data<Out>()->data();
+  zetasql_base::Status error;
+  for (int row = 0; row < num_rows; ++row) {
+    if (output->IsNull(row)) continue;
+    if (!fn(x[row], y[row], &z[row], &error)) {
+      if (!safe) return error;
+      output->SetNull(row, true);
+      error = zetasql_base::OkStatus();
+    }
+  }
+  return zetasql_base::OkStatus();
+}
+
+template <typename In, typename Out, typename Fn>
+zetasql_base::Status EvalUnaryStrict(const ValueColumn& a, bool safe, Fn fn,
+                             ValueColumn* output) {
+  const int num_rows = a.size();
+  output->Resize(num_rows);
+  PropagateNulls({&a}, output);
+  const In* x = a.data<In>().data();
+  Out* z = output->mutable_data<Out>()->data();
+  zetasql_base::Status error;
+  for (int row = 0; row < num_rows; ++row) {
+    if (output->IsNull(row)) continue;
+    if (!fn(x[row], &z[row], &error)) {
+      if (!safe) return error;
+      output->SetNull(row, true);
+      error = zetasql_base::OkStatus();
+    }
+  }
+  return zetasql_base::OkStatus();
+}
+
+enum class CompareOp {
+  kEqual,
+  kNotEqual,
+  kLess,
+  kLessOrEqual,
+  kGreater,
+  kGreaterOrEqual,
+};
+
+template <CompareOp op, typename T>
+inline bool CompareNative(const T& x, const T& y) {
+  switch (op) {
+    case CompareOp::kEqual:
+      return x == y;
+    case CompareOp::kNotEqual:
+      return x != y;
+    case CompareOp::kLess:
+      return x < y;
+    case CompareOp::kLessOrEqual:
+      return x <= y;
+    case CompareOp::kGreater:
+      return x > y;
+    case CompareOp::kGreaterOrEqual:
+      return x >= y;
+  }
+  return false;
+}
+
+template <CompareOp op>
+struct SameTypeComparer {
+  template <typename T>
+  bool operator()(const T& x, const T& y) const {
+    return CompareNative<op>(x, y);
+  }
+};
+
+template <CompareOp op>
+struct Int64Uint64Comparer {
+  bool operator()(int64_t x, uint64_t y) const {
+    return CompareNative<op>(functions::Compare64(x, y), int64_t{0});
+  }
+};
+
+template <CompareOp op>
+struct Uint64Int64Comparer {
+  bool operator()(uint64_t x, int64_t y) const {
+    return CompareNative<op>(int64_t{0}, functions::Compare64(y, x));
+  }
+};
+
+// Comparisons cannot fail, so they are computed for every row without
+// branching on nullness; the values in NULL slots are valid but unspecified,
+// and the result is masked by the null bitmap.
+template <typename In1, typename In2, typename Cmp>
+void EvalCompare(const ValueColumn& a, const ValueColumn& b, Cmp cmp,
+                 ValueColumn* output) {
+  const int num_rows = a.size();
+  output->Resize(num_rows);
+  PropagateNulls({&a, &b}, output);
+  const In1* x = a.data<In1>().data();
+  const In2* y = b.data<In2>().data();
+  uint8_t* z = output->mutable_data<uint8_t>()->data();
+  for (int row = 0; row < num_rows; ++row) {
+    z[row] = cmp(x[row], y[row]) ? 1 : 0;
+  }
+}
+
+// Evaluates a literal or a query parameter, which is constant for the batch.
+class ConstantExpr final : public BatchExpr {
+ public:
+  explicit ConstantExpr(const Value& value)
+      : BatchExpr(value.type()), value_(value) {}
+
+  zetasql_base::Status Eval(const EvalContext& context, ValueColumn* scratch,
+                    const ValueColumn** result) const override {
+    ZETASQL_RETURN_IF_ERROR(FillConstant(value_, context.num_rows(), scratch));
+    *result = scratch;
+    return zetasql_base::OkStatus();
+  }
+
+ private:
+  const Value value_;
+};
+
+class ParameterExpr final : public BatchExpr {
+ public:
+  ParameterExpr(const std::string& name, const Type* type)
+      : BatchExpr(type), name_(name) {}
+
+  zetasql_base::Status Eval(const EvalContext& context, ValueColumn* scratch,
+                    const ValueColumn** result) const override {
+    const Value* value = zetasql_base::FindOrNull(*context.parameters, name_);
+    if (value == nullptr) {
+      return ::zetasql_base::InvalidArgumentError(
+          absl::StrCat("Incomplete query parameters: ", name_));
+    }
+    if (!value->type()->Equals(output_type())) {
+      return ::zetasql_base::InvalidArgumentError(absl::StrCat(
+          "Expected query parameter '", name_, "' to be of type ",
+          output_type()->DebugString(), " but found ",
+          value->type()->DebugString()));
+    }
+    ZETASQL_RETURN_IF_ERROR(FillConstant(*value, context.num_rows(), scratch));
+    *result = scratch;
+    return zetasql_base::OkStatus();
+  }
+
+ private:
+  const std::string name_;
+};
+
+// Evaluates an expression column. The input column is returned directly
+// without copying.
+class ColumnRefExpr final : public BatchExpr {
+ public:
+  ColumnRefExpr(const std::string& name, const Type* type)
+      : BatchExpr(type), name_(name) {}
+
+  zetasql_base::Status Eval(const EvalContext& context, ValueColumn* scratch,
+                    const ValueColumn** result) const override {
+    const ValueColumn* column = context.batch->FindColumn(name_);
+    if (column == nullptr) {
+      return ::zetasql_base::InvalidArgumentError(
+          absl::StrCat("Incomplete column batch: ", name_));
+    }
+    if (!column->type()->Equals(output_type())) {
+      return ::zetasql_base::InvalidArgumentError(absl::StrCat(
+          "Expected column '", name_, "' to be of type ",
+          output_type()->DebugString(), " but found ",
+          column->type()->DebugString()));
+    }
+    *result = column;
+    return zetasql_base::OkStatus();
+  }
+
+ private:
+  const std::string name_;
+};
+
+// Base class for operators with arguments. Evaluates all arguments into
+// per-call scratch columns.
+class NaryExpr : public BatchExpr {
+ public:
+  NaryExpr(const Type* output_type,
+           std::vector<std::unique_ptr<const BatchExpr>> arguments)
+      : BatchExpr(output_type), arguments_(std::move(arguments)) {}
+
+ protected:
+  zetasql_base::Status EvalArguments(const EvalContext& context,
+                             std::vector<ValueColumn>* scratch,
+                             std::vector<const ValueColumn*>* inputs) const {
+    scratch->clear();
+    scratch->reserve(arguments_.size());
+    inputs->resize(arguments_.size());
+    for (int i = 0; i < arguments_.size(); ++i) {
+      scratch->emplace_back(arguments_[i]->output_type());
+      ZETASQL_RETURN_IF_ERROR(
+          arguments_[i]->Eval(context, &scratch->back(), &(*inputs)[i]));
+      ZETASQL_RET_CHECK_EQ(context.num_rows(), (*inputs)[i]->size());
+    }
+    return zetasql_base::OkStatus();
+  }
+
+  const std::vector<std::unique_ptr<const BatchExpr>> arguments_;
+};
+
+// A builtin function implemented by a kernel over whole columns.
+class KernelExpr final : public NaryExpr {
+ public:
+  using Kernel = std::function<zetasql_base::Status(
+      const EvalContext& context, absl::Span<const ValueColumn* const> inputs,
+      ValueColumn* output)>;
+
+  KernelExpr(const Type* output_type,
+             std::vector<std::unique_ptr<const BatchExpr>> arguments,
+             Kernel kernel)
+      : NaryExpr(output_type, std::move(arguments)),
+        kernel_(std::move(kernel)) {}
+
+  zetasql_base::Status Eval(const EvalContext& context, ValueColumn* scratch,
+                    const ValueColumn** result) const override {
+    std::vector<ValueColumn> argument_scratch;
+    std::vector<const ValueColumn*> inputs;
+    ZETASQL_RETURN_IF_ERROR(EvalArguments(context, &argument_scratch, &inputs));
+    ZETASQL_RETURN_IF_ERROR(kernel_(context, inputs, scratch));
+    *result = scratch;
+    return zetasql_base::OkStatus();
+  }
+
+ private:
+  const Kernel kernel_;
+};
+
+using Kernel = KernelExpr::Kernel;
+
+// Kernels for $and and $or, with SQL three-valued logic.
+zetasql_base::Status EvalAnd(const EvalContext& context,
+                     absl::Span<const ValueColumn* const> inputs,
+                     ValueColumn* output) {
+  const int num_rows = context.num_rows();
+  output->Resize(num_rows);
+  std::vector<uint8_t>* out = output->mutable_data<uint8_t>();
+  // Start from TRUE and fold in every argument. A FALSE input makes the row
+  // FALSE regardless of NULLs; otherwise any NULL input makes it NULL.
+  std::fill(out->begin(), out->end(), 1);
+  std::vector<uint8_t> has_null(num_rows, 0);
+  for (const ValueColumn* input : inputs) {
+    const std::vector<uint8_t>& in = input->data<uint8_t>();
+    for (int row = 0; row < num_rows; ++row) {
+      if (input->IsNull(row)) {
+        has_null[row] = 1;
+      } else {
+        (*out)[row] &= in[row];
+      }
+    }
+  }
+  for (int row = 0; row < num_rows; ++row) {
+    output->SetNull(row, (*out)[row] != 0 && has_null[row] != 0);
+  }
+  return zetasql_base::OkStatus();
+}
+
+zetasql_base::Status EvalOr(const EvalContext& context,
+                    absl::Span<const ValueColumn* const> inputs,
+                    ValueColumn* output) {
+  const int num_rows = context.num_rows();
+  output->Resize(num_rows);
+  std::vector<uint8_t>* out = output->mutable_data<uint8_t>();
+  std::fill(out->begin(), out->end(), 0);
+  std::vector<uint8_t> has_null(num_rows, 0);
+  for (const ValueColumn* input : inputs) {
+    const std::vector<uint8_t>& in = input->data<uint8_t>();
+    for (int row = 0; row < num_rows; ++row) {
+      if (input->IsNull(row)) {
+        has_null[row] = 1;
+      } else {
+        (*out)[row] |= in[row];
+      }
+    }
+  }
+  for (int row = 0; row < num_rows; ++row) {
+    output->SetNull(row, (*out)[row] == 0 && has_null[row] != 0);
+  }
+  return zetasql_base::OkStatus();
+}
+
+zetasql_base::Status EvalNot(const EvalContext& context,
+                     absl::Span<const ValueColumn* const> inputs,
+                     ValueColumn* output) {
+  const ValueColumn& input = *inputs[0];
+  output->Resize(context.num_rows());
+  PropagateNulls(inputs, output);
+  const std::vector<uint8_t>& in = input.data<uint8_t>();
+  std::vector<uint8_t>* out = output->mutable_data<uint8_t>();
+  for (int row = 0; row < context.num_rows(); ++row) {
+    (*out)[row] = in[row] ^ 1;
+  }
+  return zetasql_base::OkStatus();
+}
+
+zetasql_base::Status EvalIsNull(const EvalContext& context,
+                        absl::Span<const ValueColumn* const> inputs,
+                        ValueColumn* output) {
+  const ValueColumn& input = *inputs[0];
+  output->Resize(context.num_rows());
+  std::fill(output->mutable_null_bits()->begin(),
+            output->mutable_null_bits()->end(), 0);
+  std::vector<uint8_t>* out = output->mutable_data<uint8_t>();
+  for (int row = 0; row < context.num_rows(); ++row) {
+    (*out)[row] = input.IsNull(row) ? 1 : 0;
+  }
+  return zetasql_base::OkStatus();
+}
+
+template <typename In1, typename In2, typename Out, typename Fn>
+Kernel MakeBinaryKernel(bool safe, Fn fn) {
+  return [safe, fn](const EvalContext& context,
+                    absl::Span<const ValueColumn* const> inputs,
+                    ValueColumn* output) {
+    return EvalBinaryStrict<In1, In2, Out>(*inputs[0], *inputs[1], safe, fn,
+                                           output);
+  };
+}
+
+template <typename In, typename Out, typename Fn>
+Kernel MakeUnaryKernel(bool safe, Fn fn) {
+  return [safe, fn](const EvalContext& context,
+                    absl::Span<const ValueColumn* const> inputs,
+                    ValueColumn* output) {
+    return EvalUnaryStrict<In, Out>(*inputs[0], safe, fn, output);
+  };
+}
+
+template <typename In1, typename In2, typename Cmp>
+Kernel MakeCompareKernel(Cmp cmp) {
+  return [cmp](const EvalContext& context,
+               absl::Span<const ValueColumn* const> inputs,
+               ValueColumn* output) {
+    EvalCompare<In1, In2>(*inputs[0], *inputs[1], cmp, output);
+    return zetasql_base::OkStatus();
+  };
+}
+
+// Returns a kernel for a binary arithmetic function over arguments of type
+// <kind>, or NULL if <kind> is not supported.
+template <template <typename...> class FnSelector>
+Kernel MakeArithmeticKernel(TypeKind kind, bool safe) {
+  switch (ValueColumn::StorageForTypeKind(kind)) {
+    case ValueColumn::Storage::kInt64:
+      if (kind != TYPE_INT64) return nullptr;
+      return MakeBinaryKernel<int64_t, int64_t, int64_t>(
+          safe, &FnSelector<int64_t>::Apply);
+    case ValueColumn::Storage::kDouble:
+      if (kind != TYPE_DOUBLE) return nullptr;
+      return MakeBinaryKernel<double, double, double>(
+          safe, &FnSelector<double>::Apply);
+    case ValueColumn::Storage::kNumeric:
+      return MakeBinaryKernel<NumericValue, NumericValue, NumericValue>(
+          safe, &FnSelector<NumericValue>::Apply);
+    default:
+      return nullptr;
+  }
+}
+
+template <typename T>
+struct AddFn {
+  static bool Apply(T in1, T in2, T* out, zetasql_base::Status* error) {
+    return functions::Add<T>(in1, in2, out, error);
+  }
+};
+
+template <typename T>
+struct SubtractFn {
+  static bool Apply(T in1, T in2, T* out, zetasql_base::Status* error) {
+    return functions::Subtract<T, T>(in1, in2, out, error);
+  }
+};
+
+template <typename T>
+struct MultiplyFn {
+  static bool Apply(T in1, T in2, T* out, zetasql_base::Status* error) {
+    return functions::Multiply<T>(in1, in2, out, error);
+  }
+};
+
+template <typename T>
+struct DivideFn {
+  static bool Apply(T in1, T in2, T* out, zetasql_base::Status* error) {
+    return functions::Divide<T>(in1, in2, out, error);
+  }
+};
+
+template <CompareOp op>
+Kernel MakeComparisonKernelForOp(TypeKind kind1, TypeKind kind2) {
+  if (kind1 == TYPE_INT64 && kind2 == TYPE_UINT64) {
+    return MakeCompareKernel<int64_t, uint64_t>(Int64Uint64Comparer<op>());
+  }
+  if (kind1 == TYPE_UINT64 && kind2 == TYPE_INT64) {
+    return MakeCompareKernel<uint64_t, int64_t>(Uint64Int64Comparer<op>());
+  }
+  if (kind1 != kind2) return nullptr;
+  switch (ValueColumn::StorageForTypeKind(kind1)) {
+    case ValueColumn::Storage::kInt64:
+      if (kind1 == TYPE_ENUM) return nullptr;
+      return MakeCompareKernel<int64_t, int64_t>(SameTypeComparer<op>());
+    case ValueColumn::Storage::kUint64:
+      return MakeCompareKernel<uint64_t, uint64_t>(SameTypeComparer<op>());
+    case ValueColumn::Storage::kDouble:
+      return MakeCompareKernel<double, double>(SameTypeComparer<op>());
+    case ValueColumn::Storage::kBool:
+      return MakeCompareKernel<uint8_t, uint8_t>(SameTypeComparer<op>());
+    case ValueColumn::Storage::kString:
+      return MakeCompareKernel<std::string, std::string>(
+          SameTypeComparer<op>());
+    case ValueColumn::Storage::kNumeric:
+      return MakeCompareKernel<NumericValue, NumericValue>(
+          SameTypeComparer<op>());
+    case ValueColumn::Storage::kValue:
+      return nullptr;
+  }
+  return nullptr;
+}
+
+Kernel MakeComparisonKernel(CompareOp op, TypeKind kind1, TypeKind kind2) {
+  switch (op) {
+    case CompareOp::kEqual:
+      return MakeComparisonKernelForOp<CompareOp::kEqual>(kind1, kind2);
+    case CompareOp::kNotEqual:
+      return MakeComparisonKernelForOp<CompareOp::kNotEqual>(kind1, kind2);
+    case CompareOp::kLess:
+      return MakeComparisonKernelForOp<CompareOp::kLess>(kind1, kind2);
+    case CompareOp::kLessOrEqual:
+      return MakeComparisonKernelForOp<CompareOp::kLessOrEqual>(kind1, kind2);
+    case CompareOp::kGreater:
+      return MakeComparisonKernelForOp<CompareOp::kGreater>(kind1, kind2);
+    case CompareOp::kGreaterOrEqual:
+      return MakeComparisonKernelForOp<CompareOp::kGreaterOrEqual>(kind1,
+                                                                   kind2);
+  }
+  return nullptr;
+}
+
+Kernel MakeUnaryMinusKernel(TypeKind kind, bool safe) {
+  switch (kind) {
+    case TYPE_INT64:
+      return MakeUnaryKernel<int64_t, int64_t>(
+          safe, &functions::UnaryMinus<int64_t, int64_t>);
+    case TYPE_DOUBLE:
+      return MakeUnaryKernel<double, double>(
+          safe, &functions::UnaryMinus<double, double>);
+    case TYPE_NUMERIC:
+      return MakeUnaryKernel<NumericValue, NumericValue>(
+          safe, &functions::UnaryMinus<NumericValue, NumericValue>);
+    default:
+      return nullptr;
+  }
+}
+
+Kernel MakeExtractFromDateKernel(functions::DateTimestampPart part, bool safe) {
+  return MakeUnaryKernel<int64_t, int64_t>(
+      safe, [part](int64_t date, int64_t* out, zetasql_base::Status* error) {
+        int32_t value;
+        *error = functions::ExtractFromDate(part, static_cast<int32_t>(date),
+                                            &value);
+        *out = value;
+        return error->ok();
+      });
+}
+
+// Converts every row of the storage of <input> from In to Out. Used for
+// casts that widen a value without ever failing, such as the INT32 to INT64
+// coercions the resolver inserts around INT32 arithmetic.
+template <typename In, typename Out>
+Kernel MakeWideningCastKernelForTypes() {
+  return [](const EvalContext& context,
+            absl::Span<const ValueColumn* const> inputs,
+            ValueColumn* output) {
+    const int num_rows = context.num_rows();
+    output->Resize(num_rows);
+    PropagateNulls(inputs, output);
+    const In* in = inputs[0]->data<In>().data();
+    Out* out = output->mutable_data<Out>()->data();
+    for (int row = 0; row < num_rows; ++row) {
+      out[row] = static_cast<Out>(in[row]);
+    }
+    return zetasql_base::OkStatus();
+  };
+}
+
+// Returns a kernel for a cast from <from_kind> to <to_kind> that can never
+// fail or lose precision, or NULL if the cast is not such a widening.
+Kernel MakeWideningCastKernel(TypeKind from_kind, TypeKind to_kind) {
+  switch (from_kind) {
+    case TYPE_INT32:
+      if (to_kind == TYPE_INT64) {
+        return MakeWideningCastKernelForTypes<int64_t, int64_t>();
+      }
+      if (to_kind == TYPE_DOUBLE) {
+        return MakeWideningCastKernelForTypes<int64_t, double>();
+      }
+      return nullptr;
+    case TYPE_UINT32:
+      if (to_kind == TYPE_INT64) {
+        return MakeWideningCastKernelForTypes<uint64_t, int64_t>();
+      }
+      if (to_kind == TYPE_UINT64) {
+        return MakeWideningCastKernelForTypes<uint64_t, uint64_t>();
+      }
+      if (to_kind == TYPE_DOUBLE) {
+        return MakeWideningCastKernelForTypes<uint64_t, double>();
+      }
+      return nullptr;
+    case TYPE_FLOAT:
+      if (to_kind == TYPE_DOUBLE) {
+        return MakeWideningCastKernelForTypes<double, double>();
+      }
+      return nullptr;
+    default:
+      return nullptr;
+  }
+}
+
+// Other casts go through CastValue() row by row, which handles every pair of
+// types; casting to the same type is a no-op.
+Kernel MakeCastKernel(const Type* from_type, const Type* to_type,
+                      bool return_null_on_error) {
+  Kernel widening = MakeWideningCastKernel(from_type->kind(), to_type->kind());
+  if (widening != nullptr) return widening;
+  return [to_type, return_null_on_error](
+             const EvalContext& context,
+             absl::Span<const ValueColumn* const> inputs,
+             ValueColumn* output) -> zetasql_base::Status {
+    const ValueColumn& input = *inputs[0];
+    output->Resize(context.num_rows());
+    for (int row = 0; row < context.num_rows(); ++row) {
+      if (input.IsNull(row)) {
+        output->SetNull(row, true);
+        continue;
+      }
+      zetasql_base::StatusOr<Value> cast_value =
+          CastValue(input.GetValue(row), context.options->default_time_zone,
+                    context.options->language_options, to_type);
+      if (!cast_value.ok()) {
+        if (!return_null_on_error) return cast_value.status();
+        output->SetNull(row, true);
+        continue;
+      }
+      ZETASQL_RETURN_IF_ERROR(output->SetValue(row, cast_value.ValueOrDie()));
+    }
+    return zetasql_base::OkStatus();
+  };
+}
+
+class IdentityExpr final : public NaryExpr {
+ public:
+  explicit IdentityExpr(std::unique_ptr<const BatchExpr> argument)
+      : NaryExpr(argument->output_type(), MakeArgumentList(std::move(argument))) {
+  }
+
+  zetasql_base::Status Eval(const EvalContext& context, ValueColumn* scratch,
+                    const ValueColumn** result) const override {
+    return arguments_[0]->Eval(context, scratch, result);
+  }
+
+ private:
+  static std::vector<std::unique_ptr<const BatchExpr>> MakeArgumentList(
+      std::unique_ptr<const BatchExpr> argument) {
+    std::vector<std::unique_ptr<const BatchExpr>> arguments;
+    arguments.push_back(std::move(argument));
+    return arguments;
+  }
+};
+
+// Compiles resolved expressions into BatchExprs, recording the referenced
+// columns and parameters.
+class Compiler {
+ public:
+  zetasql_base::StatusOr<std::unique_ptr<const BatchExpr>> Compile(
+      const ResolvedExpr* expr);
+
+  std::set<std::string> referenced_columns;
+  std::set<std::string> referenced_parameters;
+
+ private:
+  zetasql_base::StatusOr<std::unique_ptr<const BatchExpr>> CompileFunctionCall(
+      const ResolvedFunctionCall* call);
+  zetasql_base::StatusOr<Kernel> GetFunctionKernel(const ResolvedFunctionCall* call);
+};
+
+zetasql_base::StatusOr<std::unique_ptr<const BatchExpr>> Compiler::Compile(
+    const ResolvedExpr* expr) {
+  switch (expr->node_kind()) {
+    case RESOLVED_LITERAL:
+      return std::unique_ptr<const BatchExpr>(
+          new ConstantExpr(expr->GetAs<ResolvedLiteral>()->value()));
+    case RESOLVED_PARAMETER: {
+      const ResolvedParameter* parameter = expr->GetAs<ResolvedParameter>();
+      if (parameter->name().empty()) {
+        return ::zetasql_base::UnimplementedError(
+            "Positional query parameters are not supported by "
+            "PreparedExpression");
+      }
+      const std::string name = absl::AsciiStrToLower(parameter->name());
+      referenced_parameters.insert(name);
+      return std::unique_ptr<const BatchExpr>(
+          new ParameterExpr(name, parameter->type()));
+    }
+    case RESOLVED_EXPRESSION_COLUMN: {
+      const std::string name = absl::AsciiStrToLower(
+          expr->GetAs<ResolvedExpressionColumn>()->name());
+      referenced_columns.insert(name);
+      return std::unique_ptr<const BatchExpr>(
+          new ColumnRefExpr(name, expr->type()));
+    }
+    case RESOLVED_CAST: {
+      const ResolvedCast* cast = expr->GetAs<ResolvedCast>();
+      ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<const BatchExpr> argument,
+                       Compile(cast->expr()));
+      if (argument->output_type()->Equals(cast->type())) {
+        return std::unique_ptr<const BatchExpr>(
+            new IdentityExpr(std::move(argument)));
+      }
+      const Type* from_type = argument->output_type();
+      std::vector<std::unique_ptr<const BatchExpr>> arguments;
+      arguments.push_back(std::move(argument));
+      return std::unique_ptr<const BatchExpr>(
+          new KernelExpr(cast->type(), std::move(arguments),
+                         MakeCastKernel(from_type, cast->type(),
+                                        cast->return_null_on_error())));
+    }
+    case RESOLVED_FUNCTION_CALL:
+      return CompileFunctionCall(expr->GetAs<ResolvedFunctionCall>());
+    default:
+      return ::zetasql_base::UnimplementedError(
+          absl::StrCat("PreparedExpression does not support ",
+                       expr->node_kind_string()));
+  }
+}
+
+zetasql_base::StatusOr<std::unique_ptr<const BatchExpr>> Compiler::CompileFunctionCall(
+    const ResolvedFunctionCall* call) {
+  ZETASQL_ASSIGN_OR_RETURN(Kernel kernel, GetFunctionKernel(call));
+  std::vector<std::unique_ptr<const BatchExpr>> arguments;
+  for (const auto& argument : call->argument_list()) {
+    ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<const BatchExpr> compiled,
+                     Compile(argument.get()));
+    arguments.push_back(std::move(compiled));
+  }
+  return std::unique_ptr<const BatchExpr>(
+      new KernelExpr(call->type(), std::move(arguments), std::move(kernel)));
+}
+
+zetasql_base::StatusOr<Kernel> Compiler::GetFunctionKernel(
+    const ResolvedFunctionCall* call) {
+  const Function* function = call->function();
+  const bool safe =
+      call->error_mode() == ResolvedFunctionCallBase::SAFE_ERROR_MODE;
+  std::vector<TypeKind> kinds;
+  for (const auto& argument : call->argument_list()) {
+    kinds.push_back(argument->type()->kind());
+  }
+
+  Kernel kernel;
+  if (function->IsZetaSQLBuiltin()) {
+    switch (call->signature().context_id()) {
+      case FN_ADD_INT64:
+      case FN_ADD_DOUBLE:
+      case FN_ADD_NUMERIC:
+        kernel = MakeArithmeticKernel<AddFn>(kinds[0], safe);
+        break;
+      case FN_ADD_UINT64:
+        kernel = MakeBinaryKernel<uint64_t, uint64_t, uint64_t>(
+            safe, &AddFn<uint64_t>::Apply);
+        break;
+      case FN_SUBTRACT_INT64:
+      case FN_SUBTRACT_DOUBLE:
+      case FN_SUBTRACT_NUMERIC:
+        kernel = MakeArithmeticKernel<SubtractFn>(kinds[0], safe);
+        break;
+      case FN_SUBTRACT_UINT64:
+        kernel = MakeBinaryKernel<uint64_t, uint64_t, int64_t>(
+            safe, &functions::Subtract<uint64_t, int64_t>);
+        break;
+      case FN_MULTIPLY_INT64:
+      case FN_MULTIPLY_DOUBLE:
+      case FN_MULTIPLY_NUMERIC:
+        kernel = MakeArithmeticKernel<MultiplyFn>(kinds[0], safe);
+        break;
+      case FN_MULTIPLY_UINT64:
+        kernel = MakeBinaryKernel<uint64_t, uint64_t, uint64_t>(
+            safe, &MultiplyFn<uint64_t>::Apply);
+        break;
+      case FN_DIVIDE_DOUBLE:
+      case FN_DIVIDE_NUMERIC:
+        kernel = MakeArithmeticKernel<DivideFn>(kinds[0], safe);
+        break;
+      case FN_UNARY_MINUS_INT64:
+      case FN_UNARY_MINUS_DOUBLE:
+      case FN_UNARY_MINUS_NUMERIC:
+        kernel = MakeUnaryMinusKernel(kinds[0], safe);
+        break;
+      case FN_EQUAL:
+      case FN_EQUAL_INT64_UINT64:
+      case FN_EQUAL_UINT64_INT64:
+        kernel = MakeComparisonKernel(CompareOp::kEqual, kinds[0], kinds[1]);
+        break;
+      case FN_NOT_EQUAL:
+      case FN_NOT_EQUAL_INT64_UINT64:
+      case FN_NOT_EQUAL_UINT64_INT64:
+        kernel =
+            MakeComparisonKernel(CompareOp::kNotEqual, kinds[0], kinds[1]);
+        break;
+      case FN_LESS:
+      case FN_LESS_INT64_UINT64:
+      case FN_LESS_UINT64_INT64:
+        kernel = MakeComparisonKernel(CompareOp::kLess, kinds[0], kinds[1]);
+        break;
+      case FN_LESS_OR_EQUAL:
+      case FN_LESS_OR_EQUAL_INT64_UINT64:
+      case FN_LESS_OR_EQUAL_UINT64_INT64:
+        kernel =
+            MakeComparisonKernel(CompareOp::kLessOrEqual, kinds[0], kinds[1]);
+        break;
+      case FN_GREATER:
+      case FN_GREATER_INT64_UINT64:
+      case FN_GREATER_UINT64_INT64:
+        kernel = MakeComparisonKernel(CompareOp::kGreater, kinds[0], kinds[1]);
+        break;
+      case FN_GREATER_OR_EQUAL:
+      case FN_GREATER_OR_EQUAL_INT64_UINT64:
+      case FN_GREATER_OR_EQUAL_UINT64_INT64:
+        kernel = MakeComparisonKernel(CompareOp::kGreaterOrEqual, kinds[0],
+                                      kinds[1]);
+        break;
+      case FN_AND:
+        kernel = &EvalAnd;
+        break;
+      case FN_OR:
+        kernel = &EvalOr;
+        break;
+      case FN_NOT:
+        kernel = &EvalNot;
+        break;
+      case FN_IS_NULL:
+        kernel = &EvalIsNull;
+        break;
+      case FN_EXTRACT_FROM_DATE: {
+        const ResolvedExpr* part = call->argument_list(1);
+        if (part->node_kind() == RESOLVED_LITERAL &&
+            !part->GetAs<ResolvedLiteral>()->value().is_null()) {
+          kernel = MakeExtractFromDateKernel(
+              static_cast<functions::DateTimestampPart>(
+                  part->GetAs<ResolvedLiteral>()->value().enum_value()),
+              safe);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  if (kernel == nullptr) {
+    return ::zetasql_base::UnimplementedError(absl::StrCat(
+        "PreparedExpression does not support ", function->SQLName(), "(",
+        call->signature().DebugString(function->SQLName()), ")"));
+  }
+  return kernel;
+}
+
+}  // namespace
+
+// ------------------------- PreparedExpression -------------------------
+
+PreparedExpression::PreparedExpression(const std::string& sql,
+                                       const EvaluatorOptions& options)
+    : sql_(sql), options_(options) {}
+
+PreparedExpression::PreparedExpression(const ResolvedExpr* expression,
+                                       const EvaluatorOptions& options)
+    : options_(options), resolved_expr_(expression) {}
+
+PreparedExpression::~PreparedExpression() {}
+
+zetasql_base::Status PreparedExpression::Prepare(const AnalyzerOptions& analyzer_options,
+                                         Catalog* catalog) {
+  ZETASQL_RET_CHECK(compiled_ == nullptr) << "Prepare() called twice";
+  if (resolved_expr_ == nullptr) {
+    type_factory_ = absl::make_unique<TypeFactory>();
+    if (catalog == nullptr) {
+      default_catalog_ = absl::make_unique<SimpleCatalog>(
+          "default_catalog", type_factory_.get());
+      default_catalog_->AddZetaSQLFunctions(
+          ZetaSQLBuiltinFunctionOptions(analyzer_options.language()));
+      catalog = default_catalog_.get();
+    }
+    ZETASQL_RETURN_IF_ERROR(AnalyzeExpression(sql_, analyzer_options, catalog,
+                                      type_factory_.get(), &analyzer_output_));
+    resolved_expr_ = analyzer_output_->resolved_expr();
+  }
+
+  Compiler compiler;
+  ZETASQL_ASSIGN_OR_RETURN(compiled_, compiler.Compile(resolved_expr_));
+  referenced_columns_.assign(compiler.referenced_columns.begin(),
+                             compiler.referenced_columns.end());
+  referenced_parameters_.assign(compiler.referenced_parameters.begin(),
+                                compiler.referenced_parameters.end());
+  return zetasql_base::OkStatus();
+}
+
+const Type* PreparedExpression::output_type() const {
+  CHECK(compiled_ != nullptr) << "Prepare() must be called first";
+  return compiled_->output_type();
+}
+
+std::vector<std::string> PreparedExpression::GetReferencedColumns() const {
+  CHECK(compiled_ != nullptr) << "Prepare() must be called first";
+  return referenced_columns_;
+}
+
+std::vector<std::string> PreparedExpression::GetReferencedParameters() const {
+  CHECK(compiled_ != nullptr) << "Prepare() must be called first";
+  return referenced_parameters_;
+}
+
+zetasql_base::Status PreparedExpression::ExecuteBatch(
+    const ColumnBatch& batch, const ParameterValueMap& parameters,
+    ValueColumn* result) const {
+  ZETASQL_RET_CHECK(compiled_ != nullptr) << "Prepare() must be called first";
+  ZETASQL_RET_CHECK(result->type()->Equals(output_type()))
+      << "Result column has type " << result->type()->DebugString()
+      << " but the expression has type " << output_type()->DebugString();
+  const EvalContext context{&batch, &parameters, &options_};
+  const ValueColumn* output = nullptr;
+  ZETASQL_RETURN_IF_ERROR(compiled_->Eval(context, result, &output));
+  if (output != result) {
+    // The expression is a bare column reference.
+    *result = *output;
+  }
+  return zetasql_base::OkStatus();
+}
+
+zetasql_base::StatusOr<Value> PreparedExpression::Execute(
+    const ParameterValueMap& columns,
+    const ParameterValueMap& parameters) const {
+  ZETASQL_RET_CHECK(compiled_ != nullptr) << "Prepare() must be called first";
+  ColumnBatch batch(/*num_rows=*/1);
+  for (const auto& entry : columns) {
+    ValueColumn column(entry.second.type());
+    ZETASQL_RETURN_IF_ERROR(column.Append(entry.second));
+    ZETASQL_RETURN_IF_ERROR(batch.AddColumn(entry.first, std::move(column)));
+  }
+  ParameterValueMap lower_parameters;
+  for (const auto& entry : parameters) {
+    lower_parameters[absl::AsciiStrToLower(entry.first)] = entry.second;
+  }
+  ValueColumn result(output_type());
+  ZETASQL_RETURN_IF_ERROR(ExecuteBatch(batch, lower_parameters, &result));
+  return result.GetValue(0);
+}
+
+}  // namespace zetasql
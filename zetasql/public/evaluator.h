@@ -0,0 +1,309 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Vectorized evaluation of ZetaSQL scalar expressions.
+//
+// PreparedExpression compiles a ResolvedExpr (either produced by
+// AnalyzeExpression or supplied by the caller) once into a tree of batch
+// operators, and then evaluates it over batches of rows stored in columnar
+// form. Each operator processes a whole column per call, so virtual dispatch
+// and Value boxing are paid once per batch instead of once per row.
+//
+// Example:
+//
+//   PreparedExpression expr("a + 1 > b");
+//   AnalyzerOptions options;
+//   ZETASQL_RETURN_IF_ERROR(options.AddExpressionColumn("a", types::Int64Type()));
+//   ZETASQL_RETURN_IF_ERROR(options.AddExpressionColumn("b", types::Int64Type()));
+//   ZETASQL_RETURN_IF_ERROR(expr.Prepare(options, catalog));
+//
+//   ColumnBatch batch(num_rows);
+//   ZETASQL_RETURN_IF_ERROR(batch.AddColumn("a", std::move(a_column)));
+//   ZETASQL_RETURN_IF_ERROR(batch.AddColumn("b", std::move(b_column)));
+//   ValueColumn result(expr.output_type());
+//   ZETASQL_RETURN_IF_ERROR(expr.ExecuteBatch(batch, /*parameters=*/{}, &result));
+//
+// Supported expressions are literals, named query parameters, expression
+// columns, CAST, and the builtin arithmetic ($add, $subtract, $multiply,
+// $divide, $unary_minus), comparison ($equal, $not_equal, $less,
+// $less_or_equal, $greater, $greater_or_equal), logical ($and, $or, $not,
+// $is_null) and EXTRACT-from-DATE functions, including SAFE mode. Prepare()
+// returns an UNIMPLEMENTED error for anything else.
+
+#ifndef ZETASQL_PUBLIC_EVALUATOR_H_
+#define ZETASQL_PUBLIC_EVALUATOR_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/catalog.h"
+#include "zetasql/public/language_options.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include <cstdint>
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "zetasql/base/status.h"
+#include "zetasql/base/statusor.h"
+
+namespace zetasql {
+
+class ResolvedExpr;
+class SimpleCatalog;
+
+namespace internal {
+class BatchExpr;
+}  // namespace internal
+
+// Map from lower-cased parameter or column name to its value.
+using ParameterValueMap = std::map<std::string, Value>;
+
+// Options that affect evaluation semantics.
+struct EvaluatorOptions {
+  // Time zone used by CAST between time-based types and strings.
+  absl::TimeZone default_time_zone = absl::UTCTimeZone();
+
+  // Language options used by CAST.
+  LanguageOptions language_options;
+};
+
+// A column of values of a single Type, in columnar layout. Non-null values are
+// stored densely in a vector of their native C++ representation, and nullness
+// is tracked in a separate bitmap. The native representation ("storage") is
+// determined by the type kind:
+//
+//   INT32, INT64, DATE, ENUM -> int64_t
+//   UINT32, UINT64           -> uint64_t
+//   FLOAT, DOUBLE            -> double
+//   BOOL                     -> uint8_t (0 or 1)
+//   STRING, BYTES            -> std::string
+//   NUMERIC                  -> NumericValue
+//   anything else            -> Value
+//
+// The slot of a null row in the data vector holds an unspecified value.
+class ValueColumn {
+ public:
+  enum class Storage {
+    kInt64,
+    kUint64,
+    kDouble,
+    kBool,
+    kString,
+    kNumeric,
+    kValue,
+  };
+
+  // Returns the storage used for values of type kind <kind>.
+  static Storage StorageForTypeKind(TypeKind kind);
+
+  // Creates an empty column of type <type>. Does not take ownership of <type>.
+  explicit ValueColumn(const Type* type);
+
+  ValueColumn(const ValueColumn&) = default;
+  ValueColumn& operator=(const ValueColumn&) = default;
+  ValueColumn(ValueColumn&&) = default;
+  ValueColumn& operator=(ValueColumn&&) = default;
+
+  const Type* type() const { return type_; }
+  Storage storage() const { return storage_; }
+  int size() const { return size_; }
+
+  // Resizes the column to <size> rows. Newly added rows are NULL.
+  void Resize(int size);
+
+  // Removes all rows.
+  void Clear() { Resize(0); }
+
+  bool IsNull(int row) const {
+    return (null_bits_[row >> 6] >> (row & 63)) & 1;
+  }
+  void SetNull(int row, bool is_null) {
+    const uint64_t mask = uint64_t{1} << (row & 63);
+    if (is_null) {
+      null_bits_[row >> 6] |= mask;
+    } else {
+      null_bits_[row >> 6] &= ~mask;
+    }
+  }
+
+  // Returns true if no row in the column is NULL.
+  bool HasNoNulls() const;
+
+  // The null bitmap, one bit per row, 64 rows per word. Bits past size() are
+  // zero.
+  const std::vector<uint64_t>& null_bits() const { return null_bits_; }
+  std::vector<uint64_t>* mutable_null_bits() { return &null_bits_; }
+
+  // Typed access to the dense data vector. T must be the C++ type of
+  // storage(), i.e. one of int64_t, uint64_t, double, uint8_t, std::string,
+  // NumericValue or Value. The vector always has size() elements.
+  template <typename T>
+  const std::vector<T>& data() const;
+  template <typename T>
+  std::vector<T>* mutable_data();
+
+  // Returns row <row> as a Value of type().
+  Value GetValue(int row) const;
+
+  // Sets row <row> to <value>. <value> must have type type().
+  zetasql_base::Status SetValue(int row, const Value& value);
+
+  // Appends <value> to the column. <value> must have type type().
+  zetasql_base::Status Append(const Value& value);
+
+ private:
+  const Type* type_;
+  Storage storage_;
+  int size_ = 0;
+  std::vector<uint64_t> null_bits_;
+
+  // Exactly one of these is used, depending on storage_.
+  std::vector<int64_t> int64_data_;
+  std::vector<uint64_t> uint64_data_;
+  std::vector<double> double_data_;
+  std::vector<uint8_t> bool_data_;
+  std::vector<std::string> string_data_;
+  std::vector<NumericValue> numeric_data_;
+  std::vector<Value> value_data_;
+};
+
+// Explicit specializations of the typed accessors, defined in evaluator.cc.
+template <>
+const std::vector<int64_t>& ValueColumn::data<int64_t>() const;
+template <>
+const std::vector<uint64_t>& ValueColumn::data<uint64_t>() const;
+template <>
+const std::vector<double>& ValueColumn::data<double>() const;
+template <>
+const std::vector<uint8_t>& ValueColumn::data<uint8_t>() const;
+template <>
+const std::vector<std::string>& ValueColumn::data<std::string>() const;
+template <>
+const std::vector<NumericValue>& ValueColumn::data<NumericValue>() const;
+template <>
+const std::vector<Value>& ValueColumn::data<Value>() const;
+template <>
+std::vector<int64_t>* ValueColumn::mutable_data<int64_t>();
+template <>
+std::vector<uint64_t>* ValueColumn::mutable_data<uint64_t>();
+template <>
+std::vector<double>* ValueColumn::mutable_data<double>();
+template <>
+std::vector<uint8_t>* ValueColumn::mutable_data<uint8_t>();
+template <>
+std::vector<std::string>* ValueColumn::mutable_data<std::string>();
+template <>
+std::vector<NumericValue>* ValueColumn::mutable_data<NumericValue>();
+template <>
+std::vector<Value>* ValueColumn::mutable_data<Value>();
+
+// A set of named columns with the same number of rows, used as the input of
+// PreparedExpression::ExecuteBatch(). Column names are case-insensitive.
+class ColumnBatch {
+ public:
+  explicit ColumnBatch(int num_rows) : num_rows_(num_rows) {}
+  ColumnBatch(const ColumnBatch&) = delete;
+  ColumnBatch& operator=(const ColumnBatch&) = delete;
+
+  int num_rows() const { return num_rows_; }
+
+  // Adds a column called <name>. Returns an error if <column> does not have
+  // num_rows() rows, or if a column with the same name already exists.
+  zetasql_base::Status AddColumn(const std::string& name, ValueColumn column);
+
+  // Returns the column called <name>, or NULL if there is none.
+  const ValueColumn* FindColumn(absl::string_view name) const;
+
+ private:
+  const int num_rows_;
+  std::map<std::string, ValueColumn> columns_;  // Keyed by lower-case name.
+};
+
+// A scalar expression that is analyzed and compiled once and can then be
+// evaluated any number of times, over single rows or over batches of rows.
+//
+// After Prepare() succeeds, the execution methods are const and thread-safe.
+class PreparedExpression {
+ public:
+  // Creates an expression from SQL text. The text is analyzed by Prepare().
+  explicit PreparedExpression(
+      const std::string& sql,
+      const EvaluatorOptions& options = EvaluatorOptions());
+
+  // Creates an expression from an already resolved expression. Does not take
+  // ownership of <expression>, which must outlive this object.
+  explicit PreparedExpression(
+      const ResolvedExpr* expression,
+      const EvaluatorOptions& options = EvaluatorOptions());
+
+  PreparedExpression(const PreparedExpression&) = delete;
+  PreparedExpression& operator=(const PreparedExpression&) = delete;
+  ~PreparedExpression();
+
+  // Analyzes the expression if it was given as SQL text, and compiles it.
+  // Expression columns and query parameters must be declared in
+  // <analyzer_options>. If <catalog> is NULL, a catalog containing only the
+  // ZetaSQL builtin functions is used. <catalog> is only used during this
+  // call.
+  zetasql_base::Status Prepare(const AnalyzerOptions& analyzer_options,
+                       Catalog* catalog = nullptr);
+
+  // Returns the type of the expression result.
+  // REQUIRES: Prepare() succeeded.
+  const Type* output_type() const;
+
+  // Returns the (lower-case) names of the expression columns and query
+  // parameters that are referenced by the expression.
+  // REQUIRES: Prepare() succeeded.
+  std::vector<std::string> GetReferencedColumns() const;
+  std::vector<std::string> GetReferencedParameters() const;
+
+  // Evaluates the expression over every row of <batch>, replacing the
+  // contents of <result>. <result> must have type output_type(). Every
+  // referenced column must be present in <batch>, with the type declared at
+  // Prepare() time, and every referenced parameter must be present in
+  // <parameters>.
+  zetasql_base::Status ExecuteBatch(const ColumnBatch& batch,
+                            const ParameterValueMap& parameters,
+                            ValueColumn* result) const;
+
+  // Evaluates the expression over a single row given by <columns>.
+  zetasql_base::StatusOr<Value> Execute(
+      const ParameterValueMap& columns = {},
+      const ParameterValueMap& parameters = {}) const;
+
+ private:
+  const std::string sql_;
+  const EvaluatorOptions options_;
+
+  // Set when the expression was given as SQL. Owns the resolved expression.
+  std::unique_ptr<TypeFactory> type_factory_;
+  std::unique_ptr<SimpleCatalog> default_catalog_;
+  std::unique_ptr<const AnalyzerOutput> analyzer_output_;
+
+  const ResolvedExpr* resolved_expr_ = nullptr;  // Not owned.
+  std::unique_ptr<const internal::BatchExpr> compiled_;
+  std::vector<std::string> referenced_columns_;
+  std::vector<std::string> referenced_parameters_;
+};
+
+}  // namespace zetasql
+
+#endif  // ZETASQL_PUBLIC_EVALUATOR_H_
@@ -0,0 +1,200 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/evaluator.h"
+
+#include <vector>
+
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/status.h"
+
+namespace zetasql {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::zetasql_base::testing::IsOkAndHolds;
+using ::zetasql_base::testing::StatusIs;
+
+TEST(ValueColumnTest, AppendAndGet) {
+  ValueColumn column(types::Int64Type());
+  ZETASQL_ASSERT_OK(column.Append(values::Int64(1)));
+  ZETASQL_ASSERT_OK(column.Append(values::NullInt64()));
+  ZETASQL_ASSERT_OK(column.Append(values::Int64(3)));
+  EXPECT_EQ(3, column.size());
+  EXPECT_FALSE(column.HasNoNulls());
+  EXPECT_EQ(values::Int64(1), column.GetValue(0));
+  EXPECT_EQ(values::NullInt64(), column.GetValue(1));
+  EXPECT_EQ(values::Int64(3), column.GetValue(2));
+  EXPECT_THAT(column.Append(values::String("a")),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+
+  column.Resize(1);
+  EXPECT_TRUE(column.HasNoNulls());
+  column.Resize(130);
+  EXPECT_TRUE(column.IsNull(1));
+  EXPECT_TRUE(column.IsNull(129));
+}
+
+TEST(PreparedExpressionTest, ScalarExecute) {
+  PreparedExpression expr("1 + 2 * 3");
+  ZETASQL_ASSERT_OK(expr.Prepare(AnalyzerOptions()));
+  EXPECT_TRUE(expr.output_type()->IsInt64());
+  EXPECT_THAT(expr.Execute(), IsOkAndHolds(values::Int64(7)));
+}
+
+TEST(PreparedExpressionTest, BatchFilter) {
+  AnalyzerOptions options;
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("a", types::Int64Type()));
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("b", types::DoubleType()));
+  ZETASQL_ASSERT_OK(options.AddQueryParameter("p", types::Int64Type()));
+
+  PreparedExpression expr("a + @p > b AND a IS NOT NULL");
+  ZETASQL_ASSERT_OK(expr.Prepare(options));
+  EXPECT_TRUE(expr.output_type()->IsBool());
+  EXPECT_THAT(expr.GetReferencedColumns(), ElementsAre("a", "b"));
+  EXPECT_THAT(expr.GetReferencedParameters(), ElementsAre("p"));
+
+  ValueColumn a(types::Int64Type());
+  ValueColumn b(types::DoubleType());
+  for (const auto& row : std::vector<std::pair<Value, Value>>{
+           {values::Int64(1), values::Double(1.5)},
+           {values::Int64(5), values::Double(1.5)},
+           {values::NullInt64(), values::Double(0)},
+           {values::Int64(5), values::NullDouble()}}) {
+    ZETASQL_ASSERT_OK(a.Append(row.first));
+    ZETASQL_ASSERT_OK(b.Append(row.second));
+  }
+  ColumnBatch batch(4);
+  ZETASQL_ASSERT_OK(batch.AddColumn("A", std::move(a)));
+  ZETASQL_ASSERT_OK(batch.AddColumn("b", std::move(b)));
+
+  ValueColumn result(expr.output_type());
+  ZETASQL_ASSERT_OK(expr.ExecuteBatch(batch, {{"p", values::Int64(1)}}, &result));
+  ASSERT_EQ(4, result.size());
+  EXPECT_EQ(values::True(), result.GetValue(0));
+  EXPECT_EQ(values::True(), result.GetValue(1));
+  EXPECT_EQ(values::False(), result.GetValue(2));
+  EXPECT_EQ(values::NullBool(), result.GetValue(3));
+
+  EXPECT_THAT(expr.ExecuteBatch(batch, {}, &result),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument,
+                       HasSubstr("Incomplete query parameters")));
+}
+
+TEST(PreparedExpressionTest, ArithmeticErrors) {
+  AnalyzerOptions options;
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("x", types::Int64Type()));
+
+  PreparedExpression expr("x + 9223372036854775807");
+  ZETASQL_ASSERT_OK(expr.Prepare(options));
+  EXPECT_THAT(expr.Execute({{"x", values::Int64(0)}}),
+              IsOkAndHolds(values::Int64(9223372036854775807)));
+  EXPECT_THAT(expr.Execute({{"x", values::Int64(1)}}),
+              StatusIs(zetasql_base::StatusCode::kOutOfRange));
+
+  PreparedExpression divide_expr("1.0 / CAST(x AS FLOAT64)");
+  ZETASQL_ASSERT_OK(divide_expr.Prepare(options));
+  EXPECT_THAT(divide_expr.Execute({{"x", values::Int64(4)}}),
+              IsOkAndHolds(values::Double(0.25)));
+  EXPECT_THAT(divide_expr.Execute({{"x", values::Int64(0)}}),
+              StatusIs(zetasql_base::StatusCode::kOutOfRange));
+}
+
+TEST(PreparedExpressionTest, WideningCasts) {
+  AnalyzerOptions options;
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("i", types::Int32Type()));
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("u", types::Uint32Type()));
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("f", types::FloatType()));
+
+  PreparedExpression expr("i + u + CAST(f AS FLOAT64) + CAST(u AS UINT64)");
+  ZETASQL_ASSERT_OK(expr.Prepare(options));
+  EXPECT_TRUE(expr.output_type()->IsDouble());
+
+  ValueColumn i(types::Int32Type());
+  ValueColumn u(types::Uint32Type());
+  ValueColumn f(types::FloatType());
+  ZETASQL_ASSERT_OK(i.Append(values::Int32(-2147483647 - 1)));
+  ZETASQL_ASSERT_OK(u.Append(values::Uint32(4294967295u)));
+  ZETASQL_ASSERT_OK(f.Append(values::Float(0.5f)));
+  ZETASQL_ASSERT_OK(i.Append(values::NullInt32()));
+  ZETASQL_ASSERT_OK(u.Append(values::Uint32(1)));
+  ZETASQL_ASSERT_OK(f.Append(values::Float(1)));
+  ColumnBatch batch(2);
+  ZETASQL_ASSERT_OK(batch.AddColumn("i", std::move(i)));
+  ZETASQL_ASSERT_OK(batch.AddColumn("u", std::move(u)));
+  ZETASQL_ASSERT_OK(batch.AddColumn("f", std::move(f)));
+
+  ValueColumn result(expr.output_type());
+  ZETASQL_ASSERT_OK(expr.ExecuteBatch(batch, {}, &result));
+  ASSERT_EQ(2, result.size());
+  EXPECT_EQ(values::Double(-2147483648.0 + 2 * 4294967295.0 + 0.5),
+            result.GetValue(0));
+  EXPECT_EQ(values::NullDouble(), result.GetValue(1));
+}
+
+TEST(PreparedExpressionTest, SafeCast) {
+  AnalyzerOptions options;
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("s", types::StringType()));
+
+  PreparedExpression expr("SAFE_CAST(s AS INT64)");
+  ZETASQL_ASSERT_OK(expr.Prepare(options));
+  EXPECT_THAT(expr.Execute({{"s", values::String("12")}}),
+              IsOkAndHolds(values::Int64(12)));
+  EXPECT_THAT(expr.Execute({{"s", values::String("abc")}}),
+              IsOkAndHolds(values::NullInt64()));
+}
+
+TEST(PreparedExpressionTest, NumericStringAndDate) {
+  AnalyzerOptions options;
+  options.mutable_language()->EnableLanguageFeature(FEATURE_NUMERIC_TYPE);
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("n", types::NumericType()));
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("s", types::StringType()));
+  ZETASQL_ASSERT_OK(options.AddExpressionColumn("d", types::DateType()));
+
+  PreparedExpression numeric_expr("n * n - n");
+  ZETASQL_ASSERT_OK(numeric_expr.Prepare(options));
+  EXPECT_THAT(numeric_expr.Execute({{"n", values::Numeric(3)}}),
+              IsOkAndHolds(values::Numeric(6)));
+
+  PreparedExpression string_expr("s < 'm' OR s IS NULL");
+  ZETASQL_ASSERT_OK(string_expr.Prepare(options));
+  EXPECT_THAT(string_expr.Execute({{"s", values::String("abc")}}),
+              IsOkAndHolds(values::True()));
+  EXPECT_THAT(string_expr.Execute({{"s", values::String("xyz")}}),
+              IsOkAndHolds(values::False()));
+  EXPECT_THAT(string_expr.Execute({{"s", values::NullString()}}),
+              IsOkAndHolds(values::True()));
+
+  PreparedExpression date_expr("EXTRACT(YEAR FROM d)");
+  ZETASQL_ASSERT_OK(date_expr.Prepare(options));
+  // 2019-01-01 is 17897 days after the epoch.
+  EXPECT_THAT(date_expr.Execute({{"d", values::Date(17897)}}),
+              IsOkAndHolds(values::Int64(2019)));
+}
+
+TEST(PreparedExpressionTest, UnsupportedExpression) {
+  PreparedExpression expr("CONCAT('a', 'b')");
+  EXPECT_THAT(expr.Prepare(AnalyzerOptions()),
+              StatusIs(zetasql_base::StatusCode::kUnimplemented));
+}
+
+}  // namespace zetasql
@@ -472,6 +472,7 @@ class FunctionSignatureOptions {
     constraints_ = argument_constraints;
     return *this;
   }
+  bool has_constraints() const { return constraints_ != nullptr; }
 
   // Setter/getter for whether this is a deprecated function signature. If so,
   // the analyzer will generate a deprecation warning if this signature is used
@@ -691,6 +692,10 @@ class FunctionSignature {
   bool CheckArgumentConstraints(
       const std::vector<InputArgumentType>& arguments) const;
 
+  // Returns true if this signature has a constraints callback, whose result
+  // may depend on more than the types of the arguments.
+  bool HasArgumentConstraints() const { return options_.has_constraints(); }
+
   // If verbose is true, include FunctionOptions modifiers.
   std::string DebugString(const std::string& function_name = "",
                      bool verbose = false) const;
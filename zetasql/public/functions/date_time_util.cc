@@ -2058,6 +2058,29 @@ zetasql_base::Status ConvertTimestampToString(absl::Time input, TimestampScale s
   return ConvertTimestampToString(input, scale, timezone, output);
 }
 
+namespace {
+
+// Process-wide cache of the time zones returned by MakeTimeZone(), for both
+// named zones and parsed offsets. absl::LoadTimeZone() requires a
+// std::string and takes a global lock, which is noticeable when a time zone
+// is given per row. Invalid time zones are never cached.
+date_time_util_internal::TimeZoneCache* GetTimeZoneCache() {
+  static auto* cache = new date_time_util_internal::TimeZoneCache;
+  return cache;
+}
+
+}  // namespace
+
+TimeZoneCacheStats GetTimeZoneCacheStats() {
+  const date_time_util_internal::TimeZoneCache* cache = GetTimeZoneCache();
+  TimeZoneCacheStats stats;
+  stats.hits = cache->hits();
+  stats.misses = cache->misses();
+  stats.entries = cache->entries();
+  stats.evictions = cache->evictions();
+  return stats;
+}
+
 zetasql_base::Status MakeTimeZone(absl::string_view timezone_string,
                           absl::TimeZone* timezone) {
   // An empty time zone is an error.  There is no inherent default.
@@ -2065,6 +2088,11 @@ zetasql_base::Status MakeTimeZone(absl::string_view timezone_string,
     return MakeEvalError() << "Invalid empty time zone";
   }
 
+  date_time_util_internal::TimeZoneCache* cache = GetTimeZoneCache();
+  if (cache->Lookup(timezone_string, timezone)) {
+    return ::zetasql_base::OkStatus();
+  }
+
   // First try to parse the time zone as of the canonical form (+HH:MM) since
   // that is not supported by the time library.
   char timezone_sign;
@@ -2078,6 +2106,7 @@ zetasql_base::Status MakeTimeZone(absl::string_view timezone_string,
       return MakeEvalError() << "Invalid time zone: " << timezone_string;
     }
     *timezone = absl::FixedTimeZone(seconds_offset);
+    cache->Insert(timezone_string, *timezone);
     return ::zetasql_base::OkStatus();
   }
 
@@ -2087,6 +2116,7 @@ zetasql_base::Status MakeTimeZone(absl::string_view timezone_string,
   if (!absl::LoadTimeZone(std::string(timezone_string), timezone)) {
     return MakeEvalError() << "Invalid time zone: " << timezone_string;
   }
+  cache->Insert(timezone_string, *timezone);
   return ::zetasql_base::OkStatus();
 }
 
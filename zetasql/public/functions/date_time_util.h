@@ -94,9 +94,25 @@ ABSL_MUST_USE_RESULT bool IsValidTime(absl::Time time);
 // Named time zones are loaded from the system's zoneinfo directory (typically
 // /usr/share/zoneinfo, /usr/share/lib/zoneinfo, etc.).  As per the base/time
 // library, time zone names are case sensitive.
+//
+// Time zones are cached process-wide, so repeated calls with the same
+// <timezone_string> do not reload the zone.
 zetasql_base::Status MakeTimeZone(absl::string_view timezone_string,
                           absl::TimeZone* timezone);
 
+// Counters for the time zone cache used by MakeTimeZone(). Calls with an
+// empty time zone are not counted.
+struct TimeZoneCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  // Time zones currently cached, not counting the few common zones that are
+  // always available.
+  int64_t entries = 0;
+  // Cached time zones that were dropped to make room for others.
+  int64_t evictions = 0;
+};
+TimeZoneCacheStats GetTimeZoneCacheStats();
+
 // Creates a absl::Time from an int64_t based timestamp value.
 ABSL_MUST_USE_RESULT absl::Time MakeTime(int64_t timestamp, TimestampScale scale);
 
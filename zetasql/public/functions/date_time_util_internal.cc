@@ -18,6 +18,8 @@
 
 #include "zetasql/base/logging.h"
 
+#include "absl/base/macros.h"
+#include "absl/hash/hash.h"
 #include "absl/time/civil_time.h"
 
 namespace zetasql {
@@ -59,6 +61,99 @@ int GetIsoWeek(absl::CivilDay day) {
   return static_cast<int>(iso_week);
 }
 
+namespace {
+
+// Time zones that dominate real traffic, which TimeZoneCache checks first.
+constexpr absl::string_view kHotTimeZoneNames[] = {
+    "UTC",
+    "America/Los_Angeles",
+    "America/New_York",
+    "America/Chicago",
+    "Europe/London",
+    "Europe/Berlin",
+    "Asia/Tokyo",
+    "Asia/Kolkata",
+};
+constexpr int kNumHotTimeZones = ABSL_ARRAYSIZE(kHotTimeZoneNames);
+
+}  // namespace
+
+TimeZoneCache::TimeZoneCache(int num_shards, int max_entries_per_shard)
+    : num_shards_(num_shards),
+      max_entries_per_shard_(max_entries_per_shard),
+      hot_zones_(new HotZone[kNumHotTimeZones]),
+      shards_(new Shard[num_shards]) {
+  DCHECK_GT(num_shards, 0);
+  DCHECK_GT(max_entries_per_shard, 0);
+}
+
+bool TimeZoneCache::Lookup(absl::string_view name, absl::TimeZone* timezone) {
+  for (int i = 0; i < kNumHotTimeZones; ++i) {
+    if (kHotTimeZoneNames[i] == name) {
+      HotZone& hot_zone = hot_zones_[i];
+      absl::call_once(hot_zone.once, [&hot_zone, i] {
+        hot_zone.loaded = absl::LoadTimeZone(std::string(kHotTimeZoneNames[i]),
+                                             &hot_zone.zone);
+      });
+      if (!hot_zone.loaded) break;
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      *timezone = hot_zone.zone;
+      return true;
+    }
+  }
+  Shard& shard = GetShard(name);
+  {
+    absl::ReaderMutexLock lock(&shard.mutex);
+    auto it = shard.index.find(name);
+    if (it != shard.index.end()) {
+      Entry& entry = *shard.entries[it->second];
+      // Avoid dirtying the cache line when the bit is already set.
+      if (!entry.referenced.load(std::memory_order_relaxed)) {
+        entry.referenced.store(true, std::memory_order_relaxed);
+      }
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      *timezone = entry.zone;
+      return true;
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void TimeZoneCache::Insert(absl::string_view name, absl::TimeZone timezone) {
+  Shard& shard = GetShard(name);
+  absl::MutexLock lock(&shard.mutex);
+  if (shard.index.contains(name)) return;
+  if (shard.entries.size() < max_entries_per_shard_) {
+    shard.entries.emplace_back(new Entry);
+    Entry& entry = *shard.entries.back();
+    entry.name = std::string(name);
+    entry.zone = timezone;
+    shard.index.emplace(entry.name, shard.entries.size() - 1);
+    entries_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  // Advance the clock hand, giving referenced entries a second chance, until
+  // it reaches one that was not looked up since it was last passed. This
+  // takes at most one full turn.
+  while (true) {
+    const int slot = shard.clock_hand;
+    shard.clock_hand = (slot + 1) % shard.entries.size();
+    Entry& entry = *shard.entries[slot];
+    if (entry.referenced.exchange(false, std::memory_order_relaxed)) continue;
+    shard.index.erase(entry.name);
+    entry.name = std::string(name);
+    entry.zone = timezone;
+    shard.index.emplace(entry.name, slot);
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+}
+
+TimeZoneCache::Shard& TimeZoneCache::GetShard(absl::string_view name) {
+  return shards_[absl::Hash<absl::string_view>()(name) % num_shards_];
+}
+
 }  // namespace date_time_util_internal
 }  // namespace functions
 }  // namespace zetasql
@@ -17,7 +17,20 @@
 #ifndef ZETASQL_PUBLIC_FUNCTIONS_DATE_TIME_UTIL_INTERNAL_H_
 #define ZETASQL_PUBLIC_FUNCTIONS_DATE_TIME_UTIL_INTERNAL_H_
 
+#include <stddef.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/call_once.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/civil_time.h"
+#include "absl/time/time.h"
 
 namespace zetasql {
 namespace functions {
@@ -74,6 +87,75 @@ absl::civil_year_t GetIsoYear(absl::CivilDay day);
 // inclusive.
 int GetIsoWeek(absl::CivilDay day);
 
+// A thread-safe cache of time zones by name, used by MakeTimeZone().
+//
+// A few zones that dominate real traffic are checked first without taking
+// any lock. Other zones live in a sharded map guarded by reader locks. Each
+// shard holds at most <max_entries_per_shard> zones; once a shard is full,
+// Insert() evicts an entry that has not been looked up since the clock hand
+// last passed it (the CLOCK approximation of LRU). Lookups only set a
+// per-entry bit, so they keep sharing the reader lock.
+class TimeZoneCache {
+ public:
+  static constexpr int kDefaultNumShards = 16;
+  static constexpr int kDefaultMaxEntriesPerShard = 256;
+
+  explicit TimeZoneCache(
+      int num_shards = kDefaultNumShards,
+      int max_entries_per_shard = kDefaultMaxEntriesPerShard);
+  TimeZoneCache(const TimeZoneCache&) = delete;
+  TimeZoneCache& operator=(const TimeZoneCache&) = delete;
+
+  // Returns true and sets <*timezone> if <name> is cached.
+  bool Lookup(absl::string_view name, absl::TimeZone* timezone);
+
+  // Caches <timezone> as <name>, evicting another entry of the same shard if
+  // that is full. Does nothing if <name> is already cached.
+  void Insert(absl::string_view name, absl::TimeZone timezone);
+
+  int64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  int64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+  // Time zones currently cached, not counting the common zones.
+  int64_t entries() const { return entries_.load(std::memory_order_relaxed); }
+  int64_t evictions() const {
+    return evictions_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct HotZone {
+    absl::once_flag once;
+    bool loaded = false;
+    absl::TimeZone zone;
+  };
+
+  struct Entry {
+    std::string name;
+    absl::TimeZone zone;
+    // Set by lookups, cleared as the clock hand passes.
+    std::atomic<bool> referenced{false};
+  };
+
+  struct Shard {
+    absl::Mutex mutex;
+    // Keys point into the names of <entries>.
+    absl::flat_hash_map<absl::string_view, int> index GUARDED_BY(mutex);
+    std::vector<std::unique_ptr<Entry>> entries GUARDED_BY(mutex);
+    int clock_hand GUARDED_BY(mutex) = 0;
+  };
+
+  Shard& GetShard(absl::string_view name);
+
+  const int num_shards_;
+  const int max_entries_per_shard_;
+  std::unique_ptr<HotZone[]> hot_zones_;
+  std::unique_ptr<Shard[]> shards_;
+
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  std::atomic<int64_t> entries_{0};
+  std::atomic<int64_t> evictions_{0};
+};
+
 }  // namespace date_time_util_internal
 }  // namespace functions
 }  // namespace zetasql
@@ -16,9 +16,12 @@
 
 #include "zetasql/public/functions/date_time_util_internal.h"
 
+#include <string>
+
 #include "gtest/gtest.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/civil_time.h"
+#include "absl/time/time.h"
 
 namespace zetasql {
 namespace functions {
@@ -109,6 +112,59 @@ TEST_P(IsoWeekTest, ISOWeekNumberTest) {
 INSTANTIATE_TEST_SUITE_P(IsoWeekTests, IsoWeekTest,
                          ::testing::ValuesIn(kIsoWeekTestCases));
 
+TEST(TimeZoneCacheTest, HitsAndMisses) {
+  TimeZoneCache cache;
+  absl::TimeZone timezone;
+  EXPECT_FALSE(cache.Lookup("+01:00", &timezone));
+  EXPECT_EQ(1, cache.misses());
+  cache.Insert("+01:00", absl::FixedTimeZone(3600));
+  EXPECT_EQ(1, cache.entries());
+  ASSERT_TRUE(cache.Lookup("+01:00", &timezone));
+  EXPECT_EQ(absl::FixedTimeZone(3600), timezone);
+  EXPECT_EQ(1, cache.hits());
+
+  // Inserting a cached name again changes nothing.
+  cache.Insert("+01:00", absl::FixedTimeZone(7200));
+  EXPECT_EQ(1, cache.entries());
+  ASSERT_TRUE(cache.Lookup("+01:00", &timezone));
+  EXPECT_EQ(absl::FixedTimeZone(3600), timezone);
+
+  // Common zones are available without being inserted.
+  ASSERT_TRUE(cache.Lookup("UTC", &timezone));
+  EXPECT_EQ(absl::UTCTimeZone(), timezone);
+  EXPECT_EQ(3, cache.hits());
+  EXPECT_EQ(1, cache.misses());
+  EXPECT_EQ(1, cache.entries());
+  EXPECT_EQ(0, cache.evictions());
+}
+
+TEST(TimeZoneCacheTest, FullShardEvictsUnreferencedEntries) {
+  TimeZoneCache cache(/*num_shards=*/1, /*max_entries_per_shard=*/2);
+  absl::TimeZone timezone;
+  cache.Insert("+01", absl::FixedTimeZone(3600));
+  cache.Insert("+02", absl::FixedTimeZone(7200));
+  ASSERT_TRUE(cache.Lookup("+01", &timezone));
+
+  // "+01" was looked up, so "+02" makes room for "+03".
+  cache.Insert("+03", absl::FixedTimeZone(10800));
+  EXPECT_EQ(2, cache.entries());
+  EXPECT_EQ(1, cache.evictions());
+  EXPECT_TRUE(cache.Lookup("+01", &timezone));
+  EXPECT_FALSE(cache.Lookup("+02", &timezone));
+  ASSERT_TRUE(cache.Lookup("+03", &timezone));
+  EXPECT_EQ(absl::FixedTimeZone(10800), timezone);
+
+  // A full shard keeps caching new zones.
+  for (int i = 4; i <= 12; ++i) {
+    const std::string name = absl::StrCat("+", i);
+    cache.Insert(name, absl::FixedTimeZone(i * 3600));
+    ASSERT_TRUE(cache.Lookup(name, &timezone)) << name;
+    EXPECT_EQ(absl::FixedTimeZone(i * 3600), timezone);
+  }
+  EXPECT_EQ(2, cache.entries());
+  EXPECT_EQ(10, cache.evictions());
+}
+
 }  // namespace date_time_util_internal
 }  // namespace functions
 }  // namespace zetasql
@@ -221,6 +221,8 @@ class NumericValue final {
   };
 
  private:
+  friend class Value;  // Stores small values inline and rebuilds them.
+
   NumericValue(uint64_t high_bits, uint64_t low_bits);
   explicit constexpr NumericValue(__int128 value);
 
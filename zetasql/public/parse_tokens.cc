@@ -17,9 +17,11 @@
 #include "zetasql/public/parse_tokens.h"
 
 #include <ctype.h>
+#include <algorithm>
 #include <memory>
 #include <utility>
 
+#include "zetasql/base/endian.h"
 #include "zetasql/base/logging.h"
 #include "zetasql/common/errors.h"
 #include "zetasql/parser/bison_parser.bison.h"
@@ -34,6 +36,7 @@
 #include "absl/strings/ascii.h"
 #include "zetasql/base/case.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "zetasql/base/ret_check.h"
 #include "zetasql/base/status.h"
 #include "zetasql/base/status_macros.h"
@@ -289,11 +292,240 @@ zetasql_base::Status GetParseTokens(const ParseTokenOptions& options,
   return ::zetasql_base::OkStatus();
 }
 
+// Returns the MurmurHash3_x64_128 hash of <data>, with seed 0. absl::Hash is
+// not used because fingerprints must be stable across processes.
+static StatementFingerprint Fingerprint128(absl::string_view data) {
+  constexpr uint64_t kC1 = 0x87c37b91114253d5ULL;
+  constexpr uint64_t kC2 = 0x4cf5ad432745937fULL;
+  const auto rotl = [](uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  };
+  const auto fmix = [](uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+  };
+
+  const char* p = data.data();
+  const size_t num_blocks = data.size() / 16;
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+  for (size_t i = 0; i < num_blocks; ++i, p += 16) {
+    uint64_t k1 = zetasql_base::LittleEndian::Load64(p);
+    uint64_t k2 = zetasql_base::LittleEndian::Load64(p + 8);
+    k1 *= kC1;
+    k1 = rotl(k1, 31);
+    k1 *= kC2;
+    h1 ^= k1;
+    h1 = rotl(h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52dce729;
+    k2 *= kC2;
+    k2 = rotl(k2, 33);
+    k2 *= kC1;
+    h2 ^= k2;
+    h2 = rotl(h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  const size_t tail_size = data.size() % 16;
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  for (size_t i = 0; i < tail_size; ++i) {
+    const uint64_t byte = static_cast<uint8_t>(p[i]);
+    if (i < 8) {
+      k1 |= byte << (i * 8);
+    } else {
+      k2 |= byte << ((i - 8) * 8);
+    }
+  }
+  if (tail_size > 8) {
+    k2 *= kC2;
+    k2 = rotl(k2, 33);
+    k2 *= kC1;
+    h2 ^= k2;
+  }
+  if (tail_size > 0) {
+    k1 *= kC1;
+    k1 = rotl(k1, 31);
+    k1 *= kC2;
+    h1 ^= k1;
+  }
+
+  h1 ^= data.size();
+  h2 ^= data.size();
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  h1 += h2;
+  h2 += h1;
+
+  StatementFingerprint fingerprint;
+  fingerprint.high = h1;
+  fingerprint.low = h2;
+  return fingerprint;
+}
+
+// Appends a token to the normalized form of a statement. The text is
+// length-prefixed so that different token sequences can't produce the same
+// normalized form.
+static void AppendNormalizedToken(char tag, absl::string_view text,
+                                  std::string* normalized) {
+  absl::StrAppend(normalized, absl::string_view(&tag, 1), text.size(), ":",
+                  text);
+}
+
+std::string StatementFingerprint::DebugString() const {
+  return absl::StrFormat("%016x%016x", high, low);
+}
+
+zetasql_base::Status GetLiteralNormalizedFingerprint(
+    absl::string_view sql, StatementFingerprint* fingerprint) {
+  using zetasql_bison_parser::BisonParserImpl;
+
+  auto tokenizer = absl::make_unique<parser::ZetaSqlFlexTokenizer>(
+      parser::BisonParserMode::kTokenizer, /*filename=*/"", sql,
+      /*start_offset=*/0);
+
+  std::string normalized;
+  normalized.reserve(sql.size());
+  int paren_depth = 0;
+  // Depth of "{" inside a hint, or 0 outside of hints.
+  int hint_depth = 0;
+  bool after_integer_hint = false;
+  // Paren depths of the enclosing GROUP BY, ORDER BY and PARTITION BY lists,
+  // innermost last.
+  std::vector<int> by_list_depths;
+  bool at_by_list_item = false;
+  // Semicolons are only added when followed by another token, so trailing
+  // semicolons are ignored.
+  bool pending_semicolon = false;
+
+  ParseLocationRange location;
+  while (true) {
+    int bison_token;
+    ZETASQL_RETURN_IF_ERROR(ConvertInternalErrorLocationToExternal(
+        tokenizer->GetNextToken(&location /* input and output */, &bison_token),
+        sql));
+    if (bison_token == 0 /* EOF */) {
+      break;
+    }
+    const absl::string_view image = absl::ClippedSubstr(
+        sql, location.start().GetByteOffset(),
+        location.end().GetByteOffset() - location.start().GetByteOffset());
+    if (pending_semicolon) {
+      AppendNormalizedToken('k', ";", &normalized);
+      pending_semicolon = false;
+    }
+
+    bool starts_by_list_item = false;
+    switch (bison_token) {
+      case ';':
+        pending_semicolon = true;
+        paren_depth = 0;
+        hint_depth = 0;
+        by_list_depths.clear();
+        break;
+
+      case BisonParserImpl::token::STRING_LITERAL:
+      case BisonParserImpl::token::BYTES_LITERAL:
+      case BisonParserImpl::token::FLOATING_POINT_LITERAL:
+      case BisonParserImpl::token::INTEGER_LITERAL: {
+        const bool is_integer =
+            bison_token == BisonParserImpl::token::INTEGER_LITERAL;
+        if (hint_depth > 0 || (is_integer && after_integer_hint) ||
+            (is_integer && at_by_list_item)) {
+          // Hint values and ordinals are part of the statement's shape.
+          AppendNormalizedToken('v', image, &normalized);
+        } else if (is_integer) {
+          Value value;
+          if (!Value::ParseInteger(image, &value)) {
+            return ConvertInternalErrorLocationToExternal(
+                MakeSqlErrorAtPoint(location.start())
+                    << "Invalid integer literal: " << image,
+                sql);
+          }
+          AppendNormalizedToken(
+              'l', value.type_kind() == TYPE_INT64 ? "INT64" : "UINT64",
+              &normalized);
+        } else if (bison_token == BisonParserImpl::token::STRING_LITERAL) {
+          AppendNormalizedToken('l', "STRING", &normalized);
+        } else if (bison_token == BisonParserImpl::token::BYTES_LITERAL) {
+          AppendNormalizedToken('l', "BYTES", &normalized);
+        } else {
+          AppendNormalizedToken('l', "DOUBLE", &normalized);
+        }
+        break;
+      }
+
+      case BisonParserImpl::token::IDENTIFIER:
+        AppendNormalizedToken('i', image, &normalized);
+        break;
+
+      default: {
+        const parser::KeywordInfo* keyword_info =
+            parser::GetKeywordInfoForBisonToken(bison_token);
+        if (keyword_info != nullptr && !keyword_info->IsReserved()) {
+          // Non-reserved keywords may be identifiers, which are case
+          // sensitive.
+          AppendNormalizedToken('i', image, &normalized);
+          break;
+        }
+        // Symbols like "@{" and ".*" may contain whitespace.
+        std::string keyword = absl::AsciiStrToUpper(image);
+        keyword.erase(std::remove_if(keyword.begin(), keyword.end(),
+                                     absl::ascii_isspace),
+                      keyword.end());
+        AppendNormalizedToken('k', keyword, &normalized);
+
+        if (bison_token == BisonParserImpl::token::KW_OPEN_HINT) {
+          hint_depth = 1;
+        } else if (bison_token == '{' && hint_depth > 0) {
+          ++hint_depth;
+        } else if (bison_token == '}' && hint_depth > 0) {
+          --hint_depth;
+        } else if (bison_token == '(') {
+          ++paren_depth;
+        } else if (bison_token == ')') {
+          --paren_depth;
+          while (!by_list_depths.empty() &&
+                 by_list_depths.back() > paren_depth) {
+            by_list_depths.pop_back();
+          }
+        } else if (bison_token == ',') {
+          starts_by_list_item = !by_list_depths.empty() &&
+                                by_list_depths.back() == paren_depth;
+        } else if (keyword == "BY") {
+          if (by_list_depths.empty() || by_list_depths.back() != paren_depth) {
+            by_list_depths.push_back(paren_depth);
+          }
+          starts_by_list_item = true;
+        } else if (keyword == "SELECT" && !by_list_depths.empty() &&
+                   by_list_depths.back() == paren_depth) {
+          by_list_depths.pop_back();
+        }
+        break;
+      }
+    }
+    after_integer_hint =
+        bison_token == BisonParserImpl::token::KW_OPEN_INTEGER_HINT;
+    at_by_list_item = starts_by_list_item;
+  }
+
+  *fingerprint = Fingerprint128(normalized);
+  return ::zetasql_base::OkStatus();
+}
+
 std::string ParseToken::GetKeyword() const {
   if (kind_ == KEYWORD) {
     return absl::AsciiStrToUpper(GetImage());
   } else if (kind_ == IDENTIFIER_OR_KEYWORD) {
-    return absl::AsciiStrToUpper(value_.string_value());
+    return absl::AsciiStrToUpper(value_.string_view_value());
   } else {
     return "";
   }
@@ -301,7 +533,7 @@ std::string ParseToken::GetKeyword() const {
 
 std::string ParseToken::GetIdentifier() const {
   if (kind_ == IDENTIFIER || kind_ == IDENTIFIER_OR_KEYWORD) {
-    return value_.string_value();
+    return std::string(value_.string_view_value());
   } else {
     return "";
   }
@@ -321,11 +553,11 @@ std::string ParseToken::GetSQL() const {
       return absl::AsciiStrToUpper(GetImage());
     case IDENTIFIER_OR_KEYWORD:
     case IDENTIFIER:
-      return ToIdentifierLiteral(value_.string_value());
+      return ToIdentifierLiteral(value_.string_view_value());
     case VALUE:
       return value_.GetSQL();
     case COMMENT:
-      return value_.string_value();
+      return std::string(value_.string_view_value());
     case END_OF_INPUT:
       return "";
   }
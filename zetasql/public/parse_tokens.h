@@ -17,7 +17,9 @@
 #ifndef ZETASQL_PUBLIC_PARSE_TOKENS_H_
 #define ZETASQL_PUBLIC_PARSE_TOKENS_H_
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/parse_location.h"
@@ -204,6 +206,52 @@ zetasql_base::Status GetParseTokens(const ParseTokenOptions& options,
                             ParseResumeLocation* resume_location,
                             std::vector<ParseToken>* tokens);
 
+// A 128-bit fingerprint of the literal-normalized form of a statement,
+// computed by GetLiteralNormalizedFingerprint().
+struct StatementFingerprint {
+  uint64_t high = 0;
+  uint64_t low = 0;
+
+  bool operator==(const StatementFingerprint& other) const {
+    return high == other.high && low == other.low;
+  }
+  bool operator!=(const StatementFingerprint& other) const {
+    return !(*this == other);
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const StatementFingerprint& fingerprint) {
+    return H::combine(std::move(h), fingerprint.high, fingerprint.low);
+  }
+
+  // Returns the fingerprint as 32 hex digits.
+  std::string DebugString() const;
+};
+
+// Computes a fingerprint of <sql> from its tokens, without parsing or
+// analyzing it. This is intended as a cache key for callers that cache
+// analyzed statements, so that statements that differ only in the values of
+// their literals share an entry.
+//
+// The fingerprint ignores whitespace, comments, the case of keywords and
+// trailing semicolons. STRING, BYTES, INT64, UINT64 and DOUBLE literals
+// (see ParseToken::GetValue) are replaced by a placeholder for their type,
+// except for
+// * integer literals that start an item in a GROUP BY, ORDER BY or
+//   PARTITION BY list, which may be ordinals, and
+// * literals inside hints,
+// which are kept as written. Identifiers are case sensitive, since they may
+// name output columns.
+//
+// The fingerprint is stable across processes and platforms. Statements with
+// equal fingerprints may still analyze differently, e.g. when a string literal
+// is coerced to a DATE and is not a valid date, so callers must still validate
+// the literal values they bind.
+//
+// Returns an error if <sql> can't be tokenized.
+zetasql_base::Status GetLiteralNormalizedFingerprint(
+    absl::string_view sql, StatementFingerprint* fingerprint);
+
 }  // namespace zetasql
 
 #endif  // ZETASQL_PUBLIC_PARSE_TOKENS_H_
@@ -226,4 +226,81 @@ TEST(GetNextTokensTest, LocationsWithCommentsForNonCommentTokens) {
               IsOkAndHolds(std::make_pair(6, 1)));
 }
 
+static StatementFingerprint Fingerprint(const std::string& sql) {
+  StatementFingerprint fingerprint;
+  ZETASQL_CHECK_OK(GetLiteralNormalizedFingerprint(sql, &fingerprint));
+  return fingerprint;
+}
+
+TEST(GetLiteralNormalizedFingerprintTest, IgnoresLiteralValues) {
+  const StatementFingerprint fingerprint =
+      Fingerprint("SELECT * FROM t WHERE id = 5 AND name = 'a'");
+  EXPECT_EQ(fingerprint,
+            Fingerprint("select *\nFROM t -- comment\n"
+                        "WHERE id = 6 AND name = \"bcd\";"));
+  EXPECT_EQ(fingerprint,
+            Fingerprint("SELECT * FROM t WHERE id = 0x10 AND name = r'x'"));
+  EXPECT_EQ(32, fingerprint.DebugString().size());
+
+  // Literals of different types, identifiers with a different case, and
+  // different shapes all change the fingerprint.
+  EXPECT_NE(fingerprint,
+            Fingerprint("SELECT * FROM t WHERE id = 5.0 AND name = 'a'"));
+  EXPECT_NE(fingerprint,
+            Fingerprint("SELECT * FROM t WHERE id = 5 AND name = b'a'"));
+  EXPECT_NE(fingerprint,
+            Fingerprint("SELECT * FROM t WHERE ID = 5 AND name = 'a'"));
+  EXPECT_NE(fingerprint,
+            Fingerprint("SELECT * FROM t WHERE id = 5 OR name = 'a'"));
+  EXPECT_NE(fingerprint,
+            Fingerprint("SELECT * FROM t WHERE id = @p AND name = 'a'"));
+  EXPECT_NE(Fingerprint("SELECT 1"),
+            Fingerprint("SELECT 18446744073709551615"));
+  EXPECT_NE(Fingerprint("SELECT 1"), Fingerprint("SELECT 1; SELECT 1"));
+}
+
+TEST(GetLiteralNormalizedFingerprintTest, KeepsOrdinalsAndHints) {
+  EXPECT_NE(Fingerprint("SELECT a, b FROM t ORDER BY 1"),
+            Fingerprint("SELECT a, b FROM t ORDER BY 2"));
+  EXPECT_NE(Fingerprint("SELECT a, b, COUNT(*) FROM t GROUP BY 1, 2"),
+            Fingerprint("SELECT a, b, COUNT(*) FROM t GROUP BY 1, 3"));
+  const std::string prefix =
+      "SELECT a, b FROM t GROUP BY (SELECT 1 ORDER BY c)";
+  EXPECT_NE(Fingerprint(absl::StrCat(prefix, ", 1")),
+            Fingerprint(absl::StrCat(prefix, ", 2")));
+  EXPECT_NE(Fingerprint("SELECT @{hint=1} a FROM t"),
+            Fingerprint("SELECT @{hint=2} a FROM t"));
+  EXPECT_NE(Fingerprint("SELECT a FROM t JOIN @5 u USING (a)"),
+            Fingerprint("SELECT a FROM t JOIN @6 u USING (a)"));
+
+  // Other literals in these clauses are still normalized.
+  EXPECT_EQ(Fingerprint("SELECT a FROM t ORDER BY a + 1 LIMIT 10"),
+            Fingerprint("SELECT a FROM t ORDER BY a + 2 LIMIT 20"));
+  EXPECT_EQ(Fingerprint("SELECT @{hint=1} a FROM t WHERE a > 1"),
+            Fingerprint("SELECT @{hint=1} a FROM t WHERE a > 2"));
+}
+
+// Fingerprints are meant to be stored and compared across processes and
+// releases, so changes to the normalized form or to the hash are visible here.
+TEST(GetLiteralNormalizedFingerprintTest, KnownAnswer) {
+  // Normalized to "k6:SELECTl5:INT64", one block plus a 1 byte tail.
+  StatementFingerprint fingerprint = Fingerprint("SELECT 1");
+  EXPECT_EQ(0x2e62b823bc85ff4bULL, fingerprint.high);
+  EXPECT_EQ(0xf6e4821b22429bf9ULL, fingerprint.low);
+  EXPECT_EQ("2e62b823bc85ff4bf6e4821b22429bf9", fingerprint.DebugString());
+  EXPECT_EQ(fingerprint, Fingerprint("select 42;"));
+
+  // Normalized to "k6:SELECTi2:abk4:FROMi1:t", one block plus a 9 byte tail.
+  fingerprint = Fingerprint("SELECT ab FROM t");
+  EXPECT_EQ(0x153e9a9da5c06d1eULL, fingerprint.high);
+  EXPECT_EQ(0x19abd4c03d30bc4cULL, fingerprint.low);
+}
+
+TEST(GetLiteralNormalizedFingerprintTest, Errors) {
+  StatementFingerprint fingerprint;
+  EXPECT_THAT(GetLiteralNormalizedFingerprint("SELECT 'abc", &fingerprint),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument,
+                       HasSubstr("Syntax error")));
+}
+
 }  // namespace zetasql
@@ -16,6 +16,7 @@
 
 #include "zetasql/public/proto_util.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -839,14 +840,273 @@ static zetasql_base::StatusOr<Value> ReadSingularProtoField(
 
 namespace {
 
-// Maps a tag number to all ProtoFieldInfos indexes with that tag number.
-using FieldInfoMap = absl::flat_hash_map<int, std::vector<int>>;
-
 // Maps a ProtoFieldInfo (by its index) to the corresponding Values we have
 // seen for it, with errors for failure to convert wire values to the
 // appropriate FieldFormats.
 using ElementValueList = std::vector<std::vector<zetasql_base::StatusOr<Value>>>;
 
+// Reads the (tag, value) pairs in <bytes> for ReadProtoFields() and
+// ProtoFieldReader. <find_field_indexes> maps a tag number to the indexes of
+// the requested fields with that tag number, or NULL if there are none.
+// <element_types> has the element type of each requested field that doesn't
+// read the has bit. The values read for field i are appended to
+// (*element_value_list)[i], which must be empty.
+//
+// If <num_tags_to_find> is positive, it is the number of distinct requested
+// tag numbers, and the scan stops as soon as all of them have been seen.
+template <typename FindFieldIndexes>
+zetasql_base::Status ReadFieldElements(
+    const std::string& bytes, absl::Span<const ProtoFieldInfo* const> field_infos,
+    absl::Span<const Type* const> element_types,
+    const FindFieldIndexes& find_field_indexes, int num_tags_to_find,
+    ElementValueList* element_value_list) {
+  uint32_t tag_and_type;
+  google::protobuf::io::ArrayInputStream stream(bytes.data(), bytes.size());
+  google::protobuf::io::CodedInputStream in(&stream);
+  while (0 < (tag_and_type = in.ReadTag())) {
+    const int tag_number = WireFormatLite::GetTagFieldNumber(tag_and_type);
+    const std::vector<int>* info_idxs = find_field_indexes(tag_number);
+    if (info_idxs == nullptr) {
+      if (ABSL_PREDICT_TRUE(WireFormatLite::SkipField(&in, tag_and_type))) {
+        continue;
+      }
+      return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+             << "Corrupted protocol buffer: "
+             << "Failed to skip field with tag number " << tag_number << " in "
+             << field_infos[0]->descriptor->containing_type()->full_name();
+    }
+    // All of the field descriptors must come from the same
+    // google::protobuf::Descriptor, so for a particular tag number, they are all the
+    // same.
+    ZETASQL_RET_CHECK(!info_idxs->empty());
+    const google::protobuf::FieldDescriptor* descriptor =
+        field_infos[(*info_idxs)[0]]->descriptor;
+
+    PackedValuesVector wire_values;
+    // Protocol buffer parsers must be able to parse repeated fields that were
+    // compiled as packed as if they were not packed, and vice versa.  Both
+    // packed and non-packed field occurrences may appear within the same
+    // message.
+    if (descriptor->is_packable() && IsPackedWireType(tag_and_type)) {
+      if (ABSL_PREDICT_FALSE(!ReadPackedWireValues(
+              descriptor->number(), descriptor->type(), &in, &wire_values))) {
+        return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+               << "Corrupted protocol buffer: "
+               << "Failed to read packed elements for field "
+               << descriptor->full_name();
+      }
+    } else {
+      WireValueType wire_value;
+      if (ABSL_PREDICT_FALSE(!ReadWireValue(descriptor->type(), tag_and_type,
+                                            bytes, &in, &wire_value))) {
+        return zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+               << "Corrupted protocol buffer: Failed to read value for field "
+               << descriptor->full_name();
+      }
+      wire_values.push_back(std::move(wire_value));
+    }
+    ZETASQL_RET_CHECK(!wire_values.empty());
+
+    // Every requested field adds at least one element the first time its tag
+    // is seen.
+    if ((*element_value_list)[(*info_idxs)[0]].empty()) {
+      --num_tags_to_find;
+    }
+    for (const int idx : *info_idxs) {
+      const ProtoFieldInfo& info = *field_infos[idx];
+      std::vector<zetasql_base::StatusOr<Value>>& elements = (*element_value_list)[idx];
+
+      if (info.get_has_bit) {
+        if (elements.empty()) {
+          elements.push_back(Value::Bool(true));
+        }
+      } else {
+        for (const WireValueType& wire_value : wire_values) {
+          elements.push_back(TranslateWireValue(wire_value, descriptor,
+                                                info.format,
+                                                element_types[idx]));
+        }
+      }
+    }
+    if (num_tags_to_find == 0) break;
+  }
+  return zetasql_base::OkStatus();
+}
+
+// Returns the value of the field described by <info>, given the <elements>
+// read for it by ReadFieldElements().
+zetasql_base::StatusOr<Value> MakeFieldValue(
+    const ProtoFieldInfo& info,
+    std::vector<zetasql_base::StatusOr<Value>>* elements) {
+  if (info.get_has_bit) {
+    return Value::Bool(!elements->empty());
+  }
+  if (info.type->IsArray()) {
+    std::vector<Value> element_values;
+    element_values.reserve(elements->size());
+    for (zetasql_base::StatusOr<Value>& value : *elements) {
+      if (ABSL_PREDICT_FALSE(!value.ok())) {
+        return value.status();
+      }
+      element_values.push_back(std::move(value).ValueOrDie());
+    }
+    return Value::Array(info.type->AsArray(), element_values);
+  }
+  if (elements->empty()) {
+    if (ABSL_PREDICT_FALSE(info.descriptor->is_required())) {
+      return zetasql_base::Status(zetasql_base::StatusCode::kOutOfRange,
+                          "Protocol buffer missing required field " +
+                              info.descriptor->full_name());
+    }
+    return info.default_value;
+  }
+  return std::move(elements->back());
+}
+
+// Returns the element type of <info>, or NULL if it reads the has bit.
+const Type* ElementType(const ProtoFieldInfo& info) {
+  if (info.get_has_bit) return nullptr;
+  return info.type->IsArray() ? info.type->AsArray()->element_type()
+                              : info.type;
+}
+
+}  // namespace
+
+// Tag numbers up to this bound are looked up in a vector rather than a hash
+// map by ProtoFieldReader.
+static constexpr int kMaxDenseTagNumber = 1024;
+
+zetasql_base::StatusOr<std::unique_ptr<const ProtoFieldReader>>
+ProtoFieldReader::Create(absl::Span<const ProtoFieldInfo* const> field_infos,
+                         const ProtoFieldReaderOptions& options) {
+  ZETASQL_RET_CHECK(!field_infos.empty());
+  std::unique_ptr<ProtoFieldReader> reader(new ProtoFieldReader);
+  const google::protobuf::Descriptor* containing_type =
+      field_infos[0]->descriptor->containing_type();
+  absl::flat_hash_map<int, int> tag_plan_indexes;
+  int max_tag_number = 0;
+  for (int i = 0; i < field_infos.size(); ++i) {
+    const ProtoFieldInfo& info = *field_infos[i];
+    ZETASQL_RET_CHECK(info.descriptor != nullptr);
+    ZETASQL_RET_CHECK_EQ(info.descriptor->containing_type(), containing_type)
+        << info.descriptor->full_name();
+    if (!info.get_has_bit) {
+      ZETASQL_RET_CHECK(info.type != nullptr) << info.descriptor->full_name();
+      ZETASQL_RET_CHECK_EQ(info.type->IsArray(), info.descriptor->is_repeated())
+          << info.descriptor->full_name();
+    }
+    reader->field_infos_.push_back(info);
+    reader->element_types_.push_back(ElementType(info));
+
+    const int tag_number = info.descriptor->number();
+    auto insert_result =
+        tag_plan_indexes.emplace(tag_number, reader->tag_plans_.size());
+    if (insert_result.second) {
+      reader->tag_plans_.emplace_back();
+      reader->tag_plans_.back().descriptor = info.descriptor;
+    }
+    reader->tag_plans_[insert_result.first->second].field_indexes.push_back(i);
+    max_tag_number = std::max(max_tag_number, tag_number);
+  }
+
+  if (max_tag_number <= kMaxDenseTagNumber) {
+    reader->dense_tag_plans_.resize(max_tag_number + 1, -1);
+    for (const auto& entry : tag_plan_indexes) {
+      reader->dense_tag_plans_[entry.first] = entry.second;
+    }
+  } else {
+    reader->sparse_tag_plans_ = std::move(tag_plan_indexes);
+  }
+  for (const ProtoFieldInfo& info : reader->field_infos_) {
+    reader->field_info_ptrs_.push_back(&info);
+  }
+
+  // With the option, a tag only needs to be seen once if every access to it
+  // reads the has bit, or if it is a non-repeated field.
+  reader->stop_when_all_found_ = options.stop_when_all_found;
+  for (const TagPlan& tag_plan : reader->tag_plans_) {
+    if (!reader->stop_when_all_found_) break;
+    bool only_has_bits = true;
+    for (const int i : tag_plan.field_indexes) {
+      only_has_bits &= reader->field_infos_[i].get_has_bit;
+    }
+    if (!only_has_bits && tag_plan.descriptor->is_repeated()) {
+      reader->stop_when_all_found_ = false;
+    }
+  }
+  return std::unique_ptr<const ProtoFieldReader>(std::move(reader));
+}
+
+const ProtoFieldReader::TagPlan* ProtoFieldReader::FindTagPlan(
+    int tag_number) const {
+  if (!dense_tag_plans_.empty()) {
+    if (tag_number >= dense_tag_plans_.size()) return nullptr;
+    const int index = dense_tag_plans_[tag_number];
+    return index < 0 ? nullptr : &tag_plans_[index];
+  }
+  const int* index = zetasql_base::FindOrNull(sparse_tag_plans_, tag_number);
+  return index == nullptr ? nullptr : &tag_plans_[*index];
+}
+
+zetasql_base::Status ProtoFieldReader::ReadElements(
+    const std::string& bytes, ElementValueList* element_value_list) const {
+  return ReadFieldElements(
+      bytes, field_info_ptrs_, element_types_,
+      [this](int tag_number) -> const std::vector<int>* {
+        const TagPlan* tag_plan = FindTagPlan(tag_number);
+        return tag_plan == nullptr ? nullptr : &tag_plan->field_indexes;
+      },
+      stop_when_all_found_ ? static_cast<int>(tag_plans_.size()) : -1,
+      element_value_list);
+}
+
+zetasql_base::Status ProtoFieldReader::Read(
+    const std::string& bytes, ProtoFieldValueList* field_value_list) const {
+  field_value_list->resize(field_infos_.size());
+
+  // If get_has_bit is true, this is either empty or contains a single
+  // Value::Bool(true).
+  ElementValueList element_value_list(field_infos_.size());
+  ZETASQL_RETURN_IF_ERROR(ReadElements(bytes, &element_value_list));
+
+  // Now that we have read all of the values we care about, use them to populate
+  // 'field_value_list'.
+  for (int i = 0; i < field_infos_.size(); ++i) {
+    (*field_value_list)[i] =
+        MakeFieldValue(field_infos_[i], &element_value_list[i]);
+  }
+  return zetasql_base::OkStatus();
+}
+
+zetasql_base::Status ProtoFieldReader::ReadColumns(
+    absl::Span<const std::string> rows,
+    std::vector<ProtoFieldValueList>* columns) const {
+  columns->resize(field_infos_.size());
+  for (ProtoFieldValueList& column : *columns) {
+    column.clear();
+    column.reserve(rows.size());
+  }
+
+  // Reused across rows to avoid reallocating the element vectors.
+  ElementValueList element_value_list(field_infos_.size());
+  for (const std::string& bytes : rows) {
+    for (std::vector<zetasql_base::StatusOr<Value>>& elements : element_value_list) {
+      elements.clear();
+    }
+    ZETASQL_RETURN_IF_ERROR(ReadElements(bytes, &element_value_list));
+    for (int i = 0; i < field_infos_.size(); ++i) {
+      (*columns)[i].push_back(
+          MakeFieldValue(field_infos_[i], &element_value_list[i]));
+    }
+  }
+  return zetasql_base::OkStatus();
+}
+
+namespace {
+
+// Maps a tag number to all ProtoFieldInfos indexes with that tag number.
+using FieldInfoMap = absl::flat_hash_map<int, std::vector<int>>;
+
 }  // namespace
 
 zetasql_base::Status ReadProtoFields(
@@ -864,125 +1124,34 @@ zetasql_base::Status ReadProtoFields(
   field_value_list->resize(field_infos.size());
 
   FieldInfoMap field_info_map;
+  std::vector<const Type*> element_types;
+  element_types.reserve(field_infos.size());
   for (int i = 0; i < field_infos.size(); ++i) {
     const ProtoFieldInfo* field_info = field_infos[i];
+    if (!field_info->get_has_bit) {
+      ZETASQL_RET_CHECK_EQ(field_info->type->IsArray(),
+                   field_info->descriptor->is_repeated());
+    }
     field_info_map[field_info->descriptor->number()].push_back(i);
+    element_types.push_back(ElementType(*field_info));
   }
 
   // If get_has_bit is true, this is either empty or contains a single
   // Value::Bool(true).
   ElementValueList element_value_list(field_infos.size());
   ZETASQL_RET_CHECK(!field_infos.empty());
-  const google::protobuf::FieldDescriptor* some_field = field_infos[0]->descriptor;
-    uint32_t tag_and_type;
-    google::protobuf::io::ArrayInputStream cord_stream(bytes.data(), bytes.size());
-    google::protobuf::io::CodedInputStream in(&cord_stream);
-    while (0 < (tag_and_type = in.ReadTag())) {
-      const int tag_number = WireFormatLite::GetTagFieldNumber(tag_and_type);
-      const std::vector<int>* info_idxs =
-          zetasql_base::FindOrNull(field_info_map, tag_number);
-      if (info_idxs == nullptr) {
-        if (ABSL_PREDICT_TRUE(WireFormatLite::SkipField(&in, tag_and_type))) {
-          continue;
-        }
-        return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
-               << "Corrupted protocol buffer: "
-               << "Failed to skip field with tag number " << tag_number
-               << " in " << some_field->containing_type()->full_name();
-      }
-      // All of the field descriptors must come from the same
-      // google::protobuf::Descriptor, so for a particular tag number, they are all the
-      // same.
-      ZETASQL_RET_CHECK(!info_idxs->empty());
-      const google::protobuf::FieldDescriptor* descriptor =
-          field_infos[(*info_idxs)[0]]->descriptor;
-
-      PackedValuesVector wire_values;
-      // Protocol buffer parsers must be able to parse repeated fields that were
-      // compiled as packed as if they were not packed, and vice versa.  Both
-      // packed and non-packed field occurrences may appear within the same
-      // message.
-      if (descriptor->is_packable() && IsPackedWireType(tag_and_type)) {
-        if (ABSL_PREDICT_FALSE(!ReadPackedWireValues(
-                descriptor->number(), descriptor->type(), &in, &wire_values))) {
-          return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
-                 << "Corrupted protocol buffer: "
-                 << "Failed to read packed elements for field "
-                 << descriptor->full_name();
-        }
-      } else {
-        WireValueType wire_value;
-        if (ABSL_PREDICT_FALSE(!ReadWireValue(descriptor->type(), tag_and_type,
-                                              bytes, &in, &wire_value))) {
-          return zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
-                 << "Corrupted protocol buffer: Failed to read value for field "
-                 << descriptor->full_name();
-        }
-        wire_values.push_back(std::move(wire_value));
-      }
-      ZETASQL_RET_CHECK(!wire_values.empty());
-
-      for (int i = 0; i < info_idxs->size(); ++i) {
-        const int idx = (*info_idxs)[i];
-        const ProtoFieldInfo* info = field_infos[idx];
-        std::vector<zetasql_base::StatusOr<Value>>& elements = element_value_list[idx];
-
-        if (info->get_has_bit) {
-          if (elements.empty()) {
-            elements.push_back(Value::Bool(true));
-          }
-        } else {
-          const Type* element_type = info->type->IsArray()
-                                         ? info->type->AsArray()->element_type()
-                                         : info->type;
-          for (const WireValueType& wire_value : wire_values) {
-            elements.push_back(TranslateWireValue(wire_value, descriptor,
-                                                  info->format, element_type));
-          }
-        }
-      }
-    }
+  ZETASQL_RETURN_IF_ERROR(ReadFieldElements(
+      bytes, field_infos, element_types,
+      [&field_info_map](int tag_number) {
+        return zetasql_base::FindOrNull(field_info_map, tag_number);
+      },
+      /*num_tags_to_find=*/-1, &element_value_list));
 
   // Now that we have read all of the values we care about, use them to populate
   // 'field_value_list'.
   for (int i = 0; i < field_infos.size(); ++i) {
-    const ProtoFieldInfo* info = field_infos[i];
-    std::vector<zetasql_base::StatusOr<Value>>& values = element_value_list[i];
-    if (info->get_has_bit) {
-      (*field_value_list)[i] = Value::Bool(!values.empty());
-    } else {
-      zetasql_base::StatusOr<Value> new_value;
-
-      ZETASQL_RET_CHECK_EQ(info->type->IsArray(), info->descriptor->is_repeated());
-      if (info->type->IsArray()) {
-        std::vector<Value> element_values;
-        bool success = true;
-        for (zetasql_base::StatusOr<Value>& value : values) {
-          if (ABSL_PREDICT_FALSE(!value.ok())) {
-            success = false;
-            new_value = value.status();
-            break;
-          }
-          element_values.push_back(value.ValueOrDie());
-        }
-
-        if (success) {
-          new_value = Value::Array(info->type->AsArray(), element_values);
-        }
-      } else if (values.empty()) {
-        if (ABSL_PREDICT_FALSE(info->descriptor->is_required())) {
-          new_value = zetasql_base::Status(zetasql_base::StatusCode::kOutOfRange,
-                                   "Protocol buffer missing required field " +
-                                       info->descriptor->full_name());
-        } else {
-          new_value = info->default_value;
-        }
-      } else {
-        new_value = std::move(values.back());
-      }
-
-      (*field_value_list)[i] = std::move(new_value);
-    }
+    (*field_value_list)[i] =
+        MakeFieldValue(*field_infos[i], &element_value_list[i]);
   }
 
   return zetasql_base::OkStatus();
@@ -17,6 +17,8 @@
 #ifndef ZETASQL_PUBLIC_PROTO_UTIL_H_
 #define ZETASQL_PUBLIC_PROTO_UTIL_H_
 
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "google/protobuf/descriptor.h"
@@ -25,6 +27,7 @@
 #include "zetasql/public/value.h"
 #include <cstdint>
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "zetasql/base/status.h"
 #include "zetasql/base/statusor.h"
 
@@ -117,6 +120,93 @@ zetasql_base::Status ReadProtoFields(
     const std::string& bytes,
     ProtoFieldValueList* field_value_list);
 
+// Options for ProtoFieldReader.
+struct ProtoFieldReaderOptions {
+  // If true, the reader stops scanning a proto as soon as it has found all
+  // the requested fields, unless a value of a repeated field is requested.
+  // This assumes that each non-repeated field occurs at most once, which
+  // holds for protos serialized by the proto library but not for
+  // concatenations of serialized protos. Corruption after the last requested
+  // field is not detected.
+  //
+  // If false, every proto is scanned to the end, like ReadProtoFields() does.
+  bool stop_when_all_found = false;
+};
+
+// A reusable, precompiled form of ReadProtoFields() for reading the same
+// fields from many serialized protos. The mapping from tag numbers to the
+// requested fields is computed once, in Create(), rather than for each proto.
+//
+// Example:
+//   ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<const ProtoFieldReader> reader,
+//                    ProtoFieldReader::Create(field_infos));
+//   std::vector<ProtoFieldValueList> columns;
+//   ZETASQL_RETURN_IF_ERROR(reader->ReadColumns(serialized_rows, &columns));
+//
+// A ProtoFieldReader is immutable and thread-safe.
+class ProtoFieldReader {
+ public:
+  // Same requirements on <field_infos> as for ReadProtoFields(). The
+  // ProtoFieldInfos are copied.
+  static zetasql_base::StatusOr<std::unique_ptr<const ProtoFieldReader>> Create(
+      absl::Span<const ProtoFieldInfo* const> field_infos,
+      const ProtoFieldReaderOptions& options = ProtoFieldReaderOptions());
+
+  ProtoFieldReader(const ProtoFieldReader&) = delete;
+  ProtoFieldReader& operator=(const ProtoFieldReader&) = delete;
+
+  int num_fields() const { return field_infos_.size(); }
+  const ProtoFieldInfo& field_info(int i) const { return field_infos_[i]; }
+
+  // With default options, equivalent to ReadProtoFields() with the
+  // ProtoFieldInfos of this reader.
+  zetasql_base::Status Read(const std::string& bytes,
+                    ProtoFieldValueList* field_value_list) const;
+
+  // Reads the fields of every proto in <rows>. On success, <columns> has one
+  // ProtoFieldValueList per field, and (*columns)[i][j] is the value of
+  // field_info(i) in rows[j]. Returns an error if any row is corrupted.
+  zetasql_base::Status ReadColumns(absl::Span<const std::string> rows,
+                           std::vector<ProtoFieldValueList>* columns) const;
+
+ private:
+  // The ProtoFieldInfos reading a particular tag number.
+  struct TagPlan {
+    const google::protobuf::FieldDescriptor* descriptor = nullptr;
+    // Indexes into <field_infos_>.
+    std::vector<int> field_indexes;
+  };
+
+  // Maps a ProtoFieldInfo (by its index) to the corresponding Values we have
+  // seen for it, with errors for failure to convert wire values to the
+  // appropriate FieldFormats.
+  using ElementValueList = std::vector<std::vector<zetasql_base::StatusOr<Value>>>;
+
+  ProtoFieldReader() {}
+
+  // Returns the TagPlan for <tag_number>, or NULL if no field with that tag
+  // number was requested.
+  const TagPlan* FindTagPlan(int tag_number) const;
+
+  // Scans <bytes> and appends the values read for field i to
+  // (*element_value_list)[i], which must be empty.
+  zetasql_base::Status ReadElements(const std::string& bytes,
+                            ElementValueList* element_value_list) const;
+
+  std::vector<ProtoFieldInfo> field_infos_;
+  // Points to the elements of <field_infos_>.
+  std::vector<const ProtoFieldInfo*> field_info_ptrs_;
+  // The element types of <field_infos_>. Unused for has bits.
+  std::vector<const Type*> element_types_;
+  std::vector<TagPlan> tag_plans_;
+  // If all requested tag numbers are small, maps a tag number to its index
+  // in <tag_plans_>, or -1. Otherwise empty, and <sparse_tag_plans_> is used.
+  std::vector<int> dense_tag_plans_;
+  absl::flat_hash_map<int, int> sparse_tag_plans_;
+  // True if a proto can stop being read once every TagPlan has been seen.
+  bool stop_when_all_found_ = false;
+};
+
 // Convenience form of ReadProtoFields() for reading a single field. Reads the
 // proto field matching tag and type of 'field_descr' from 'bytes' and returns
 // the result in 'output_value'. If 'tag' is missing in 'bytes', returns
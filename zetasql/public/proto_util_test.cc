@@ -16,8 +16,10 @@
 
 #include "zetasql/public/proto_util.h"
 
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "zetasql/base/logging.h"
 #include "google/protobuf/io/coded_stream.h"
@@ -766,8 +768,187 @@ TEST_P(ReadProtoFieldsTest, SameFieldWithTwoFormats) {
   EXPECT_THAT(value_list[1], IsOkAndHolds(values::Date(10)));
 }
 
+TEST_P(ReadProtoFieldsTest, CorruptedTail) {
+  kitchen_sink_.set_int64_key_1(1);
+  kitchen_sink_.set_int32_val(10);
+  std::string bytes;
+  kitchen_sink_.SerializePartialToString(&bytes);
+  const std::string valid_bytes = bytes;
+
+  ProtoFieldInfo key_info;
+  key_info.descriptor =
+      kitchen_sink_.GetDescriptor()->FindFieldByName("int64_key_1");
+  ASSERT_TRUE(key_info.descriptor != nullptr);
+  key_info.format = FieldFormat_Format_DEFAULT_FORMAT;
+  key_info.type = types::Int64Type();
+  key_info.default_value = values::Int64(0);
+  ProtoFieldInfo has_int32_info;
+  has_int32_info.descriptor =
+      kitchen_sink_.GetDescriptor()->FindFieldByName("int32_val");
+  ASSERT_TRUE(has_int32_info.descriptor != nullptr);
+  has_int32_info.get_has_bit = true;
+
+  // A length-delimited field that claims more bytes than are left, and
+  // truncated varints of int64_key_1 and of int32_val.
+  for (const std::string& tail :
+       {std::string("\xa2\x06\x0a"), std::string("\x08\x80"),
+        std::string("\x18\x80")}) {
+    bytes = valid_bytes + tail;
+    ProtoFieldValueList value_list;
+    EXPECT_THAT(ReadProtoFields({&key_info}, bytes, &value_list),
+                StatusIs(zetasql_base::OUT_OF_RANGE,
+                         HasSubstr("Corrupted protocol buffer")));
+    // Both requested fields are found before the corruption.
+    value_list.clear();
+    EXPECT_THAT(
+        ReadProtoFields({&key_info, &has_int32_info}, bytes, &value_list),
+        StatusIs(zetasql_base::OUT_OF_RANGE,
+                 HasSubstr("Corrupted protocol buffer")));
+  }
+
+  // Dropping the last byte truncates the last field.
+  bytes = valid_bytes.substr(0, valid_bytes.size() - 1);
+  ProtoFieldValueList value_list;
+  EXPECT_THAT(ReadProtoFields({&key_info, &has_int32_info}, bytes, &value_list),
+              StatusIs(zetasql_base::OUT_OF_RANGE));
+}
+
 INSTANTIATE_TEST_SUITE_P(ReadProtoFieldsTestInstantiation, ReadProtoFieldsTest,
                          ::testing::Values(false, true));
 
+class ProtoFieldReaderTest : public ::testing::Test {
+ protected:
+  ProtoFieldInfo MakeFieldInfo(const std::string& field_name, const Type* type,
+                               const Value& default_value,
+                               bool get_has_bit = false) {
+    ProtoFieldInfo info;
+    info.descriptor = KitchenSinkPB::descriptor()->FindFieldByName(field_name);
+    EXPECT_TRUE(info.descriptor != nullptr) << field_name;
+    info.format = FieldFormat_Format_DEFAULT_FORMAT;
+    info.type = type;
+    info.default_value = default_value;
+    info.get_has_bit = get_has_bit;
+    return info;
+  }
+};
+
+TEST_F(ProtoFieldReaderTest, ReadColumns) {
+  const ProtoFieldInfo int32_info =
+      MakeFieldInfo("int32_val", types::Int32Type(), values::Int32(77));
+  const ProtoFieldInfo key_info =
+      MakeFieldInfo("int64_key_1", types::Int64Type(), values::Int64(0));
+  const ProtoFieldInfo repeated_info = MakeFieldInfo(
+      "repeated_int32_packed", types::Int32ArrayType(), Value());
+  const ProtoFieldInfo has_int32_info =
+      MakeFieldInfo("int32_val", types::Int32Type(), Value(),
+                    /*get_has_bit=*/true);
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<const ProtoFieldReader> reader,
+      ProtoFieldReader::Create(
+          {&int32_info, &key_info, &repeated_info, &has_int32_info}));
+  EXPECT_EQ(4, reader->num_fields());
+
+  std::vector<std::string> rows(2);
+  KitchenSinkPB kitchen_sink;
+  kitchen_sink.set_int64_key_1(1);
+  kitchen_sink.set_int32_val(10);
+  kitchen_sink.add_repeated_int32_packed(5);
+  kitchen_sink.add_repeated_int32_packed(6);
+  kitchen_sink.SerializePartialToString(&rows[0]);
+  kitchen_sink.Clear();
+  kitchen_sink.SerializePartialToString(&rows[1]);
+
+  std::vector<ProtoFieldValueList> columns;
+  ZETASQL_ASSERT_OK(reader->ReadColumns(rows, &columns));
+  ASSERT_EQ(4, columns.size());
+  for (const ProtoFieldValueList& column : columns) {
+    ASSERT_EQ(2, column.size());
+  }
+  EXPECT_THAT(columns[0][0], IsOkAndHolds(values::Int32(10)));
+  EXPECT_THAT(columns[0][1], IsOkAndHolds(values::Int32(77)));
+  EXPECT_THAT(columns[1][0], IsOkAndHolds(values::Int64(1)));
+  EXPECT_THAT(columns[1][1],
+              StatusIs(zetasql_base::OUT_OF_RANGE,
+                       HasSubstr("Protocol buffer missing required field")));
+  EXPECT_THAT(columns[2][0],
+              IsOkAndHolds(Value::Array(types::Int32ArrayType(),
+                                        {values::Int32(5), values::Int32(6)})));
+  EXPECT_THAT(columns[2][1],
+              IsOkAndHolds(Value::Array(types::Int32ArrayType(), {})));
+  EXPECT_THAT(columns[3][0], IsOkAndHolds(values::Bool(true)));
+  EXPECT_THAT(columns[3][1], IsOkAndHolds(values::Bool(false)));
+
+  // Read() gives the same values as ReadProtoFields().
+  ProtoFieldValueList expected;
+  ZETASQL_ASSERT_OK(ReadProtoFields(
+      {&int32_info, &key_info, &repeated_info, &has_int32_info}, rows[0],
+      &expected));
+  ProtoFieldValueList actual;
+  ZETASQL_ASSERT_OK(reader->Read(rows[0], &actual));
+  ASSERT_EQ(expected.size(), actual.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].ValueOrDie(), actual[i].ValueOrDie());
+  }
+}
+
+TEST_F(ProtoFieldReaderTest, CorruptedRow) {
+  const ProtoFieldInfo int32_info =
+      MakeFieldInfo("int32_val", types::Int32Type(), values::Int32(77));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<const ProtoFieldReader> reader,
+                       ProtoFieldReader::Create({&int32_info}));
+  std::vector<ProtoFieldValueList> columns;
+  EXPECT_THAT(reader->ReadColumns({"", "\xa2\x06\x0a"}, &columns),
+              StatusIs(zetasql_base::OUT_OF_RANGE,
+                       HasSubstr("Corrupted protocol buffer")));
+}
+
+TEST_F(ProtoFieldReaderTest, StopWhenAllFound) {
+  KitchenSinkPB kitchen_sink;
+  std::string bytes1;
+  kitchen_sink.set_int32_val(1);
+  kitchen_sink.SerializePartialToString(&bytes1);
+  std::string bytes2;
+  kitchen_sink.set_int32_val(2);
+  kitchen_sink.SerializePartialToString(&bytes2);
+  // A truncated field at the end is only noticed if the reader gets there.
+  const std::string bytes = bytes1 + bytes2 + "\xa2\x06\x0a";
+
+  const ProtoFieldInfo int32_info =
+      MakeFieldInfo("int32_val", types::Int32Type(), values::Int32(77));
+  const ProtoFieldInfo has_int32_info =
+      MakeFieldInfo("int32_val", types::Int32Type(), Value(),
+                    /*get_has_bit=*/true);
+
+  const ProtoFieldInfo repeated_info = MakeFieldInfo(
+      "repeated_int32_packed", types::Int32ArrayType(), Value());
+
+  // By default, every proto is read to the end.
+  for (const ProtoFieldInfo* info : {&int32_info, &has_int32_info}) {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<const ProtoFieldReader> reader,
+                         ProtoFieldReader::Create({info}));
+    ProtoFieldValueList values;
+    EXPECT_THAT(reader->Read(bytes, &values),
+                StatusIs(zetasql_base::OUT_OF_RANGE,
+                         HasSubstr("Corrupted protocol buffer")));
+  }
+
+  ProtoFieldReaderOptions options;
+  options.stop_when_all_found = true;
+  ProtoFieldValueList values;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<const ProtoFieldReader> reader,
+      ProtoFieldReader::Create({&int32_info, &has_int32_info}, options));
+  ZETASQL_ASSERT_OK(reader->Read(bytes, &values));
+  // Only the first occurrence of the field is read.
+  EXPECT_THAT(values[0], IsOkAndHolds(values::Int32(1)));
+  EXPECT_THAT(values[1], IsOkAndHolds(values::Bool(true)));
+
+  // Values of repeated fields are always read to the end.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      reader, ProtoFieldReader::Create({&int32_info, &repeated_info}, options));
+  EXPECT_THAT(reader->Read(bytes, &values),
+              StatusIs(zetasql_base::OUT_OF_RANGE));
+}
+
 }  // namespace
 }  // namespace zetasql
@@ -16,8 +16,10 @@
 
 #include "zetasql/public/simple_catalog.h"
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <utility>
 
 #include "zetasql/base/logging.h"
 #include "zetasql/proto/simple_catalog.pb.h"
@@ -26,6 +28,7 @@
 #include "zetasql/public/simple_constant.pb.h"
 #include "zetasql/public/simple_table.pb.h"
 #include "zetasql/public/table_valued_function.h"
+#include "absl/hash/hash.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/ascii.h"
 #include "zetasql/base/case.h"
@@ -39,23 +42,63 @@
 
 namespace zetasql {
 
+namespace {
+
+// Source of SimpleCatalog versions.
+std::atomic<uint64_t> next_catalog_version(1);
+
+uint64_t NextCatalogVersion() {
+  return next_catalog_version.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
 SimpleCatalog::SimpleCatalog(const std::string& name, TypeFactory* type_factory)
-    : name_(name), type_factory_(type_factory) {
+    : name_(name), type_factory_(type_factory),
+      version_(NextCatalogVersion()) {
+}
+
+absl::optional<uint64_t> SimpleCatalog::GetVersionToken() const {
+  uint64_t token;
+  std::vector<const Catalog*> sub_catalogs;
+  {
+    absl::ReaderMutexLock l(&mutex_);
+    token = version_;
+    sub_catalogs.reserve(catalogs_.size());
+    for (const auto& entry : catalogs_) {
+      sub_catalogs.push_back(entry.second);
+    }
+  }
+  // The order of sub-catalogs doesn't matter, so their tokens are combined
+  // with a commutative operation.
+  uint64_t sub_catalog_tokens = 0;
+  for (const Catalog* sub_catalog : sub_catalogs) {
+    const absl::optional<uint64_t> sub_token = sub_catalog->GetVersionToken();
+    if (!sub_token.has_value()) return absl::nullopt;
+    sub_catalog_tokens +=
+        absl::Hash<std::pair<const Catalog*, uint64_t>>()(
+            std::make_pair(sub_catalog, *sub_token));
+  }
+  if (sub_catalogs.empty()) return token;
+  return absl::Hash<std::pair<uint64_t, uint64_t>>()(
+      std::make_pair(token, sub_catalog_tokens));
 }
 
+void SimpleCatalog::BumpVersionLocked() { version_ = NextCatalogVersion(); }
+
 zetasql_base::Status SimpleCatalog::GetTable(
     const std::string& name,
     const Table** table,
     const FindOptions& options) {
-  absl::MutexLock l(&mutex_);
-  *table = zetasql_base::FindPtrOrNull(tables_, absl::AsciiStrToLower(name));
+  absl::ReaderMutexLock l(&mutex_);
+  *table = zetasql_base::FindPtrOrNull(tables_, name);
   return ::zetasql_base::OkStatus();
 }
 
 zetasql_base::Status SimpleCatalog::GetModel(const std::string& name, const Model** model,
                                      const FindOptions& options) {
-  absl::MutexLock l(&mutex_);
-  *model = zetasql_base::FindPtrOrNull(models_, absl::AsciiStrToLower(name));
+  absl::ReaderMutexLock l(&mutex_);
+  *model = zetasql_base::FindPtrOrNull(models_, name);
   return ::zetasql_base::OkStatus();
 }
 
@@ -63,8 +106,8 @@ zetasql_base::Status SimpleCatalog::GetFunction(
     const std::string& name,
     const Function** function,
     const FindOptions& options) {
-  absl::MutexLock l(&mutex_);
-  *function = zetasql_base::FindPtrOrNull(functions_, absl::AsciiStrToLower(name));
+  absl::ReaderMutexLock l(&mutex_);
+  *function = zetasql_base::FindPtrOrNull(functions_, name);
   return ::zetasql_base::OkStatus();
 }
 
@@ -72,9 +115,9 @@ zetasql_base::Status SimpleCatalog::GetTableValuedFunction(
     const std::string& name,
     const TableValuedFunction** function,
     const FindOptions& options) {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   *function =
-      zetasql_base::FindPtrOrNull(table_valued_functions_, absl::AsciiStrToLower(name));
+      zetasql_base::FindPtrOrNull(table_valued_functions_, name);
   return ::zetasql_base::OkStatus();
 }
 
@@ -82,8 +125,8 @@ zetasql_base::Status SimpleCatalog::GetProcedure(
     const std::string& name,
     const Procedure** procedure,
     const FindOptions& options) {
-  absl::MutexLock l(&mutex_);
-  *procedure = zetasql_base::FindPtrOrNull(procedures_, absl::AsciiStrToLower(name));
+  absl::ReaderMutexLock l(&mutex_);
+  *procedure = zetasql_base::FindPtrOrNull(procedures_, name);
   return ::zetasql_base::OkStatus();
 }
 
@@ -93,8 +136,8 @@ zetasql_base::Status SimpleCatalog::GetType(
     const FindOptions& options) {
   const google::protobuf::DescriptorPool* pool;
   {
-    absl::MutexLock l(&mutex_);
-    *type = zetasql_base::FindPtrOrNull(types_, absl::AsciiStrToLower(name));
+    absl::ReaderMutexLock l(&mutex_);
+    *type = zetasql_base::FindPtrOrNull(types_, name);
     if (*type != nullptr) {
       return ::zetasql_base::OkStatus();
     }
@@ -127,16 +170,16 @@ zetasql_base::Status SimpleCatalog::GetCatalog(
     const std::string& name,
     Catalog** catalog,
     const FindOptions& options) {
-  absl::MutexLock l(&mutex_);
-  *catalog = zetasql_base::FindPtrOrNull(catalogs_, absl::AsciiStrToLower(name));
+  absl::ReaderMutexLock l(&mutex_);
+  *catalog = zetasql_base::FindPtrOrNull(catalogs_, name);
   return ::zetasql_base::OkStatus();
 }
 
 zetasql_base::Status SimpleCatalog::GetConstant(const std::string& name,
                                         const Constant** constant,
                                         const FindOptions& options) {
-  absl::MutexLock l(&mutex_);
-  *constant = zetasql_base::FindPtrOrNull(constants_, absl::AsciiStrToLower(name));
+  absl::ReaderMutexLock l(&mutex_);
+  *constant = zetasql_base::FindPtrOrNull(constants_, name);
   return ::zetasql_base::OkStatus();
 }
 
@@ -255,11 +298,13 @@ std::string SimpleCatalog::SuggestConstant(
 void SimpleCatalog::AddTable(const std::string& name, const Table* table) {
   absl::MutexLock l(&mutex_);
   zetasql_base::InsertOrDie(&tables_, absl::AsciiStrToLower(name), table);
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::AddModel(const std::string& name, const Model* model) {
   absl::MutexLock l(&mutex_);
   zetasql_base::InsertOrDie(&models_, absl::AsciiStrToLower(name), model);
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::AddType(const std::string& name, const Type* type) {
@@ -269,6 +314,7 @@ void SimpleCatalog::AddType(const std::string& name, const Type* type) {
 
 void SimpleCatalog::AddTypeLocked(const std::string& name, const Type* type) {
   zetasql_base::InsertOrDie(&types_, absl::AsciiStrToLower(name), type);
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::AddCatalog(const std::string& name, Catalog* catalog) {
@@ -278,10 +324,12 @@ void SimpleCatalog::AddCatalog(const std::string& name, Catalog* catalog) {
 
 void SimpleCatalog::AddCatalogLocked(const std::string& name, Catalog* catalog) {
   zetasql_base::InsertOrDie(&catalogs_, absl::AsciiStrToLower(name), catalog);
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::AddFunctionLocked(
     const std::string& name, const Function* function) {
+  BumpVersionLocked();
   zetasql_base::InsertOrDie(&functions_, absl::AsciiStrToLower(name), function);
   if (!function->alias_name().empty() &&
       zetasql_base::StringCaseCompare(function->alias_name(), name) != 0) {
@@ -299,6 +347,7 @@ void SimpleCatalog::AddTableValuedFunctionLocked(
     const std::string& name, const TableValuedFunction* table_function) {
   zetasql_base::InsertOrDie(&table_valued_functions_, absl::AsciiStrToLower(name),
                    table_function);
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::AddTableValuedFunction(
@@ -311,11 +360,13 @@ void SimpleCatalog::AddProcedure(
     const std::string& name, const Procedure* procedure) {
   absl::MutexLock l(&mutex_);
   zetasql_base::InsertOrDie(&procedures_, absl::AsciiStrToLower(name), procedure);
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::AddConstant(const std::string& name, const Constant* constant) {
   absl::MutexLock l(&mutex_);
   zetasql_base::InsertOrDie(&constants_, absl::AsciiStrToLower(name), constant);
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::AddOwnedTable(const std::string& name,
@@ -484,13 +535,13 @@ bool SimpleCatalog::AddOwnedFunctionIfNotPresent(
     const std::string& name, std::unique_ptr<Function>* function) {
   absl::MutexLock l(&mutex_);
   // If the function name exists, return false.
-  if (zetasql_base::ContainsKey(functions_, absl::AsciiStrToLower(name))) {
+  if (zetasql_base::ContainsKey(functions_, name)) {
     return false;
   }
   const std::string alias_name = (*function)->alias_name();
   // If the function has an alias and the alias exists, return false.
   if (!alias_name.empty() && zetasql_base::StringCaseCompare(alias_name, name) != 0) {
-    if (zetasql_base::ContainsKey(functions_, absl::AsciiStrToLower(alias_name))) {
+    if (zetasql_base::ContainsKey(functions_, alias_name)) {
       return false;
     }
   }
@@ -519,7 +570,7 @@ bool SimpleCatalog::AddOwnedTableValuedFunctionIfNotPresent(
     const std::string& name, std::unique_ptr<TableValuedFunction>* table_function) {
   absl::MutexLock l(&mutex_);
   // If the table function name exists, return false.
-  if (zetasql_base::ContainsKey(table_valued_functions_, absl::AsciiStrToLower(name))) {
+  if (zetasql_base::ContainsKey(table_valued_functions_, name)) {
     return false;
   }
   AddOwnedTableValuedFunctionLocked(name, std::move(*table_function));
@@ -535,7 +586,7 @@ bool SimpleCatalog::AddOwnedTableValuedFunctionIfNotPresent(
 bool SimpleCatalog::AddTypeIfNotPresent(const std::string& name, const Type* type) {
   absl::MutexLock l(&mutex_);
   // If the table function name exists, return false.
-  if (zetasql_base::ContainsKey(types_, absl::AsciiStrToLower(name))) {
+  if (zetasql_base::ContainsKey(types_, name)) {
     return false;
   }
   AddTypeLocked(name, type);
@@ -575,6 +626,7 @@ void SimpleCatalog::SetDescriptorPool(const google::protobuf::DescriptorPool* po
       << "SimpleCatalog::SetDescriptorPool can only be called once";
   owned_descriptor_pool_.reset();
   descriptor_pool_ = pool;
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::SetOwnedDescriptorPool(const google::protobuf::DescriptorPool* pool) {
@@ -583,15 +635,16 @@ void SimpleCatalog::SetOwnedDescriptorPool(const google::protobuf::DescriptorPoo
       << "SimpleCatalog::SetDescriptorPool can only be called once";
   owned_descriptor_pool_.reset(pool);
   descriptor_pool_ = pool;
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::AddZetaSQLFunctions(
     const ZetaSQLBuiltinFunctionOptions& options) {
-  std::map<std::string, std::unique_ptr<Function>> function_map;
+  std::shared_ptr<const ZetaSQLBuiltinFunctionSet> builtin_functions =
+      GetSharedZetaSQLFunctions(options);
   // We have to call type_factory() while not holding mutex_.
   TypeFactory* type_factory = this->type_factory();
-  GetZetaSQLFunctions(type_factory, options, &function_map);
-  for (auto& function_pair : function_map) {
+  for (const auto& function_pair : builtin_functions->functions()) {
     const std::vector<std::string>& path = function_pair.second->FunctionNamePath();
     SimpleCatalog* catalog = this;
     if (path.size() > 1) {
@@ -612,8 +665,10 @@ void SimpleCatalog::AddZetaSQLFunctions(
                 .second);
       }
     }
-    catalog->AddOwnedFunction(path.back(), std::move(function_pair.second));
+    catalog->AddFunction(path.back(), function_pair.second.get());
   }
+  absl::MutexLock l(&mutex_);
+  builtin_function_sets_.push_back(std::move(builtin_functions));
 }
 
 void SimpleCatalog::ClearFunctions() {
@@ -624,6 +679,8 @@ void SimpleCatalog::ClearFunctions() {
     catalogs_.erase(pair.first);
   }
   owned_zetasql_subcatalogs_.clear();
+  builtin_function_sets_.clear();
+  BumpVersionLocked();
 }
 
 void SimpleCatalog::ClearTableValuedFunctions() {
@@ -634,6 +691,7 @@ void SimpleCatalog::ClearTableValuedFunctions() {
     catalogs_.erase(pair.first);
   }
   owned_zetasql_subcatalogs_.clear();
+  BumpVersionLocked();
 }
 
 TypeFactory* SimpleCatalog::type_factory() {
@@ -740,7 +798,7 @@ zetasql_base::Status SimpleCatalog::SerializeImpl(
     bool ignore_builtin, bool ignore_recursive) const {
   seen_catalogs->insert(this);
 
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
 
   proto->Clear();
   proto->set_name(name_);
@@ -850,42 +908,42 @@ zetasql_base::Status SimpleCatalog::SerializeImpl(
 }
 
 std::vector<std::string> SimpleCatalog::table_names() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<std::string> table_names;
   zetasql_base::AppendKeysFromMap(tables_, &table_names);
   return table_names;
 }
 
 std::vector<const Table*> SimpleCatalog::tables() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<const Table*> tables;
   zetasql_base::AppendValuesFromMap(tables_, &tables);
   return tables;
 }
 
 std::vector<const Type*> SimpleCatalog::types() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<const Type*> types;
   zetasql_base::AppendValuesFromMap(types_, &types);
   return types;
 }
 
 std::vector<std::string> SimpleCatalog::function_names() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<std::string> function_names;
   zetasql_base::AppendKeysFromMap(functions_, &function_names);
   return function_names;
 }
 
 std::vector<const Function*> SimpleCatalog::functions() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<const Function*> functions;
   zetasql_base::AppendValuesFromMap(functions_, &functions);
   return functions;
 }
 
 std::vector<std::string> SimpleCatalog::table_valued_function_names() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<std::string> table_valued_function_names;
   zetasql_base::AppendKeysFromMap(table_valued_functions_, &table_valued_function_names);
   return table_valued_function_names;
@@ -893,42 +951,42 @@ std::vector<std::string> SimpleCatalog::table_valued_function_names() const {
 
 std::vector<const TableValuedFunction*> SimpleCatalog::table_valued_functions()
     const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<const TableValuedFunction*> table_valued_functions;
   zetasql_base::AppendValuesFromMap(table_valued_functions_, &table_valued_functions);
   return table_valued_functions;
 }
 
 std::vector<const Procedure*> SimpleCatalog::procedures() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<const Procedure*> procedures;
   zetasql_base::AppendValuesFromMap(procedures_, &procedures);
   return procedures;
 }
 
 std::vector<std::string> SimpleCatalog::catalog_names() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<std::string> catalog_names;
   zetasql_base::AppendKeysFromMap(catalogs_, &catalog_names);
   return catalog_names;
 }
 
 std::vector<Catalog*> SimpleCatalog::catalogs() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<Catalog*> catalogs;
   zetasql_base::AppendValuesFromMap(catalogs_, &catalogs);
   return catalogs;
 }
 
 std::vector<std::string> SimpleCatalog::constant_names() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<std::string> constant_names;
   zetasql_base::AppendKeysFromMap(constants_, &constant_names);
   return constant_names;
 }
 
 std::vector<const Constant*> SimpleCatalog::constants() const {
-  absl::MutexLock l(&mutex_);
+  absl::ReaderMutexLock l(&mutex_);
   std::vector<const Constant*> constants;
   zetasql_base::AppendValuesFromMap(constants_, &constants);
   return constants;
@@ -974,7 +1032,7 @@ const Column* SimpleTable::FindColumnByName(const std::string& name) const {
   if (name.empty()) {
     return nullptr;
   }
-  return zetasql_base::FindPtrOrNull(columns_map_, absl::AsciiStrToLower(name));
+  return zetasql_base::FindPtrOrNull(columns_map_, name);
 }
 
 zetasql_base::Status SimpleTable::AddColumn(const Column* column, bool is_owned) {
@@ -1186,14 +1244,14 @@ const Column* SimpleModel::FindInputByName(const std::string& name) const {
   if (name.empty()) {
     return nullptr;
   }
-  return zetasql_base::FindPtrOrNull(inputs_map_, absl::AsciiStrToLower(name));
+  return zetasql_base::FindPtrOrNull(inputs_map_, name);
 }
 
 const Column* SimpleModel::FindOutputByName(const std::string& name) const {
   if (name.empty()) {
     return nullptr;
   }
-  return zetasql_base::FindPtrOrNull(outputs_map_, absl::AsciiStrToLower(name));
+  return zetasql_base::FindPtrOrNull(outputs_map_, name);
 }
 zetasql_base::Status SimpleModel::AddInput(const Column* column, bool is_owned) {
   std::unique_ptr<const Column> column_owner;
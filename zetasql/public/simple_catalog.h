@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "zetasql/base/case.h"
 #include "zetasql/base/logging.h"
 #include "google/protobuf/descriptor.h"
 #include "zetasql/public/builtin_function.h"
@@ -48,6 +49,18 @@ class SimpleColumnProto;
 class SimpleConstantProto;
 class SimpleTableProto;
 
+namespace internal {
+
+// Map from lowercased object name to object. Lookups are ASCII
+// case-insensitive and accept names in any case without lowercasing (and
+// allocating a copy of) them first.
+template <typename T>
+using CaseInsensitiveNameMap =
+    absl::flat_hash_map<std::string, T, zetasql_base::StringViewCaseHash,
+                        zetasql_base::StringViewCaseEqual>;
+
+}  // namespace internal
+
 // SimpleCatalog is a concrete implementation of the Catalog interface.
 // It acts as a simple container for objects in the Catalog.
 //
@@ -67,6 +80,13 @@ class SimpleCatalog : public Catalog {
 
   std::string FullName() const override { return name_; }
 
+  // Changes whenever an object is added to or removed from this catalog or
+  // one of its sub-catalogs. Changes made to the added objects themselves
+  // (e.g. adding a column to a SimpleTable) are not tracked. Returns
+  // absl::nullopt if a sub-catalog does not support versioning.
+  absl::optional<uint64_t> GetVersionToken() const override
+      LOCKS_EXCLUDED(mutex_);
+
   zetasql_base::Status GetTable(const std::string& name, const Table** table,
                         const FindOptions& options = FindOptions()) override
       LOCKS_EXCLUDED(mutex_);
@@ -352,6 +372,9 @@ class SimpleCatalog : public Catalog {
   void AddTypeLocked(const std::string& name, const Type* type)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Records that the contents of this catalog changed.
+  void BumpVersionLocked() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // Unified implementation of SuggestFunction and SuggestTableValuedFunction.
   std::string SuggestFunctionOrTableValuedFunction(
       bool is_table_valued_function, absl::Span<const std::string> mistyped_path);
@@ -364,15 +387,18 @@ class SimpleCatalog : public Catalog {
   TypeFactory* type_factory_ GUARDED_BY(mutex_);
   std::unique_ptr<TypeFactory> owned_type_factory_ GUARDED_BY(mutex_);
 
-  absl::flat_hash_map<std::string, const Table*> tables_ GUARDED_BY(mutex_);
-  absl::flat_hash_map<std::string, const Model*> models_ GUARDED_BY(mutex_);
-  absl::flat_hash_map<std::string, const Type*> types_ GUARDED_BY(mutex_);
-  absl::flat_hash_map<std::string, const Function*> functions_ GUARDED_BY(mutex_);
-  absl::flat_hash_map<std::string, const TableValuedFunction*>
+  internal::CaseInsensitiveNameMap<const Table*> tables_ GUARDED_BY(mutex_);
+  internal::CaseInsensitiveNameMap<const Model*> models_ GUARDED_BY(mutex_);
+  internal::CaseInsensitiveNameMap<const Type*> types_ GUARDED_BY(mutex_);
+  internal::CaseInsensitiveNameMap<const Function*> functions_
+      GUARDED_BY(mutex_);
+  internal::CaseInsensitiveNameMap<const TableValuedFunction*>
       table_valued_functions_ GUARDED_BY(mutex_);
-  absl::flat_hash_map<std::string, const Procedure*> procedures_ GUARDED_BY(mutex_);
-  absl::flat_hash_map<std::string, Catalog*> catalogs_ GUARDED_BY(mutex_);
-  absl::flat_hash_map<std::string, const Constant*> constants_ GUARDED_BY(mutex_);
+  internal::CaseInsensitiveNameMap<const Procedure*> procedures_
+      GUARDED_BY(mutex_);
+  internal::CaseInsensitiveNameMap<Catalog*> catalogs_ GUARDED_BY(mutex_);
+  internal::CaseInsensitiveNameMap<const Constant*> constants_
+      GUARDED_BY(mutex_);
 
   std::vector<std::unique_ptr<const Table>> owned_tables_ GUARDED_BY(mutex_);
   std::vector<std::unique_ptr<const Model>> owned_models_ GUARDED_BY(mutex_);
@@ -392,6 +418,15 @@ class SimpleCatalog : public Catalog {
   absl::flat_hash_map<std::string, std::unique_ptr<SimpleCatalog>>
       owned_zetasql_subcatalogs_ GUARDED_BY(mutex_);
 
+  // Keeps the built-in functions added by AddZetaSQLFunctions() alive. They
+  // are shared with other catalogs rather than owned by this one.
+  std::vector<std::shared_ptr<const ZetaSQLBuiltinFunctionSet>>
+      builtin_function_sets_ GUARDED_BY(mutex_);
+
+  // Taken from a process-wide sequence, so that different catalogs never
+  // share a version.
+  uint64_t version_ GUARDED_BY(mutex_);
+
   const google::protobuf::DescriptorPool* descriptor_pool_ GUARDED_BY(mutex_) = nullptr;
   std::unique_ptr<const google::protobuf::DescriptorPool> GUARDED_BY(mutex_)
       owned_descriptor_pool_;
@@ -499,7 +534,7 @@ class SimpleTable : public Table {
   bool is_value_table_ = false;
   std::vector<const Column*> columns_;
   std::vector<std::unique_ptr<const Column>> owned_columns_;
-  absl::flat_hash_map<std::string, const Column*> columns_map_;
+  internal::CaseInsensitiveNameMap<const Column*> columns_map_;
   absl::flat_hash_set<std::string> duplicate_column_names_;
   int64_t id_ = 0;
   bool allow_anonymous_column_name_ = false;
@@ -560,10 +595,10 @@ class SimpleModel : public Model {
   // be owned by this class or not. In case they are owned by this class, they
   // will be added to <owned_inputs_outputs_> and will be deleted at destruction
   // time.
-  absl::flat_hash_map<std::string, const Column*> inputs_map_;
+  internal::CaseInsensitiveNameMap<const Column*> inputs_map_;
   std::vector<const Column*> inputs_;
 
-  absl::flat_hash_map<std::string, const Column*> outputs_map_;
+  internal::CaseInsensitiveNameMap<const Column*> outputs_map_;
   std::vector<const Column*> outputs_;
 
   // All the input and output columns that this class owns.
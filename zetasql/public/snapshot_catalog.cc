@@ -0,0 +1,417 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/snapshot_catalog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/ascii.h"
+#include "zetasql/base/logging.h"
+#include "zetasql/base/ret_check.h"
+#include "zetasql/base/source_location.h"
+#include "zetasql/base/status_builder.h"
+#include "zetasql/base/status_macros.h"
+
+namespace zetasql {
+
+namespace {
+
+// Source of Snapshot versions.
+std::atomic<uint64_t> next_snapshot_version(1);
+
+uint64_t NextSnapshotVersion() {
+  return next_snapshot_version.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Wraps an object owned by the caller in a shared_ptr that doesn't delete it.
+template <typename T>
+std::shared_ptr<T> Unowned(T* object) {
+  return std::shared_ptr<T>(object, [](T*) {});
+}
+
+// Adds <object> to <map> under the lowercased <name>, or returns an error if
+// the name is already taken.
+template <typename Map>
+zetasql_base::Status InsertName(const std::string& catalog_name, const char* kind,
+                        const std::string& name,
+                        typename Map::mapped_type object, Map* map) {
+  ZETASQL_RET_CHECK(object != nullptr) << kind << " " << name << " is NULL";
+  if (!map->emplace(absl::AsciiStrToLower(name), std::move(object)).second) {
+    return ::zetasql_base::AlreadyExistsErrorBuilder(ZETASQL_LOC)
+           << kind << " " << name << " already exists in catalog "
+           << catalog_name;
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+// Returns a raw pointer to the object registered under <name>, or NULL.
+template <typename T, typename Map>
+T* FindRaw(const Map& map, const std::string& name) {
+  auto it = map.find(name);
+  return it == map.end() ? nullptr : it->second.get();
+}
+
+template <typename Map>
+std::vector<std::string> SortedNames(const Map& map) {
+  std::vector<std::string> names;
+  names.reserve(map.size());
+  for (const auto& entry : map) {
+    names.push_back(entry.first);
+  }
+  std::sort(names.begin(), names.end());
+  return names;
+}
+
+}  // namespace
+
+SnapshotCatalog::SnapshotCatalog(const std::string& name,
+                                 std::shared_ptr<Snapshot> initial)
+    : name_(name),
+      current_(initial != nullptr ? std::move(initial)
+                                  : Builder(name).Build()) {}
+
+SnapshotCatalog::~SnapshotCatalog() {}
+
+std::shared_ptr<SnapshotCatalog::Snapshot> SnapshotCatalog::snapshot() const {
+  return std::atomic_load(&current_);
+}
+
+uint64_t SnapshotCatalog::version() const { return snapshot()->version(); }
+
+void SnapshotCatalog::Publish(std::shared_ptr<Snapshot> snapshot) {
+  CHECK(snapshot != nullptr);
+  absl::MutexLock l(&writer_mutex_);
+  std::atomic_store(&current_, std::move(snapshot));
+}
+
+zetasql_base::Status SnapshotCatalog::Update(
+    const std::function<zetasql_base::Status(Builder*)>& update) {
+  absl::MutexLock l(&writer_mutex_);
+  Builder builder(*std::atomic_load(&current_));
+  ZETASQL_RETURN_IF_ERROR(update(&builder));
+  std::atomic_store(&current_, builder.Build());
+  return ::zetasql_base::OkStatus();
+}
+
+SnapshotCatalog::Snapshot::Snapshot(const std::string& name, Contents contents)
+    : name_(name),
+      version_(NextSnapshotVersion()),
+      contents_(std::move(contents)) {}
+
+SnapshotCatalog::Snapshot::~Snapshot() {}
+
+absl::optional<uint64_t> SnapshotCatalog::Snapshot::GetVersionToken() const {
+  if (contents_.catalogs.empty()) return version_;
+  // The order of sub-catalogs doesn't matter, so their tokens are combined
+  // with a commutative operation.
+  uint64_t sub_catalog_tokens = 0;
+  for (const auto& entry : contents_.catalogs) {
+    const Catalog* sub_catalog = entry.second.get();
+    const absl::optional<uint64_t> sub_token = sub_catalog->GetVersionToken();
+    if (!sub_token.has_value()) return absl::nullopt;
+    sub_catalog_tokens +=
+        absl::Hash<std::pair<const Catalog*, uint64_t>>()(
+            std::make_pair(sub_catalog, *sub_token));
+  }
+  return absl::Hash<std::pair<uint64_t, uint64_t>>()(
+      std::make_pair(version_, sub_catalog_tokens));
+}
+
+std::vector<std::string> SnapshotCatalog::Snapshot::table_names() const {
+  return SortedNames(contents_.tables);
+}
+
+std::vector<std::string> SnapshotCatalog::Snapshot::function_names() const {
+  return SortedNames(contents_.functions);
+}
+
+std::vector<std::string> SnapshotCatalog::Snapshot::type_names() const {
+  return SortedNames(contents_.types);
+}
+
+zetasql_base::Status SnapshotCatalog::Snapshot::GetTable(const std::string& name,
+                                                 const Table** table,
+                                                 const FindOptions& options) {
+  *table = FindRaw<const Table>(contents_.tables, name);
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Snapshot::GetModel(const std::string& name,
+                                                 const Model** model,
+                                                 const FindOptions& options) {
+  *model = FindRaw<const Model>(contents_.models, name);
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Snapshot::GetFunction(
+    const std::string& name, const Function** function,
+    const FindOptions& options) {
+  *function = FindRaw<const Function>(contents_.functions, name);
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Snapshot::GetTableValuedFunction(
+    const std::string& name, const TableValuedFunction** function,
+    const FindOptions& options) {
+  *function =
+      FindRaw<const TableValuedFunction>(contents_.table_valued_functions, name);
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Snapshot::GetProcedure(
+    const std::string& name, const Procedure** procedure,
+    const FindOptions& options) {
+  *procedure = FindRaw<const Procedure>(contents_.procedures, name);
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Snapshot::GetType(const std::string& name,
+                                                const Type** type,
+                                                const FindOptions& options) {
+  *type = FindRaw<const Type>(contents_.types, name);
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Snapshot::GetCatalog(
+    const std::string& name, Catalog** catalog, const FindOptions& options) {
+  *catalog = FindRaw<Catalog>(contents_.catalogs, name);
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Snapshot::GetConstant(
+    const std::string& name, const Constant** constant,
+    const FindOptions& options) {
+  *constant = FindRaw<const Constant>(contents_.constants, name);
+  return ::zetasql_base::OkStatus();
+}
+
+SnapshotCatalog::Builder::Builder(const std::string& name) : name_(name) {}
+
+SnapshotCatalog::Builder::Builder(const Snapshot& base)
+    : name_(base.name_), contents_(base.contents_) {}
+
+std::shared_ptr<SnapshotCatalog::Snapshot> SnapshotCatalog::Builder::Build()
+    const {
+  // Snapshot's constructor is private, so std::make_shared can't be used.
+  return std::shared_ptr<Snapshot>(new Snapshot(name_, contents_));
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddTable(const std::string& name,
+                                                const Table* table) {
+  return InsertName(name_, "Table", name, Unowned(table), &contents_.tables);
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddTable(const Table* table) {
+  ZETASQL_RET_CHECK(table != nullptr);
+  return AddTable(table->Name(), table);
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedTable(
+    std::shared_ptr<const Table> table) {
+  ZETASQL_RET_CHECK(table != nullptr);
+  const std::string name = table->Name();
+  return InsertName(name_, "Table", name, std::move(table), &contents_.tables);
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddTables(
+    absl::Span<const Table* const> tables) {
+  contents_.tables.reserve(contents_.tables.size() + tables.size());
+  for (const Table* table : tables) {
+    ZETASQL_RETURN_IF_ERROR(AddTable(table));
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedTables(
+    std::vector<std::unique_ptr<const Table>> tables) {
+  contents_.tables.reserve(contents_.tables.size() + tables.size());
+  for (std::unique_ptr<const Table>& table : tables) {
+    ZETASQL_RETURN_IF_ERROR(AddOwnedTable(std::move(table)));
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+bool SnapshotCatalog::Builder::RemoveTable(const std::string& name) {
+  return contents_.tables.erase(name) > 0;
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddModel(const Model* model) {
+  ZETASQL_RET_CHECK(model != nullptr);
+  return InsertName(name_, "Model", model->Name(), Unowned(model),
+                    &contents_.models);
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedModel(
+    std::shared_ptr<const Model> model) {
+  ZETASQL_RET_CHECK(model != nullptr);
+  const std::string name = model->Name();
+  return InsertName(name_, "Model", name, std::move(model), &contents_.models);
+}
+
+bool SnapshotCatalog::Builder::RemoveModel(const std::string& name) {
+  return contents_.models.erase(name) > 0;
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddFunction(const Function* function) {
+  return AddOwnedFunction(Unowned(function));
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedFunction(
+    std::shared_ptr<const Function> function) {
+  ZETASQL_RET_CHECK(function != nullptr);
+  const std::string& name = function->Name();
+  const std::string& alias_name = function->alias_name();
+  const bool has_alias =
+      !alias_name.empty() && !zetasql_base::CaseEqual(alias_name, name);
+  // Check the alias first so that a failed call leaves the Builder unchanged.
+  if (has_alias && contents_.functions.contains(alias_name)) {
+    return ::zetasql_base::AlreadyExistsErrorBuilder(ZETASQL_LOC)
+           << "Function " << alias_name << " already exists in catalog "
+           << name_;
+  }
+  ZETASQL_RETURN_IF_ERROR(
+      InsertName(name_, "Function", name, function, &contents_.functions));
+  if (has_alias) {
+    ZETASQL_RETURN_IF_ERROR(InsertName(name_, "Function", alias_name,
+                               std::move(function), &contents_.functions));
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddFunctions(
+    absl::Span<const Function* const> functions) {
+  contents_.functions.reserve(contents_.functions.size() + functions.size());
+  for (const Function* function : functions) {
+    ZETASQL_RETURN_IF_ERROR(AddFunction(function));
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedFunctions(
+    std::vector<std::unique_ptr<const Function>> functions) {
+  contents_.functions.reserve(contents_.functions.size() + functions.size());
+  for (std::unique_ptr<const Function>& function : functions) {
+    ZETASQL_RETURN_IF_ERROR(AddOwnedFunction(std::move(function)));
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+bool SnapshotCatalog::Builder::RemoveFunction(const std::string& name) {
+  auto it = contents_.functions.find(name);
+  if (it == contents_.functions.end()) return false;
+  const std::shared_ptr<const Function> function = std::move(it->second);
+  contents_.functions.erase(it);
+  // Also remove the entry for the function's other name, if any.
+  for (const std::string* other :
+       {&function->Name(), &function->alias_name()}) {
+    auto other_it = contents_.functions.find(*other);
+    if (other_it != contents_.functions.end() &&
+        other_it->second == function) {
+      contents_.functions.erase(other_it);
+    }
+  }
+  return true;
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddTableValuedFunction(
+    const TableValuedFunction* function) {
+  return AddOwnedTableValuedFunction(Unowned(function));
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedTableValuedFunction(
+    std::shared_ptr<const TableValuedFunction> function) {
+  ZETASQL_RET_CHECK(function != nullptr);
+  const std::string name = function->Name();
+  return InsertName(name_, "Table-valued function", name, std::move(function),
+                    &contents_.table_valued_functions);
+}
+
+bool SnapshotCatalog::Builder::RemoveTableValuedFunction(
+    const std::string& name) {
+  return contents_.table_valued_functions.erase(name) > 0;
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddProcedure(
+    const Procedure* procedure) {
+  return AddOwnedProcedure(Unowned(procedure));
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedProcedure(
+    std::shared_ptr<const Procedure> procedure) {
+  ZETASQL_RET_CHECK(procedure != nullptr);
+  const std::string name = procedure->Name();
+  return InsertName(name_, "Procedure", name, std::move(procedure),
+                    &contents_.procedures);
+}
+
+bool SnapshotCatalog::Builder::RemoveProcedure(const std::string& name) {
+  return contents_.procedures.erase(name) > 0;
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddConstant(const Constant* constant) {
+  return AddOwnedConstant(Unowned(constant));
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedConstant(
+    std::shared_ptr<const Constant> constant) {
+  ZETASQL_RET_CHECK(constant != nullptr);
+  const std::string name = constant->Name();
+  return InsertName(name_, "Constant", name, std::move(constant),
+                    &contents_.constants);
+}
+
+bool SnapshotCatalog::Builder::RemoveConstant(const std::string& name) {
+  return contents_.constants.erase(name) > 0;
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddCatalog(const std::string& name,
+                                                  Catalog* catalog) {
+  return InsertName(name_, "Catalog", name, Unowned(catalog),
+                    &contents_.catalogs);
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddOwnedCatalog(
+    const std::string& name, std::shared_ptr<Catalog> catalog) {
+  return InsertName(name_, "Catalog", name, std::move(catalog),
+                    &contents_.catalogs);
+}
+
+bool SnapshotCatalog::Builder::RemoveCatalog(const std::string& name) {
+  return contents_.catalogs.erase(name) > 0;
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddType(const std::string& name,
+                                               const Type* type) {
+  return InsertName(name_, "Type", name, Unowned(type), &contents_.types);
+}
+
+zetasql_base::Status SnapshotCatalog::Builder::AddTypes(
+    absl::Span<const std::pair<std::string, const Type*>> types) {
+  contents_.types.reserve(contents_.types.size() + types.size());
+  for (const auto& entry : types) {
+    ZETASQL_RETURN_IF_ERROR(AddType(entry.first, entry.second));
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+bool SnapshotCatalog::Builder::RemoveType(const std::string& name) {
+  return contents_.types.erase(name) > 0;
+}
+
+}  // namespace zetasql
@@ -0,0 +1,283 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef ZETASQL_PUBLIC_SNAPSHOT_CATALOG_H_
+#define ZETASQL_PUBLIC_SNAPSHOT_CATALOG_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/catalog.h"
+#include "zetasql/public/constant.h"
+#include "zetasql/public/function.h"
+#include "zetasql/public/procedure.h"
+#include "zetasql/public/table_valued_function.h"
+#include "zetasql/public/type.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "zetasql/base/case.h"
+#include "zetasql/base/status.h"
+#include "zetasql/base/statusor.h"
+
+namespace zetasql {
+
+// SnapshotCatalog holds catalog contents that can be replaced atomically
+// while queries are being analyzed against them.
+//
+// The contents live in immutable, versioned Snapshots. A Snapshot is built
+// with a SnapshotCatalog::Builder, which supports registering many tables,
+// functions and types at once, and is then published with Publish() or
+// Update(). Publishing is copy-on-write: readers that already hold the
+// previous Snapshot keep seeing it, unchanged, until they release it.
+//
+// SnapshotCatalog is deliberately not a Catalog itself. Lookups return raw
+// pointers, and an object removed by a concurrent Update() is deleted as
+// soon as the last Snapshot holding it goes away, so readers must pin a
+// Snapshot with snapshot() for as long as they use anything found through
+// it. The Snapshot is the Catalog to analyze against, and it must outlive
+// the analyzer output since resolved ASTs point at catalog objects:
+//
+//   std::shared_ptr<SnapshotCatalog::Snapshot> snapshot = catalog.snapshot();
+//   ZETASQL_RETURN_IF_ERROR(AnalyzeStatement(sql, options, snapshot.get(),
+//                                    &type_factory, &output));
+//
+// Objects registered in a Snapshot are shared by all later Snapshots derived
+// from it, and owned objects are deleted when the last Snapshot referencing
+// them goes away.
+//
+// Types are not owned. The TypeFactory that created them must outlive every
+// Snapshot that references them.
+//
+// Names are case-insensitive, as in SimpleCatalog.
+//
+// This class is thread-safe. Snapshots are immutable and thread-safe.
+class SnapshotCatalog {
+ public:
+  class Builder;
+  class Snapshot;
+
+  // Creates a catalog whose initial contents are <initial>, or an empty
+  // Snapshot if <initial> is NULL.
+  explicit SnapshotCatalog(const std::string& name,
+                           std::shared_ptr<Snapshot> initial = nullptr);
+  SnapshotCatalog(const SnapshotCatalog&) = delete;
+  SnapshotCatalog& operator=(const SnapshotCatalog&) = delete;
+  ~SnapshotCatalog();
+
+  std::string FullName() const { return name_; }
+
+  // Returns the current Snapshot. Readers never wait for an Update() to
+  // build its Snapshot, but see <current_> for the locking this does.
+  std::shared_ptr<Snapshot> snapshot() const;
+
+  // Returns the version of the current Snapshot.
+  uint64_t version() const;
+
+  // Makes <snapshot> the current contents of this catalog.
+  void Publish(std::shared_ptr<Snapshot> snapshot);
+
+  // Builds a new Snapshot from the current one by applying <update> to a
+  // Builder initialized with its contents, and publishes it. Concurrent
+  // Update() calls are serialized, so no update is lost. If <update> or
+  // building the Snapshot fails, nothing is published and the error is
+  // returned.
+  zetasql_base::Status Update(const std::function<zetasql_base::Status(Builder*)>& update);
+
+ private:
+  const std::string name_;
+
+  // Serializes writers, so that Update() is an atomic read-modify-write.
+  // Readers never take this mutex.
+  absl::Mutex writer_mutex_;
+
+  // The current Snapshot. Only accessed with the std::atomic_load and
+  // std::atomic_store overloads for std::shared_ptr. These are not lock-free:
+  // the standard libraries guard them with a small process-wide pool of
+  // mutexes picked by address, held just long enough to copy the pointer and
+  // bump its reference count. Readers can thus briefly contend with each
+  // other, with the store in Publish() and with unrelated shared_ptrs hashed
+  // to the same mutex, but never with the Builder work in Update().
+  std::shared_ptr<Snapshot> current_;
+};
+
+// An immutable version of the contents of a SnapshotCatalog.
+class SnapshotCatalog::Snapshot : public Catalog {
+ public:
+  Snapshot(const Snapshot&) = delete;
+  Snapshot& operator=(const Snapshot&) = delete;
+  ~Snapshot() override;
+
+  std::string FullName() const override { return name_; }
+
+  // A process-wide unique number identifying this Snapshot. Snapshots built
+  // later have larger versions.
+  uint64_t version() const { return version_; }
+
+  absl::optional<uint64_t> GetVersionToken() const override;
+
+  // Returns the names of the objects of each kind, sorted. Names are
+  // lowercased.
+  std::vector<std::string> table_names() const;
+  std::vector<std::string> function_names() const;
+  std::vector<std::string> type_names() const;
+
+ protected:
+  zetasql_base::Status GetTable(const std::string& name, const Table** table,
+                        const FindOptions& options = FindOptions()) override;
+
+  zetasql_base::Status GetModel(const std::string& name, const Model** model,
+                        const FindOptions& options = FindOptions()) override;
+
+  zetasql_base::Status GetFunction(const std::string& name, const Function** function,
+                           const FindOptions& options = FindOptions()) override;
+
+  zetasql_base::Status GetTableValuedFunction(
+      const std::string& name, const TableValuedFunction** function,
+      const FindOptions& options = FindOptions()) override;
+
+  zetasql_base::Status GetProcedure(
+      const std::string& name, const Procedure** procedure,
+      const FindOptions& options = FindOptions()) override;
+
+  zetasql_base::Status GetType(const std::string& name, const Type** type,
+                       const FindOptions& options = FindOptions()) override;
+
+  zetasql_base::Status GetCatalog(const std::string& name, Catalog** catalog,
+                          const FindOptions& options = FindOptions()) override;
+
+  zetasql_base::Status GetConstant(const std::string& name, const Constant** constant,
+                           const FindOptions& options = FindOptions()) override;
+
+ private:
+  friend class SnapshotCatalog;
+  friend class SnapshotCatalog::Builder;
+
+  template <typename T>
+  using NameMap =
+      absl::flat_hash_map<std::string, std::shared_ptr<T>,
+                          zetasql_base::StringViewCaseHash,
+                          zetasql_base::StringViewCaseEqual>;
+
+  // The contents of a Snapshot, also used by Builder while building one.
+  struct Contents {
+    NameMap<const Table> tables;
+    NameMap<const Model> models;
+    NameMap<const Function> functions;
+    NameMap<const TableValuedFunction> table_valued_functions;
+    NameMap<const Procedure> procedures;
+    NameMap<Catalog> catalogs;
+    NameMap<const Constant> constants;
+    // Types are never owned; the shared_ptrs have no-op deleters.
+    NameMap<const Type> types;
+  };
+
+  Snapshot(const std::string& name, Contents contents);
+
+  const std::string name_;
+  const uint64_t version_;
+  const Contents contents_;
+};
+
+// Builds a SnapshotCatalog::Snapshot. Objects can be added one at a time or
+// in bulk, either owned (passed as std::unique_ptr or std::shared_ptr) or
+// unowned (passed as a raw pointer, which must outlive every Snapshot built
+// from this Builder and every Snapshot derived from those).
+//
+// Adding an object whose name is already registered returns an error, and
+// leaves the Builder unchanged; call the matching Remove method first to
+// replace an object. A failed bulk Add may have added some of its objects.
+//
+// A Builder is not thread-safe.
+class SnapshotCatalog::Builder {
+ public:
+  // Starts from an empty catalog called <name>.
+  explicit Builder(const std::string& name);
+
+  // Starts from the contents of <base>. Objects from <base> are shared, not
+  // copied.
+  explicit Builder(const Snapshot& base);
+
+  Builder(const Builder&) = delete;
+  Builder& operator=(const Builder&) = delete;
+
+  // Tables and models are registered by name, using Table::Name() or
+  // Model::Name() unless a name is given.
+  zetasql_base::Status AddTable(const std::string& name, const Table* table);
+  zetasql_base::Status AddTable(const Table* table);
+  zetasql_base::Status AddOwnedTable(std::shared_ptr<const Table> table);
+  zetasql_base::Status AddTables(absl::Span<const Table* const> tables);
+  zetasql_base::Status AddOwnedTables(
+      std::vector<std::unique_ptr<const Table>> tables);
+  bool RemoveTable(const std::string& name);
+
+  zetasql_base::Status AddModel(const Model* model);
+  zetasql_base::Status AddOwnedModel(std::shared_ptr<const Model> model);
+  bool RemoveModel(const std::string& name);
+
+  // Functions are registered under Function::Name(), and also under their
+  // alias name if they have one.
+  zetasql_base::Status AddFunction(const Function* function);
+  zetasql_base::Status AddOwnedFunction(std::shared_ptr<const Function> function);
+  zetasql_base::Status AddFunctions(absl::Span<const Function* const> functions);
+  zetasql_base::Status AddOwnedFunctions(
+      std::vector<std::unique_ptr<const Function>> functions);
+  // Removes the function registered under <name>, and its other name if it
+  // has an alias.
+  bool RemoveFunction(const std::string& name);
+
+  zetasql_base::Status AddTableValuedFunction(const TableValuedFunction* function);
+  zetasql_base::Status AddOwnedTableValuedFunction(
+      std::shared_ptr<const TableValuedFunction> function);
+  bool RemoveTableValuedFunction(const std::string& name);
+
+  zetasql_base::Status AddProcedure(const Procedure* procedure);
+  zetasql_base::Status AddOwnedProcedure(std::shared_ptr<const Procedure> procedure);
+  bool RemoveProcedure(const std::string& name);
+
+  zetasql_base::Status AddConstant(const Constant* constant);
+  zetasql_base::Status AddOwnedConstant(std::shared_ptr<const Constant> constant);
+  bool RemoveConstant(const std::string& name);
+
+  zetasql_base::Status AddCatalog(const std::string& name, Catalog* catalog);
+  zetasql_base::Status AddOwnedCatalog(const std::string& name,
+                               std::shared_ptr<Catalog> catalog);
+  bool RemoveCatalog(const std::string& name);
+
+  // Types are registered under the given names.
+  zetasql_base::Status AddType(const std::string& name, const Type* type);
+  zetasql_base::Status AddTypes(
+      absl::Span<const std::pair<std::string, const Type*>> types);
+  bool RemoveType(const std::string& name);
+
+  // Returns a new Snapshot with the current contents. The Builder can be
+  // used again afterwards; later changes don't affect the returned Snapshot.
+  std::shared_ptr<Snapshot> Build() const;
+
+ private:
+  const std::string name_;
+  Snapshot::Contents contents_;
+};
+
+}  // namespace zetasql
+
+#endif  // ZETASQL_PUBLIC_SNAPSHOT_CATALOG_H_
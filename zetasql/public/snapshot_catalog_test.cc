@@ -0,0 +1,196 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/snapshot_catalog.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/function.h"
+#include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/type.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+
+namespace zetasql {
+
+using ::testing::ElementsAre;
+using ::zetasql_base::testing::StatusIs;
+
+TEST(SnapshotCatalogTest, BuildAndLookup) {
+  SimpleTable t1("T1", {{"a", types::Int64Type()}});
+  SimpleTable t2("t2", {{"b", types::StringType()}});
+  Function fn("MyFn", "test", Function::SCALAR,
+              FunctionOptions().set_alias_name("my_alias"));
+
+  SnapshotCatalog::Builder builder("cat");
+  ZETASQL_ASSERT_OK(builder.AddTables({&t1, &t2}));
+  ZETASQL_ASSERT_OK(builder.AddFunction(&fn));
+  ZETASQL_ASSERT_OK(builder.AddTypes({{"MyInt", types::Int64Type()}}));
+  SnapshotCatalog catalog("cat", builder.Build());
+  const std::shared_ptr<SnapshotCatalog::Snapshot> snapshot =
+      catalog.snapshot();
+
+  const Table* table;
+  ZETASQL_ASSERT_OK(snapshot->FindTable({"t1"}, &table));
+  EXPECT_EQ(&t1, table);
+  ZETASQL_ASSERT_OK(snapshot->FindTable({"T2"}, &table));
+  EXPECT_EQ(&t2, table);
+  EXPECT_THAT(snapshot->FindTable({"t3"}, &table),
+              StatusIs(zetasql_base::StatusCode::kNotFound));
+
+  const Function* function;
+  ZETASQL_ASSERT_OK(snapshot->FindFunction({"myfn"}, &function));
+  EXPECT_EQ(&fn, function);
+  ZETASQL_ASSERT_OK(snapshot->FindFunction({"MY_ALIAS"}, &function));
+  EXPECT_EQ(&fn, function);
+
+  const Type* type;
+  ZETASQL_ASSERT_OK(snapshot->FindType({"myint"}, &type));
+  EXPECT_TRUE(type->IsInt64());
+
+  EXPECT_THAT(snapshot->table_names(), ElementsAre("t1", "t2"));
+  EXPECT_THAT(snapshot->function_names(),
+              ElementsAre("my_alias", "myfn"));
+}
+
+TEST(SnapshotCatalogTest, DuplicateNames) {
+  SimpleTable t1("t", {{"a", types::Int64Type()}});
+  SimpleTable t2("T", {{"a", types::Int64Type()}});
+  SnapshotCatalog::Builder builder("cat");
+  ZETASQL_ASSERT_OK(builder.AddTable(&t1));
+  EXPECT_THAT(builder.AddTable(&t2),
+              StatusIs(zetasql_base::StatusCode::kAlreadyExists));
+  EXPECT_TRUE(builder.RemoveTable("T"));
+  EXPECT_FALSE(builder.RemoveTable("T"));
+  ZETASQL_EXPECT_OK(builder.AddTable(&t2));
+
+  // A function whose alias is taken is not added at all.
+  Function fn1("f1", "test", Function::SCALAR);
+  Function fn2("f2", "test", Function::SCALAR,
+               FunctionOptions().set_alias_name("F1"));
+  ZETASQL_ASSERT_OK(builder.AddFunction(&fn1));
+  EXPECT_THAT(builder.AddFunction(&fn2),
+              StatusIs(zetasql_base::StatusCode::kAlreadyExists));
+  EXPECT_THAT(builder.Build()->function_names(), ElementsAre("f1"));
+
+  EXPECT_TRUE(builder.RemoveFunction("f1"));
+  ZETASQL_ASSERT_OK(builder.AddFunction(&fn2));
+  EXPECT_TRUE(builder.RemoveFunction("F1"));
+  EXPECT_TRUE(builder.Build()->function_names().empty());
+}
+
+TEST(SnapshotCatalogTest, UpdateIsCopyOnWrite) {
+  SnapshotCatalog catalog("cat");
+  const std::shared_ptr<SnapshotCatalog::Snapshot> empty = catalog.snapshot();
+  const uint64_t empty_version = catalog.version();
+
+  ZETASQL_ASSERT_OK(catalog.Update([](SnapshotCatalog::Builder* builder) {
+    return builder->AddOwnedTable(absl::make_unique<SimpleTable>(
+        "t", std::vector<SimpleTable::NameAndType>{{"a", types::Int64Type()}}));
+  }));
+  const std::shared_ptr<SnapshotCatalog::Snapshot> v1 = catalog.snapshot();
+  EXPECT_GT(catalog.version(), empty_version);
+  EXPECT_NE(empty->GetVersionToken(), v1->GetVersionToken());
+  EXPECT_EQ(v1->GetVersionToken(), catalog.snapshot()->GetVersionToken());
+
+  // The old snapshot is unchanged.
+  const Table* table;
+  EXPECT_THAT(empty->FindTable({"t"}, &table),
+              StatusIs(zetasql_base::StatusCode::kNotFound));
+  ZETASQL_ASSERT_OK(v1->FindTable({"t"}, &table));
+
+  // A failed update publishes nothing.
+  EXPECT_THAT(catalog.Update([](SnapshotCatalog::Builder* builder) {
+    builder->RemoveTable("t");
+    return zetasql_base::InvalidArgumentError("failed");
+  }),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+  EXPECT_EQ(v1, catalog.snapshot());
+
+  // Owned objects stay alive as long as a snapshot references them.
+  ZETASQL_ASSERT_OK(catalog.Update([](SnapshotCatalog::Builder* builder) {
+    builder->RemoveTable("t");
+    return zetasql_base::OkStatus();
+  }));
+  EXPECT_THAT(catalog.snapshot()->FindTable({"t"}, &table),
+              StatusIs(zetasql_base::StatusCode::kNotFound));
+  ZETASQL_ASSERT_OK(v1->FindTable({"t"}, &table));
+  EXPECT_EQ("t", table->Name());
+}
+
+TEST(SnapshotCatalogTest, SubCatalogVersionTokens) {
+  SimpleCatalog nested("nested");
+  SnapshotCatalog::Builder builder("cat");
+  ZETASQL_ASSERT_OK(builder.AddCatalog("nested", &nested));
+  const std::shared_ptr<SnapshotCatalog::Snapshot> snapshot = builder.Build();
+
+  const absl::optional<uint64_t> token = snapshot->GetVersionToken();
+  ASSERT_TRUE(token.has_value());
+  EXPECT_EQ(token, snapshot->GetVersionToken());
+  nested.AddType("t", types::Int32Type());
+  EXPECT_NE(token, snapshot->GetVersionToken());
+
+  const Type* type;
+  ZETASQL_ASSERT_OK(snapshot->FindType({"nested", "t"}, &type));
+  EXPECT_TRUE(type->IsInt32());
+}
+
+TEST(SnapshotCatalogTest, ConcurrentReadersAndWriter) {
+  SnapshotCatalog catalog("cat");
+  std::vector<std::unique_ptr<SimpleTable>> tables;
+  for (int i = 0; i < 100; ++i) {
+    tables.push_back(absl::make_unique<SimpleTable>(
+        absl::StrCat("t", i),
+        std::vector<SimpleTable::NameAndType>{{"a", types::Int64Type()}}));
+  }
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&catalog]() {
+      for (int i = 0; i < 1000; ++i) {
+        // Each snapshot holds a prefix t0..tN-1 of the tables.
+        std::shared_ptr<SnapshotCatalog::Snapshot> snapshot =
+            catalog.snapshot();
+        const int num_tables = snapshot->table_names().size();
+        const Table* table;
+        if (num_tables > 0) {
+          ZETASQL_EXPECT_OK(snapshot->FindTable(
+              {absl::StrCat("t", num_tables - 1)}, &table));
+        }
+        EXPECT_FALSE(
+            snapshot->FindTable({absl::StrCat("t", num_tables)}, &table)
+                .ok());
+      }
+    });
+  }
+  for (const std::unique_ptr<SimpleTable>& table : tables) {
+    ZETASQL_ASSERT_OK(catalog.Update([&table](SnapshotCatalog::Builder* builder) {
+      return builder->AddTable(table.get());
+    }));
+  }
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(100, catalog.snapshot()->table_names().size());
+}
+
+}  // namespace zetasql
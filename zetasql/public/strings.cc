@@ -17,6 +17,7 @@
 #include "zetasql/public/strings.h"
 
 #include <ctype.h>
+#include <string.h>
 #include <iterator>
 
 #include "zetasql/base/logging.h"
@@ -34,6 +35,11 @@
 #include "zetasql/base/status.h"
 #include "zetasql/base/status_macros.h"
 
+#if defined(__GNUC__) && defined(__SSE2__)
+#define ZETASQL_STRINGS_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace zetasql {
 
 // x must be a valid hex.
@@ -105,6 +111,65 @@ static int AppendCodePoint(char* s, int32_t cp) {
   return 1;
 }
 
+// Returns the length of the longest prefix of [p, end) containing neither '\\'
+// nor '\r'. CUnescapeInternal copies such runs through unchanged.
+static size_t SpanUnescapedRun(const char* p, const char* end) {
+  const char* start = p;
+#ifdef ZETASQL_STRINGS_SSE2
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  for (; end - p >= 16; p += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const int mask = _mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(v, backslash), _mm_cmpeq_epi8(v, carriage_return)));
+    if (mask != 0) return (p - start) + __builtin_ctz(mask);
+  }
+#endif
+  while (p < end && *p != '\\' && *p != '\r') ++p;
+  return p - start;
+}
+
+// Returns true if escaping never changes <c>: printable ASCII other than '\\'
+// and the quote characters, and also bytes >= 0x80 if <utf8_safe>.
+static inline bool IsPassThroughChar(unsigned char c, bool utf8_safe) {
+  if (c >= 0x80) return utf8_safe;
+  return absl::ascii_isprint(c) && c != '\\' && c != '\'' && c != '"' &&
+         c != '`';
+}
+
+// Returns the length of the longest prefix of [p, end) made of characters for
+// which IsPassThroughChar() is true. Escaping copies such runs in bulk.
+static size_t SpanPassThroughRun(const char* p, const char* end,
+                                 bool utf8_safe) {
+  const char* start = p;
+#ifdef ZETASQL_STRINGS_SSE2
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i del = _mm_set1_epi8(0x7f);
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i single_quote = _mm_set1_epi8('\'');
+  const __m128i double_quote = _mm_set1_epi8('"');
+  const __m128i backquote = _mm_set1_epi8('`');
+  for (; end - p >= 16; p += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    // Bytes are compared as signed, so this also matches bytes >= 0x80.
+    __m128i special = _mm_cmplt_epi8(v, space);
+    if (utf8_safe) {
+      special = _mm_andnot_si128(_mm_cmplt_epi8(v, _mm_setzero_si128()),
+                                 special);
+    }
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(v, del));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(v, backslash));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(v, single_quote));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(v, double_quote));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(v, backquote));
+    const int mask = _mm_movemask_epi8(special);
+    if (mask != 0) return (p - start) + __builtin_ctz(mask);
+  }
+#endif
+  while (p < end && IsPassThroughChar(*p, utf8_safe)) ++p;
+  return p - start;
+}
+
 // ----------------------------------------------------------------------
 // CUnescapeInternal()
 //    Unescapes C escape sequences and is the reverse of CEscape().
@@ -175,7 +240,10 @@ static bool CUnescapeInternal(absl::string_view source,
   while (p < end) {
     if (*p != '\\') {
       if (*p != '\r') {
-        *d++ = *p++;
+        const size_t run = SpanUnescapedRun(p, end);
+        memcpy(d, p, run);
+        d += run;
+        p += run;
       } else {
         // All types of newlines in different platforms i.e. '\r', '\n', '\r\n'
         // are replaced with '\n'.
@@ -470,29 +538,43 @@ static bool CUnescapeInternal(absl::string_view source,
 // If escape_quote_char is non-zero, only escape the quote character
 // (from '"`) that matches escape_quote_char.
 // This allows writing "ab'cd" or 'ab"cd' or `ab"cd` without extra escaping.
+//
+// Appends the escaped std::string to <dest>. Runs of characters that need no
+// escaping are copied in bulk.
 // ----------------------------------------------------------------------
-static std::string CEscapeInternal(absl::string_view src, bool utf8_safe,
-                              char escape_quote_char) {
-  std::string dest;
+static void CEscapeInternal(absl::string_view src, bool utf8_safe,
+                            char escape_quote_char, std::string* dest) {
+  dest->reserve(dest->size() + src.size());
   bool last_hex_escape = false;  // true if last output char was \xNN.
 
-  for (const char* p = src.begin(); p < src.end(); ++p) {
-    unsigned char c = *p;
+  const char* p = src.begin();
+  const char* end = src.end();
+  while (p < end) {
+    // A hex digit right after a hex escape must itself be escaped, so only
+    // take the bulk path when the previous character was not hex escaped.
+    if (!last_hex_escape) {
+      const size_t run = SpanPassThroughRun(p, end, utf8_safe);
+      dest->append(p, run);
+      p += run;
+      if (p == end) break;
+    }
+
+    unsigned char c = *p++;
     bool is_hex_escape = false;
     switch (c) {
-      case '\n': dest.append("\\" "n"); break;
-      case '\r': dest.append("\\" "r"); break;
-      case '\t': dest.append("\\" "t"); break;
-      case '\\': dest.append("\\" "\\"); break;
+      case '\n': dest->append("\\" "n"); break;
+      case '\r': dest->append("\\" "r"); break;
+      case '\t': dest->append("\\" "t"); break;
+      case '\\': dest->append("\\" "\\"); break;
 
       case '\'':
       case '\"':
       case '`':
         // Escape only quote chars that match escape_quote_char.
         if (escape_quote_char == 0 || c == escape_quote_char) {
-          dest.push_back('\\');
+          dest->push_back('\\');
         }
-        dest.push_back(c);
+        dest->push_back(c);
         break;
 
       default:
@@ -502,18 +584,23 @@ static std::string CEscapeInternal(absl::string_view src, bool utf8_safe,
         if ((!utf8_safe || c < 0x80) &&
             (!absl::ascii_isprint(c) ||
              (last_hex_escape && absl::ascii_isxdigit(c)))) {
-          dest.append("\\" "x");
-          dest.push_back(hex_char[c / 16]);
-          dest.push_back(hex_char[c % 16]);
+          dest->append("\\" "x");
+          dest->push_back(hex_char[c / 16]);
+          dest->push_back(hex_char[c % 16]);
           is_hex_escape = true;
         } else {
-          dest.push_back(c);
+          dest->push_back(c);
           break;
         }
     }
     last_hex_escape = is_hex_escape;
   }
+}
 
+static std::string CEscapeInternal(absl::string_view src, bool utf8_safe,
+                                   char escape_quote_char) {
+  std::string dest;
+  CEscapeInternal(src, utf8_safe, escape_quote_char, &dest);
   return dest;
 }
 
@@ -545,40 +632,63 @@ zetasql_base::Status UnescapeBytes(absl::string_view str, std::string* out,
 }
 
 std::string EscapeString(absl::string_view str) {
-  return CEscapeInternal(str, true /* utf8_safe */, 0 /* escape_quote_char */);
+  std::string escaped;
+  AppendEscapedString(str, &escaped);
+  return escaped;
+}
+
+void AppendEscapedString(absl::string_view str, std::string* out) {
+  CEscapeInternal(str, true /* utf8_safe */, 0 /* escape_quote_char */, out);
 }
 
 std::string EscapeBytes(absl::string_view str, bool escape_all_bytes,
                    char escape_quote_char) {
   std::string escaped_bytes;
-  for (const char* p = str.begin(); p < str.end(); ++p) {
-    unsigned char c = *p;
+  AppendEscapedBytes(str, escape_all_bytes, escape_quote_char, &escaped_bytes);
+  return escaped_bytes;
+}
+
+void AppendEscapedBytes(absl::string_view str, bool escape_all_bytes,
+                        char escape_quote_char, std::string* out) {
+  out->reserve(out->size() + str.size());
+  const char* p = str.begin();
+  const char* end = str.end();
+  while (p < end) {
+    if (!escape_all_bytes) {
+      // Printable bytes other than escape and quote characters are copied
+      // through in bulk.
+      const size_t run = SpanPassThroughRun(p, end, false /* utf8_safe */);
+      out->append(p, run);
+      p += run;
+      if (p == end) break;
+    }
+    unsigned char c = *p++;
     if (escape_all_bytes || !absl::ascii_isprint(c)) {
-      escaped_bytes += "\\x";
-      escaped_bytes += absl::BytesToHexString(absl::string_view(p, 1));
+      out->append("\\x");
+      out->push_back(hex_char[c / 16]);
+      out->push_back(hex_char[c % 16]);
     } else {
       switch (c) {
         // Note that we only handle printable escape characters here.  All
         // unprintable (\n, \r, \t, etc.) are hex escaped above.
         case '\\':
-          escaped_bytes += "\\\\";
+          out->append("\\\\");
           break;
         case '\'':
         case '"':
         case '`':
           // Escape only quote chars that match escape_quote_char.
           if (escape_quote_char == 0 || c == escape_quote_char) {
-            escaped_bytes += '\\';
+            out->push_back('\\');
           }
-          escaped_bytes += c;
+          out->push_back(c);
           break;
         default:
-          escaped_bytes += c;
+          out->push_back(c);
           break;
       }
     }
   }
-  return escaped_bytes;
 }
 
 static bool MayBeTripleQuotedString(const absl::string_view str) {
@@ -690,39 +800,71 @@ zetasql_base::Status ParseBytesLiteral(absl::string_view str, std::string* out,
   return ::zetasql_base::OkStatus();
 }
 
+// Returns the quote character that ToStringLiteral() and ToBytesLiteral() use
+// for <str>: single quotes if that avoids escaping, otherwise double quotes.
+static char ChooseLiteralQuoteChar(absl::string_view str) {
+  return (str.find('"') != str.npos && str.find('\'') == str.npos) ? '\''
+                                                                    : '"';
+}
+
+// Appends <str> quoted with <quote>, and prefixed with b if <is_bytes>.
+static void AppendQuotedLiteral(absl::string_view str, char quote,
+                                bool is_bytes, std::string* out) {
+  if (is_bytes) {
+    out->push_back('b');
+    out->push_back(quote);
+    AppendEscapedBytes(str, false /* escape_all_bytes */, quote, out);
+  } else {
+    out->push_back(quote);
+    CEscapeInternal(str, true /* utf8_safe */, quote, out);
+  }
+  out->push_back(quote);
+}
+
 std::string ToStringLiteral(absl::string_view str) {
-  absl::string_view quote =
-      (str.find('"') != str.npos && str.find('\'') == str.npos) ? "'" : "\"";
-  return absl::StrCat(
-      quote, CEscapeInternal(str, true /* utf8_safe */, quote[0]), quote);
+  std::string literal;
+  AppendStringLiteral(str, &literal);
+  return literal;
+}
+
+void AppendStringLiteral(absl::string_view str, std::string* out) {
+  AppendQuotedLiteral(str, ChooseLiteralQuoteChar(str), false /* is_bytes */,
+                      out);
 }
 
 std::string ToSingleQuotedStringLiteral(absl::string_view str) {
-  return absl::StrCat("'", CEscapeInternal(str, true /* utf8_safe */, '\''),
-                      "'");
+  std::string literal;
+  AppendQuotedLiteral(str, '\'', false /* is_bytes */, &literal);
+  return literal;
 }
 
 std::string ToDoubleQuotedStringLiteral(absl::string_view str) {
-  return absl::StrCat("\"", CEscapeInternal(str, true /* utf8_safe */, '"'),
-                      "\"");
+  std::string literal;
+  AppendQuotedLiteral(str, '"', false /* is_bytes */, &literal);
+  return literal;
 }
 
 std::string ToBytesLiteral(absl::string_view str) {
-  absl::string_view quote =
-      (str.find('"') != str.npos && str.find('\'') == str.npos) ? "'" : "\"";
-  return absl::StrCat("b", quote,
-                      EscapeBytes(str, false /* escape_all_bytes */, quote[0]),
-                      quote);
+  std::string literal;
+  AppendBytesLiteral(str, &literal);
+  return literal;
+}
+
+void AppendBytesLiteral(absl::string_view str, std::string* out) {
+  AppendQuotedLiteral(str, ChooseLiteralQuoteChar(str), true /* is_bytes */,
+                      out);
 }
 
 std::string ToSingleQuotedBytesLiteral(absl::string_view str) {
-  return absl::StrCat(
-      "b'", EscapeBytes(str, false /* escape_all_bytes */, '\''), "'");
+  std::string literal;
+  AppendQuotedLiteral(str, '\'', true /* is_bytes */, &literal);
+  return literal;
 }
 
 std::string ToDoubleQuotedBytesLiteral(absl::string_view str) {
-  return absl::StrCat(
-      "b\"", EscapeBytes(str, false /* escape_all_bytes */, '"'), "\"");
+  std::string literal;
+  AppendQuotedLiteral(str, '"', true /* is_bytes */, &literal);
+  return literal;
 }
 
 // Return true if <str> is a valid identifier without quoting.
@@ -64,6 +64,12 @@ std::string EscapeString(absl::string_view str);
 std::string EscapeBytes(absl::string_view str, bool escape_all_bytes = false,
                    char escape_quote_char = 0);
 
+// Same as EscapeString() and EscapeBytes(), but append the escaped value to
+// <out> instead of returning a new std::string.
+void AppendEscapedString(absl::string_view str, std::string* out);
+void AppendEscapedBytes(absl::string_view str, bool escape_all_bytes,
+                        char escape_quote_char, std::string* out);
+
 // Unquote and unescape a quoted ZetaSQL std::string literal (of the form '...',
 // "...", r'...' or r"...").
 // If an error occurs and <error_string> is not NULL, then it is populated with
@@ -106,6 +112,12 @@ std::string ToSingleQuotedBytesLiteral(absl::string_view str);
 // Prefixes with b and always uses double quotes.
 std::string ToDoubleQuotedBytesLiteral(absl::string_view str);
 
+// Same as ToStringLiteral() and ToBytesLiteral(), but append the literal to
+// <out>. Use these when building a larger std::string to avoid allocating a
+// temporary for each literal.
+void AppendStringLiteral(absl::string_view str, std::string* out);
+void AppendBytesLiteral(absl::string_view str, std::string* out);
+
 // Parse a ZetaSQL identifier.
 // The std::string may be quoted with backticks.  If so, unquote and unescape it.
 // Otherwise, the std::string must be a valid ZetaSQL identifier.
@@ -812,6 +812,39 @@ TEST(StringsTest, TestNewlines) {
   ExpectParsedString("a\r\nb", {"'''a\\r\\nb'''"});
 }
 
+TEST(StringsTest, LongStrings) {
+  // Long runs of characters that need no escaping are copied in bulk; make
+  // sure the characters around and between them are still handled.
+  const std::string run(37, 'x');
+  TestValue(run);
+  TestValue(absl::StrCat(run, "\n", run, "'", run, "\\"));
+  TestValue(absl::StrCat("\x01", run, "\xc3\xa9", run, "\x7f"));
+  EXPECT_EQ(absl::StrCat("'", run, "\\'\"", run, "'"),
+            ToSingleQuotedStringLiteral(absl::StrCat(run, "'\"", run)));
+  // A hex digit following a hex escape is escaped as well.
+  EXPECT_EQ(absl::StrCat("\\x01\\x61", run),
+            EscapeString(absl::StrCat("\x01" "a", run)));
+  ExpectParsedString(
+      absl::StrCat(run, "\n", run, "\n", run),
+      {absl::StrCat("'''", run, "\r\n", run, "\r", run, "'''")});
+  ExpectParsedBytes(absl::StrCat(run, "\x80", run),
+                    {absl::StrCat("b'", run, "\\x80", run, "'")});
+}
+
+TEST(StringsTest, AppendLiterals) {
+  std::string out = "SELECT ";
+  AppendStringLiteral("a'b", &out);
+  out.append(", ");
+  AppendBytesLiteral("c\nd", &out);
+  out.append(", ");
+  AppendEscapedString("e\"f", &out);
+  out.append(", ");
+  AppendEscapedBytes("g'h", false /* escape_all_bytes */, '"', &out);
+  out.append(", ");
+  AppendEscapedBytes("ij", true /* escape_all_bytes */, 0, &out);
+  EXPECT_EQ("SELECT \"a'b\", b\"c\\x0ad\", e\\\"f, g'h, \\x69\\x6a", out);
+}
+
 TEST(RawStringsTest, CompareRawAndRegularStringParsing) {
   ExpectParsedString("\\n",
                      {"r'\\n'", "r\"\\n\"", "r'''\\n'''", "r\"\"\"\\n\"\"\""});
@@ -17,6 +17,7 @@
 #include "zetasql/public/templated_sql_function.h"
 
 #include "zetasql/base/logging.h"
+#include "zetasql/parser/parser.h"
 #include "zetasql/proto/function.pb.h"
 #include "zetasql/proto/internal_error_location.pb.h"
 #include "zetasql/public/error_location.pb.h"
@@ -50,6 +51,25 @@ TemplatedSQLFunction::TemplatedSQLFunction(
   ZETASQL_CHECK_OK(signature.IsValidForFunction());
 }
 
+TemplatedSQLFunction::~TemplatedSQLFunction() {}
+
+zetasql_base::Status TemplatedSQLFunction::GetParsedExpression(
+    const ParserOutput** parser_output) const {
+  absl::call_once(parse_once_, [this]() {
+    // Use a dedicated IdStringPool and arena, since the parse tree is shared
+    // by every analysis that calls this function.
+    ParserOptions parser_options;
+    parser_options.CreateDefaultArenasIfNotSet();
+    std::unique_ptr<ParserOutput> output;
+    parse_status_ =
+        ParseExpression(parse_resume_location_, parser_options, &output);
+    parser_output_ = std::move(output);
+  });
+  ZETASQL_RETURN_IF_ERROR(parse_status_);
+  *parser_output = parser_output_.get();
+  return ::zetasql_base::OkStatus();
+}
+
 // static
 zetasql_base::Status TemplatedSQLFunction::Deserialize(
     const FunctionProto& proto,
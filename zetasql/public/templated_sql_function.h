@@ -25,6 +25,7 @@
 #include "zetasql/public/function.h"
 #include "zetasql/public/parse_resume_location.h"
 #include "zetasql/public/type.h"
+#include "absl/base/call_once.h"
 #include "zetasql/base/status.h"
 
 // This file includes interfaces and classes related to templated SQL
@@ -36,6 +37,7 @@
 namespace zetasql {
 
 class FunctionProto;
+class ParserOutput;
 class ResolvedComputedColumn;
 class ResolvedExpr;
 
@@ -75,6 +77,7 @@ class TemplatedSQLFunction : public Function {
                        const ParseResumeLocation& parse_resume_location,
                        Mode mode = Function::SCALAR,
                        const FunctionOptions& options = FunctionOptions());
+  ~TemplatedSQLFunction() override;
 
   const std::vector<std::string>& GetArgumentNames() const {
     return argument_names_;
@@ -104,6 +107,12 @@ class TemplatedSQLFunction : public Function {
     return parse_resume_location_;
   }
 
+  // Returns the parse tree of the SQL expression body in <*parser_output>.
+  // The body is parsed only once; later calls return the same ParserOutput,
+  // or the same parse error. The ParserOutput has its own IdStringPool and
+  // arena, is owned by this function and must not be modified. Thread-safe.
+  zetasql_base::Status GetParsedExpression(const ParserOutput** parser_output) const;
+
  private:
   // If non-NULL, this Catalog is used to override the catalog when the
   // resolver runs.
@@ -120,6 +129,12 @@ class TemplatedSQLFunction : public Function {
   // statement begins.  This allows the TemplatedSQLFunction to get access
   // to the SQL function body from the <parse_resume_location_> when needed.
   ParseResumeLocation parse_resume_location_;
+
+  // Result of parsing <parse_resume_location_>, computed once by
+  // GetParsedExpression().
+  mutable absl::once_flag parse_once_;
+  mutable zetasql_base::Status parse_status_;
+  mutable std::unique_ptr<const ParserOutput> parser_output_;
 };
 
 // This is the context for a specific call to a templated SQL function. It
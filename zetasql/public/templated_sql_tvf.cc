@@ -89,6 +89,37 @@ zetasql_base::Status TemplatedSQLTVF::Deserialize(
   return zetasql_base::OkStatus();
 }
 
+TemplatedSQLTVF::TemplatedSQLTVF(
+    const std::vector<std::string>& function_name_path,
+    const FunctionSignature& signature,
+    const std::vector<std::string>& arg_name_list,
+    const ParseResumeLocation& parse_resume_location)
+    : TableValuedFunction(function_name_path, signature),
+      arg_name_list_(arg_name_list),
+      parse_resume_location_(parse_resume_location) {}
+
+TemplatedSQLTVF::~TemplatedSQLTVF() {}
+
+zetasql_base::Status TemplatedSQLTVF::GetParsedStatement(
+    const ParserOutput** parser_output) const {
+  absl::call_once(parse_once_, [this]() {
+    // The parse tree outlives any single analysis, so it gets its own
+    // IdStringPool and arena.
+    ParserOptions parser_options;
+    parser_options.CreateDefaultArenasIfNotSet();
+    std::unique_ptr<ParserOutput> output;
+    bool at_end_of_input = false;
+    ParseResumeLocation this_parse_resume_location(parse_resume_location_);
+    parse_status_ = ParseNextStatement(&this_parse_resume_location,
+                                       parser_options, &output,
+                                       &at_end_of_input);
+    parser_output_ = std::move(output);
+  });
+  ZETASQL_RETURN_IF_ERROR(parse_status_);
+  *parser_output = parser_output_.get();
+  return ::zetasql_base::OkStatus();
+}
+
 zetasql_base::Status TemplatedSQLTVF::Resolve(
     const AnalyzerOptions* analyzer_options,
     const std::vector<TVFInputArgumentType>& input_arguments,
@@ -135,16 +166,10 @@ zetasql_base::Status TemplatedSQLTVF::Resolve(
     }
   }
 
-  // Create a separate new parser and parse the templated TVFs SQL query body.
-  // Use the same ID std::string pool from the original parser.
-  ParserOptions parser_options(analyzer_options->id_string_pool(),
-                               analyzer_options->arena());
-  std::unique_ptr<ParserOutput> parser_output;
-  bool at_end_of_input = false;
-  ParseResumeLocation this_parse_resume_location(parse_resume_location_);
+  // Get the parsed SQL query body, which is parsed once and then shared.
+  const ParserOutput* parser_output;
   ZETASQL_RETURN_IF_ERROR(ForwardNestedResolutionAnalysisError(
-      ParseNextStatement(&this_parse_resume_location, parser_options,
-                         &parser_output, &at_end_of_input),
+      GetParsedStatement(&parser_output),
       analyzer_options->error_message_mode()));
   if (parser_output->statement()->node_kind() != AST_QUERY_STATEMENT) {
     // TODO: Attach proper error locations to the returned Status.
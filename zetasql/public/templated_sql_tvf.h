@@ -28,6 +28,7 @@
 #include "zetasql/public/parse_resume_location.h"
 #include "zetasql/public/table_valued_function.h"
 #include "zetasql/public/type.h"
+#include "absl/base/call_once.h"
 #include "zetasql/base/status.h"
 
 // This file includes interfaces and classes related to templated SQL
@@ -39,6 +40,7 @@
 namespace zetasql {
 
 class AnalyzerOptions;
+class ParserOutput;
 class ResolvedQueryStmt;
 class TableValuedFunctionProto;
 
@@ -61,10 +63,8 @@ class TemplatedSQLTVF : public TableValuedFunction {
   TemplatedSQLTVF(const std::vector<std::string>& function_name_path,
                   const FunctionSignature& signature,
                   const std::vector<std::string>& arg_name_list,
-                  const ParseResumeLocation& parse_resume_location)
-      : TableValuedFunction(function_name_path, signature),
-        arg_name_list_(arg_name_list),
-        parse_resume_location_(parse_resume_location) {}
+                  const ParseResumeLocation& parse_resume_location);
+  ~TemplatedSQLTVF() override;
 
   const std::vector<std::string>& GetArgumentNames() const { return arg_name_list_; }
 
@@ -111,6 +111,12 @@ class TemplatedSQLTVF : public TableValuedFunction {
     return parse_resume_location_;
   }
 
+  // Returns the parse tree of the SQL query body in <*parser_output>. Like
+  // TemplatedSQLFunction::GetParsedExpression(), the body is parsed once and
+  // the ParserOutput (or parse error) is reused by every later Resolve().
+  // Thread-safe.
+  zetasql_base::Status GetParsedStatement(const ParserOutput** parser_output) const;
+
  private:
   // Performs some quick sanity checks on the function signature before starting
   // nested analysis.
@@ -146,6 +152,12 @@ class TemplatedSQLTVF : public TableValuedFunction {
 
   // If true, the analyzer allows query parameters within the SQL function body.
   bool allow_query_parameters_ = false;
+
+  // Result of parsing <parse_resume_location_>, computed once by
+  // GetParsedStatement().
+  mutable absl::once_flag parse_once_;
+  mutable zetasql_base::Status parse_status_;
+  mutable std::unique_ptr<const ParserOutput> parser_output_;
 };
 
 // The TemplatedSQLTVF::Resolve method returns an instance of this class. It
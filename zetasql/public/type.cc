@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <algorithm>
 #include <limits>
+#include <tuple>
 
 #include "zetasql/base/logging.h"
 #include "google/protobuf/descriptor.pb.h"
@@ -36,6 +37,7 @@
 #include <cstdint>
 #include "absl/base/macros.h"
 #include "absl/base/optimization.h"
+#include "absl/hash/hash.h"
 #include "absl/memory/memory.h"
 #include "zetasql/base/case.h"
 #include "absl/strings/match.h"
@@ -1487,8 +1489,11 @@ bool TypeEquals::operator()(const Type* const type1,
 }
 
 TypeFactory::TypeFactory()
-    : cached_simple_types_(),
-      nesting_depth_limit_(kDefaultTypeFactoryNestingDepthLimit) {}
+    : nesting_depth_limit_(kDefaultTypeFactoryNestingDepthLimit) {
+  for (std::atomic<const Type*>& cached_type : cached_simple_types_) {
+    cached_type.store(nullptr, std::memory_order_relaxed);
+  }
+}
 
 TypeFactory::~TypeFactory() {
   // Need to delete these in a loop because the destructor is only visible
@@ -1522,6 +1527,11 @@ int TypeFactory::nesting_depth_limit() const {
   return nesting_depth_limit_;
 }
 
+int64_t TypeFactory::GetEstimatedOwnedMemoryBytesSize() const {
+  absl::MutexLock l(&mutex_);
+  return estimated_owned_memory_bytes_;
+}
+
 void TypeFactory::set_nesting_depth_limit(int value) {
   // We don't want to have to check the depth for simple types, so a depth of
   // 0 must be allowed.
@@ -1540,6 +1550,12 @@ template <class TYPE>
 const TYPE* TypeFactory::TakeOwnershipLocked(const TYPE* type) {
   DCHECK_EQ(type->type_factory_, this);
   owned_types_.push_back(type);
+  estimated_owned_memory_bytes_ += sizeof(TYPE) + sizeof(type);
+  if (type->IsStruct()) {
+    for (const StructField& field : type->AsStruct()->fields()) {
+      estimated_owned_memory_bytes_ += sizeof(field) + field.name.capacity();
+    }
+  }
   return type;
 }
 
@@ -1569,12 +1585,44 @@ const Type* TypeFactory::get_numeric() {
 
 const Type* TypeFactory::MakeSimpleType(TypeKind kind) {
   CHECK(Type::IsSimpleType(kind)) << kind;
+  std::atomic<const Type*>& cached_type = cached_simple_types_[kind];
+  const Type* type = cached_type.load(std::memory_order_acquire);
+  if (ABSL_PREDICT_TRUE(type != nullptr)) {
+    return type;
+  }
   absl::MutexLock l(&mutex_);
-  if (cached_simple_types_[kind] == nullptr) {
-    cached_simple_types_[kind] =
-        TakeOwnershipLocked(new SimpleType(this, kind));
+  // Another thread may have created the type while we were waiting.
+  type = cached_type.load(std::memory_order_relaxed);
+  if (type == nullptr) {
+    type = TakeOwnershipLocked(new SimpleType(this, kind));
+    cached_type.store(type, std::memory_order_release);
+  }
+  return type;
+}
+
+size_t TypeFactory::StructFieldsHash::operator()(
+    absl::Span<const StructField> fields) const {
+  size_t hash = fields.size();
+  for (const StructField& field : fields) {
+    hash = absl::Hash<std::tuple<size_t, absl::string_view, const Type*>>()(
+        std::make_tuple(hash, absl::string_view(field.name), field.type));
+  }
+  return hash;
+}
+
+bool TypeFactory::StructFieldsEq::operator()(
+    absl::Span<const StructField> fields1,
+    absl::Span<const StructField> fields2) const {
+  if (fields1.size() != fields2.size()) return false;
+  for (int i = 0; i < fields1.size(); ++i) {
+    // Field names are compared case-sensitively because they are preserved
+    // in the type name.
+    if (fields1[i].type != fields2[i].type ||
+        fields1[i].name != fields2[i].name) {
+      return false;
+    }
   }
-  return cached_simple_types_[kind];
+  return true;
 }
 
 zetasql_base::Status TypeFactory::MakeArrayType(
@@ -1591,7 +1639,21 @@ zetasql_base::Status TypeFactory::MakeArrayType(
              << "Array type would exceed nesting depth limit of "
              << depth_limit;
     }
-    *result = TakeOwnership(new ArrayType(this, element_type));
+    {
+      absl::ReaderMutexLock l(&mutex_);
+      const ArrayType* const* cached =
+          zetasql_base::FindOrNull(cached_array_types_, element_type);
+      if (cached != nullptr) {
+        *result = *cached;
+        return ::zetasql_base::OkStatus();
+      }
+    }
+    absl::MutexLock l(&mutex_);
+    const ArrayType*& cached = cached_array_types_[element_type];
+    if (cached == nullptr) {
+      cached = TakeOwnershipLocked(new ArrayType(this, element_type));
+    }
+    *result = cached;
     return ::zetasql_base::OkStatus();
   }
 }
@@ -1629,10 +1691,26 @@ zetasql_base::Status TypeFactory::MakeStructTypeFromVector(
     }
     AddDependency(field.type);
   }
+  const absl::Span<const StructField> key(fields);
+  {
+    absl::ReaderMutexLock l(&mutex_);
+    const auto it = cached_struct_types_.find(key);
+    if (it != cached_struct_types_.end()) {
+      *result = *it;
+      return ::zetasql_base::OkStatus();
+    }
+  }
+  absl::MutexLock l(&mutex_);
+  const auto it = cached_struct_types_.find(key);
+  if (it != cached_struct_types_.end()) {
+    *result = *it;
+    return ::zetasql_base::OkStatus();
+  }
   // We calculate <max_nesting_depth> in the previous loop. We also need to
   // increment it to take into account the struct itself.
-  *result = TakeOwnership(
+  *result = TakeOwnershipLocked(
       new StructType(this, std::move(fields), max_nesting_depth + 1));
+  cached_struct_types_.insert(*result);
   return ::zetasql_base::OkStatus();
 }
 
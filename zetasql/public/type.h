@@ -17,9 +17,11 @@
 #ifndef ZETASQL_PUBLIC_TYPE_H_
 #define ZETASQL_PUBLIC_TYPE_H_
 
-// TODO Maybe store and re-use the same type object for all identical
-//   struct/array/proto/enum types?
+// TODO Maybe also re-use the same type object for all identical
+//   proto/enum types? Simple, array and struct types are already interned
+//   by TypeFactory.
 
+#include <atomic>
 #include <cstddef>
 #include <functional>
 #include <memory>
@@ -992,7 +994,9 @@ struct TypeEquals {
 // A TypeFactory creates and owns Type objects.
 // Created Type objects live until the TypeFactory is destroyed.
 // The TypeFactory may return the same Type object from multiple calls that
-// request equivalent types.
+// request equivalent types. In particular, simple types, and array and struct
+// types built from the same component Type objects (and the same field names)
+// are interned, so repeated requests do not allocate.
 //
 // When a compound Type (array or struct) is constructed referring to a Type
 // from a separate TypeFactory, the constructed type may refer to the Type from
@@ -1174,6 +1178,10 @@ class TypeFactory {
   int nesting_depth_limit() const LOCKS_EXCLUDED(mutex_);
   void set_nesting_depth_limit(int value) LOCKS_EXCLUDED(mutex_);
 
+  // Returns the approximate memory used by the types owned by this
+  // TypeFactory. Types are never released, so this only grows.
+  int64_t GetEstimatedOwnedMemoryBytesSize() const LOCKS_EXCLUDED(mutex_);
+
  private:
   // Store links to and from TypeFactories that this TypeFactory depends on.
   // This is used as a sanity check to catch incorrect destruction order.
@@ -1217,12 +1225,50 @@ class TypeFactory {
       const Type** result_type,
       std::set<const google::protobuf::Descriptor*>* ancestor_messages);
 
+  // Hash and equality over the field names and Type pointers of a struct,
+  // which can be looked up with either a StructType or a span of fields.
+  struct StructFieldsHash {
+    using is_transparent = void;
+    size_t operator()(absl::Span<const StructField> fields) const;
+    size_t operator()(const StructType* type) const {
+      return (*this)(type->fields());
+    }
+  };
+  struct StructFieldsEq {
+    using is_transparent = void;
+    bool operator()(absl::Span<const StructField> fields1,
+                    absl::Span<const StructField> fields2) const;
+    bool operator()(const StructType* type1, const StructType* type2) const {
+      return (*this)(type1->fields(), type2->fields());
+    }
+    bool operator()(const StructType* type1,
+                    absl::Span<const StructField> fields2) const {
+      return (*this)(type1->fields(), fields2);
+    }
+    bool operator()(absl::Span<const StructField> fields1,
+                    const StructType* type2) const {
+      return (*this)(fields1, type2->fields());
+    }
+  };
+
   // TODO: Should TypeFactory have a DescriptorPool?
   mutable absl::Mutex mutex_;
-  const Type* cached_simple_types_[TypeKind_ARRAYSIZE] GUARDED_BY(mutex_);
   std::vector<const Type*> owned_types_ GUARDED_BY(mutex_);
 
+  // Simple types are created on first use and never change afterwards, so
+  // they are read without taking <mutex_>.
+  std::atomic<const Type*> cached_simple_types_[TypeKind_ARRAYSIZE];
+
+  // Interned array and struct types. Lookups take <mutex_> in shared mode;
+  // only the first request for a given type takes it exclusively.
+  absl::flat_hash_map<const Type*, const ArrayType*> cached_array_types_
+      GUARDED_BY(mutex_);
+  absl::flat_hash_set<const StructType*, StructFieldsHash, StructFieldsEq>
+      cached_struct_types_ GUARDED_BY(mutex_);
+
   int nesting_depth_limit_ GUARDED_BY(mutex_);
+
+  int64_t estimated_owned_memory_bytes_ GUARDED_BY(mutex_) = 0;
 };
 
 namespace types {
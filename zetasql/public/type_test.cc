@@ -0,0 +1,114 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/type.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "zetasql/base/testing/status_matchers.h"
+#include "gtest/gtest.h"
+
+namespace zetasql {
+
+TEST(TypeFactoryTest, SimpleTypesAreInterned) {
+  TypeFactory factory;
+  const Type* int64_type = factory.get_int64();
+  EXPECT_TRUE(int64_type->IsInt64());
+  EXPECT_EQ(int64_type, factory.get_int64());
+  EXPECT_EQ(int64_type, factory.MakeSimpleType(TYPE_INT64));
+  EXPECT_NE(int64_type, factory.get_int32());
+}
+
+TEST(TypeFactoryTest, ArrayTypesAreInterned) {
+  TypeFactory factory;
+  const ArrayType* array1;
+  const ArrayType* array2;
+  const ArrayType* array3;
+  ZETASQL_ASSERT_OK(factory.MakeArrayType(factory.get_int64(), &array1));
+  ZETASQL_ASSERT_OK(factory.MakeArrayType(factory.get_int64(), &array2));
+  ZETASQL_ASSERT_OK(factory.MakeArrayType(factory.get_string(), &array3));
+  EXPECT_EQ(array1, array2);
+  EXPECT_NE(array1, array3);
+
+  // Types from another factory are distinct components.
+  const ArrayType* array4;
+  ZETASQL_ASSERT_OK(factory.MakeArrayType(types::Int64Type(), &array4));
+  EXPECT_NE(array1, array4);
+  EXPECT_TRUE(array1->Equals(array4));
+}
+
+TEST(TypeFactoryTest, StructTypesAreInterned) {
+  TypeFactory factory;
+  const StructType* struct1;
+  const StructType* struct2;
+  ZETASQL_ASSERT_OK(factory.MakeStructType(
+      {{"a", factory.get_int64()}, {"b", factory.get_string()}}, &struct1));
+  ZETASQL_ASSERT_OK(factory.MakeStructType(
+      {{"a", factory.get_int64()}, {"b", factory.get_string()}}, &struct2));
+  EXPECT_EQ(struct1, struct2);
+
+  const ArrayType* array1;
+  const ArrayType* array2;
+  ZETASQL_ASSERT_OK(factory.MakeArrayType(struct1, &array1));
+  ZETASQL_ASSERT_OK(factory.MakeArrayType(struct2, &array2));
+  EXPECT_EQ(array1, array2);
+
+  // Field names are part of the key, including their case.
+  const StructType* struct3;
+  ZETASQL_ASSERT_OK(factory.MakeStructType(
+      {{"A", factory.get_int64()}, {"b", factory.get_string()}}, &struct3));
+  EXPECT_NE(struct1, struct3);
+  EXPECT_EQ("STRUCT<A INT64, b STRING>", struct3->DebugString());
+
+  const StructType* struct4;
+  ZETASQL_ASSERT_OK(factory.MakeStructType({{"a", factory.get_int64()}}, &struct4));
+  EXPECT_NE(struct1, struct4);
+
+  const StructType* empty1;
+  const StructType* empty2;
+  ZETASQL_ASSERT_OK(factory.MakeStructType({}, &empty1));
+  ZETASQL_ASSERT_OK(factory.MakeStructType({}, &empty2));
+  EXPECT_EQ(empty1, empty2);
+}
+
+TEST(TypeFactoryTest, ConcurrentInterning) {
+  TypeFactory factory;
+  constexpr int kNumThreads = 8;
+  std::vector<const Type*> results(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&factory, &results, i] {
+      const Type* array_type = nullptr;
+      for (int j = 0; j < 100; ++j) {
+        const StructType* struct_type;
+        ZETASQL_CHECK_OK(factory.MakeStructType(
+            {{"x", factory.get_double()}, {"y", factory.get_double()}},
+            &struct_type));
+        ZETASQL_CHECK_OK(factory.MakeArrayType(struct_type, &array_type));
+      }
+      results[i] = array_type;
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (const Type* type : results) {
+    EXPECT_EQ(results[0], type);
+  }
+}
+
+}  // namespace zetasql
@@ -55,6 +55,7 @@ using zetasql::types::BoolArrayType;
 using zetasql::types::BoolType;
 using zetasql::types::BytesArrayType;
 using zetasql::types::BytesType;
+using zetasql::types::DateArrayType;
 using zetasql::types::DatetimeType;
 using zetasql::types::DateType;
 using zetasql::types::DoubleArrayType;
@@ -81,6 +82,13 @@ using absl::Substitute;
 
 namespace zetasql {
 
+namespace {
+
+// True while a ThreadConfinedValueScope is alive on this thread.
+thread_local bool thread_confined_value_scope_active = false;
+
+}  // namespace
+
 // -------------------------------------------------------
 // Value
 // -------------------------------------------------------
@@ -108,24 +116,26 @@ Value::Value(const Type* type)
       break;
     case TYPE_STRING:
     case TYPE_BYTES:
-      string_ptr_ = new StringRef();
+      // Null std::string and bytes values are stored inline.
+      string_length_ = 0;
       break;
     case TYPE_GEOGRAPHY:
       geography_ptr_ = new GeographyRef();
       break;
     case TYPE_NUMERIC:
-      numeric_ptr_ = new NumericRef();
+      // Null NUMERIC values are stored inline.
+      numeric_high_bits_ = 0;
+      numeric_low_bits_ = 0;
       break;
     case TYPE_ENUM:
       enum_type_ = type->AsEnum();
       break;
     case TYPE_ARRAY:
     case TYPE_STRUCT:
-      list_ptr_ = new TypedList(type);
+      list_ptr_ = MaybeConfine(new TypedList(type));
       break;
     case TYPE_PROTO:
-      proto_ptr_ = new ProtoRep(type->AsProto(),
-                                "");
+      proto_ptr_ = new ProtoRep(type->AsProto(), "");
       break;
     case TYPE_UNKNOWN:
     case __TypeKind__switch_must_have_a_default__:
@@ -145,13 +155,13 @@ void Value::CopyFrom(const Value& that) {
       break;
     case TYPE_STRING:
     case TYPE_BYTES:
-      string_ptr_->Ref();
+      if (has_string_ref()) string_ptr_->Ref();
       break;
     case TYPE_GEOGRAPHY:
       geography_ptr_->Ref();
       break;
     case TYPE_NUMERIC:
-      numeric_ptr_->Ref();
+      if (has_numeric_ref()) numeric_ptr_->Ref();
       break;
     case TYPE_PROTO:
       proto_ptr_->Ref();
@@ -237,7 +247,7 @@ Value Value::ArrayInternal(bool safe, const ArrayType* array_type,
   Value result(array_type);
   result.is_null_ = false;
   result.order_kind_ = order_kind;
-  std::vector<Value>& value_list = result.list_ptr_->values();
+  std::vector<Value>& value_list = result.list_ptr_->mutable_values();
   value_list = std::move(values);
   if (kDebugMode || safe) {
     for (const Value& v : value_list) {
@@ -253,7 +263,7 @@ Value Value::StructInternal(bool safe, const StructType* struct_type,
                             std::vector<Value>&& values) {
   Value result(struct_type);
   result.is_null_ = false;
-  std::vector<Value>& value_list = result.list_ptr_->values();
+  std::vector<Value>& value_list = result.list_ptr_->mutable_values();
   value_list = std::move(values);
   if (kDebugMode || safe) {
     // Check that values are compatible with the type.
@@ -269,6 +279,191 @@ Value Value::StructInternal(bool safe, const StructType* struct_type,
   return result;
 }
 
+Value::TypedList::TypedList(const ArrayType* array_type, size_t element_size,
+                            const void* data, int num_elements,
+                            std::vector<uint64_t> null_bitmap)
+    : type_(array_type), packed_(new PackedElements) {
+  packed_->data.reset(
+      new char[std::max<size_t>(num_elements * element_size, 1)]);
+  packed_->size = num_elements;
+  packed_->element_size = element_size;
+  packed_->null_bitmap = std::move(null_bitmap);
+  if (num_elements > 0) {
+    memcpy(packed_->data.get(), data, num_elements * element_size);
+  }
+}
+
+template <typename T>
+void Value::TypedList::MaterializeAs(Value (*make_value)(T)) const {
+  const Type* element_type = type_->AsArray()->element_type();
+  const T* data = static_cast<const T*>(packed_data());
+  values_.reserve(packed_->size);
+  for (int i = 0; i < packed_->size; ++i) {
+    values_.push_back(packed_element_is_null(i) ? Value::Null(element_type)
+                                                : make_value(data[i]));
+  }
+}
+
+void Value::TypedList::MaterializeValues() const {
+  const Type* element_type = type_->AsArray()->element_type();
+  switch (element_type->kind()) {
+    case TYPE_INT32:
+      MaterializeAs(&Value::Int32);
+      break;
+    case TYPE_INT64:
+      MaterializeAs(&Value::Int64);
+      break;
+    case TYPE_UINT32:
+      MaterializeAs(&Value::Uint32);
+      break;
+    case TYPE_UINT64:
+      MaterializeAs(&Value::Uint64);
+      break;
+    case TYPE_BOOL:
+      MaterializeAs(&Value::Bool);
+      break;
+    case TYPE_FLOAT:
+      MaterializeAs(&Value::Float);
+      break;
+    case TYPE_DOUBLE:
+      MaterializeAs(&Value::Double);
+      break;
+    case TYPE_DATE:
+      MaterializeAs(&Value::Date);
+      break;
+    default:
+      LOG(FATAL) << "Unexpected packed element type: "
+                 << element_type->DebugString();
+  }
+}
+
+bool Value::TypedList::PackedBytesEqual(const TypedList& that,
+                                        bool* equal) const {
+  if (!is_packed() || !that.is_packed() || packed_has_nulls() ||
+      that.packed_has_nulls()) {
+    return false;
+  }
+  const TypeKind element_kind = type_->AsArray()->element_type()->kind();
+  if (element_kind == TYPE_FLOAT || element_kind == TYPE_DOUBLE ||
+      element_kind != that.type_->AsArray()->element_type()->kind()) {
+    return false;
+  }
+  *equal = size() == that.size() &&
+           memcmp(packed_data(), that.packed_data(),
+                  size() * packed_->element_size) == 0;
+  return true;
+}
+
+uint64_t Value::TypedList::physical_byte_size() const {
+  if (physical_byte_size_ != 0) {
+    return physical_byte_size_;
+  }
+  uint64_t size = sizeof(TypedList);
+  if (is_packed()) {
+    // values_ may be materialized concurrently, so it is not read here. The
+    // elements are fixed-width scalars, so count them as if materialized.
+    size += sizeof(PackedElements) +
+            packed_->size * (packed_->element_size + sizeof(Value)) +
+            packed_->null_bitmap.size() * sizeof(uint64_t);
+  } else {
+    for (const Value& value : values_) {
+      size += value.physical_byte_size();
+    }
+  }
+  physical_byte_size_ = size;
+  return size;
+}
+
+Value Value::PackedArrayInternal(const ArrayType* array_type,
+                                 TypeKind element_kind,
+                                 TypeKind alt_element_kind,
+                                 size_t element_size, const void* data,
+                                 size_t num_elements,
+                                 absl::Span<const bool> is_null) {
+  const TypeKind kind = array_type->element_type()->kind();
+  CHECK(kind == element_kind || kind == alt_element_kind)
+      << "Cannot create a packed " << array_type->DebugString()
+      << " from elements of type " << TypeKind_Name(element_kind);
+  CHECK_LE(num_elements, std::numeric_limits<int>::max());
+  std::vector<uint64_t> null_bitmap;
+  if (!is_null.empty()) {
+    CHECK_EQ(num_elements, is_null.size());
+    for (size_t i = 0; i < num_elements; ++i) {
+      if (!is_null[i]) continue;
+      if (null_bitmap.empty()) null_bitmap.resize((num_elements + 63) / 64);
+      null_bitmap[i / 64] |= uint64_t{1} << (i % 64);
+    }
+  }
+  Value result;
+  result.type_kind_ = TYPE_ARRAY;
+  result.list_ptr_ = MaybeConfine(
+      new TypedList(array_type, element_size, data,
+                    static_cast<int>(num_elements), std::move(null_bitmap)));
+  return result;
+}
+
+Value Value::PackedArray(const ArrayType* array_type,
+                         absl::Span<const int32_t> values,
+                         absl::Span<const bool> is_null) {
+  if (array_type->element_type()->kind() == TYPE_DATE) {
+    for (int i = 0; i < values.size(); ++i) {
+      if (!is_null.empty() && is_null[i]) continue;
+      CHECK_LE(values[i], types::kDateMax);
+      CHECK_GE(values[i], types::kDateMin);
+    }
+  }
+  return PackedArrayInternal(array_type, TYPE_INT32, TYPE_DATE,
+                             sizeof(int32_t), values.data(), values.size(),
+                             is_null);
+}
+
+Value Value::PackedArray(const ArrayType* array_type,
+                         absl::Span<const int64_t> values,
+                         absl::Span<const bool> is_null) {
+  return PackedArrayInternal(array_type, TYPE_INT64, TYPE_INT64,
+                             sizeof(int64_t), values.data(), values.size(),
+                             is_null);
+}
+
+Value Value::PackedArray(const ArrayType* array_type,
+                         absl::Span<const uint32_t> values,
+                         absl::Span<const bool> is_null) {
+  return PackedArrayInternal(array_type, TYPE_UINT32, TYPE_UINT32,
+                             sizeof(uint32_t), values.data(), values.size(),
+                             is_null);
+}
+
+Value Value::PackedArray(const ArrayType* array_type,
+                         absl::Span<const uint64_t> values,
+                         absl::Span<const bool> is_null) {
+  return PackedArrayInternal(array_type, TYPE_UINT64, TYPE_UINT64,
+                             sizeof(uint64_t), values.data(), values.size(),
+                             is_null);
+}
+
+Value Value::PackedArray(const ArrayType* array_type,
+                         absl::Span<const bool> values,
+                         absl::Span<const bool> is_null) {
+  return PackedArrayInternal(array_type, TYPE_BOOL, TYPE_BOOL, sizeof(bool),
+                             values.data(), values.size(), is_null);
+}
+
+Value Value::PackedArray(const ArrayType* array_type,
+                         absl::Span<const float> values,
+                         absl::Span<const bool> is_null) {
+  return PackedArrayInternal(array_type, TYPE_FLOAT, TYPE_FLOAT,
+                             sizeof(float), values.data(), values.size(),
+                             is_null);
+}
+
+Value Value::PackedArray(const ArrayType* array_type,
+                         absl::Span<const double> values,
+                         absl::Span<const bool> is_null) {
+  return PackedArrayInternal(array_type, TYPE_DOUBLE, TYPE_DOUBLE,
+                             sizeof(double), values.data(), values.size(),
+                             is_null);
+}
+
 const Type* Value::type() const {
   CHECK(is_valid()) << DebugString();
   switch (type_kind()) {
@@ -313,6 +508,71 @@ const std::vector<Value>& Value::elements() const {
   return list_ptr_->values();
 }
 
+bool Value::has_packed_elements() const {
+  CHECK_EQ(TYPE_ARRAY, type_kind_);
+  CHECK(!is_null()) << "Null value";
+  return list_ptr_->is_packed();
+}
+
+const void* Value::PackedElementData(TypeKind element_kind) const {
+  CHECK(has_packed_elements()) << "Array elements are not packed";
+  CHECK_EQ(element_kind, list_ptr_->type()->AsArray()->element_type()->kind());
+  return list_ptr_->packed_data();
+}
+
+absl::Span<const int32_t> Value::packed_int32_elements() const {
+  return absl::MakeConstSpan(
+      static_cast<const int32_t*>(PackedElementData(TYPE_INT32)),
+      list_ptr_->size());
+}
+
+absl::Span<const int64_t> Value::packed_int64_elements() const {
+  return absl::MakeConstSpan(
+      static_cast<const int64_t*>(PackedElementData(TYPE_INT64)),
+      list_ptr_->size());
+}
+
+absl::Span<const uint32_t> Value::packed_uint32_elements() const {
+  return absl::MakeConstSpan(
+      static_cast<const uint32_t*>(PackedElementData(TYPE_UINT32)),
+      list_ptr_->size());
+}
+
+absl::Span<const uint64_t> Value::packed_uint64_elements() const {
+  return absl::MakeConstSpan(
+      static_cast<const uint64_t*>(PackedElementData(TYPE_UINT64)),
+      list_ptr_->size());
+}
+
+absl::Span<const bool> Value::packed_bool_elements() const {
+  return absl::MakeConstSpan(
+      static_cast<const bool*>(PackedElementData(TYPE_BOOL)),
+      list_ptr_->size());
+}
+
+absl::Span<const float> Value::packed_float_elements() const {
+  return absl::MakeConstSpan(
+      static_cast<const float*>(PackedElementData(TYPE_FLOAT)),
+      list_ptr_->size());
+}
+
+absl::Span<const double> Value::packed_double_elements() const {
+  return absl::MakeConstSpan(
+      static_cast<const double*>(PackedElementData(TYPE_DOUBLE)),
+      list_ptr_->size());
+}
+
+absl::Span<const int32_t> Value::packed_date_elements() const {
+  return absl::MakeConstSpan(
+      static_cast<const int32_t*>(PackedElementData(TYPE_DATE)),
+      list_ptr_->size());
+}
+
+bool Value::packed_element_is_null(int i) const {
+  CHECK(has_packed_elements()) << "Array elements are not packed";
+  return list_ptr_->packed_element_is_null(i);
+}
+
 Value Value::TimestampFromUnixMicros(int64_t v) {
   CHECK(functions::IsValidTimestamp(v, functions::kMicroseconds)) << v;
   return Value(absl::FromUnixMicros(v));
@@ -430,11 +690,11 @@ uint64_t Value::physical_byte_size() const {
     case TYPE_TIMESTAMP:
       break;
     case TYPE_NUMERIC:
-      physical_size += sizeof(NumericRef);
+      if (has_numeric_ref()) physical_size += sizeof(NumericRef);
       break;
     case TYPE_STRING:
     case TYPE_BYTES:
-      physical_size += string_ptr_->physical_byte_size();
+      if (has_string_ref()) physical_size += string_ptr_->physical_byte_size();
       break;
     case TYPE_ARRAY:
     case TYPE_STRUCT:
@@ -452,12 +712,60 @@ uint64_t Value::physical_byte_size() const {
   return physical_size;
 }
 
+template <typename Fn>
+bool Value::ForEachRef(const Fn& fn) const {
+  if (!is_valid()) return true;
+  switch (type_kind_) {
+    case TYPE_STRING:
+    case TYPE_BYTES:
+      return !has_string_ref() || fn(string_ptr_);
+    case TYPE_ARRAY:
+    case TYPE_STRUCT:
+      if (!fn(list_ptr_)) return false;
+      // The elements of packed lists hold no reference counted objects.
+      if (list_ptr_->is_packed()) return true;
+      for (const Value& element : list_ptr_->values()) {
+        if (!element.ForEachRef(fn)) return false;
+      }
+      return true;
+    default:
+      return true;
+  }
+}
+
+void Value::MakeShareable() {
+  ForEachRef([](const zetasql_base::ThreadConfinableReferenceCounted* ref) {
+    ref->Share();
+    return true;
+  });
+}
+
+bool Value::IsShareable() const {
+  return ForEachRef(
+      [](const zetasql_base::ThreadConfinableReferenceCounted* ref) {
+        return !ref->IsThreadConfined();
+      });
+}
+
+ThreadConfinedValueScope::ThreadConfinedValueScope()
+    : previously_active_(thread_confined_value_scope_active) {
+  thread_confined_value_scope_active = true;
+}
+
+ThreadConfinedValueScope::~ThreadConfinedValueScope() {
+  thread_confined_value_scope_active = previously_active_;
+}
+
+bool ThreadConfinedValueScope::IsActive() {
+  return thread_confined_value_scope_active;
+}
+
 std::string Value::ToCord() const {
   CHECK(!is_null()) << "Null value";
   switch (type_kind_) {
     case TYPE_STRING:
     case TYPE_BYTES:
-      return string_ptr_->value();
+      return std::string(string_payload());
     case TYPE_PROTO:
       return proto_ptr_->value();
     default:
@@ -605,8 +913,8 @@ bool Value::EqualsInternal(const Value& x, const Value& y, bool allow_bags,
       return float_margin.Equal(x.float_value(), y.float_value());
     case TYPE_DOUBLE:
       return float_margin.Equal(x.double_value(), y.double_value());
-    case TYPE_STRING: return x.string_value() == y.string_value();
-    case TYPE_BYTES: return x.bytes_value() == y.bytes_value();
+    case TYPE_STRING: return x.string_view_value() == y.string_view_value();
+    case TYPE_BYTES: return x.bytes_view_value() == y.bytes_view_value();
     case TYPE_DATE: return x.date_value() == y.date_value();
     case TYPE_TIMESTAMP:
       return x.timestamp_seconds_ == y.timestamp_seconds_ &&
@@ -640,6 +948,11 @@ bool Value::EqualsInternal(const Value& x, const Value& y, bool allow_bags,
         return EqualElementMultiSet(x, y, element_order_spec, float_margin,
                                     reason);
       }
+      bool packed_equal;
+      if (x.list_ptr_->PackedBytesEqual(*y.list_ptr_, &packed_equal) &&
+          (packed_equal || reason == nullptr)) {
+        return packed_equal;
+      }
       for (int i = 0; i < x.num_elements(); i++) {
         if (!EqualsInternal(x.element(i), y.element(i), allow_bags,
                             element_order_spec, float_margin, reason)) {
@@ -1043,8 +1356,8 @@ bool Value::LessThan(const Value& that) const {
           return false;
         }
         return double_value() < that.double_value();
-      case TYPE_STRING: return string_value() < that.string_value();
-      case TYPE_BYTES: return bytes_value() < that.bytes_value();
+      case TYPE_STRING: return string_view_value() < that.string_view_value();
+      case TYPE_BYTES: return bytes_view_value() < that.bytes_view_value();
       case TYPE_DATE: return date_value() < that.date_value();
       case TYPE_TIMESTAMP:
         return ToTime() < that.ToTime();
@@ -1303,10 +1616,10 @@ std::string Value::DebugString(bool verbose) const {
         s = RoundTripDoubleToString(double_value());
         break;
       case TYPE_STRING:
-        s = ToStringLiteral(string_value());
+        s = ToStringLiteral(string_view_value());
         break;
       case TYPE_BYTES:
-        s = ToBytesLiteral(bytes_value());
+        s = ToBytesLiteral(bytes_view_value());
         break;
       case TYPE_DATE:
         // Failure cannot actually happen in this context since date_value()
@@ -1866,60 +2179,39 @@ bool Value::ParseInteger(absl::string_view input, Value* value) {
 namespace values {
 
 Value Int32Array(absl::Span<const int32_t> values) {
-  std::vector<Value> value_vector;
-  for (auto v : values) {
-    value_vector.push_back(Int32(v));
-  }
-  return Value::Array(Int32ArrayType(), value_vector);
+  return Value::PackedArray(Int32ArrayType(), values);
 }
 
 Value Int64Array(absl::Span<const int64_t> values) {
-  std::vector<Value> value_vector;
-  for (auto v : values) {
-    value_vector.push_back(Int64(v));
-  }
-  return Value::Array(Int64ArrayType(), value_vector);
+  return Value::PackedArray(Int64ArrayType(), values);
 }
 
 Value Uint32Array(absl::Span<const uint32_t> values) {
-  std::vector<Value> value_vector;
-  for (auto v : values) {
-    value_vector.push_back(Uint32(v));
-  }
-  return Value::Array(Uint32ArrayType(), value_vector);
+  return Value::PackedArray(Uint32ArrayType(), values);
 }
 
 Value Uint64Array(absl::Span<const uint64_t> values) {
-  std::vector<Value> value_vector;
-  for (auto v : values) {
-    value_vector.push_back(Uint64(v));
-  }
-  return Value::Array(Uint64ArrayType(), value_vector);
+  return Value::PackedArray(Uint64ArrayType(), values);
 }
 
 Value BoolArray(const std::vector<bool>& values) {
-  std::vector<Value> value_vector;
-  value_vector.reserve(values.size());
-  for (auto v : values) {
-    value_vector.push_back(Bool(v));
-  }
-  return Value::Array(BoolArrayType(), value_vector);
+  // std::vector<bool> is not contiguous, so copy it first.
+  std::unique_ptr<bool[]> bools(new bool[values.size()]);
+  std::copy(values.begin(), values.end(), bools.get());
+  return Value::PackedArray(BoolArrayType(),
+                            absl::MakeConstSpan(bools.get(), values.size()));
+}
+
+Value DateArray(absl::Span<const int32_t> values) {
+  return Value::PackedArray(DateArrayType(), values);
 }
 
 Value FloatArray(absl::Span<const float> values) {
-  std::vector<Value> value_vector;
-  for (auto v : values) {
-    value_vector.push_back(Float(v));
-  }
-  return Value::Array(FloatArrayType(), value_vector);
+  return Value::PackedArray(FloatArrayType(), values);
 }
 
 Value DoubleArray(absl::Span<const double> values) {
-  std::vector<Value> value_vector;
-  for (auto v : values) {
-    value_vector.push_back(Double(v));
-  }
-  return Value::Array(DoubleArrayType(), value_vector);
+  return Value::PackedArray(DoubleArrayType(), values);
 }
 
 Value StringArray(absl::Span<const std::string> values) {
@@ -1980,10 +2272,10 @@ zetasql_base::Status Value::Serialize(ValueProto* value_proto) const {
       value_proto->set_numeric_value(numeric_value().SerializeAsProtoBytes());
       break;
     case TYPE_STRING:
-      value_proto->set_string_value(string_value());
+      value_proto->set_string_value(std::string(string_view_value()));
       break;
     case TYPE_BYTES:
-      value_proto->set_bytes_value(bytes_value());
+      value_proto->set_bytes_value(std::string(bytes_view_value()));
       break;
     case TYPE_DATE:
       value_proto->set_date_value(date_value());
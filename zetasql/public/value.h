@@ -19,6 +19,7 @@
 
 #include <stddef.h>
 #include <iosfwd>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
@@ -65,6 +66,10 @@ namespace zetasql {
 // produces a new instance that can be used concurrently with the original in
 // arbitrary ways.
 //
+// Values created while a ThreadConfinedValueScope is active are an exception:
+// they, and all their copies, may only be used on the creating thread until
+// MakeShareable() is called on them there.
+//
 class Value {
  public:
   // Constructs an invalid value. Needed for using values with STL. All methods
@@ -89,6 +94,16 @@ class Value {
   // value.
   uint64_t physical_byte_size() const;
 
+  // Makes this value, and every value it contains, safe to use from other
+  // threads if it was created in a ThreadConfinedValueScope. This also affects
+  // all copies of the value, since they share its representation. Must be
+  // called on the thread that created the value, before handing it to other
+  // threads.
+  void MakeShareable();
+
+  // Returns true if no part of this value is confined to a thread.
+  bool IsShareable() const;
+
   // Returns true if the value is null.
   bool is_null() const;
 
@@ -108,8 +123,16 @@ class Value {
   bool bool_value() const;             // REQUIRES: bool type
   float float_value() const;           // REQUIRES: float type
   double double_value() const;         // REQUIRES: double type
+  // REQUIRES: the value was not created with CompactString(), CompactBytes(),
+  // ExternalString() or ExternalBytes(), which hold no std::string.
   const std::string& string_value() const;  // REQUIRES: std::string type
   const std::string& bytes_value() const;   // REQUIRES: bytes type
+  // Views of the std::string and bytes data, valid until the value is destroyed or
+  // assigned to. They work for all values, so code that may see values from
+  // CompactString(), CompactBytes(), ExternalString() or ExternalBytes()
+  // must use them.
+  absl::string_view string_view_value() const;  // REQUIRES: std::string type
+  absl::string_view bytes_view_value() const;   // REQUIRES: bytes type
   int32_t date_value() const;            // REQUIRES: date type
   int32_t enum_value() const;            // REQUIRES: enum type
   const std::string& enum_name() const;     // REQUIRES: enum type
@@ -132,7 +155,7 @@ class Value {
   DatetimeValue datetime_value() const;  // REQUIRES: datetime type
 
   // REQUIRES: numeric type
-  const NumericValue& numeric_value() const;
+  NumericValue numeric_value() const;
 
   // Generic accessor for numeric PODs.
   // REQUIRES: T is one of int32_t, int64_t, uint32_t, uint64_t, bool, float, double.
@@ -184,6 +207,32 @@ class Value {
   const Value& element(int i) const;
   const std::vector<Value>& elements() const;
 
+  // Arrays created with PackedArray() (including those from values::Int64Array
+  // and friends) keep their elements in a contiguous buffer rather than as a
+  // vector of Values. elements() and element() materialize the Values on
+  // first use; hot code can read the buffer directly with the accessors below.
+  //
+  // The packed buffer lives as long as the array, even after the elements are
+  // materialized, so spans returned by the accessors below stay valid.
+  //
+  // Returns true if this array's elements are packed. REQUIRES: !is_null().
+  bool has_packed_elements() const;
+  // Returns the packed elements. REQUIRES: has_packed_elements(), and the
+  // element type matches the accessor. The value of a NULL element in the
+  // returned span is unspecified.
+  absl::Span<const int32_t> packed_int32_elements() const;
+  absl::Span<const int64_t> packed_int64_elements() const;
+  absl::Span<const uint32_t> packed_uint32_elements() const;
+  absl::Span<const uint64_t> packed_uint64_elements() const;
+  absl::Span<const bool> packed_bool_elements() const;
+  absl::Span<const float> packed_float_elements() const;
+  absl::Span<const double> packed_double_elements() const;
+  // Days since the epoch, as for date_value().
+  absl::Span<const int32_t> packed_date_elements() const;
+  // Returns true if element 'i' of a packed array is NULL.
+  // REQUIRES: has_packed_elements().
+  bool packed_element_is_null(int i) const;
+
   // Returns true if 'this' equals 'that' or both are null. This is *not* SQL
   // equality which returns null when either value is null. Returns false if
   // 'this' and 'that' have different types. For floating point values, returns
@@ -291,6 +340,21 @@ class Value {
   static Value Bytes(absl::string_view v);
   // str may contain '\0' in the middle, without getting truncated.
   template <size_t N> static Value Bytes(const char (&str)[N]);
+  // Create std::string and bytes values that store data of up to 12 bytes inline
+  // in the value, without any allocation. Longer data is copied as usual.
+  // Read such values with string_view_value() and bytes_view_value().
+  static Value CompactString(absl::string_view v);
+  static Value CompactBytes(absl::string_view v);
+  // Create std::string and bytes values that reference 'v' without copying it,
+  // e.g. for bulk loads from an arena or a memory-mapped file. 'keep_alive'
+  // is held by the value and all its copies, and must keep the buffer behind
+  // 'v' alive and unchanged until it is released. Short values are stored
+  // inline, as for CompactString(). Read such values with string_view_value()
+  // and bytes_view_value().
+  static Value ExternalString(absl::string_view v,
+                              std::shared_ptr<const void> keep_alive);
+  static Value ExternalBytes(absl::string_view v,
+                             std::shared_ptr<const void> keep_alive);
   static Value Date(int32_t v);
   // Creates a timestamp value from absl::Time at nanoseconds precision.
   static Value Timestamp(absl::Time t);
@@ -373,6 +437,32 @@ class Value {
   static Value UnsafeArray(const ArrayType* array_type,
                            std::vector<Value>&& values);
 #endif
+  // Creates an array of the given 'array_type' with packed elements (see
+  // has_packed_elements()). The element type must match the element C++
+  // type: INT32 or DATE for int32_t, INT64, UINT32, UINT64, BOOL, FLOAT or
+  // DOUBLE. 'is_null' is either empty, or has one entry per element that is
+  // true for NULL elements.
+  static Value PackedArray(const ArrayType* array_type,
+                           absl::Span<const int32_t> values,
+                           absl::Span<const bool> is_null = {});
+  static Value PackedArray(const ArrayType* array_type,
+                           absl::Span<const int64_t> values,
+                           absl::Span<const bool> is_null = {});
+  static Value PackedArray(const ArrayType* array_type,
+                           absl::Span<const uint32_t> values,
+                           absl::Span<const bool> is_null = {});
+  static Value PackedArray(const ArrayType* array_type,
+                           absl::Span<const uint64_t> values,
+                           absl::Span<const bool> is_null = {});
+  static Value PackedArray(const ArrayType* array_type,
+                           absl::Span<const bool> values,
+                           absl::Span<const bool> is_null = {});
+  static Value PackedArray(const ArrayType* array_type,
+                           absl::Span<const float> values,
+                           absl::Span<const bool> is_null = {});
+  static Value PackedArray(const ArrayType* array_type,
+                           absl::Span<const double> values,
+                           absl::Span<const bool> is_null = {});
   // Creates a null of the given 'type'.
   static Value Null(const Type* type);
   // Creates an invalid value.
@@ -400,6 +490,7 @@ class Value {
   friend class InternalValue;  // Defined in zetasql/common/internal_value.h.
   friend struct InternalComparer;  // Defined in value.cc.
   friend struct InternalHasher;    // Defined in value.cc
+  friend class ValueHasher;        // Defined in value_hasher.h
   class GeographyRef;  // Defined in value_inl.h
   class NumericRef;  // Defined in value_inl.h
   class StringRef;  // Defined in value_inl.h
@@ -416,6 +507,50 @@ class Value {
 
   static const int kInvalidTypeKind = __TypeKind__switch_must_have_a_default__;
 
+  // NUMERIC values whose packed representation fits in 96 bits (roughly,
+  // those with an absolute value below 2^95 / 10^9, or 3.9e19) are stored
+  // inline in the value, without a NumericRef. Larger values set
+  // <numeric_high_bits_> to this marker and live in <numeric_ptr_>.
+  static const int32_t kNumericRefMarker = std::numeric_limits<int32_t>::min();
+
+  bool has_numeric_ref() const {
+    return numeric_high_bits_ == kNumericRefMarker;
+  }
+
+  // Compact STRING and BYTES values of at most kMaxInlineStringLength bytes,
+  // and all NULL ones, are stored inline in the 32-bit and 64-bit parts of
+  // the value, with their length in <string_length_>. Other values set
+  // <string_length_> to kStringRefMarker and live in <string_ptr_>.
+  static const int kMaxInlineStringLength = 12;
+  static const uint8_t kStringRefMarker = 0xff;
+
+  bool has_string_ref() const { return string_length_ == kStringRefMarker; }
+
+  // Returns the data of a STRING or BYTES value. Null values are empty.
+  absl::string_view string_payload() const;
+
+  // Returns the data of a non-null STRING or BYTES value that owns a
+  // std::string.
+  const std::string& string_payload_as_std_string() const;
+
+  // Returns the buffer holding inline STRING and BYTES data.
+  char* inline_string_data();
+  const char* inline_string_data() const;
+
+  // Stores 'value' inline if it is short enough. Returns false otherwise.
+  bool SetInlineString(absl::string_view value);
+
+  // Calls 'fn' on each thread-confinable object (StringRef or TypedList) held
+  // by this value, including those of nested values, until it returns false.
+  // Returns false if 'fn' did.
+  template <typename Fn>
+  bool ForEachRef(const Fn& fn) const;
+
+  // Confines the newly created 'ref' to the current thread if a
+  // ThreadConfinedValueScope is active, and returns it.
+  template <typename T>
+  static T* MaybeConfine(T* ref);
+
   // Constructors for non-null atomic values.
   explicit Value(int32_t value);
   explicit Value(int64_t value);
@@ -428,6 +563,10 @@ class Value {
   Value(TypeKind type_kind, int64_t value);
   // REQUIRES: type_kind is std::string or bytes
   Value(TypeKind type_kind, std::string value);
+  // REQUIRES: type_kind is std::string or bytes. Stores 'value' inline if it is
+  // short enough. Otherwise, if 'keep_alive' is NULL, 'value' is copied.
+  Value(TypeKind type_kind, absl::string_view value,
+        std::shared_ptr<const void> keep_alive);
 
   // Constructs a typed NULL of the given 'type'.
   explicit Value(const Type* type);
@@ -510,6 +649,20 @@ class Value {
                               std::vector<Value>&& values);
 #endif
 
+  // Creates a packed array from 'num_elements' elements of 'element_size'
+  // bytes at 'data'. The element type of 'array_type' must be 'element_kind'
+  // or 'alt_element_kind'.
+  static Value PackedArrayInternal(const ArrayType* array_type,
+                                   TypeKind element_kind,
+                                   TypeKind alt_element_kind,
+                                   size_t element_size, const void* data,
+                                   size_t num_elements,
+                                   absl::Span<const bool> is_null);
+
+  // Returns the packed element buffer of an array whose element type must be
+  // 'element_kind'.
+  const void* PackedElementData(TypeKind element_kind) const;
+
   // Compares arrays as multisets ignoring the order of the elements. Upon
   // inequality, 'reason' may be set to detailed explanation if 'reason' !=
   // nullptr. Called from EqualsInternal().
@@ -530,9 +683,14 @@ class Value {
   // type_kind_ is either zetasql::TypeKind or -1 for invalid values.
   int16_t type_kind_ = kInvalidTypeKind;
   bool is_null_ = false;
-  // This bit is used internally by test code to represent unordered arrays;
-  // public arrays are always ordered.
-  bool order_kind_ = kPreservesOrder;
+  union {
+    // This bit is used internally by test code to represent unordered arrays;
+    // public arrays are always ordered.
+    bool order_kind_ = kPreservesOrder;
+    // Used for TYPE_STRING and TYPE_BYTES. Either kStringRefMarker, if the
+    // value is held in <string_ptr_>, or the length of the inline value.
+    uint8_t string_length_;
+  };
 
   // 32-bit part of the value.
   union {
@@ -540,6 +698,10 @@ class Value {
     // Used for google.protobuf.Timestamp.nanos and sub-second part of
     // DatetimeValue and TimeValue.
     int32_t subsecond_nanos_;
+    // Used for TYPE_NUMERIC. Either kNumericRefMarker, if the value is held
+    // in <numeric_ptr_>, or the high 32 bits of the inline 96-bit packed
+    // value whose low 64 bits are in <numeric_low_bits_>.
+    int32_t numeric_high_bits_;
   };
 
   // 64-bit part of the value.
@@ -554,12 +716,16 @@ class Value {
     int64_t timestamp_seconds_;  // Same as google.protobuf.Timestamp.seconds.
     int32_t bit_field_32_value_;   // Whole-second part of TimeValue.
     int64_t bit_field_64_value_;   // Whole-second part of DatetimeValue.
-    StringRef* string_ptr_;  // Reffed. Used for TYPE_STRING and TYPE_BYTES.
+    // Used for values of TYPE_STRING and TYPE_BYTES that don't fit inline.
+    // Reffed.
+    StringRef* string_ptr_;
     TypedList* list_ptr_;  // Reffed. Used for arrays and structs.
     const EnumType* enum_type_;  // Not owned. Used for enums.
     ProtoRep* proto_ptr_;        // Reffed. Used for protos.
     GeographyRef* geography_ptr_;  // Owned. Used for geographies.
-    NumericRef* numeric_ptr_;  // Owned. Used for values of TYPE_NUMERIC.
+    // Used for values of TYPE_NUMERIC that don't fit inline. Reffed.
+    NumericRef* numeric_ptr_;
+    uint64_t numeric_low_bits_;  // Used for inline values of TYPE_NUMERIC.
   };
   // Intentionally copyable.
 };
@@ -571,6 +737,33 @@ static_assert(sizeof(Value) == sizeof(int64_t) * 2, "Value size mismatch");
 // Allow Value to be logged.
 std::ostream& operator<<(std::ostream& out, const Value& value);
 
+// While a ThreadConfinedValueScope is alive, STRING, BYTES, ARRAY and STRUCT
+// Values created on the current thread use non-atomic reference counts, so
+// that copying and destroying them is cheaper. Other values are unaffected. Such values, and all their copies, must stay on the current
+// thread, even after the scope ends, unless Value::MakeShareable() is called
+// on them first. Debug builds check this on every copy. Scopes can be nested.
+//
+// This is meant for per-thread evaluation loops that build many intermediate
+// values which never leave the thread:
+//
+//   ThreadConfinedValueScope confined_values;
+//   for (...) { ... build and combine values ... }
+//   result.MakeShareable();
+//   queue->Push(result);
+class ThreadConfinedValueScope {
+ public:
+  ThreadConfinedValueScope();
+  ThreadConfinedValueScope(const ThreadConfinedValueScope&) = delete;
+  ThreadConfinedValueScope& operator=(const ThreadConfinedValueScope&) = delete;
+  ~ThreadConfinedValueScope();
+
+  // Returns true if a scope is active on the current thread.
+  static bool IsActive();
+
+ private:
+  const bool previously_active_;
+};
+
 namespace values {
 
 // Constructors below wrap the respective static methods in Value class. See
@@ -644,6 +837,8 @@ Value Uint32Array(absl::Span<const uint32_t> values);
 Value BoolArray(const std::vector<bool>& values);
 Value FloatArray(absl::Span<const float> values);
 Value DoubleArray(absl::Span<const double> values);
+// Days since the epoch, as for Date().
+Value DateArray(absl::Span<const int32_t> values);
 Value StringArray(absl::Span<const std::string> values);
 Value BytesArray(absl::Span<const std::string> values);
 // Does not take ownership of Cord* values.
@@ -0,0 +1,557 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/value_columnar.h"
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include "google/protobuf/descriptor.h"
+#include "zetasql/public/functions/date_time_util.h"
+#include "absl/strings/str_cat.h"
+#include "zetasql/base/source_location.h"
+#include "zetasql/base/ret_check.h"
+#include "zetasql/base/status_builder.h"
+#include "zetasql/base/status_macros.h"
+
+namespace zetasql {
+
+namespace {
+
+constexpr char kMagic[] = "ZSQLCOL1";
+constexpr int kMagicSize = 8;
+constexpr int64_t kNanosPerSecond = 1000000000;
+
+int64_t NumNullWords(int64_t num_rows) { return (num_rows + 63) / 64; }
+
+// Writes columns to the end of a string, padding every section to a multiple
+// of 8 bytes from where the writer started.
+class ColumnarWriter {
+ public:
+  explicit ColumnarWriter(std::string* output)
+      : output_(output), start_(output->size()) {}
+  ColumnarWriter(const ColumnarWriter&) = delete;
+  ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+  void WriteHeader(int64_t num_rows) {
+    memcpy(Extend(kMagicSize), kMagic, kMagicSize);
+    zetasql_base::LittleEndian::Store64(Extend(8), num_rows);
+  }
+
+  // Writes the column for <rows>, where nullptr stands for a NULL row.
+  zetasql_base::Status WriteColumn(const Type* type,
+                           const std::vector<const Value*>& rows);
+
+ private:
+  static bool IsNullRow(const Value* row) {
+    return row == nullptr || row->is_null();
+  }
+
+  // Appends a zero-filled, padded section of <bytes> bytes and returns a
+  // pointer to it. The pointer is invalidated by the next call.
+  char* Extend(int64_t bytes) {
+    const size_t offset = output_->size();
+    const int64_t padded = (bytes + 7) & ~int64_t{7};
+    output_->resize(offset + padded);
+    return &(*output_)[offset];
+  }
+
+  template <typename GetBits>
+  void WriteFixed32(const std::vector<const Value*>& rows, GetBits get_bits) {
+    char* data = Extend(4 * rows.size());
+    for (int64_t i = 0; i < rows.size(); ++i) {
+      if (!IsNullRow(rows[i])) {
+        zetasql_base::LittleEndian::Store32(data + 4 * i, get_bits(*rows[i]));
+      }
+    }
+  }
+
+  template <typename GetBits>
+  void WriteFixed64(const std::vector<const Value*>& rows, GetBits get_bits) {
+    char* data = Extend(8 * rows.size());
+    for (int64_t i = 0; i < rows.size(); ++i) {
+      if (!IsNullRow(rows[i])) {
+        zetasql_base::LittleEndian::Store64(data + 8 * i, get_bits(*rows[i]));
+      }
+    }
+  }
+
+  std::string* output_;
+  const size_t start_;
+};
+
+zetasql_base::Status ColumnarWriter::WriteColumn(
+    const Type* type, const std::vector<const Value*>& rows) {
+  ZETASQL_RET_CHECK_EQ((output_->size() - start_) % 8, 0);
+  const int64_t num_rows = rows.size();
+  char* null_bits = Extend(8 * NumNullWords(num_rows));
+  for (int64_t word = 0; word < NumNullWords(num_rows); ++word) {
+    uint64_t bits = 0;
+    const int64_t end = std::min(num_rows, 64 * (word + 1));
+    for (int64_t i = 64 * word; i < end; ++i) {
+      if (IsNullRow(rows[i])) {
+        bits |= uint64_t{1} << (i & 63);
+      }
+    }
+    zetasql_base::LittleEndian::Store64(null_bits + 8 * word, bits);
+  }
+
+  switch (type->kind()) {
+    case TYPE_INT32:
+      WriteFixed32(rows, [](const Value& v) { return v.int32_value(); });
+      break;
+    case TYPE_UINT32:
+      WriteFixed32(rows, [](const Value& v) { return v.uint32_value(); });
+      break;
+    case TYPE_DATE:
+      WriteFixed32(rows, [](const Value& v) { return v.date_value(); });
+      break;
+    case TYPE_ENUM:
+      WriteFixed32(rows, [](const Value& v) { return v.enum_value(); });
+      break;
+    case TYPE_FLOAT:
+      WriteFixed32(rows, [](const Value& v) {
+        return absl::bit_cast<uint32_t>(v.float_value());
+      });
+      break;
+    case TYPE_INT64:
+      WriteFixed64(rows, [](const Value& v) { return v.int64_value(); });
+      break;
+    case TYPE_UINT64:
+      WriteFixed64(rows, [](const Value& v) { return v.uint64_value(); });
+      break;
+    case TYPE_DOUBLE:
+      WriteFixed64(rows, [](const Value& v) {
+        return absl::bit_cast<uint64_t>(v.double_value());
+      });
+      break;
+    case TYPE_TIME:
+      WriteFixed64(rows, [](const Value& v) {
+        return v.time_value().Packed64TimeNanos();
+      });
+      break;
+    case TYPE_BOOL: {
+      char* data = Extend(num_rows);
+      for (int64_t i = 0; i < num_rows; ++i) {
+        data[i] = !IsNullRow(rows[i]) && rows[i]->bool_value();
+      }
+      break;
+    }
+    case TYPE_TIMESTAMP: {
+      // Seconds are rounded down, so nanoseconds are never negative.
+      WriteFixed64(rows, [](const Value& v) {
+        return absl::ToUnixSeconds(v.ToTime());
+      });
+      WriteFixed32(rows, [](const Value& v) {
+        const absl::Time t = v.ToTime();
+        return absl::ToInt64Nanoseconds(
+            t - absl::FromUnixSeconds(absl::ToUnixSeconds(t)));
+      });
+      break;
+    }
+    case TYPE_DATETIME:
+      WriteFixed64(rows, [](const Value& v) {
+        return v.datetime_value().Packed64DatetimeSeconds();
+      });
+      WriteFixed32(rows, [](const Value& v) {
+        return v.datetime_value().Nanoseconds();
+      });
+      break;
+    case TYPE_NUMERIC: {
+      char* data = Extend(16 * num_rows);
+      for (int64_t i = 0; i < num_rows; ++i) {
+        if (!IsNullRow(rows[i])) {
+          const NumericValue& numeric = rows[i]->numeric_value();
+          zetasql_base::LittleEndian::Store64(data + 16 * i, numeric.low_bits());
+          zetasql_base::LittleEndian::Store64(data + 16 * i + 8,
+                                      numeric.high_bits());
+        }
+      }
+      break;
+    }
+    case TYPE_STRING:
+    case TYPE_BYTES:
+    case TYPE_PROTO: {
+      const TypeKind kind = type->kind();
+      auto get_bytes = [kind](const Value& v) -> absl::string_view {
+        if (kind == TYPE_STRING) return v.string_view_value();
+        if (kind == TYPE_BYTES) return v.bytes_view_value();
+        return absl::string_view();
+      };
+      // Proto values are serialized on demand, so keep them alive until they
+      // have been copied.
+      std::vector<std::string> proto_bytes;
+      if (kind == TYPE_PROTO) {
+        proto_bytes.resize(num_rows);
+        for (int64_t i = 0; i < num_rows; ++i) {
+          if (!IsNullRow(rows[i])) proto_bytes[i] = rows[i]->ToCord();
+        }
+      }
+      char* offsets = Extend(8 * (num_rows + 1));
+      uint64_t total = 0;
+      for (int64_t i = 0; i < num_rows; ++i) {
+        if (!IsNullRow(rows[i])) {
+          total += kind == TYPE_PROTO ? proto_bytes[i].size()
+                                      : get_bytes(*rows[i]).size();
+        }
+        zetasql_base::LittleEndian::Store64(offsets + 8 * (i + 1), total);
+      }
+      char* blob = Extend(total);
+      for (int64_t i = 0; i < num_rows; ++i) {
+        if (IsNullRow(rows[i])) continue;
+        const absl::string_view bytes = kind == TYPE_PROTO
+                                            ? absl::string_view(proto_bytes[i])
+                                            : get_bytes(*rows[i]);
+        memcpy(blob, bytes.data(), bytes.size());
+        blob += bytes.size();
+      }
+      break;
+    }
+    case TYPE_ARRAY: {
+      std::vector<const Value*> elements;
+      char* offsets = Extend(8 * (num_rows + 1));
+      for (int64_t i = 0; i < num_rows; ++i) {
+        if (!IsNullRow(rows[i])) {
+          for (const Value& element : rows[i]->elements()) {
+            elements.push_back(&element);
+          }
+        }
+        zetasql_base::LittleEndian::Store64(offsets + 8 * (i + 1), elements.size());
+      }
+      return WriteColumn(type->AsArray()->element_type(), elements);
+    }
+    case TYPE_STRUCT: {
+      const StructType* struct_type = type->AsStruct();
+      std::vector<const Value*> fields(num_rows);
+      for (int field = 0; field < struct_type->num_fields(); ++field) {
+        for (int64_t i = 0; i < num_rows; ++i) {
+          fields[i] = IsNullRow(rows[i]) ? nullptr : &rows[i]->field(field);
+        }
+        ZETASQL_RETURN_IF_ERROR(
+            WriteColumn(struct_type->field(field).type, fields));
+      }
+      break;
+    }
+    default:
+      return ::zetasql_base::UnimplementedErrorBuilder(ZETASQL_LOC)
+             << "Columnar encoding does not support type "
+             << type->DebugString();
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+}  // namespace
+
+zetasql_base::Status SerializeValuesToColumnar(const Type* type,
+                                       absl::Span<const Value> values,
+                                       std::string* output) {
+  std::vector<const Value*> rows;
+  rows.reserve(values.size());
+  for (const Value& value : values) {
+    if (!value.is_valid() || !value.type()->Equals(type)) {
+      return ::zetasql_base::InvalidArgumentErrorBuilder(ZETASQL_LOC)
+             << "Expected value of type " << type->DebugString()
+             << ", found " << value.FullDebugString();
+    }
+    rows.push_back(&value);
+  }
+  const size_t original_size = output->size();
+  ColumnarWriter writer(output);
+  writer.WriteHeader(values.size());
+  const zetasql_base::Status status = writer.WriteColumn(type, rows);
+  if (!status.ok()) {
+    output->resize(original_size);
+  }
+  return status;
+}
+
+// Walks the buffer in the order it was written, validating sizes and offsets
+// and recording where each column's sections are.
+class ColumnarValueReader::Parser {
+ public:
+  explicit Parser(absl::string_view buffer) : buffer_(buffer) {}
+  Parser(const Parser&) = delete;
+  Parser& operator=(const Parser&) = delete;
+
+  zetasql_base::Status ParseHeader(int64_t* num_rows) {
+    const char* header;
+    ZETASQL_RETURN_IF_ERROR(Take(kMagicSize + 8, &header));
+    if (memcmp(header, kMagic, kMagicSize) != 0) {
+      return Error() << "bad magic number";
+    }
+    return CheckNumRows(zetasql_base::LittleEndian::Load64(header + kMagicSize),
+                        num_rows);
+  }
+
+  zetasql_base::Status ParseColumn(const Type* type, int64_t num_rows,
+                           Column* column);
+
+  zetasql_base::Status Finish() {
+    if (position_ != buffer_.size()) {
+      return Error() << (buffer_.size() - position_) << " trailing bytes";
+    }
+    return ::zetasql_base::OkStatus();
+  }
+
+ private:
+  ::zetasql_base::StatusBuilder Error() {
+    return ::zetasql_base::InvalidArgumentErrorBuilder(ZETASQL_LOC)
+           << "Invalid columnar Value encoding: ";
+  }
+
+  // Every row takes at least one bit, which bounds the number of rows and
+  // keeps section sizes below from overflowing.
+  zetasql_base::Status CheckNumRows(uint64_t value, int64_t* num_rows) {
+    if (value > 8 * static_cast<uint64_t>(buffer_.size())) {
+      return Error() << "row count " << value << " exceeds the buffer size";
+    }
+    *num_rows = static_cast<int64_t>(value);
+    return ::zetasql_base::OkStatus();
+  }
+
+  // Consumes a section of <bytes> bytes, plus padding.
+  zetasql_base::Status Take(int64_t bytes, const char** section) {
+    const uint64_t padded = (static_cast<uint64_t>(bytes) + 7) & ~uint64_t{7};
+    if (padded > buffer_.size() - position_) {
+      return Error() << "truncated buffer";
+    }
+    *section = buffer_.data() + position_;
+    position_ += padded;
+    return ::zetasql_base::OkStatus();
+  }
+
+  // Consumes <num_rows> + 1 offsets, which must start at zero and be
+  // nondecreasing, and returns the last one.
+  zetasql_base::Status TakeOffsets(int64_t num_rows, const char** offsets,
+                           uint64_t* end) {
+    ZETASQL_RETURN_IF_ERROR(Take(8 * (num_rows + 1), offsets));
+    uint64_t previous = 0;
+    for (int64_t i = 0; i <= num_rows; ++i) {
+      const uint64_t offset = Column::Word(*offsets, i);
+      if (offset < previous || (i == 0 && offset != 0)) {
+        return Error() << "offsets are not increasing";
+      }
+      previous = offset;
+    }
+    *end = previous;
+    return ::zetasql_base::OkStatus();
+  }
+
+  const absl::string_view buffer_;
+  size_t position_ = 0;
+};
+
+zetasql_base::Status ColumnarValueReader::Parser::ParseColumn(const Type* type,
+                                                      int64_t num_rows,
+                                                      Column* column) {
+  column->type_ = type;
+  column->size_ = num_rows;
+  ZETASQL_RETURN_IF_ERROR(Take(8 * NumNullWords(num_rows), &column->null_bits_));
+
+  switch (type->kind()) {
+    case TYPE_INT32:
+    case TYPE_UINT32:
+    case TYPE_DATE:
+    case TYPE_ENUM:
+    case TYPE_FLOAT:
+      return Take(4 * num_rows, &column->data_);
+    case TYPE_INT64:
+    case TYPE_UINT64:
+    case TYPE_DOUBLE:
+    case TYPE_TIME:
+      return Take(8 * num_rows, &column->data_);
+    case TYPE_BOOL:
+      return Take(num_rows, &column->data_);
+    case TYPE_TIMESTAMP:
+    case TYPE_DATETIME:
+      ZETASQL_RETURN_IF_ERROR(Take(8 * num_rows, &column->data_));
+      return Take(4 * num_rows, &column->nanos_);
+    case TYPE_NUMERIC:
+      ZETASQL_RETURN_IF_ERROR(Take(16 * num_rows, &column->data_));
+      // Checked here so that GetNumeric() can't fail.
+      for (int64_t i = 0; i < num_rows; ++i) {
+        if (!NumericValue::FromHighAndLowBits(Column::Word(column->data_,
+                                                           2 * i + 1),
+                                              Column::Word(column->data_,
+                                                           2 * i))
+                 .ok()) {
+          return Error() << "NUMERIC value out of range";
+        }
+      }
+      return ::zetasql_base::OkStatus();
+    case TYPE_STRING:
+    case TYPE_BYTES:
+    case TYPE_PROTO: {
+      uint64_t blob_size;
+      ZETASQL_RETURN_IF_ERROR(TakeOffsets(num_rows, &column->offsets_, &blob_size));
+      if (blob_size > buffer_.size()) {
+        return Error() << "truncated buffer";
+      }
+      return Take(blob_size, &column->blob_);
+    }
+    case TYPE_ARRAY: {
+      uint64_t num_elements;
+      ZETASQL_RETURN_IF_ERROR(
+          TakeOffsets(num_rows, &column->offsets_, &num_elements));
+      int64_t checked_num_elements;
+      ZETASQL_RETURN_IF_ERROR(CheckNumRows(num_elements, &checked_num_elements));
+      column->children_.resize(1);
+      return ParseColumn(type->AsArray()->element_type(), checked_num_elements,
+                         &column->children_[0]);
+    }
+    case TYPE_STRUCT: {
+      const StructType* struct_type = type->AsStruct();
+      column->children_.resize(struct_type->num_fields());
+      for (int i = 0; i < struct_type->num_fields(); ++i) {
+        ZETASQL_RETURN_IF_ERROR(ParseColumn(struct_type->field(i).type, num_rows,
+                                    &column->children_[i]));
+      }
+      return ::zetasql_base::OkStatus();
+    }
+    default:
+      return ::zetasql_base::UnimplementedErrorBuilder(ZETASQL_LOC)
+             << "Columnar encoding does not support type "
+             << type->DebugString();
+  }
+}
+
+zetasql_base::Status ColumnarValueReader::Init(const Type* type,
+                                       absl::string_view buffer) {
+  column_ = Column();
+  Parser parser(buffer);
+  int64_t num_rows;
+  ZETASQL_RETURN_IF_ERROR(parser.ParseHeader(&num_rows));
+  Column column;
+  ZETASQL_RETURN_IF_ERROR(parser.ParseColumn(type, num_rows, &column));
+  ZETASQL_RETURN_IF_ERROR(parser.Finish());
+  column_ = std::move(column);
+  return ::zetasql_base::OkStatus();
+}
+
+zetasql_base::Status ColumnarValueReader::GetValues(
+    std::vector<Value>* values) const {
+  values->clear();
+  values->reserve(num_rows());
+  for (int64_t i = 0; i < num_rows(); ++i) {
+    ZETASQL_ASSIGN_OR_RETURN(Value value, column_.GetValue(i));
+    values->push_back(std::move(value));
+  }
+  return ::zetasql_base::OkStatus();
+}
+
+NumericValue ColumnarValueReader::Column::GetNumeric(int64_t row) const {
+  return NumericValue::FromHighAndLowBits(Word(data_, 2 * row + 1),
+                                          Word(data_, 2 * row))
+      .ValueOrDie();
+}
+
+zetasql_base::StatusOr<Value> ColumnarValueReader::Column::GetValue(
+    int64_t row) const {
+  if (IsNull(row)) {
+    return Value::Null(type_);
+  }
+  switch (type_->kind()) {
+    case TYPE_INT32:
+      return Value::Int32(GetInt32(row));
+    case TYPE_UINT32:
+      return Value::Uint32(GetUint32(row));
+    case TYPE_INT64:
+      return Value::Int64(GetInt64(row));
+    case TYPE_UINT64:
+      return Value::Uint64(GetUint64(row));
+    case TYPE_BOOL:
+      return Value::Bool(GetBool(row));
+    case TYPE_FLOAT:
+      return Value::Float(GetFloat(row));
+    case TYPE_DOUBLE:
+      return Value::Double(GetDouble(row));
+    case TYPE_NUMERIC:
+      return Value::Numeric(GetNumeric(row));
+    case TYPE_STRING:
+      return Value::String(GetString(row));
+    case TYPE_BYTES:
+      return Value::Bytes(GetString(row));
+    case TYPE_PROTO:
+      return Value::Proto(type_->AsProto(), std::string(GetString(row)));
+    case TYPE_DATE:
+      if (!functions::IsValidDate(GetInt32(row))) {
+        return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+               << "Invalid value for DATE: " << GetInt32(row);
+      }
+      return Value::Date(GetInt32(row));
+    case TYPE_TIMESTAMP: {
+      if (Load32(nanos_, row) >= kNanosPerSecond) {
+        return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+               << "Invalid nanoseconds for TIMESTAMP: " << Load32(nanos_, row);
+      }
+      const absl::Time t = GetTimestamp(row);
+      if (!functions::IsValidTime(t)) {
+        return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+               << "Invalid value for TIMESTAMP: " << absl::FormatTime(t);
+      }
+      return Value::Timestamp(t);
+    }
+    case TYPE_DATETIME: {
+      const DatetimeValue datetime = GetDatetime(row);
+      if (!datetime.IsValid()) {
+        return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+               << "Invalid value for DATETIME";
+      }
+      return Value::Datetime(datetime);
+    }
+    case TYPE_TIME: {
+      const TimeValue time = GetTime(row);
+      if (!time.IsValid()) {
+        return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+               << "Invalid value for TIME";
+      }
+      return Value::Time(time);
+    }
+    case TYPE_ENUM:
+      if (type_->AsEnum()->enum_descriptor()->FindValueByNumber(
+              GetInt32(row)) == nullptr) {
+        return ::zetasql_base::OutOfRangeErrorBuilder(ZETASQL_LOC)
+               << "Invalid value for " << type_->DebugString() << ": "
+               << GetInt32(row);
+      }
+      return Value::Enum(type_->AsEnum(), GetInt32(row));
+    case TYPE_ARRAY: {
+      std::vector<Value> elements;
+      elements.reserve(ElementsEnd(row) - ElementsBegin(row));
+      for (int64_t i = ElementsBegin(row); i < ElementsEnd(row); ++i) {
+        ZETASQL_ASSIGN_OR_RETURN(Value element, this->elements().GetValue(i));
+        elements.push_back(std::move(element));
+      }
+      return Value::UnsafeArray(type_->AsArray(), std::move(elements));
+    }
+    case TYPE_STRUCT: {
+      std::vector<Value> fields;
+      fields.reserve(num_fields());
+      for (int i = 0; i < num_fields(); ++i) {
+        ZETASQL_ASSIGN_OR_RETURN(Value field, this->field(i).GetValue(row));
+        fields.push_back(std::move(field));
+      }
+      return Value::UnsafeStruct(type_->AsStruct(), std::move(fields));
+    }
+    default:
+      return ::zetasql_base::UnimplementedErrorBuilder(ZETASQL_LOC)
+             << "Columnar encoding does not support type "
+             << type_->DebugString();
+  }
+}
+
+}  // namespace zetasql
@@ -0,0 +1,203 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// A compact columnar binary encoding for Values of a known Type.
+//
+// Value::Serialize() produces one ValueProto message per array element and
+// struct field, which is expensive for large arrays. The columnar encoding
+// instead stores a sequence of rows of the same Type as a tree of columns in
+// one contiguous buffer, and ColumnarValueReader reads the buffer in place,
+// without copying or parsing individual values.
+//
+// The Type is not part of the encoding; the reader must use the same Type as
+// the writer. All integers are little-endian, and every section below starts
+// at a multiple of 8 bytes from the start of the buffer (sections are
+// zero-padded).
+//
+//   buffer  := magic (8 bytes, "ZSQLCOL1") num_rows (uint64) column
+//   column  := null_bits payload
+//
+// <null_bits> has one bit per row, 64 rows per uint64 word, and the bit is
+// set if the row is NULL. The payload of a column with n rows depends on its
+// type kind:
+//
+//   INT32, UINT32, DATE, ENUM, FLOAT:  n 4-byte values
+//   INT64, UINT64, DOUBLE:             n 8-byte values
+//   TIME:                              n 8-byte packed nanos (civil_time.h)
+//   BOOL:                              n 1-byte values (0 or 1)
+//   TIMESTAMP:  n int64 Unix seconds, then n int32 nanoseconds in [0, 1e9)
+//   DATETIME:   n int64 packed seconds (civil_time.h), then n int32 nanos
+//   NUMERIC:    n pairs of (low 64 bits, high 64 bits) of the packed value
+//   STRING, BYTES, PROTO:
+//               n + 1 uint64 offsets, then offsets[n] bytes of data. Row i
+//               is data[offsets[i], offsets[i + 1]).
+//   ARRAY:      n + 1 uint64 offsets, then the column of all elements
+//               (offsets[n] rows). Row i has elements [offsets[i],
+//               offsets[i + 1]).
+//   STRUCT:     one column of n rows per field, in field order.
+//
+// NULL rows have zero-valued payloads: empty strings and arrays, and NULL
+// fields for structs.
+
+#ifndef ZETASQL_PUBLIC_VALUE_COLUMNAR_H_
+#define ZETASQL_PUBLIC_VALUE_COLUMNAR_H_
+
+#include <string>
+#include <vector>
+
+#include "zetasql/base/endian.h"
+#include "zetasql/public/civil_time.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/base/casts.h"
+#include <cstdint>
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "zetasql/base/status.h"
+#include "zetasql/base/statusor.h"
+
+namespace zetasql {
+
+// Appends the columnar encoding of <values> to <output>. All values must have
+// type <type>. Returns an error if <type> contains a type kind that the
+// encoding doesn't support (e.g. GEOGRAPHY).
+zetasql_base::Status SerializeValuesToColumnar(const Type* type,
+                                       absl::Span<const Value> values,
+                                       std::string* output);
+
+// Reads a buffer written by SerializeValuesToColumnar(). The buffer is
+// validated once by Init(); after that, all accessors read directly from the
+// buffer, which must outlive the reader.
+//
+// Example:
+//   ColumnarValueReader reader;
+//   ZETASQL_RETURN_IF_ERROR(reader.Init(type, buffer));
+//   const ColumnarValueReader::Column& rows = reader.column();
+//   for (int64_t i = 0; i < rows.size(); ++i) {
+//     if (!rows.IsNull(i)) Process(rows.GetString(i));
+//   }
+class ColumnarValueReader {
+ public:
+  // A column of the encoded tree. Accessors for a row require that the row is
+  // in [0, size()) and, for typed accessors, that it is not NULL and that the
+  // type kind matches. They are not checked.
+  class Column {
+   public:
+    const Type* type() const { return type_; }
+    int64_t size() const { return size_; }
+
+    bool IsNull(int64_t row) const {
+      return (Word(null_bits_, row >> 6) >> (row & 63)) & 1;
+    }
+
+    int32_t GetInt32(int64_t row) const {  // INT32, DATE, ENUM
+      return static_cast<int32_t>(Load32(data_, row));
+    }
+    uint32_t GetUint32(int64_t row) const { return Load32(data_, row); }
+    int64_t GetInt64(int64_t row) const {
+      return static_cast<int64_t>(Word(data_, row));
+    }
+    uint64_t GetUint64(int64_t row) const { return Word(data_, row); }
+    bool GetBool(int64_t row) const { return data_[row] != 0; }
+    float GetFloat(int64_t row) const {
+      return absl::bit_cast<float>(Load32(data_, row));
+    }
+    double GetDouble(int64_t row) const {
+      return absl::bit_cast<double>(Word(data_, row));
+    }
+    absl::Time GetTimestamp(int64_t row) const {
+      return absl::FromUnixSeconds(GetInt64(row)) +
+             absl::Nanoseconds(Load32(nanos_, row));
+    }
+    TimeValue GetTime(int64_t row) const {
+      return TimeValue::FromPacked64Nanos(GetInt64(row));
+    }
+    DatetimeValue GetDatetime(int64_t row) const {
+      return DatetimeValue::FromPacked64SecondsAndNanos(
+          GetInt64(row), static_cast<int32_t>(Load32(nanos_, row)));
+    }
+    NumericValue GetNumeric(int64_t row) const;
+    // STRING, BYTES and PROTO. The result points into the buffer.
+    absl::string_view GetString(int64_t row) const {
+      const uint64_t begin = Word(offsets_, row);
+      return absl::string_view(blob_ + begin, Word(offsets_, row + 1) - begin);
+    }
+
+    // For STRUCT columns.
+    int num_fields() const { return children_.size(); }
+    const Column& field(int i) const { return children_[i]; }
+
+    // For ARRAY columns. The elements of <row> are rows
+    // [ElementsBegin(row), ElementsEnd(row)) of elements().
+    int64_t ElementsBegin(int64_t row) const { return Word(offsets_, row); }
+    int64_t ElementsEnd(int64_t row) const { return Word(offsets_, row + 1); }
+    const Column& elements() const { return children_[0]; }
+
+    // Materializes row <row> as a Value. Returns an error if the encoded value
+    // is not valid for type().
+    zetasql_base::StatusOr<Value> GetValue(int64_t row) const;
+
+   private:
+    friend class ColumnarValueReader;
+
+    static uint64_t Word(const char* base, int64_t index) {
+      return zetasql_base::LittleEndian::Load64(base + 8 * index);
+    }
+    static uint32_t Load32(const char* base, int64_t index) {
+      return zetasql_base::LittleEndian::Load32(base + 4 * index);
+    }
+
+    const Type* type_ = nullptr;
+    int64_t size_ = 0;
+    const char* null_bits_ = nullptr;
+    // Fixed-width values, or the seconds of TIMESTAMP and DATETIME values.
+    const char* data_ = nullptr;
+    // Nanoseconds of TIMESTAMP and DATETIME values.
+    const char* nanos_ = nullptr;
+    // Offsets of STRING, BYTES, PROTO and ARRAY values.
+    const char* offsets_ = nullptr;
+    const char* blob_ = nullptr;
+    // Struct fields, or the elements of an array.
+    std::vector<Column> children_;
+  };
+
+  ColumnarValueReader() {}
+  ColumnarValueReader(const ColumnarValueReader&) = delete;
+  ColumnarValueReader& operator=(const ColumnarValueReader&) = delete;
+
+  // Validates that <buffer> is a well-formed encoding of values of <type>
+  // and prepares the reader. <buffer> must outlive the reader.
+  zetasql_base::Status Init(const Type* type, absl::string_view buffer);
+
+  int64_t num_rows() const { return column_.size(); }
+
+  // The top-level column, with one row per encoded value.
+  const Column& column() const { return column_; }
+
+  // Materializes all rows.
+  zetasql_base::Status GetValues(std::vector<Value>* values) const;
+
+ private:
+  class Parser;
+
+  Column column_;
+};
+
+}  // namespace zetasql
+
+#endif  // ZETASQL_PUBLIC_VALUE_COLUMNAR_H_
@@ -0,0 +1,202 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/value_columnar.h"
+
+#include <string>
+#include <vector>
+
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/civil_time.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace zetasql {
+
+using ::zetasql_base::testing::StatusIs;
+
+namespace {
+
+// Encodes <values>, decodes them again and checks that they are unchanged.
+void ExpectRoundTrip(const Type* type, const std::vector<Value>& values) {
+  std::string buffer;
+  ZETASQL_ASSERT_OK(SerializeValuesToColumnar(type, values, &buffer));
+  EXPECT_EQ(0, buffer.size() % 8);
+
+  ColumnarValueReader reader;
+  ZETASQL_ASSERT_OK(reader.Init(type, buffer));
+  ASSERT_EQ(values.size(), reader.num_rows());
+  std::vector<Value> decoded;
+  ZETASQL_ASSERT_OK(reader.GetValues(&decoded));
+  ASSERT_EQ(values.size(), decoded.size());
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], decoded[i]) << values[i].FullDebugString() << " vs "
+                                     << decoded[i].FullDebugString();
+  }
+}
+
+}  // namespace
+
+TEST(ValueColumnarTest, Scalars) {
+  ExpectRoundTrip(types::Int32Type(),
+                  {Value::Int32(-1), Value::NullInt32(), Value::Int32(7)});
+  ExpectRoundTrip(types::Int64Type(),
+                  {Value::Int64(int64_t{1} << 40), Value::NullInt64()});
+  ExpectRoundTrip(types::Uint32Type(), {Value::Uint32(0xffffffff)});
+  ExpectRoundTrip(types::Uint64Type(), {Value::Uint64(~uint64_t{0})});
+  ExpectRoundTrip(types::BoolType(),
+                  {Value::Bool(true), Value::NullBool(), Value::Bool(false)});
+  ExpectRoundTrip(types::FloatType(), {Value::Float(1.5), Value::NullFloat()});
+  ExpectRoundTrip(types::DoubleType(),
+                  {Value::Double(-0.25), Value::Double(1e300)});
+  ExpectRoundTrip(types::StringType(),
+                  {Value::String("abc"), Value::NullString(), Value::String(""),
+                   Value::String("with\0nul")});
+  ExpectRoundTrip(types::BytesType(), {Value::Bytes("\xff\x00\x01")});
+  ExpectRoundTrip(types::DateType(), {Value::Date(17897), Value::NullDate()});
+  ExpectRoundTrip(
+      types::TimestampType(),
+      {Value::Timestamp(absl::FromUnixNanos(1234567890123456789)),
+       Value::Timestamp(absl::FromUnixNanos(-1)), Value::NullTimestamp()});
+  ExpectRoundTrip(types::TimeType(),
+                  {Value::Time(TimeValue::FromHMSAndNanos(12, 34, 56, 789))});
+  ExpectRoundTrip(types::DatetimeType(),
+                  {Value::Datetime(DatetimeValue::FromYMDHMSAndNanos(
+                      2019, 1, 2, 3, 4, 5, 123456789))});
+  ExpectRoundTrip(types::NumericType(),
+                  {Value::Numeric(NumericValue(-3)),
+                   Value::Numeric(NumericValue::MaxValue()),
+                   Value::NullNumeric()});
+  ExpectRoundTrip(types::Int64Type(), {});
+}
+
+TEST(ValueColumnarTest, NestedArraysAndStructs) {
+  TypeFactory factory;
+  const StructType* struct_type;
+  ZETASQL_ASSERT_OK(factory.MakeStructType(
+      {{"a", types::Int64Type()}, {"b", types::StringArrayType()}},
+      &struct_type));
+  const ArrayType* array_type;
+  ZETASQL_ASSERT_OK(factory.MakeArrayType(struct_type, &array_type));
+
+  const Value row1 = Value::Struct(
+      struct_type,
+      {Value::Int64(1), Value::Array(types::StringArrayType(),
+                                     {Value::String("x"), Value::NullString()})});
+  const Value row2 = Value::Struct(
+      struct_type, {Value::NullInt64(), Value::Null(types::StringArrayType())});
+  ExpectRoundTrip(array_type,
+                  {Value::Array(array_type, {row1, Value::Null(struct_type),
+                                             row2}),
+                   Value::Null(array_type), Value::EmptyArray(array_type),
+                   Value::Array(array_type, {row2})});
+
+  std::vector<Value> many;
+  for (int i = 0; i < 1000; ++i) {
+    many.push_back(i % 3 == 0 ? Value::Null(struct_type) : row1);
+  }
+  ExpectRoundTrip(struct_type, many);
+}
+
+TEST(ValueColumnarTest, ZeroCopyAccess) {
+  TypeFactory factory;
+  const StructType* struct_type;
+  ZETASQL_ASSERT_OK(factory.MakeStructType(
+      {{"id", types::Int64Type()}, {"name", types::StringType()}},
+      &struct_type));
+  std::vector<Value> values;
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(Value::Struct(
+        struct_type, {Value::Int64(i), i % 10 == 0
+                                           ? Value::NullString()
+                                           : Value::String(std::to_string(i))}));
+  }
+  std::string buffer;
+  ZETASQL_ASSERT_OK(SerializeValuesToColumnar(struct_type, values, &buffer));
+
+  ColumnarValueReader reader;
+  ZETASQL_ASSERT_OK(reader.Init(struct_type, buffer));
+  const ColumnarValueReader::Column& ids = reader.column().field(0);
+  const ColumnarValueReader::Column& names = reader.column().field(1);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_FALSE(reader.column().IsNull(i));
+    EXPECT_EQ(i, ids.GetInt64(i));
+    EXPECT_EQ(i % 10 == 0, names.IsNull(i));
+    if (!names.IsNull(i)) {
+      const absl::string_view name = names.GetString(i);
+      EXPECT_EQ(std::to_string(i), name);
+      EXPECT_GE(name.data(), buffer.data());
+      EXPECT_LE(name.data() + name.size(), buffer.data() + buffer.size());
+    }
+  }
+}
+
+TEST(ValueColumnarTest, AppendsToOutput) {
+  std::string buffer = "prefix";
+  ZETASQL_ASSERT_OK(SerializeValuesToColumnar(types::StringType(),
+                                      {Value::String("a")}, &buffer));
+  ColumnarValueReader reader;
+  ZETASQL_ASSERT_OK(reader.Init(types::StringType(),
+                        absl::string_view(buffer).substr(6)));
+  EXPECT_EQ("a", reader.column().GetString(0));
+}
+
+TEST(ValueColumnarTest, Errors) {
+  std::string buffer;
+  EXPECT_THAT(SerializeValuesToColumnar(types::Int64Type(),
+                                        {Value::Int32(1)}, &buffer),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+  EXPECT_THAT(SerializeValuesToColumnar(types::GeographyType(),
+                                        {Value::NullGeography()}, &buffer),
+              StatusIs(zetasql_base::StatusCode::kUnimplemented));
+  EXPECT_TRUE(buffer.empty());
+
+  ZETASQL_ASSERT_OK(SerializeValuesToColumnar(
+      types::StringType(), {Value::String("abc"), Value::String("de")},
+      &buffer));
+  ColumnarValueReader reader;
+  EXPECT_THAT(reader.Init(types::StringType(), ""),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+  EXPECT_THAT(
+      reader.Init(types::StringType(),
+                  absl::string_view(buffer).substr(0, buffer.size() - 8)),
+      StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+  EXPECT_THAT(reader.Init(types::StringType(), buffer + std::string(8, '\0')),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+  // The reader trusts the caller for the type, but still checks sizes.
+  EXPECT_THAT(reader.Init(types::Int64Type(), buffer),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+
+  // Corrupt the second offset so that offsets decrease.
+  std::string corrupted = buffer;
+  corrupted[16 + 8 + 8] = 100;
+  EXPECT_THAT(reader.Init(types::StringType(), corrupted),
+              StatusIs(zetasql_base::StatusCode::kInvalidArgument));
+
+  // Out-of-range dates are detected when the value is materialized.
+  buffer.clear();
+  ZETASQL_ASSERT_OK(SerializeValuesToColumnar(types::Int32Type(),
+                                      {Value::Int32(100000000)}, &buffer));
+  ZETASQL_ASSERT_OK(reader.Init(types::DateType(), buffer));
+  EXPECT_THAT(reader.column().GetValue(0),
+              StatusIs(zetasql_base::StatusCode::kOutOfRange));
+}
+
+}  // namespace zetasql
@@ -0,0 +1,474 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/value_hasher.h"
+
+#include <cmath>
+
+#include "zetasql/base/logging.h"
+#include "absl/base/casts.h"
+#include "absl/hash/hash.h"
+#include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+
+namespace zetasql {
+
+namespace {
+
+constexpr uint64_t kSeed = 0x2D358DCCAA6C78A5ull;
+constexpr uint64_t kNullHashCode = 0x8BB84B93962EACC9ull;
+constexpr uint64_t kNanHashCode = 0x4B33A62ED433D4A3ull;
+
+// Mixes <value> into the hash <state>, by folding the 128-bit product of
+// their sum and a large odd constant.
+inline uint64_t Mix(uint64_t state, uint64_t value) {
+  static constexpr uint64_t kMul = 0x9DDFEA08EB382D69ull;
+  const absl::uint128 product = absl::uint128(state + value) * kMul;
+  return absl::Uint128High64(product) ^ absl::Uint128Low64(product);
+}
+
+// The bits hashed for each fixed-width scalar, shared by Values and packed
+// array elements. Equal values, including all NaNs and both zeros, have
+// equal bits.
+inline uint64_t Bits(int32_t v) { return static_cast<uint64_t>(v); }
+inline uint64_t Bits(int64_t v) { return static_cast<uint64_t>(v); }
+inline uint64_t Bits(uint32_t v) { return v; }
+inline uint64_t Bits(uint64_t v) { return v; }
+inline uint64_t Bits(bool v) { return v ? 1 : 0; }
+inline uint64_t Bits(double v) {
+  if (std::isnan(v)) return kNanHashCode;
+  if (v == 0) return 0;
+  return absl::bit_cast<uint64_t>(v);
+}
+inline uint64_t Bits(float v) { return Bits(static_cast<double>(v)); }
+
+template <typename T>
+inline bool ScalarEquals(T x, T y) {
+  return x == y;
+}
+template <>
+inline bool ScalarEquals(float x, float y) {
+  return x == y || (std::isnan(x) && std::isnan(y));
+}
+template <>
+inline bool ScalarEquals(double x, double y) {
+  return x == y || (std::isnan(x) && std::isnan(y));
+}
+
+}  // namespace
+
+struct ValueHasher::Ops {
+  // Fixed-width scalars.
+  static uint64_t Int32Bits(const Value& v) { return Bits(v.int32_value_); }
+  static uint64_t Int64Bits(const Value& v) { return Bits(v.int64_value_); }
+  static uint64_t Uint32Bits(const Value& v) { return Bits(v.uint32_value_); }
+  static uint64_t Uint64Bits(const Value& v) { return Bits(v.uint64_value_); }
+  static uint64_t BoolBits(const Value& v) { return Bits(v.bool_value_); }
+  static uint64_t FloatBits(const Value& v) { return Bits(v.float_value_); }
+  static uint64_t DoubleBits(const Value& v) { return Bits(v.double_value_); }
+  static uint64_t EnumBits(const Value& v) { return Bits(v.enum_value_); }
+  static uint64_t TimestampBits(const Value& v) {
+    return Mix(Bits(v.timestamp_seconds_), Bits(v.subsecond_nanos_));
+  }
+  static uint64_t TimeBits(const Value& v) {
+    return Mix(Bits(v.bit_field_32_value_), Bits(v.subsecond_nanos_));
+  }
+  static uint64_t DatetimeBits(const Value& v) {
+    return Mix(Bits(v.bit_field_64_value_), Bits(v.subsecond_nanos_));
+  }
+  static uint64_t NumericBits(const Value& v) {
+    const NumericValue numeric = v.numeric_value();
+    return Mix(numeric.high_bits(), numeric.low_bits());
+  }
+  static uint64_t StringBits(const Value& v) {
+    return absl::Hash<absl::string_view>()(v.string_payload());
+  }
+
+  static bool Int32Equals(const Value& x, const Value& y) {
+    return x.int32_value_ == y.int32_value_;
+  }
+  static bool Int64Equals(const Value& x, const Value& y) {
+    return x.int64_value_ == y.int64_value_;
+  }
+  static bool Uint32Equals(const Value& x, const Value& y) {
+    return x.uint32_value_ == y.uint32_value_;
+  }
+  static bool Uint64Equals(const Value& x, const Value& y) {
+    return x.uint64_value_ == y.uint64_value_;
+  }
+  static bool BoolEquals(const Value& x, const Value& y) {
+    return x.bool_value_ == y.bool_value_;
+  }
+  static bool FloatEquals(const Value& x, const Value& y) {
+    return ScalarEquals(x.float_value_, y.float_value_);
+  }
+  static bool DoubleEquals(const Value& x, const Value& y) {
+    return ScalarEquals(x.double_value_, y.double_value_);
+  }
+  static bool EnumEquals(const Value& x, const Value& y) {
+    return x.enum_value_ == y.enum_value_;
+  }
+  static bool TimestampEquals(const Value& x, const Value& y) {
+    return x.timestamp_seconds_ == y.timestamp_seconds_ &&
+           x.subsecond_nanos_ == y.subsecond_nanos_;
+  }
+  static bool TimeEquals(const Value& x, const Value& y) {
+    return x.bit_field_32_value_ == y.bit_field_32_value_ &&
+           x.subsecond_nanos_ == y.subsecond_nanos_;
+  }
+  static bool DatetimeEquals(const Value& x, const Value& y) {
+    return x.bit_field_64_value_ == y.bit_field_64_value_ &&
+           x.subsecond_nanos_ == y.subsecond_nanos_;
+  }
+  static bool NumericEquals(const Value& x, const Value& y) {
+    return x.numeric_value() == y.numeric_value();
+  }
+  static bool StringEquals(const Value& x, const Value& y) {
+    return x.string_payload() == y.string_payload();
+  }
+
+  template <uint64_t (*GetBits)(const Value&)>
+  static uint64_t HashScalar(const Node& node, const Value& v,
+                             uint64_t state) {
+    return Mix(state, v.is_null_ ? kNullHashCode : GetBits(v));
+  }
+
+  template <bool (*EqualValues)(const Value&, const Value&)>
+  static bool EqualsScalar(const Node& node, const Value& x, const Value& y) {
+    if (x.is_null_ || y.is_null_) return x.is_null_ == y.is_null_;
+    return EqualValues(x, y);
+  }
+
+  // Arrays. Packed and unpacked arrays with the same elements have the same
+  // hash code.
+  template <typename T>
+  static uint64_t HashPackedAs(const Value::TypedList& list, uint64_t state) {
+    const T* data = static_cast<const T*>(list.packed_data());
+    const int size = list.size();
+    if (!list.packed_has_nulls()) {
+      for (int i = 0; i < size; ++i) state = Mix(state, Bits(data[i]));
+      return state;
+    }
+    for (int i = 0; i < size; ++i) {
+      state = Mix(state, list.packed_element_is_null(i) ? kNullHashCode
+                                                        : Bits(data[i]));
+    }
+    return state;
+  }
+
+  template <typename T>
+  static bool EqualsPackedAs(const Value::TypedList& x,
+                             const Value::TypedList& y) {
+    const T* x_data = static_cast<const T*>(x.packed_data());
+    const T* y_data = static_cast<const T*>(y.packed_data());
+    for (int i = 0; i < x.size(); ++i) {
+      const bool x_is_null = x.packed_element_is_null(i);
+      if (x_is_null != y.packed_element_is_null(i)) return false;
+      if (!x_is_null && !ScalarEquals(x_data[i], y_data[i])) return false;
+    }
+    return true;
+  }
+
+  // Reads a non-NULL unpacked array element as the C++ type of the
+  // corresponding packed element.
+  static void Unpack(const Value& v, int32_t* out) { *out = v.int32_value_; }
+  static void Unpack(const Value& v, int64_t* out) { *out = v.int64_value_; }
+  static void Unpack(const Value& v, uint32_t* out) {
+    *out = v.uint32_value_;
+  }
+  static void Unpack(const Value& v, uint64_t* out) {
+    *out = v.uint64_value_;
+  }
+  static void Unpack(const Value& v, bool* out) { *out = v.bool_value_; }
+  static void Unpack(const Value& v, float* out) { *out = v.float_value_; }
+  static void Unpack(const Value& v, double* out) { *out = v.double_value_; }
+
+  // Compares a packed array against an unpacked one of the same size,
+  // element by element, without materializing the packed elements.
+  template <typename T>
+  static bool EqualsPackedToUnpackedAs(const Value::TypedList& packed,
+                                       const Value::TypedList& unpacked) {
+    const T* data = static_cast<const T*>(packed.packed_data());
+    const std::vector<Value>& values = unpacked.values();
+    for (int i = 0; i < values.size(); ++i) {
+      const bool is_null = packed.packed_element_is_null(i);
+      if (is_null != values[i].is_null_) return false;
+      if (is_null) continue;
+      T element;
+      Unpack(values[i], &element);
+      if (!ScalarEquals(data[i], element)) return false;
+    }
+    return true;
+  }
+
+  // Compares packed <x> with <y>, which may or may not be packed.
+  template <typename T>
+  static bool EqualsPackedTo(const Value::TypedList& x,
+                             const Value::TypedList& y) {
+    return y.is_packed() ? EqualsPackedAs<T>(x, y)
+                         : EqualsPackedToUnpackedAs<T>(x, y);
+  }
+
+  static uint64_t HashArray(const Node& node, const Value& v,
+                            uint64_t state) {
+    if (v.is_null_) return Mix(state, kNullHashCode);
+    const Value::TypedList& list = *v.list_ptr_;
+    state = Mix(state, list.size());
+    const Node& element = node.children[0];
+    if (list.is_packed()) {
+      switch (element.type->kind()) {
+        case TYPE_INT32:
+        case TYPE_DATE:
+          return HashPackedAs<int32_t>(list, state);
+        case TYPE_INT64:
+          return HashPackedAs<int64_t>(list, state);
+        case TYPE_UINT32:
+          return HashPackedAs<uint32_t>(list, state);
+        case TYPE_UINT64:
+          return HashPackedAs<uint64_t>(list, state);
+        case TYPE_BOOL:
+          return HashPackedAs<bool>(list, state);
+        case TYPE_FLOAT:
+          return HashPackedAs<float>(list, state);
+        case TYPE_DOUBLE:
+          return HashPackedAs<double>(list, state);
+        default:
+          LOG(DFATAL) << "Unexpected packed array element type "
+                      << element.type->DebugString();
+          break;
+      }
+    }
+    for (const Value& e : list.values()) {
+      state = element.hash(element, e, state);
+    }
+    return state;
+  }
+
+  static bool EqualsArray(const Node& node, const Value& x, const Value& y) {
+    if (x.is_null_ || y.is_null_) return x.is_null_ == y.is_null_;
+    const Value::TypedList& x_list = *x.list_ptr_;
+    const Value::TypedList& y_list = *y.list_ptr_;
+    if (x_list.size() != y_list.size()) return false;
+    bool equal;
+    if (x_list.PackedBytesEqual(y_list, &equal)) return equal;
+    const Node& element = node.children[0];
+    if (x_list.is_packed() || y_list.is_packed()) {
+      // Put the packed side first.
+      const Value::TypedList& packed = x_list.is_packed() ? x_list : y_list;
+      const Value::TypedList& other = x_list.is_packed() ? y_list : x_list;
+      switch (element.type->kind()) {
+        case TYPE_INT32:
+        case TYPE_DATE:
+          return EqualsPackedTo<int32_t>(packed, other);
+        case TYPE_INT64:
+          return EqualsPackedTo<int64_t>(packed, other);
+        case TYPE_UINT32:
+          return EqualsPackedTo<uint32_t>(packed, other);
+        case TYPE_UINT64:
+          return EqualsPackedTo<uint64_t>(packed, other);
+        case TYPE_BOOL:
+          return EqualsPackedTo<bool>(packed, other);
+        case TYPE_FLOAT:
+          return EqualsPackedTo<float>(packed, other);
+        case TYPE_DOUBLE:
+          return EqualsPackedTo<double>(packed, other);
+        default:
+          LOG(DFATAL) << "Unexpected packed array element type "
+                      << element.type->DebugString();
+          break;
+      }
+    }
+    const std::vector<Value>& x_values = x_list.values();
+    const std::vector<Value>& y_values = y_list.values();
+    for (int i = 0; i < x_values.size(); ++i) {
+      if (!element.equals(element, x_values[i], y_values[i])) return false;
+    }
+    return true;
+  }
+
+  // Structs are hashed and compared field by field, in order.
+  static uint64_t HashStruct(const Node& node, const Value& v,
+                             uint64_t state) {
+    if (v.is_null_) return Mix(state, kNullHashCode);
+    const std::vector<Value>& fields = v.list_ptr_->values();
+    for (int i = 0; i < fields.size(); ++i) {
+      state = node.children[i].hash(node.children[i], fields[i], state);
+    }
+    return state;
+  }
+
+  static bool EqualsStruct(const Node& node, const Value& x, const Value& y) {
+    if (x.is_null_ || y.is_null_) return x.is_null_ == y.is_null_;
+    const std::vector<Value>& x_fields = x.list_ptr_->values();
+    const std::vector<Value>& y_fields = y.list_ptr_->values();
+    for (int i = 0; i < x_fields.size(); ++i) {
+      if (!node.children[i].equals(node.children[i], x_fields[i],
+                                   y_fields[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Types without a specialized implementation.
+  static uint64_t HashGeneric(const Node& node, const Value& v,
+                              uint64_t state) {
+    return Mix(state, v.HashCode());
+  }
+
+  static bool EqualsGeneric(const Node& node, const Value& x, const Value& y) {
+    return x.Equals(y);
+  }
+
+  template <HashFn hash>
+  static void HashBatch(const Node& node, absl::Span<const Value> values,
+                        absl::Span<size_t> hashes) {
+    for (int i = 0; i < values.size(); ++i) {
+      hashes[i] = hash(node, values[i], kSeed);
+    }
+  }
+};
+
+ValueHasher::Node ValueHasher::MakeNode(const Type* type) {
+  Node node;
+  node.type = type;
+  switch (type->kind()) {
+    case TYPE_INT32:
+    case TYPE_DATE:
+      node.hash = &Ops::HashScalar<&Ops::Int32Bits>;
+      node.equals = &Ops::EqualsScalar<&Ops::Int32Equals>;
+      break;
+    case TYPE_INT64:
+      node.hash = &Ops::HashScalar<&Ops::Int64Bits>;
+      node.equals = &Ops::EqualsScalar<&Ops::Int64Equals>;
+      break;
+    case TYPE_UINT32:
+      node.hash = &Ops::HashScalar<&Ops::Uint32Bits>;
+      node.equals = &Ops::EqualsScalar<&Ops::Uint32Equals>;
+      break;
+    case TYPE_UINT64:
+      node.hash = &Ops::HashScalar<&Ops::Uint64Bits>;
+      node.equals = &Ops::EqualsScalar<&Ops::Uint64Equals>;
+      break;
+    case TYPE_BOOL:
+      node.hash = &Ops::HashScalar<&Ops::BoolBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::BoolEquals>;
+      break;
+    case TYPE_FLOAT:
+      node.hash = &Ops::HashScalar<&Ops::FloatBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::FloatEquals>;
+      break;
+    case TYPE_DOUBLE:
+      node.hash = &Ops::HashScalar<&Ops::DoubleBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::DoubleEquals>;
+      break;
+    case TYPE_ENUM:
+      node.hash = &Ops::HashScalar<&Ops::EnumBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::EnumEquals>;
+      break;
+    case TYPE_TIMESTAMP:
+      node.hash = &Ops::HashScalar<&Ops::TimestampBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::TimestampEquals>;
+      break;
+    case TYPE_TIME:
+      node.hash = &Ops::HashScalar<&Ops::TimeBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::TimeEquals>;
+      break;
+    case TYPE_DATETIME:
+      node.hash = &Ops::HashScalar<&Ops::DatetimeBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::DatetimeEquals>;
+      break;
+    case TYPE_NUMERIC:
+      node.hash = &Ops::HashScalar<&Ops::NumericBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::NumericEquals>;
+      break;
+    case TYPE_STRING:
+    case TYPE_BYTES:
+      node.hash = &Ops::HashScalar<&Ops::StringBits>;
+      node.equals = &Ops::EqualsScalar<&Ops::StringEquals>;
+      break;
+    case TYPE_ARRAY:
+      node.hash = &Ops::HashArray;
+      node.equals = &Ops::EqualsArray;
+      node.children.push_back(MakeNode(type->AsArray()->element_type()));
+      break;
+    case TYPE_STRUCT:
+      node.hash = &Ops::HashStruct;
+      node.equals = &Ops::EqualsStruct;
+      for (const StructType::StructField& field : type->AsStruct()->fields()) {
+        node.children.push_back(MakeNode(field.type));
+      }
+      break;
+    default:
+      node.hash = &Ops::HashGeneric;
+      node.equals = &Ops::EqualsGeneric;
+      break;
+  }
+  return node;
+}
+
+ValueHasher::ValueHasher(const Type* type)
+    : type_(type), root_(MakeNode(type)) {}
+
+size_t ValueHasher::HashCode(const Value& value) const {
+  DCHECK(value.type()->Equivalent(type_)) << value.type()->DebugString();
+  return root_.hash(root_, value, kSeed);
+}
+
+void ValueHasher::HashCodes(absl::Span<const Value> values,
+                            absl::Span<size_t> hashes) const {
+  CHECK_EQ(values.size(), hashes.size());
+#ifndef NDEBUG
+  for (const Value& value : values) {
+    DCHECK(value.type()->Equivalent(type_)) << value.type()->DebugString();
+  }
+#endif
+  // Select a loop with an inlined hash function for the common key types.
+  switch (type_->kind()) {
+    case TYPE_INT32:
+    case TYPE_DATE:
+      Ops::HashBatch<&Ops::HashScalar<&Ops::Int32Bits>>(root_, values, hashes);
+      break;
+    case TYPE_INT64:
+      Ops::HashBatch<&Ops::HashScalar<&Ops::Int64Bits>>(root_, values, hashes);
+      break;
+    case TYPE_UINT64:
+      Ops::HashBatch<&Ops::HashScalar<&Ops::Uint64Bits>>(root_, values,
+                                                         hashes);
+      break;
+    case TYPE_STRING:
+    case TYPE_BYTES:
+      Ops::HashBatch<&Ops::HashScalar<&Ops::StringBits>>(root_, values,
+                                                         hashes);
+      break;
+    case TYPE_STRUCT:
+      Ops::HashBatch<&Ops::HashStruct>(root_, values, hashes);
+      break;
+    default:
+      for (int i = 0; i < values.size(); ++i) {
+        hashes[i] = root_.hash(root_, values[i], kSeed);
+      }
+      break;
+  }
+}
+
+bool ValueHasher::Equals(const Value& x, const Value& y) const {
+  DCHECK(x.type()->Equivalent(type_)) << x.type()->DebugString();
+  DCHECK(y.type()->Equivalent(type_)) << y.type()->DebugString();
+  return root_.equals(root_, x, y);
+}
+
+}  // namespace zetasql
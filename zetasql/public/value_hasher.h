@@ -0,0 +1,126 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef ZETASQL_PUBLIC_VALUE_HASHER_H_
+#define ZETASQL_PUBLIC_VALUE_HASHER_H_
+
+#include <stddef.h>
+#include <cstdint>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/types/span.h"
+
+namespace zetasql {
+
+// ValueHasher hashes and compares Values of one known Type, for use as the
+// keys of hash joins, GROUP BY and other large hash tables.
+//
+// Value::HashCode() and Value::Equals() dispatch on the type kind of every
+// value they visit, and Value::Equals() also handles order-ignoring arrays
+// and comparison reasons. A ValueHasher instead resolves the Type once, when
+// it is constructed, into a tree of per-kind hash and equality functions,
+// and reads the values directly. Packed arrays (see Value::PackedArray()) are
+// hashed and compared without materializing their elements.
+//
+// Equals() agrees with Value::Equals(): NaNs are equal to each other, +0 and
+// -0 are equal, and two NULLs are equal. HashCode() is consistent with
+// Equals(), but differs from Value::HashCode(). Unlike Value::HashCode(),
+// arrays are hashed in order.
+//
+// PROTO and GEOGRAPHY values fall back to Value::HashCode() and
+// Value::Equals().
+//
+// All values passed to a ValueHasher must have its Type (or an equivalent
+// one). This is checked in debug builds only.
+//
+// Example:
+//
+//   ValueHasher hasher(key_type);
+//   absl::flat_hash_map<Value, int, ValueHasher::Hash, ValueHasher::Eq>
+//       groups(/*bucket_count=*/0, ValueHasher::Hash(&hasher),
+//              ValueHasher::Eq(&hasher));
+//
+// ValueHasher is immutable and thread-safe.
+class ValueHasher {
+ public:
+  // <type> is not owned, and must outlive the ValueHasher.
+  explicit ValueHasher(const Type* type);
+  ValueHasher(const ValueHasher&) = delete;
+  ValueHasher& operator=(const ValueHasher&) = delete;
+
+  const Type* type() const { return type_; }
+
+  size_t HashCode(const Value& value) const;
+
+  // Sets <hashes>[i] to HashCode(<values>[i]). Dispatches on the type once
+  // for the whole batch. REQUIRES: hashes.size() == values.size().
+  void HashCodes(absl::Span<const Value> values,
+                 absl::Span<size_t> hashes) const;
+
+  bool Equals(const Value& x, const Value& y) const;
+
+  // Hash and equality functors for hash containers. The ValueHasher must
+  // outlive them.
+  class Hash {
+   public:
+    explicit Hash(const ValueHasher* hasher) : hasher_(hasher) {}
+    size_t operator()(const Value& value) const {
+      return hasher_->HashCode(value);
+    }
+
+   private:
+    const ValueHasher* hasher_;
+  };
+
+  class Eq {
+   public:
+    explicit Eq(const ValueHasher* hasher) : hasher_(hasher) {}
+    bool operator()(const Value& x, const Value& y) const {
+      return hasher_->Equals(x, y);
+    }
+
+   private:
+    const ValueHasher* hasher_;
+  };
+
+ private:
+  // Functions for one type in the tree, selected by its type kind.
+  struct Node;
+  using HashFn = uint64_t (*)(const Node& node, const Value& value,
+                              uint64_t state);
+  using EqualsFn = bool (*)(const Node& node, const Value& x, const Value& y);
+  struct Node {
+    const Type* type;
+    HashFn hash;
+    EqualsFn equals;
+    // The element of an array, or the fields of a struct.
+    std::vector<Node> children;
+  };
+
+  // Holds the per-kind functions. Defined in value_hasher.cc.
+  struct Ops;
+
+  static Node MakeNode(const Type* type);
+
+  const Type* const type_;
+  const Node root_;
+};
+
+}  // namespace zetasql
+
+#endif  // ZETASQL_PUBLIC_VALUE_HASHER_H_
@@ -0,0 +1,236 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/public/value_hasher.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "zetasql/base/testing/status_matchers.h"
+#include "zetasql/public/civil_time.h"
+#include "zetasql/public/numeric_value.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
+
+namespace zetasql {
+
+namespace {
+
+// Checks that ValueHasher::Equals() agrees with Value::Equals() on all pairs
+// of <values>, that equal values have equal hash codes, and that HashCodes()
+// agrees with HashCode().
+void ExpectConsistent(const Type* type, const std::vector<Value>& values) {
+  ValueHasher hasher(type);
+  for (const Value& x : values) {
+    for (const Value& y : values) {
+      EXPECT_EQ(x.Equals(y), hasher.Equals(x, y))
+          << x.FullDebugString() << " vs " << y.FullDebugString();
+      if (x.Equals(y)) {
+        EXPECT_EQ(hasher.HashCode(x), hasher.HashCode(y))
+            << x.FullDebugString() << " vs " << y.FullDebugString();
+      }
+    }
+  }
+  std::vector<size_t> hashes(values.size());
+  hasher.HashCodes(values, absl::MakeSpan(hashes));
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(hasher.HashCode(values[i]), hashes[i]);
+  }
+}
+
+TEST(ValueHasherTest, Scalars) {
+  ExpectConsistent(types::Int64Type(),
+                   {Value::Int64(0), Value::Int64(1), Value::Int64(-1),
+                    Value::Int64(1), Value::NullInt64()});
+  ExpectConsistent(types::Int32Type(),
+                   {Value::Int32(5), Value::Int32(-5), Value::NullInt32()});
+  ExpectConsistent(types::Uint64Type(),
+                   {Value::Uint64(0), Value::Uint64(~uint64_t{0}),
+                    Value::NullUint64()});
+  ExpectConsistent(types::BoolType(),
+                   {Value::Bool(true), Value::Bool(false), Value::NullBool()});
+  ExpectConsistent(types::DateType(),
+                   {Value::Date(0), Value::Date(17000), Value::NullDate()});
+  ExpectConsistent(
+      types::TimestampType(),
+      {Value::Timestamp(absl::FromUnixNanos(1)),
+       Value::Timestamp(absl::FromUnixNanos(2)),
+       Value::Timestamp(absl::FromUnixSeconds(1)), Value::NullTimestamp()});
+  ExpectConsistent(
+      types::DatetimeType(),
+      {Value::Datetime(DatetimeValue::FromYMDHMSAndNanos(2019, 1, 2, 3, 4, 5,
+                                                         6)),
+       Value::Datetime(DatetimeValue::FromYMDHMSAndNanos(2019, 1, 2, 3, 4, 5,
+                                                         7)),
+       Value::NullDatetime()});
+  ExpectConsistent(
+      types::StringType(),
+      {Value::String(""), Value::String("a"), Value::String("b"),
+       Value::String("a string that doesn't fit inline"),
+       Value::String("a string that doesn't fit inline"), Value::NullString()});
+  ExpectConsistent(types::BytesType(),
+                   {Value::Bytes("a"), Value::Bytes(std::string("\0a", 2)),
+                    Value::NullBytes()});
+  ExpectConsistent(
+      types::NumericType(),
+      {Value::Numeric(NumericValue(1)), Value::Numeric(NumericValue(-1)),
+       Value::Numeric(NumericValue::MaxValue()),
+       Value::Numeric(NumericValue::MinValue()), Value::NullNumeric()});
+}
+
+TEST(ValueHasherTest, FloatingPoint) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+  ExpectConsistent(types::DoubleType(),
+                   {Value::Double(0.0), Value::Double(-0.0), Value::Double(1),
+                    Value::Double(nan), Value::Double(-nan),
+                    Value::Double(inf), Value::Double(-inf),
+                    Value::NullDouble()});
+  ExpectConsistent(types::FloatType(),
+                   {Value::Float(0.0f), Value::Float(-0.0f),
+                    Value::Float(std::numeric_limits<float>::quiet_NaN()),
+                    Value::Float(1.5f), Value::NullFloat()});
+}
+
+TEST(ValueHasherTest, PackedAndUnpackedArrays) {
+  const std::vector<int64_t> elements = {1, 2, 3};
+  const Value packed = Value::PackedArray(types::Int64ArrayType(), elements);
+  const bool is_null[] = {false, true, false};
+  const Value packed_with_null =
+      Value::PackedArray(types::Int64ArrayType(), elements, is_null);
+  const Value unpacked =
+      Value::Array(types::Int64ArrayType(),
+                   {Value::Int64(1), Value::Int64(2), Value::Int64(3)});
+  const Value unpacked_with_null =
+      Value::Array(types::Int64ArrayType(),
+                   {Value::Int64(1), Value::NullInt64(), Value::Int64(3)});
+  ASSERT_TRUE(packed.has_packed_elements());
+  ASSERT_FALSE(unpacked.has_packed_elements());
+  ExpectConsistent(
+      types::Int64ArrayType(),
+      {packed, packed_with_null, unpacked, unpacked_with_null,
+       Value::Array(types::Int64ArrayType(), {Value::Int64(1)}),
+       Value::EmptyArray(types::Int64ArrayType()),
+       Value::Null(types::Int64ArrayType())});
+
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const std::vector<double> doubles = {nan, -0.0};
+  ExpectConsistent(
+      types::DoubleArrayType(),
+      {Value::PackedArray(types::DoubleArrayType(), doubles),
+       Value::PackedArray(types::DoubleArrayType(),
+                          std::vector<double>{nan, 0.0}),
+       Value::Array(types::DoubleArrayType(),
+                    {Value::Double(nan), Value::Double(0.0)})});
+}
+
+TEST(ValueHasherTest, MixedPackedAndUnpackedArraysWithNulls) {
+  const bool is_null[] = {false, true, false, true};
+  const Value packed = Value::PackedArray(
+      types::Int32ArrayType(), std::vector<int32_t>{7, 0, -7, 0}, is_null);
+  const Value equal = Value::Array(
+      types::Int32ArrayType(), {Value::Int32(7), Value::NullInt32(),
+                                Value::Int32(-7), Value::NullInt32()});
+  const Value null_differs = Value::Array(
+      types::Int32ArrayType(), {Value::Int32(7), Value::Int32(0),
+                                Value::Int32(-7), Value::NullInt32()});
+  const Value value_differs = Value::Array(
+      types::Int32ArrayType(), {Value::Int32(7), Value::NullInt32(),
+                                Value::Int32(7), Value::NullInt32()});
+  ValueHasher hasher(types::Int32ArrayType());
+  EXPECT_TRUE(hasher.Equals(packed, equal));
+  EXPECT_TRUE(hasher.Equals(equal, packed));
+  EXPECT_FALSE(hasher.Equals(packed, null_differs));
+  EXPECT_FALSE(hasher.Equals(null_differs, packed));
+  EXPECT_FALSE(hasher.Equals(packed, value_differs));
+  EXPECT_FALSE(hasher.Equals(value_differs, packed));
+  EXPECT_EQ(hasher.HashCode(packed), hasher.HashCode(equal));
+  // Comparing against unpacked arrays does not materialize the elements.
+  EXPECT_TRUE(packed.has_packed_elements());
+
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const bool double_is_null[] = {true, false, false};
+  const Value packed_doubles = Value::PackedArray(
+      types::DoubleArrayType(), std::vector<double>{1, nan, -0.0},
+      double_is_null);
+  ValueHasher double_hasher(types::DoubleArrayType());
+  EXPECT_TRUE(double_hasher.Equals(
+      packed_doubles,
+      Value::Array(types::DoubleArrayType(),
+                   {Value::NullDouble(), Value::Double(-nan),
+                    Value::Double(0.0)})));
+  EXPECT_FALSE(double_hasher.Equals(
+      Value::Array(types::DoubleArrayType(),
+                   {Value::Double(1), Value::Double(nan),
+                    Value::Double(0.0)}),
+      packed_doubles));
+  EXPECT_TRUE(packed_doubles.has_packed_elements());
+}
+
+TEST(ValueHasherTest, StructsAndNestedArrays) {
+  TypeFactory factory;
+  const StructType* struct_type;
+  ZETASQL_ASSERT_OK(factory.MakeStructType(
+      {{"a", types::Int64Type()}, {"b", types::StringArrayType()}},
+      &struct_type));
+  const Value row1 = Value::Struct(
+      struct_type,
+      {Value::Int64(1), Value::Array(types::StringArrayType(),
+                                     {Value::String("x"), Value::NullString()})});
+  const Value row2 = Value::Struct(
+      struct_type, {Value::Int64(1), Value::Null(types::StringArrayType())});
+  const Value row3 = Value::Struct(
+      struct_type,
+      {Value::NullInt64(), Value::EmptyArray(types::StringArrayType())});
+  ExpectConsistent(struct_type,
+                   {row1, row2, row3, Value::Null(struct_type), row1, row2});
+
+  const ArrayType* array_type;
+  ZETASQL_ASSERT_OK(factory.MakeArrayType(struct_type, &array_type));
+  ExpectConsistent(array_type, {Value::Array(array_type, {row1, row2}),
+                                Value::Array(array_type, {row2, row1}),
+                                Value::Array(array_type, {row1, row2}),
+                                Value::Null(array_type)});
+}
+
+TEST(ValueHasherTest, HashSet) {
+  TypeFactory factory;
+  const StructType* struct_type;
+  ZETASQL_ASSERT_OK(factory.MakeStructType(
+      {{"id", types::Int64Type()}, {"name", types::StringType()}},
+      &struct_type));
+  ValueHasher hasher(struct_type);
+  absl::flat_hash_set<Value, ValueHasher::Hash, ValueHasher::Eq> keys(
+      /*bucket_count=*/0, ValueHasher::Hash(&hasher), ValueHasher::Eq(&hasher));
+  for (int i = 0; i < 1000; ++i) {
+    keys.insert(Value::Struct(struct_type,
+                              {Value::Int64(i % 100),
+                               Value::String(std::to_string(i % 50))}));
+  }
+  EXPECT_EQ(100, keys.size());
+  EXPECT_EQ(1, keys.count(Value::Struct(
+                   struct_type, {Value::Int64(51), Value::String("1")})));
+  EXPECT_EQ(0, keys.count(Value::Struct(
+                   struct_type, {Value::Int64(51), Value::String("2")})));
+}
+
+}  // namespace
+}  // namespace zetasql
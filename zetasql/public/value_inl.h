@@ -40,39 +40,96 @@
 #include "zetasql/public/type.pb.h"
 #include "zetasql/public/value.h"  
 #include <cstdint>
+#include "absl/base/call_once.h"
 #include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "zetasql/base/simple_reference_counted.h"
+#include "zetasql/base/thread_confinable_reference_counted.h"
 
 namespace zetasql {
 
-class Value::TypedList : public zetasql_base::SimpleReferenceCounted {
+class Value::TypedList
+    : public zetasql_base::ThreadConfinableReferenceCounted {
  public:
   explicit TypedList(const Type* type) : type_(type) { CHECK(type != nullptr); }
 
+  // Creates a packed list holding <num_elements> fixed-width scalars of the
+  // element type of <array_type>, each <element_size> bytes, copied from
+  // <data>. <null_bitmap> has bit i set if element i is NULL, or is empty if
+  // no element is NULL.
+  TypedList(const ArrayType* array_type, size_t element_size,
+            const void* data, int num_elements,
+            std::vector<uint64_t> null_bitmap);
+
   TypedList(const TypedList&) = delete;
   TypedList& operator=(const TypedList&) = delete;
 
   const Type* type() const { return type_; }
-  std::vector<Value>& values() { return values_; }
-  uint64_t physical_byte_size() const {
-    if (physical_byte_size_.has_value()) {
-      return physical_byte_size_.value();
-    }
-    uint64_t size = sizeof(TypedList);
-    for (const Value& value : values_) {
-      size += value.physical_byte_size();
+
+  // Returns the values for building a new list. REQUIRES: !is_packed().
+  std::vector<Value>& mutable_values() {
+    DCHECK(!is_packed());
+    return values_;
+  }
+
+  // Returns the values. A packed list materializes them on the first call,
+  // which is thread-safe. The packed buffer is kept alongside them.
+  const std::vector<Value>& values() const {
+    if (packed_ != nullptr) {
+      absl::call_once(packed_->materialize_once,
+                      [this] { MaterializeValues(); });
     }
-    physical_byte_size_ = size;
-    return size;
+    return values_;
+  }
+
+  int size() const {
+    return packed_ != nullptr ? packed_->size : values_.size();
+  }
+
+  bool is_packed() const { return packed_ != nullptr; }
+
+  // The contiguous element buffer of a packed list. REQUIRES: is_packed().
+  const void* packed_data() const { return packed_->data.get(); }
+  bool packed_has_nulls() const { return !packed_->null_bitmap.empty(); }
+  bool packed_element_is_null(int i) const {
+    const std::vector<uint64_t>& null_bitmap = packed_->null_bitmap;
+    return !null_bitmap.empty() && ((null_bitmap[i / 64] >> (i % 64)) & 1);
   }
 
+  // Returns true if both lists are packed and their elements can be compared
+  // bytewise, and sets <*equal> to the result. Floating point elements are
+  // never compared bytewise, because of NaNs and signed zeros.
+  bool PackedBytesEqual(const TypedList& that, bool* equal) const;
+
+  uint64_t physical_byte_size() const;
+
  private:
+  // Fills <values_> from the packed buffer.
+  void MaterializeValues() const;
+  template <typename T>
+  void MaterializeAs(Value (*make_value)(T)) const;
+
+  // The elements of a list created packed. Kept in a separate allocation so
+  // that STRUCT and unpacked ARRAY lists only pay for the pointer to it.
+  struct PackedElements {
+    // Never modified after construction, so that const readers of the
+    // packed buffer can race with materialization.
+    std::unique_ptr<char[]> data;
+    int size = 0;
+    size_t element_size = 0;
+    std::vector<uint64_t> null_bitmap;
+    absl::once_flag materialize_once;
+  };
+
   const Type* type_;  // not owned
-  std::vector<Value> values_;
-  mutable absl::optional<uint64_t> physical_byte_size_;
+  // For packed lists, empty until materialized by values().
+  mutable std::vector<Value> values_;
+  // Zero until computed.
+  mutable uint64_t physical_byte_size_ = 0;
+  // Set only for lists created packed.
+  const std::unique_ptr<PackedElements> packed_;
 };
 
 // -------------------------------------------------------
@@ -135,28 +192,43 @@ class Value::NumericRef : public zetasql_base::SimpleReferenceCounted {
 };
 
 // -------------------------------------------------------
-// StringRef is ref count wrapper around std::string.
+// StringRef is ref count wrapper around std::string data that doesn't fit
+// inline in a Value. The data is either owned, or an external buffer kept
+// alive by 'keep_alive'.
 // -------------------------------------------------------
-class Value::StringRef : public zetasql_base::SimpleReferenceCounted {
+class Value::StringRef
+    : public zetasql_base::ThreadConfinableReferenceCounted {
  public:
-  StringRef() {}
   explicit StringRef(std::string value)
-      : value_(std::move(value)) {
+      : owned_(std::move(value)), value_(owned_) {
+  }
+
+  StringRef(absl::string_view value, std::shared_ptr<const void> keep_alive)
+      : value_(value), keep_alive_(std::move(keep_alive)) {
   }
 
   StringRef(const StringRef&) = delete;
   StringRef& operator=(const StringRef&) = delete;
 
-  const std::string& value() const {
+  absl::string_view value() const {
     return value_;
   }
 
+  // True if the data is owned, rather than an external buffer.
+  bool is_owned() const { return keep_alive_ == nullptr; }
+
+  // Returns the owned data. REQUIRES: is_owned().
+  const std::string& owned() const { return owned_; }
+
+  // External buffers are not counted, since they are owned elsewhere.
   uint64_t physical_byte_size() const {
-    return sizeof(StringRef) + value_.size() * sizeof(char);
+    return sizeof(StringRef) + owned_.size() * sizeof(char);
   }
 
  private:
-  const std::string value_;
+  const std::string owned_;
+  const absl::string_view value_;
+  const std::shared_ptr<const void> keep_alive_;
 };
 
 // -------------------------------------------------------
@@ -175,7 +247,7 @@ inline void Value::Clear() {
   switch (type_kind_) {
     case TYPE_STRING:
     case TYPE_BYTES:
-      string_ptr_->Unref();
+      if (has_string_ref()) string_ptr_->Unref();
       break;
     case TYPE_ARRAY:
     case TYPE_STRUCT:
@@ -187,7 +259,7 @@ inline void Value::Clear() {
       geography_ptr_->Unref();
       break;
     case TYPE_NUMERIC:
-      numeric_ptr_->Unref();
+      if (has_numeric_ref()) numeric_ptr_->Unref();
       break;
     case TYPE_PROTO:
       proto_ptr_->Unref();
@@ -255,15 +327,78 @@ inline Value::Value(double value)
     : type_kind_(TYPE_DOUBLE), double_value_(value) {
 }
 
+template <typename T>
+inline T* Value::MaybeConfine(T* ref) {
+  if (ThreadConfinedValueScope::IsActive()) ref->ConfineToCurrentThread();
+  return ref;
+}
+
 inline Value::Value(TypeKind type_kind, std::string value)
-    : type_kind_(static_cast<int16_t>(type_kind)),
-      string_ptr_(new StringRef(std::move(value))) {
+    : type_kind_(static_cast<int16_t>(type_kind)) {
   CHECK(type_kind == TYPE_STRING ||
         type_kind == TYPE_BYTES);
+  string_length_ = kStringRefMarker;
+  string_ptr_ = MaybeConfine(new StringRef(std::move(value)));
+}
+
+inline Value::Value(TypeKind type_kind, absl::string_view value,
+                    std::shared_ptr<const void> keep_alive)
+    : type_kind_(static_cast<int16_t>(type_kind)) {
+  CHECK(type_kind == TYPE_STRING ||
+        type_kind == TYPE_BYTES);
+  if (!SetInlineString(value)) {
+    string_length_ = kStringRefMarker;
+    string_ptr_ = MaybeConfine(
+        keep_alive == nullptr ? new StringRef(std::string(value))
+                              : new StringRef(value, std::move(keep_alive)));
+  }
+}
+
+inline char* Value::inline_string_data() {
+  return const_cast<char*>(
+      static_cast<const Value*>(this)->inline_string_data());
 }
 
-inline Value::Value(const NumericValue& numeric)
-    : type_kind_(TYPE_NUMERIC), numeric_ptr_(new NumericRef(numeric)) {
+inline const char* Value::inline_string_data() const {
+  static_assert(offsetof(Value, int64_value_) ==
+                        offsetof(Value, enum_value_) + sizeof(int32_t) &&
+                    sizeof(Value) - offsetof(Value, enum_value_) ==
+                        kMaxInlineStringLength,
+                "Inline strings must fill the 32-bit and 64-bit parts");
+  return reinterpret_cast<const char*>(this) + offsetof(Value, enum_value_);
+}
+
+inline bool Value::SetInlineString(absl::string_view value) {
+  if (value.size() > kMaxInlineStringLength) return false;
+  string_length_ = static_cast<uint8_t>(value.size());
+  if (!value.empty()) {
+    memcpy(inline_string_data(), value.data(), value.size());
+  }
+  return true;
+}
+
+inline absl::string_view Value::string_payload() const {
+  if (has_string_ref()) return string_ptr_->value();
+  return absl::string_view(inline_string_data(), string_length_);
+}
+
+inline const std::string& Value::string_payload_as_std_string() const {
+  CHECK(has_string_ref() && string_ptr_->is_owned())
+      << "Compact and external values have no std::string; use "
+         "string_view_value() or bytes_view_value()";
+  return string_ptr_->owned();
+}
+
+inline Value::Value(const NumericValue& numeric) : type_kind_(TYPE_NUMERIC) {
+  const int64_t high_bits = static_cast<int64_t>(numeric.high_bits());
+  const int32_t high_bits_32 = static_cast<int32_t>(high_bits);
+  if (high_bits_32 == high_bits && high_bits_32 != kNumericRefMarker) {
+    numeric_high_bits_ = high_bits_32;
+    numeric_low_bits_ = numeric.low_bits();
+  } else {
+    numeric_high_bits_ = kNumericRefMarker;
+    numeric_ptr_ = new NumericRef(numeric);
+  }
 }
 
 inline Value Value::Struct(const StructType* type,
@@ -323,6 +458,22 @@ inline Value Value::Bytes(const char (&str)[N]) {
   return Value::Bytes(std::string(str, N - 1));
 }
 
+inline Value Value::CompactString(absl::string_view v) {
+  return Value(TYPE_STRING, v, nullptr);
+}
+inline Value Value::CompactBytes(absl::string_view v) {
+  return Value(TYPE_BYTES, v, nullptr);
+}
+
+inline Value Value::ExternalString(absl::string_view v,
+                                   std::shared_ptr<const void> keep_alive) {
+  return Value(TYPE_STRING, v, std::move(keep_alive));
+}
+inline Value Value::ExternalBytes(absl::string_view v,
+                                  std::shared_ptr<const void> keep_alive) {
+  return Value(TYPE_BYTES, v, std::move(keep_alive));
+}
+
 inline Value Value::Date(int32_t v) {
   return Value(TYPE_DATE, v);
 }
@@ -456,13 +607,25 @@ inline double Value::double_value() const {
 inline const std::string& Value::string_value() const {
   CHECK_EQ(TYPE_STRING, type_kind_) << "Not a std::string value";
   CHECK(!is_null_) << "Null value";
-  return string_ptr_->value();
+  return string_payload_as_std_string();
 }
 
 inline const std::string& Value::bytes_value() const {
   CHECK_EQ(TYPE_BYTES, type_kind_) << "Not a bytes value";
   CHECK(!is_null_) << "Null value";
-  return string_ptr_->value();
+  return string_payload_as_std_string();
+}
+
+inline absl::string_view Value::string_view_value() const {
+  CHECK_EQ(TYPE_STRING, type_kind_) << "Not a std::string value";
+  CHECK(!is_null_) << "Null value";
+  return string_payload();
+}
+
+inline absl::string_view Value::bytes_view_value() const {
+  CHECK_EQ(TYPE_BYTES, type_kind_) << "Not a bytes value";
+  CHECK(!is_null_) << "Null value";
+  return string_payload();
 }
 
 inline int32_t Value::date_value() const {
@@ -487,18 +650,24 @@ inline DatetimeValue Value::datetime_value() const {
       bit_field_64_value_, subsecond_nanos_);
 }
 
-inline const NumericValue& Value::numeric_value() const {
+inline NumericValue Value::numeric_value() const {
   CHECK_EQ(TYPE_NUMERIC, type_kind_) << "Not a numeric type";
   CHECK(!is_null_) << "Null value";
-  return numeric_ptr_->value();
+  if (has_numeric_ref()) {
+    return numeric_ptr_->value();
+  }
+  return NumericValue(static_cast<uint64_t>(int64_t{numeric_high_bits_}),
+                      numeric_low_bits_);
 }
 
 inline bool Value::empty() const {
-  return elements().empty();
+  return num_elements() == 0;
 }
 
 inline int Value::num_elements() const {
-  return elements().size();
+  CHECK_EQ(TYPE_ARRAY, type_kind_);
+  CHECK(!is_null()) << "Null value";
+  return list_ptr_->size();
 }
 
 inline int Value::num_fields() const {
@@ -566,7 +735,7 @@ H Value::HashValueInternal(H h) const {
     }
     case TYPE_STRING:
     case TYPE_BYTES: {
-      return H::combine(std::move(h), string_ptr_->value());
+      return H::combine(std::move(h), string_payload());
     }
     case TYPE_DATE: {
       return H::combine(std::move(h), int32_value_);
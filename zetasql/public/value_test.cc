@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include <limits>
+#include <thread>  // NOLINT(build/c++11)
 #include <type_traits>
 #include <utility>
 
@@ -53,6 +54,7 @@
 namespace zetasql {
 
 using ::google::protobuf::internal::WireFormatLite;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::Not;
 using ::zetasql_base::testing::StatusIs;
@@ -217,6 +219,111 @@ TEST_F(ValueTest, StringNonNull) {
   EXPECT_EQ("foo", value_copy.string_value());
 }
 
+TEST_F(ValueTest, StringStorage) {
+  // Values around the inline size limit, including embedded zeros.
+  for (int length : {0, 1, 11, 12, 13, 100}) {
+    std::string str(length, 'x');
+    if (length > 2) str[length / 2] = '\0';
+    for (const Value& value :
+         {Value::String(str), Value::StringValue(str), Value::Bytes(str),
+          Value::CompactString(str), Value::CompactBytes(str)}) {
+      const bool is_string = value.type_kind() == TYPE_STRING;
+      EXPECT_EQ(str, is_string ? value.string_view_value()
+                               : value.bytes_view_value());
+      Value copy = value;
+      Value moved = std::move(copy);
+      EXPECT_EQ(value, moved);
+      EXPECT_EQ(value.HashCode(), moved.HashCode());
+    }
+    // Only compact values are stored inline.
+    EXPECT_EQ(length <= 12,
+              Value::CompactString(str).physical_byte_size() == sizeof(Value))
+        << length;
+    EXPECT_GT(Value::String(str).physical_byte_size(), sizeof(Value));
+    EXPECT_EQ(Value::String(str), Value::CompactString(str));
+    EXPECT_EQ(Value::String(str).HashCode(),
+              Value::CompactString(str).HashCode());
+    EXPECT_NE(Value::CompactString(str), Value::String(str + "y"));
+    EXPECT_TRUE(Value::CompactString(str).LessThan(Value::String(str + "y")));
+    EXPECT_EQ(str, Value::String(str).string_value());
+    EXPECT_EQ(str, Value::Bytes(str).bytes_value());
+  }
+
+  // Compact values hold no std::string to return a reference to.
+  EXPECT_DEATH(Value::CompactString("abc").string_value(), "string_view_value");
+
+  // External values share the caller's buffer and keep it alive.
+  const std::string long_str = "a std::string that doesn't fit inline";
+  auto buffer = std::make_shared<std::string>(long_str);
+  Value external = Value::ExternalString(*buffer, buffer);
+  EXPECT_EQ(buffer->data(), external.string_view_value().data());
+  EXPECT_EQ(2, buffer.use_count());
+  {
+    Value copy = external;
+    EXPECT_EQ(2, buffer.use_count());
+    EXPECT_EQ(Value::String(long_str), copy);
+    EXPECT_EQ(Value::String(long_str).HashCode(), copy.HashCode());
+  }
+  const std::string* data = buffer.get();
+  buffer.reset();
+  EXPECT_EQ(long_str, external.string_view_value());
+  EXPECT_EQ(data->data(), external.string_view_value().data());
+  EXPECT_DEATH(external.string_value(), "string_view_value");
+  external = Value::NullString();
+  EXPECT_TRUE(external.is_null());
+
+  // Short external values are copied.
+  auto short_buffer = std::make_shared<std::string>("abc");
+  Value short_external = Value::ExternalBytes(*short_buffer, short_buffer);
+  EXPECT_EQ(1, short_buffer.use_count());
+  EXPECT_EQ(Value::Bytes("abc"), short_external);
+}
+
+TEST_F(ValueTest, ThreadConfinedValues) {
+  const std::string long_str = "a std::string that doesn't fit inline";
+  Value value;
+  {
+    ThreadConfinedValueScope confined_values;
+    EXPECT_TRUE(ThreadConfinedValueScope::IsActive());
+    {
+      ThreadConfinedValueScope nested_scope;
+    }
+    EXPECT_TRUE(ThreadConfinedValueScope::IsActive());
+
+    // Inline values hold nothing to confine, and only strings, arrays and
+    // structs are confined.
+    EXPECT_TRUE(Value::CompactString("abc").IsShareable());
+    EXPECT_TRUE(Value::Int64(1).IsShareable());
+    EXPECT_TRUE(Value::Numeric(NumericValue::MaxValue()).IsShareable());
+    EXPECT_FALSE(Value::String(long_str).IsShareable());
+    EXPECT_FALSE(Int64Array({1, 2, 3}).IsShareable());
+
+    value = Struct({"a", "b"}, {Array({String(long_str), NullString()}),
+                                Int64(2)});
+    EXPECT_FALSE(value.IsShareable());
+    Value copy = value;
+    EXPECT_EQ(value, copy);
+  }
+  EXPECT_FALSE(ThreadConfinedValueScope::IsActive());
+  EXPECT_FALSE(value.IsShareable());
+
+  // Values created outside a scope are shareable, even if they contain
+  // confined values.
+  Value array = Value::Array(types::StringArrayType(),
+                             {value.field(0).element(0), String("x")});
+  EXPECT_FALSE(array.IsShareable());
+  value.MakeShareable();
+  EXPECT_TRUE(value.IsShareable());
+  EXPECT_TRUE(array.IsShareable());
+
+  std::thread other_thread([&value, &long_str] {
+    Value copy = value;
+    EXPECT_EQ(long_str, copy.field(0).element(0).string_value());
+  });
+  other_thread.join();
+  EXPECT_EQ(Value::String(long_str), value.field(0).element(0));
+}
+
 void disguised_move(Value& o1, Value& o2) {  // NOLINT
   o1 = std::move(o2);
 }
@@ -392,6 +499,38 @@ TEST_F(ValueTest, Numeric) {
     EXPECT_TRUE(!value.is_null());
     EXPECT_EQ(NumericValue(123LL), value.numeric_value());
   }
+
+  // Small values are stored inline, large ones in a NumericRef. Both behave
+  // the same.
+  const std::vector<NumericValue> numerics = {
+      NumericValue(0LL),
+      NumericValue(-1LL),
+      NumericValue::FromString("12345678901.123456789").ValueOrDie(),
+      NumericValue::FromString("-39614081257.132168796").ValueOrDie(),
+      NumericValue::FromString("39614081257.132168797").ValueOrDie(),
+      NumericValue::FromString("-39614081257132168796.771975168")
+          .ValueOrDie(),
+      NumericValue::FromString("39614081257132168796.771975167")
+          .ValueOrDie(),
+      NumericValue::FromString("39614081257132168796.771975168")
+          .ValueOrDie(),
+      NumericValue::MaxValue(),
+      NumericValue::MinValue()};
+  for (const NumericValue& numeric : numerics) {
+    Value v1 = Value::Numeric(numeric);
+    EXPECT_EQ(numeric, v1.numeric_value());
+    Value v2(v1);
+    EXPECT_EQ(numeric, v2.numeric_value());
+    Value v3 = Value::NullNumeric();
+    v3 = v2;
+    v1 = Value::Int32(1);
+    EXPECT_EQ(numeric, v3.numeric_value());
+    EXPECT_EQ(Value::Numeric(numeric), v3);
+    EXPECT_EQ(Value::Numeric(numeric).HashCode(), v3.HashCode());
+    EXPECT_NE(Value::NullNumeric(), v3);
+  }
+  EXPECT_LT(Value::Numeric(NumericValue(1LL)).physical_byte_size(),
+            Value::Numeric(NumericValue::MaxValue()).physical_byte_size());
 }
 
 TEST_F(ValueTest, GenericAccessors) {
@@ -937,6 +1076,82 @@ TEST_F(ValueTest, DoubleArray) {
             v2.GetSQLLiteral(PRODUCT_INTERNAL));
 }
 
+TEST_F(ValueTest, PackedArray) {
+  Value v1 = Int64Array({1, -2, 3});
+  ASSERT_TRUE(v1.has_packed_elements());
+  EXPECT_THAT(v1.packed_int64_elements(), ElementsAre(1, -2, 3));
+  EXPECT_EQ(3, v1.num_elements());
+  EXPECT_FALSE(v1.empty());
+  EXPECT_FALSE(v1.packed_element_is_null(0));
+  // Legacy accessors see the same elements.
+  EXPECT_EQ(Int64(-2), v1.element(1));
+  EXPECT_EQ(3, v1.elements().size());
+  EXPECT_EQ("[1, -2, 3]", v1.DebugString());
+
+  // Packed and unpacked arrays with the same elements are equal, and hash the
+  // same.
+  Value v2 = Value::Array(Int64ArrayType(), {Int64(1), Int64(-2), Int64(3)});
+  EXPECT_FALSE(v2.has_packed_elements());
+  EXPECT_EQ(v1, v2);
+  EXPECT_EQ(v1.HashCode(), v2.HashCode());
+  EXPECT_EQ(v1, Int64Array({1, -2, 3}));
+  EXPECT_NE(v1, Int64Array({1, -2, 4}));
+  EXPECT_NE(v1, Int64Array({1, -2}));
+
+  const std::vector<int32_t> int32s = {5, 0, 7};
+  Value v3 = Value::PackedArray(Int32ArrayType(), int32s, {false, true, false});
+  ASSERT_TRUE(v3.has_packed_elements());
+  EXPECT_TRUE(v3.packed_element_is_null(1));
+  EXPECT_EQ(Int32(5), v3.element(0));
+  EXPECT_EQ(NullInt32(), v3.element(1));
+  EXPECT_EQ(Value::Array(Int32ArrayType(), {Int32(5), NullInt32(), Int32(7)}),
+            v3);
+
+  Value v4 = DateArray({0, 17000});
+  EXPECT_THAT(v4.packed_date_elements(), ElementsAre(0, 17000));
+  EXPECT_EQ(Date(17000), v4.element(1));
+
+  Value v5 = BoolArray({true, false, true});
+  EXPECT_THAT(v5.packed_bool_elements(),
+              ElementsAre(true, false, true));
+  EXPECT_EQ(False(), v5.element(1));
+
+  Value v6 = DoubleArray({1.5, std::numeric_limits<double>::quiet_NaN()});
+  EXPECT_EQ(v6, DoubleArray({1.5, std::numeric_limits<double>::quiet_NaN()}));
+  EXPECT_EQ(DoubleArray({0.0}), DoubleArray({-0.0}));
+
+  EXPECT_TRUE(Int64Array({}).empty());
+  EXPECT_EQ(0, Int64Array({}).num_elements());
+  EXPECT_TRUE(Int64Array({}).packed_int64_elements().empty());
+}
+
+TEST_F(ValueTest, PackedArrayKeptAfterMaterialization) {
+  Value value = Value::PackedArray(
+      Int64ArrayType(), std::vector<int64_t>{1, 2, 3}, {false, true, false});
+  const uint64_t packed_size = value.physical_byte_size();
+  absl::Span<const int64_t> packed = value.packed_int64_elements();
+  EXPECT_EQ(NullInt64(), value.element(1));
+  EXPECT_TRUE(value.has_packed_elements());
+  EXPECT_EQ(packed.data(), value.packed_int64_elements().data());
+  EXPECT_EQ(3, value.num_elements());
+  EXPECT_EQ(Value::Array(Int64ArrayType(), {Int64(1), NullInt64(), Int64(3)}),
+            value);
+  EXPECT_EQ(packed_size, value.physical_byte_size());
+
+  // Materializing on one thread doesn't disturb readers of the buffer on
+  // another.
+  const Value shared = Int64Array({4, 5});
+  std::thread reader([&shared] {
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_THAT(shared.packed_int64_elements(), ElementsAre(4, 5));
+    }
+  });
+  EXPECT_EQ(Int64(5), shared.element(1));
+  reader.join();
+  EXPECT_TRUE(shared.has_packed_elements());
+  EXPECT_EQ(shared, Int64Array({4, 5}));
+}
+
 TEST_F(ValueTest, ArrayBag) {
   std::vector<Value> values = {Int64(1), Int64(2), Int64(1), NullInt64(),
                                NullInt64()};
@@ -1970,6 +2185,9 @@ TEST_F(ValueTest, Serialize) {
   SerializeDeserialize(
       Array({NullInt64(), Int64(std::numeric_limits<int64_t>::lowest()),
              Int64(std::numeric_limits<int64_t>::max()), Int64(0)}));
+  SerializeDeserialize(Int64Array({std::numeric_limits<int64_t>::lowest(), 0}));
+  SerializeDeserialize(Value::PackedArray(
+      Int64ArrayType(), std::vector<int64_t>{1, 2}, {true, false}));
 
   SerializeDeserialize(NullUint32());
   SerializeDeserialize(Uint32(42));
@@ -16,6 +16,8 @@
 
 #include "zetasql/resolved_ast/resolved_node.h"
 
+#include <cstddef>
+#include <new>
 #include <queue>
 
 #include "zetasql/base/logging.h"
@@ -31,13 +33,57 @@
 #include "zetasql/resolved_ast/resolved_ast.h"
 #include "zetasql/resolved_ast/resolved_column.h"
 #include "zetasql/public/parse_location_range.pb.h"
-#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "zetasql/base/map_util.h"
 
 namespace zetasql {
 
+namespace {
+
+// The arena that ResolvedNode::operator new allocates from on this thread, or
+// NULL to allocate from the heap. Set by ResolvedNodeArenaScope.
+thread_local zetasql_base::UnsafeArena* resolved_node_arena = nullptr;
+
+// Whether the node that operator delete is about to free was allocated from an
+// arena. Set by ~ResolvedNode, which always runs immediately before it.
+thread_local bool deleting_arena_node = false;
+
+}  // namespace
+
+void* ResolvedNode::operator new(size_t size) {
+  if (resolved_node_arena != nullptr) {
+    return resolved_node_arena->AllocAligned(size, alignof(std::max_align_t));
+  }
+  return ::operator new(size);
+}
+
+void ResolvedNode::operator delete(void* node) {
+  if (!deleting_arena_node) {
+    ::operator delete(node);
+  }
+}
+
+// Nodes are always constructed in the same scope as their operator new ran in,
+// so the innermost scope also tells where this node was allocated.
+ResolvedNode::ResolvedNode()
+    : allocated_in_arena_(resolved_node_arena != nullptr) {}
+
+ResolvedNode::~ResolvedNode() {
+  ClearParseLocationRange();
+  deleting_arena_node = allocated_in_arena_;
+}
+
+ResolvedNodeArenaScope::ResolvedNodeArenaScope(
+    zetasql_base::UnsafeArena* arena)
+    : previous_arena_(resolved_node_arena) {
+  resolved_node_arena = arena;
+}
+
+ResolvedNodeArenaScope::~ResolvedNodeArenaScope() {
+  resolved_node_arena = previous_arena_;
+}
+
 // ResolvedNode::RestoreFrom is generated in resolved_node.cc.template.
 
 zetasql_base::Status ResolvedNode::Accept(ResolvedASTVisitor* visitor) const {
@@ -50,11 +96,26 @@ zetasql_base::Status ResolvedNode::ChildrenAccept(ResolvedASTVisitor* visitor) c
 
 void ResolvedNode::SetParseLocationRange(
     const ParseLocationRange& parse_location_range) {
-  parse_location_range_ =
-      absl::make_unique<ParseLocationRange>(parse_location_range);
+  ClearParseLocationRange();
+  // ParseLocationRange is trivially destructible, so arena-allocated nodes keep
+  // it in the arena too, and never free it.
+  if (allocated_in_arena_ && resolved_node_arena != nullptr) {
+    parse_location_range_ = new (resolved_node_arena->AllocAligned(
+        sizeof(ParseLocationRange), alignof(ParseLocationRange)))
+        ParseLocationRange(parse_location_range);
+    parse_location_range_in_arena_ = true;
+  } else {
+    parse_location_range_ = new ParseLocationRange(parse_location_range);
+  }
 }
 
-void ResolvedNode::ClearParseLocationRange() { parse_location_range_.reset(); }
+void ResolvedNode::ClearParseLocationRange() {
+  if (!parse_location_range_in_arena_) {
+    delete parse_location_range_;
+  }
+  parse_location_range_ = nullptr;
+  parse_location_range_in_arena_ = false;
+}
 
 std::string ResolvedNode::DebugString() const {
   std::string output;
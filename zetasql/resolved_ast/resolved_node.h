@@ -17,6 +17,7 @@
 #ifndef ZETASQL_RESOLVED_AST_RESOLVED_NODE_H_
 #define ZETASQL_RESOLVED_AST_RESOLVED_NODE_H_
 
+#include <cstddef>
 #include <memory>
 #include <set>
 #include <string>
@@ -24,6 +25,7 @@
 #include <vector>
 
 #include "google/protobuf/descriptor.h"
+#include "zetasql/base/arena.h"
 #include "zetasql/public/catalog.h"
 #include "zetasql/public/id_string.h"
 #include "zetasql/public/parse_location.h"
@@ -56,10 +58,20 @@ class ResolvedNode {
  public:
   using SUPER = void;  // Indicates that ResolvedNode has no parent.
 
-  ResolvedNode() {}
+  ResolvedNode();
   ResolvedNode(const ResolvedNode&) = delete;
   ResolvedNode& operator=(const ResolvedNode&) = delete;
-  virtual ~ResolvedNode() {}
+  virtual ~ResolvedNode();
+
+  // Nodes are allocated from the arena of the innermost ResolvedNodeArenaScope
+  // on the current thread, if there is one, and from the heap otherwise.
+  // Heap-allocated nodes have no per-node overhead for this. Deleting a node
+  // allocated from an arena runs its destructor, which releases the heap
+  // memory owned by its fields, but leaves the node itself (and its parse
+  // location range) to be reclaimed with the arena. Nodes can therefore still
+  // be owned through std::unique_ptr regardless of where they were allocated.
+  static void* operator new(size_t size);
+  static void operator delete(void* node);
 
   // Return this node's kind.
   // e.g. zetasql::RESOLVED_TABLE_SCAN for ResolvedTableScan.
@@ -227,10 +239,10 @@ class ResolvedNode {
   // particular) and only if AnalyzerOption::record_parse_locations() is set.
   // DEPRECATED: Use GetParseLocationRangeOrNULL().
   const ParseLocationRange* GetParseLocationOrNULL() const {
-    return parse_location_range_.get();
+    return parse_location_range_;
   }
   const ParseLocationRange* GetParseLocationRangeOrNULL() const {
-    return parse_location_range_.get();
+    return parse_location_range_;
   }
 
   // Returns the depth of the Resolved AST tree rooted at the current node.
@@ -315,7 +327,30 @@ class ResolvedNode {
   friend class ResolvedMakeProtoField;
   friend class ResolvedOutputColumn;
 
-  std::unique_ptr<ParseLocationRange> parse_location_range_;  // May be NULL.
+  // May be NULL. Owned, unless <parse_location_range_in_arena_>.
+  ParseLocationRange* parse_location_range_ = nullptr;
+
+  // Stored after the pointers so that derived classes can reuse the padding.
+  const bool allocated_in_arena_;
+  bool parse_location_range_in_arena_ = false;
+};
+
+// While a ResolvedNodeArenaScope is alive, ResolvedNodes created on the
+// current thread are allocated from <arena>, or from the heap if <arena> is
+// NULL. Scopes can be nested; the innermost scope wins.
+//
+// The arena must outlive every node allocated from it, including nodes that
+// were released from their original owner. Typically this is the arena()
+// of an AnalyzerOutput, which the AnalyzerOutput keeps alive.
+class ResolvedNodeArenaScope {
+ public:
+  explicit ResolvedNodeArenaScope(zetasql_base::UnsafeArena* arena);
+  ResolvedNodeArenaScope(const ResolvedNodeArenaScope&) = delete;
+  ResolvedNodeArenaScope& operator=(const ResolvedNodeArenaScope&) = delete;
+  ~ResolvedNodeArenaScope();
+
+ private:
+  zetasql_base::UnsafeArena* const previous_arena_;
 };
 
 }  // namespace zetasql
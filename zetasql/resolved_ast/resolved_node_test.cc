@@ -0,0 +1,102 @@
+//
+// Copyright 2019 ZetaSQL Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "zetasql/resolved_ast/resolved_node.h"
+
+#include <memory>
+#include <vector>
+
+#include "zetasql/base/arena.h"
+#include "zetasql/public/parse_location.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "gtest/gtest.h"
+
+namespace zetasql {
+
+TEST(ResolvedNodeArenaScopeTest, AllocatesFromInnermostScope) {
+  zetasql_base::UnsafeArena arena(/*block_size=*/4096);
+  const size_t initial_bytes = arena.status().bytes_allocated();
+
+  std::unique_ptr<ResolvedLiteral> heap_literal =
+      MakeResolvedLiteral(Value::Int64(1));
+  EXPECT_EQ(initial_bytes, arena.status().bytes_allocated());
+
+  // Enough nodes to need more than the arena's first block.
+  std::vector<std::unique_ptr<const ResolvedExpr>> arguments;
+  std::unique_ptr<ResolvedLiteral> nested_heap_literal;
+  {
+    ResolvedNodeArenaScope scope(&arena);
+    for (int i = 0; i < 100; ++i) {
+      arguments.push_back(MakeResolvedLiteral(Value::String("abc")));
+    }
+    {
+      ResolvedNodeArenaScope heap_scope(/*arena=*/nullptr);
+      nested_heap_literal = MakeResolvedLiteral(Value::Int64(2));
+    }
+  }
+  const size_t arena_bytes = arena.status().bytes_allocated();
+  EXPECT_GT(arena_bytes, initial_bytes);
+
+  // Nodes stay valid outside of the scope, and can be mixed freely.
+  arguments.push_back(std::move(heap_literal));
+  arguments.push_back(std::move(nested_heap_literal));
+  std::unique_ptr<ResolvedMakeStruct> make_struct = MakeResolvedMakeStruct(
+      types::EmptyStructType(), std::move(arguments));
+  EXPECT_EQ(Value::String("abc"),
+            make_struct->field_list(0)->GetAs<ResolvedLiteral>()->value());
+  EXPECT_EQ(arena_bytes, arena.status().bytes_allocated());
+
+  // Deleting arena-allocated nodes doesn't free their memory.
+  make_struct.reset();
+  EXPECT_EQ(arena_bytes, arena.status().bytes_allocated());
+}
+
+TEST(ResolvedNodeArenaScopeTest, ParseLocationRangeFollowsNode) {
+  zetasql_base::UnsafeArena arena(/*block_size=*/4096);
+  ParseLocationRange range;
+  range.set_start(ParseLocationPoint::FromByteOffset(1));
+  range.set_end(ParseLocationPoint::FromByteOffset(3));
+
+  std::unique_ptr<ResolvedLiteral> arena_literal;
+  std::unique_ptr<ResolvedLiteral> heap_literal;
+  {
+    ResolvedNodeArenaScope scope(&arena);
+    arena_literal = MakeResolvedLiteral(Value::Int64(1));
+    ResolvedNodeArenaScope heap_scope(/*arena=*/nullptr);
+    heap_literal = MakeResolvedLiteral(Value::Int64(2));
+  }
+
+  {
+    ResolvedNodeArenaScope scope(&arena);
+    const size_t bytes = arena.status().bytes_allocated();
+    heap_literal->SetParseLocationRange(range);
+    EXPECT_EQ(bytes, arena.status().bytes_allocated());
+    arena_literal->SetParseLocationRange(range);
+    arena_literal->SetParseLocationRange(range);
+  }
+  EXPECT_EQ(range, *arena_literal->GetParseLocationRangeOrNULL());
+  EXPECT_EQ(range, *heap_literal->GetParseLocationRangeOrNULL());
+
+  // Outside of a scope, ranges of arena-allocated nodes go on the heap.
+  arena_literal->SetParseLocationRange(range);
+  EXPECT_EQ(range, *arena_literal->GetParseLocationRangeOrNULL());
+  arena_literal->ClearParseLocationRange();
+  EXPECT_EQ(nullptr, arena_literal->GetParseLocationRangeOrNULL());
+}
+
+}  // namespace zetasql
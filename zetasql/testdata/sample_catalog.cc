@@ -132,7 +132,8 @@ static zetasql_base::StatusOr<const Type*> ComputeResultTypeCallbackForNullOfTyp
   ZETASQL_RET_CHECK(arguments[0].type()->IsString());
   const Value& value = *arguments[0].literal_value();
   ZETASQL_RET_CHECK(!value.is_null());
-  const std::string& type_name = absl::AsciiStrToUpper(value.string_value());
+  const std::string type_name =
+      absl::AsciiStrToUpper(value.string_view_value());
   if (!Type::IsSimpleTypeName(type_name, language_options.product_mode())) {
     return MakeSqlError() << "Type not implemented for NULL_OF_TYPE: "
                           << ToStringLiteral(type_name);
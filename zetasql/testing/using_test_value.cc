@@ -104,6 +104,7 @@ using zetasql::values::NullUint64;
 
 using zetasql::values::BoolArray;
 using zetasql::values::BytesArray;
+using zetasql::values::DateArray;
 using zetasql::values::DoubleArray;
 using zetasql::values::FloatArray;
 using zetasql::values::Int32Array;